@@ -1,12 +1,15 @@
 // SPDX-FileCopyrightText: Copyright 2023 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <string>
+#include <thread>
 
 #include "audio_core/adsp/apps/audio_renderer/command_list_processor.h"
 #include "audio_core/renderer/command/command_list_header.h"
 #include "audio_core/renderer/command/commands.h"
 #include "common/settings.h"
+#include "common/thread_worker.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/kernel/k_process.h"
@@ -14,6 +17,41 @@
 
 namespace AudioCore::ADSP::AudioRenderer {
 
+namespace {
+/// Runs with fewer voices than this are processed on the renderer thread
+constexpr size_t MinParallelVoiceSegments = 16;
+
+void ProcessVoiceCommands(const CommandListProcessor& processor, u8* begin, const u8* end) {
+    while (begin != end) {
+        auto& command{*reinterpret_cast<Renderer::ICommand*>(begin)};
+        if (command.enabled && command.type != Renderer::CommandId::DepopPrepare) {
+            command.Process(processor);
+        }
+        begin += command.size;
+    }
+}
+} // Anonymous namespace
+
+struct CommandListProcessor::VoiceWorkers {
+    explicit VoiceWorkers(u32 num_threads)
+        : num_chunks{num_threads * 2}, chunks{std::make_unique<Chunk[]>(num_chunks)},
+          workers{num_threads, "AudioVoiceWorker"} {}
+
+    /// Contiguous voice segments processed by one task, with their own mix buffers
+    struct Chunk {
+        CommandListProcessor processor;
+        std::vector<s32> mix_buffers;
+    };
+
+    size_t num_chunks;
+    std::unique_ptr<Chunk[]> chunks;
+    Common::ThreadWorker workers;
+};
+
+CommandListProcessor::CommandListProcessor() = default;
+
+CommandListProcessor::~CommandListProcessor() = default;
+
 void CommandListProcessor::Initialize(Core::System& system_, Kernel::KProcess& process,
                                       CpuAddr buffer, u64 size, Sink::SinkStream* stream_) {
     system = &system_;
@@ -58,6 +96,14 @@ u64 CommandListProcessor::Process(u32 session_id) {
     for (u32 index = 0; index < command_count; index++) {
         auto& command{*reinterpret_cast<Renderer::ICommand*>(commands)};
 
+        if (command.voice_segment != 0 && !Settings::values.dump_audio_commands) {
+            const auto processed{ProcessVoiceSegments(command_base, command_count - index)};
+            if (processed != 0) {
+                index += processed - 1;
+                continue;
+            }
+        }
+
         if (command.magic != 0xCAFEBABE) {
             LOG_ERROR(Service_Audio, "Command has invalid magic! Expected 0xCAFEBABE, got {:08X}",
                       command.magic);
@@ -101,4 +147,91 @@ u64 CommandListProcessor::Process(u32 session_id) {
     return end_time - start_time_;
 }
 
+u32 CommandListProcessor::ProcessVoiceSegments(const CpuAddr command_base, const u32 max_commands) {
+    voice_segments.clear();
+    u8* end{commands};
+    u32 run_count{0};
+    u32 current_segment{0};
+    while (run_count < max_commands) {
+        auto& command{*reinterpret_cast<Renderer::ICommand*>(end)};
+        if (command.magic != Renderer::CommandMagic || command.voice_segment == 0 ||
+            CpuAddr(end) - command_base + command.size > commands_buffer_size ||
+            !command.Verify(*this)) {
+            break;
+        }
+        if (command.voice_segment != current_segment) {
+            current_segment = command.voice_segment;
+            voice_segments.push_back(end);
+        }
+        end += command.size;
+        run_count++;
+    }
+    if (run_count == 0) {
+        return 0;
+    }
+
+    // Depop prepare commands accumulate into the depop buffer shared by all voices, so they are
+    // processed first and in order. Nothing else in a voice depends on them.
+    for (u8* it = commands; it != end;) {
+        auto& command{*reinterpret_cast<Renderer::ICommand*>(it)};
+        if (command.enabled && command.type == Renderer::CommandId::DepopPrepare) {
+            command.Process(*this);
+        }
+        it += command.size;
+    }
+
+    if (voice_segments.size() < MinParallelVoiceSegments || buffer_count < MaxChannels) {
+        ProcessVoiceCommands(*this, commands, end);
+    } else {
+        if (!voice_workers) {
+            voice_workers = std::make_unique<VoiceWorkers>(
+                std::max(std::thread::hardware_concurrency(), 2U) / 2);
+        }
+        // The voice channel buffers are the last MaxChannels mix buffers, voices decode into them
+        // and add into the mix buffers before them. Each chunk gets its own voice channels.
+        const size_t mix_size{(buffer_count - MaxChannels) * sample_count};
+        const size_t num_segments{voice_segments.size()};
+        const size_t num_chunks{std::min(num_segments, voice_workers->num_chunks)};
+        voice_segments.push_back(end);
+
+        for (size_t i = 0; i < num_chunks; i++) {
+            auto& chunk{voice_workers->chunks[i]};
+            chunk.mix_buffers.resize(static_cast<size_t>(buffer_count) * sample_count);
+            std::fill_n(chunk.mix_buffers.begin(), mix_size, 0);
+
+            auto& worker{chunk.processor};
+            worker.system = system;
+            worker.memory = memory;
+            worker.header = header;
+            worker.sample_count = sample_count;
+            worker.target_sample_rate = target_sample_rate;
+            worker.mix_buffers = chunk.mix_buffers;
+            worker.buffer_count = buffer_count;
+            worker.start_time = start_time;
+            worker.current_processing_time = current_processing_time;
+
+            u8* const first{voice_segments[i * num_segments / num_chunks]};
+            const u8* const last{voice_segments[(i + 1) * num_segments / num_chunks]};
+            voice_workers->workers.QueueWork(
+                [&worker, first, last] { ProcessVoiceCommands(worker, first, last); });
+        }
+        voice_workers->workers.WaitForRequests();
+
+        // Mixing only ever adds a rounded product to the output, which wraps like an unsigned
+        // add. Summing the chunks in any order gives the same samples as mixing the voices in
+        // order.
+        for (size_t i = 0; i < num_chunks; i++) {
+            const auto& chunk_buffers{voice_workers->chunks[i].mix_buffers};
+            for (size_t sample = 0; sample < mix_size; sample++) {
+                mix_buffers[sample] = static_cast<s32>(static_cast<u32>(mix_buffers[sample]) +
+                                                       static_cast<u32>(chunk_buffers[sample]));
+            }
+        }
+    }
+
+    processed_command_count += run_count;
+    commands = end;
+    return run_count;
+}
+
 } // namespace AudioCore::ADSP::AudioRenderer
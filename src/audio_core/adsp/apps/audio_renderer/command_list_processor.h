@@ -3,7 +3,10 @@
 
 #pragma once
 
+#include <memory>
 #include <span>
+#include <string>
+#include <vector>
 
 #include "audio_core/common/common.h"
 #include "audio_core/renderer/command/command_list_header.h"
@@ -36,6 +39,9 @@ namespace ADSP::AudioRenderer {
  */
 class CommandListProcessor {
 public:
+    CommandListProcessor();
+    ~CommandListProcessor();
+
     /**
      * Initialize the processor.
      *
@@ -111,6 +117,26 @@ public:
     u64 end_time{};
     /// Last command list string generated, used for dumping audio commands to console
     std::string last_dump{};
+
+private:
+    struct VoiceWorkers;
+
+    /**
+     * Process the run of voice segments starting at the current command, on the voice workers
+     * when there are enough of them. Stops before the first command that is not part of a voice
+     * segment or is not valid, which is then left to the caller.
+     *
+     * @param command_base - Address the command buffer size is checked from.
+     * @param max_commands - Maximum number of commands to process.
+     *
+     * @return The number of commands processed.
+     */
+    u32 ProcessVoiceSegments(CpuAddr command_base, u32 max_commands);
+
+    /// First command of each voice segment in the current run
+    std::vector<u8*> voice_segments{};
+    /// Workers processing voice segments in parallel, created on first use
+    std::unique_ptr<VoiceWorkers> voice_workers{};
 };
 
 } // namespace ADSP::AudioRenderer
@@ -34,6 +34,9 @@ T& CommandBuffer::GenerateStart(const s32 node_id) {
     cmd.type = Id;
     cmd.size = sizeof(T);
     cmd.node_id = node_id;
+    // Performance commands write the time since the start of the command list and count the
+    // entries in the shared frame header, so they stay in order outside of the voice segments.
+    cmd.voice_segment = Id == CommandId::Performance ? 0 : voice_segment;
 
     return cmd;
 }
@@ -713,4 +716,12 @@ void CommandBuffer::GenerateCompressorCommand(s16 buffer_offset, EffectInfoBase&
     GenerateEnd<CompressorCommand>(cmd);
 }
 
+void CommandBuffer::BeginVoiceSegment() {
+    voice_segment = ++voice_segment_count;
+}
+
+void CommandBuffer::EndVoiceSegment() {
+    voice_segment = 0;
+}
+
 } // namespace AudioCore::Renderer
@@ -439,6 +439,17 @@ public:
      */
     void GenerateCompressorCommand(s16 buffer_offset, EffectInfoBase& effect_info, s32 node_id);
 
+    /**
+     * Begin a voice segment, commands generated until EndVoiceSegment are tagged with it.
+     * See ICommand::voice_segment.
+     */
+    void BeginVoiceSegment();
+
+    /**
+     * End the current voice segment.
+     */
+    void EndVoiceSegment();
+
     /// Command list buffer generated commands will be added to
     std::span<u8> command_list{};
     /// Input sample count, unused
@@ -457,6 +468,10 @@ public:
     ICommandProcessingTimeEstimator* time_estimator{};
     /// Used to check which rendering features are currently enabled
     BehaviorInfo* behavior{};
+    /// Voice segment of the commands being generated, 0 outside of a segment
+    u32 voice_segment{};
+    /// Number of voice segments generated so far
+    u32 voice_segment_count{};
 
 private:
     template <typename T, CommandId Id>
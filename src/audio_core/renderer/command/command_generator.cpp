@@ -282,6 +282,15 @@ void CommandGenerator::GenerateVoiceCommands() {
             continue;
         }
 
+        // Voices without a data source read whatever the previous voice left in the voice
+        // buffers, so they must stay in order with the others.
+        const bool is_independent{sorted_info->sample_format == SampleFormat::PcmInt16 ||
+                                  sorted_info->sample_format == SampleFormat::PcmFloat ||
+                                  sorted_info->sample_format == SampleFormat::Adpcm};
+        if (is_independent) {
+            command_buffer.BeginVoiceSegment();
+        }
+
         EntryAspect voice_entry_aspect(*this, PerformanceEntryType::Voice, sorted_info->node_id);
 
         GenerateVoiceCommand(*sorted_info);
@@ -291,6 +300,8 @@ void CommandGenerator::GenerateVoiceCommands() {
                                                       PerformanceState::Stop,
                                                       voice_entry_aspect.performance_entry_address);
         }
+
+        command_buffer.EndVoiceSegment();
     }
 
     splitter_context.UpdateInternalState();
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2022 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <array>
 #include <vector>
 
@@ -240,6 +241,10 @@ void DecodeFromWaveBuffers(Core::Memory::Memory& memory, const DecodeFromWaveBuf
         index = (index + 1) % MaxWaveBuffers;
         consumed++;
     };
+    // Samples not decoded, when the voice starves, are silent rather than what the previous voice
+    // left in the buffer. This keeps every voice independent of the ones processed before it.
+    std::ranges::fill(args.output, 0);
+
     auto& voice_state{*args.voice_state};
     auto remaining_sample_count{args.sample_count};
     auto fraction{voice_state.fraction};
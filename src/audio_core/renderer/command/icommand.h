@@ -93,6 +93,11 @@ struct ICommand {
     u32 estimated_process_time{};
     /// Node id of the voice or mix this command was generated from
     u32 node_id{};
+    /// Voice segment this command belongs to, 0 if it is not part of one. Consecutive commands
+    /// with the same segment make up one voice, which only depends on its own state and only
+    /// adds into the mix buffers, so segments can be processed in any order. Performance
+    /// commands are never part of a segment.
+    u32 voice_segment{};
 };
 
 } // namespace AudioCore::Renderer
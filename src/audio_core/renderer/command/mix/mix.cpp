@@ -7,6 +7,7 @@
 
 #include "audio_core/adsp/apps/audio_renderer/command_list_processor.h"
 #include "audio_core/renderer/command/mix/mix.h"
+#include "audio_core/renderer/command/mix/mix_kernels.h"
 #include "common/fixed_point.h"
 
 namespace AudioCore::Renderer {
@@ -23,9 +24,7 @@ template <size_t Q>
 static void ApplyMix(std::span<s32> output, std::span<const s32> input, const f32 volume_,
                      const u32 sample_count) {
     const Common::FixedPoint<64 - Q, Q> volume{volume_};
-    for (u32 i = 0; i < sample_count; i++) {
-        output[i] = (output[i] + input[i] * volume).to_int();
-    }
+    MixSamples(output.first(sample_count), input, volume.to_raw(), 0, Q);
 }
 
 void MixCommand::Dump([[maybe_unused]] const AudioRenderer::CommandListProcessor& processor,
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <limits>
+
+#include "audio_core/renderer/command/mix/mix_kernels.h"
+#include "common/assert.h"
+
+#if defined(ARCHITECTURE_x86_64)
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace AudioCore::Renderer {
+namespace {
+/// Number of samples processed by each iteration of the vectorized kernels
+constexpr s64 VECTOR_SIZE = 8;
+
+/// Same rounding as Common::FixedPoint::to_int
+s32 RoundToInt(s64 value, u32 q) {
+    const s64 fractional_mask = (s64{1} << q) - 1;
+    return static_cast<s32>((value + ((value & fractional_mask) >> 1)) >> q);
+}
+
+namespace Generic {
+void Gain(s32* output, const s32* input, u32 count, s64 volume, s64 ramp, u32 q) {
+    for (u32 i = 0; i < count; i++) {
+        output[i] = RoundToInt(input[i] * volume, q);
+        volume += ramp;
+    }
+}
+
+void Mix(s32* output, const s32* input, u32 count, s64 volume, s64 ramp, u32 q) {
+    for (u32 i = 0; i < count; i++) {
+        output[i] = RoundToInt((s64{output[i]} << q) + input[i] * volume, q);
+        volume += ramp;
+    }
+}
+} // namespace Generic
+
+constexpr MixKernels GENERIC_KERNELS{
+    .gain = Generic::Gain,
+    .mix = Generic::Mix,
+};
+
+#if defined(ARCHITECTURE_x86_64)
+constexpr MixKernels AVX2_KERNELS{
+    .gain = AVX2::Gain,
+    .mix = AVX2::Mix,
+};
+#endif
+
+bool FitsInS32(s64 value) {
+    return value >= std::numeric_limits<s32>::min() && value <= std::numeric_limits<s32>::max();
+}
+
+/// Vectorized kernels multiply 32-bit volumes, check every volume the ramp goes through fits
+bool CanVectorize(size_t count, s64 volume, s64 ramp) {
+    const s64 last_volume = volume + ramp * static_cast<s64>(count - 1);
+    return count >= VECTOR_SIZE && FitsInS32(volume) && FitsInS32(last_volume) &&
+           FitsInS32(ramp * VECTOR_SIZE);
+}
+
+const MixKernels& GetKernels(size_t count, s64 volume, s64 ramp) {
+    static const MixKernels& host_kernels = GetMixKernels(GetHostMixKernelLevel());
+    return CanVectorize(count, volume, ramp) ? host_kernels : GENERIC_KERNELS;
+}
+} // Anonymous namespace
+
+const MixKernels& GetMixKernels(MixKernelLevel level) {
+    switch (level) {
+    case MixKernelLevel::AVX2:
+#if defined(ARCHITECTURE_x86_64)
+        return AVX2_KERNELS;
+#endif
+        [[fallthrough]];
+    case MixKernelLevel::Generic:
+        break;
+    }
+    return GENERIC_KERNELS;
+}
+
+MixKernelLevel GetHostMixKernelLevel() {
+#if defined(ARCHITECTURE_x86_64)
+    static const bool has_avx2 = Common::GetCPUCaps().avx2;
+    return has_avx2 ? MixKernelLevel::AVX2 : MixKernelLevel::Generic;
+#else
+    return MixKernelLevel::Generic;
+#endif
+}
+
+void GainSamples(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp, u32 q) {
+    ASSERT(input.size() >= output.size());
+    GetKernels(output.size(), volume, ramp)
+        .gain(output.data(), input.data(), static_cast<u32>(output.size()), volume, ramp, q);
+}
+
+void MixSamples(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp, u32 q) {
+    ASSERT(input.size() >= output.size());
+    GetKernels(output.size(), volume, ramp)
+        .mix(output.data(), input.data(), static_cast<u32>(output.size()), volume, ramp, q);
+}
+
+} // namespace AudioCore::Renderer
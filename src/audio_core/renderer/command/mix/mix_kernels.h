@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <span>
+
+#include "common/common_types.h"
+
+namespace AudioCore::Renderer {
+
+/**
+ * Apply a fixed point volume to samples, rounding the same way as Common::FixedPoint::to_int.
+ *
+ * @param output - Output samples, may be the same buffer as the input.
+ * @param input  - Input samples.
+ * @param count  - Number of samples to process.
+ * @param volume - Raw fixed point volume of the first sample.
+ * @param ramp   - Raw fixed point volume added after every sample.
+ * @param q      - Number of fractional bits of the volume.
+ */
+using GainFn = void (*)(s32* output, const s32* input, u32 count, s64 volume, s64 ramp, u32 q);
+
+struct MixKernels {
+    /// Writes the gained input to the output
+    GainFn gain;
+    /// Adds the gained input to the output
+    GainFn mix;
+};
+
+enum class MixKernelLevel {
+    Generic,
+    AVX2,
+};
+
+/**
+ * Get the mixing kernels for the given instruction set level.
+ * Vectorized kernels require every volume of the ramp to fit in 32 bits.
+ *
+ * @param level - Instruction set level.
+ * @return The mixing kernels.
+ */
+[[nodiscard]] const MixKernels& GetMixKernels(MixKernelLevel level);
+
+/**
+ * Get the best mixing kernel level supported by the host CPU.
+ *
+ * @return The kernel level.
+ */
+[[nodiscard]] MixKernelLevel GetHostMixKernelLevel();
+
+/**
+ * Write the input samples with a fixed point volume applied to the output samples, using the
+ * best kernel for the host and volumes.
+ *
+ * @param output - Output samples, may be the same buffer as the input.
+ * @param input  - Input samples, must be at least as large as the output.
+ * @param volume - Raw fixed point volume of the first sample.
+ * @param ramp   - Raw fixed point volume added after every sample.
+ * @param q      - Number of fractional bits of the volume.
+ */
+void GainSamples(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp, u32 q);
+
+/**
+ * Add the input samples with a fixed point volume applied to the output samples, using the best
+ * kernel for the host and volumes.
+ *
+ * @param output - Output samples, may be the same buffer as the input.
+ * @param input  - Input samples, must be at least as large as the output.
+ * @param volume - Raw fixed point volume of the first sample.
+ * @param ramp   - Raw fixed point volume added after every sample.
+ * @param q      - Number of fractional bits of the volume.
+ */
+void MixSamples(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp, u32 q);
+
+#if defined(ARCHITECTURE_x86_64)
+namespace AVX2 {
+void Gain(s32* output, const s32* input, u32 count, s64 volume, s64 ramp, u32 q);
+void Mix(s32* output, const s32* input, u32 count, s64 volume, s64 ramp, u32 q);
+} // namespace AVX2
+#endif
+
+} // namespace AudioCore::Renderer
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// This file is compiled with AVX2 enabled, it must only be called after checking the host CPU.
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+#include "audio_core/renderer/command/mix/mix_kernels.h"
+
+namespace AudioCore::Renderer::AVX2 {
+namespace {
+s32 RoundToInt(s64 value, u32 q) {
+    const s64 fractional_mask = (s64{1} << q) - 1;
+    return static_cast<s32>((value + ((value & fractional_mask) >> 1)) >> q);
+}
+
+/**
+ * Multiply 8 samples by 8 volumes, rounding like Common::FixedPoint::to_int.
+ *
+ * Only the low 32 bits of the rounded 64-bit products are kept. Those are bits q to q + 31 of the
+ * unshifted value, which a logical shift extracts just like the arithmetic shift of the scalar
+ * code does.
+ */
+__m256i GainVector(__m256i samples, __m256i volumes, __m256i fractional_mask, __m128i shift) {
+    const auto round = [&](__m256i product) {
+        const __m256i half_fraction =
+            _mm256_srli_epi64(_mm256_and_si256(product, fractional_mask), 1);
+        return _mm256_srl_epi64(_mm256_add_epi64(product, half_fraction), shift);
+    };
+    const __m256i even = round(_mm256_mul_epi32(samples, volumes));
+    const __m256i odd = round(
+        _mm256_mul_epi32(_mm256_srli_epi64(samples, 32), _mm256_srli_epi64(volumes, 32)));
+    return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0b10101010);
+}
+
+template <bool accumulate>
+void Apply(s32* output, const s32* input, u32 count, s64 volume, s64 ramp, u32 q) {
+    const __m256i fractional_mask = _mm256_set1_epi64x((s64{1} << q) - 1);
+    const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(q));
+    const __m256i ramp_offsets =
+        _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<s32>(ramp)),
+                           _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i volumes =
+            _mm256_add_epi32(_mm256_set1_epi32(static_cast<s32>(volume)), ramp_offsets);
+        const __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+        __m256i result = GainVector(samples, volumes, fractional_mask, shift);
+        if constexpr (accumulate) {
+            result = _mm256_add_epi32(
+                result, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(output + i)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), result);
+        volume += ramp * 8;
+    }
+    for (; i < count; i++) {
+        if constexpr (accumulate) {
+            output[i] = RoundToInt((s64{output[i]} << q) + input[i] * volume, q);
+        } else {
+            output[i] = RoundToInt(input[i] * volume, q);
+        }
+        volume += ramp;
+    }
+}
+} // Anonymous namespace
+
+void Gain(s32* output, const s32* input, u32 count, s64 volume, s64 ramp, u32 q) {
+    Apply<false>(output, input, count, volume, ramp, q);
+}
+
+void Mix(s32* output, const s32* input, u32 count, s64 volume, s64 ramp, u32 q) {
+    Apply<true>(output, input, count, volume, ramp, q);
+}
+
+} // namespace AudioCore::Renderer::AVX2
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "audio_core/adsp/apps/audio_renderer/command_list_processor.h"
+#include "audio_core/renderer/command/mix/mix_kernels.h"
 #include "audio_core/renderer/command/mix/mix_ramp.h"
 #include "common/fixed_point.h"
 #include "common/logging/log.h"
@@ -11,23 +12,18 @@ namespace AudioCore::Renderer {
 template <size_t Q>
 s32 ApplyMixRamp(std::span<s32> output, std::span<const s32> input, const f32 volume_,
                  const f32 ramp_, const u32 sample_count) {
-    Common::FixedPoint<64 - Q, Q> volume{volume_};
-    Common::FixedPoint<64 - Q, Q> sample{0};
-
-    if (ramp_ == 0.0f) {
-        for (u32 i = 0; i < sample_count; i++) {
-            sample = input[i] * volume;
-            output[i] = (output[i] + sample).to_int();
-        }
-    } else {
-        Common::FixedPoint<64 - Q, Q> ramp{ramp_};
-        for (u32 i = 0; i < sample_count; i++) {
-            sample = input[i] * volume;
-            output[i] = (output[i] + sample).to_int();
-            volume += ramp;
-        }
+    const Common::FixedPoint<64 - Q, Q> volume{volume_};
+    const Common::FixedPoint<64 - Q, Q> ramp{ramp_};
+    if (sample_count == 0) {
+        return 0;
     }
-    return sample.to_int();
+    // Read before mixing, the input and output can be the same buffer
+    const s32 last_input{input[sample_count - 1]};
+    const auto last_volume{Common::FixedPoint<64 - Q, Q>::from_base(
+        volume.to_raw() + ramp.to_raw() * static_cast<s64>(sample_count - 1))};
+
+    MixSamples(output.first(sample_count), input, volume.to_raw(), ramp.to_raw(), Q);
+    return (last_input * last_volume).to_int();
 }
 
 template s32 ApplyMixRamp<15>(std::span<s32>, std::span<const s32>, f32, f32, u32);
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "audio_core/adsp/apps/audio_renderer/command_list_processor.h"
+#include "audio_core/renderer/command/mix/mix_kernels.h"
 #include "audio_core/renderer/command/mix/volume.h"
 #include "common/fixed_point.h"
 #include "common/logging/log.h"
@@ -23,9 +24,7 @@ static void ApplyUniformGain(std::span<s32> output, std::span<const s32> input,
         std::memcpy(output.data(), input.data(), input.size_bytes());
     } else {
         const Common::FixedPoint<64 - Q, Q> gain{volume};
-        for (u32 i = 0; i < sample_count; i++) {
-            output[i] = (input[i] * gain).to_int();
-        }
+        GainSamples(output.first(sample_count), input, gain.to_raw(), 0, Q);
     }
 }
 
@@ -1,10 +1,106 @@
 // SPDX-FileCopyrightText: Copyright 2022 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <array>
+
+#if defined(ARCHITECTURE_x86_64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#elif defined(ARCHITECTURE_arm64)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wimplicit-int-conversion"
+#include <sse2neon.h>
+#pragma GCC diagnostic pop
+#endif
+
 #include "audio_core/renderer/command/resample/resample.h"
 
 namespace AudioCore::Renderer {
 
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_arm64)
+/**
+ * Multiply 4 consecutive input samples by 4 filter taps, truncated to 8 fractional bits the same
+ * way as constructing a Common::FixedPoint<56, 8> from each float product.
+ */
+static __m128i FilterTaps(const s16* input, const f32* lut) {
+    const __m128i samples_s16 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input));
+    const __m128i samples = _mm_srai_epi32(_mm_unpacklo_epi16(samples_s16, samples_s16), 16);
+    const __m128 products = _mm_mul_ps(_mm_cvtepi32_ps(samples), _mm_loadu_ps(lut));
+    return _mm_cvttps_epi32(_mm_mul_ps(products, _mm_set1_ps(256.0f)));
+}
+
+/// Sums the lanes of each vector, returning the 4 sums in order
+static __m128i HorizontalSums(__m128i v0, __m128i v1, __m128i v2, __m128i v3) {
+    __m128 row0 = _mm_castsi128_ps(v0);
+    __m128 row1 = _mm_castsi128_ps(v1);
+    __m128 row2 = _mm_castsi128_ps(v2);
+    __m128 row3 = _mm_castsi128_ps(v3);
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+    return _mm_add_epi32(_mm_add_epi32(_mm_castps_si128(row0), _mm_castps_si128(row1)),
+                         _mm_add_epi32(_mm_castps_si128(row2), _mm_castps_si128(row3)));
+}
+#endif
+
+/**
+ * Resample with a polyphase filter, each output sample is the sum of NumTaps input samples
+ * weighted by the taps of the lut row selected by the current fraction.
+ *
+ * @tparam NumTaps          - Number of filter taps, 4 or 8.
+ * @param output            - Output buffer.
+ * @param input             - Input buffer.
+ * @param lut               - Filter taps, NumTaps per row and 256 rows.
+ * @param sample_rate_ratio - Ratio for resampling.
+ * @param fraction          - Current read fraction.
+ * @param samples_to_write  - Number of samples to write.
+ */
+template <u32 NumTaps>
+static void ResamplePolyphase(std::span<s32> output, std::span<const s16> input,
+                              std::span<const f32> lut,
+                              const Common::FixedPoint<49, 15>& sample_rate_ratio,
+                              Common::FixedPoint<49, 15>& fraction, const u32 samples_to_write) {
+    static_assert(NumTaps == 4 || NumTaps == 8);
+    u32 read_index{0};
+    u32 i{0};
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_arm64)
+    // Produce 4 output samples at a time, the fraction has to be stepped one sample at a time
+    // but the taps of all 4 are multiplied and summed together.
+    for (; i + 4 <= samples_to_write; i += 4) {
+        __m128i low_taps[4];
+        __m128i high_taps[4];
+        for (u32 j = 0; j < 4; j++) {
+            const auto lut_index{(fraction.get_frac() >> 8) * NumTaps};
+            low_taps[j] = FilterTaps(&input[read_index], &lut[lut_index]);
+            if constexpr (NumTaps == 8) {
+                high_taps[j] = FilterTaps(&input[read_index + 4], &lut[lut_index + 4]);
+            }
+            fraction += sample_rate_ratio;
+            read_index += static_cast<u32>(fraction.to_int_floor());
+            fraction.clear_int();
+        }
+        __m128i sums = HorizontalSums(low_taps[0], low_taps[1], low_taps[2], low_taps[3]);
+        if constexpr (NumTaps == 8) {
+            sums = _mm_add_epi32(
+                sums, HorizontalSums(high_taps[0], high_taps[1], high_taps[2], high_taps[3]));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[i]), _mm_srai_epi32(sums, 8));
+    }
+#endif
+    for (; i < samples_to_write; i++) {
+        const auto lut_index{(fraction.get_frac() >> 8) * NumTaps};
+        Common::FixedPoint<56, 8> sum{0};
+        for (u32 tap = 0; tap < NumTaps; tap++) {
+            sum += Common::FixedPoint<56, 8>{input[read_index + tap] * lut[lut_index + tap]};
+        }
+        output[i] = sum.to_int_floor();
+        fraction += sample_rate_ratio;
+        read_index += static_cast<u32>(fraction.to_int_floor());
+        fraction.clear_int();
+    }
+}
+
 static void ResampleLowQuality(std::span<s32> output, std::span<const s16> input,
                                const Common::FixedPoint<49, 15>& sample_rate_ratio,
                                Common::FixedPoint<49, 15>& fraction, const u32 samples_to_write) {
@@ -292,19 +388,8 @@ static void ResampleNormalQuality(std::span<s32> output, std::span<const s16> in
         }
     };
 
-    auto lut{get_lut()};
-    u32 read_index{0};
-    for (u32 i = 0; i < samples_to_write; i++) {
-        const auto lut_index{(fraction.get_frac() >> 8) * 4};
-        const Common::FixedPoint<56, 8> sample0{input[read_index + 0] * lut[lut_index + 0]};
-        const Common::FixedPoint<56, 8> sample1{input[read_index + 1] * lut[lut_index + 1]};
-        const Common::FixedPoint<56, 8> sample2{input[read_index + 2] * lut[lut_index + 2]};
-        const Common::FixedPoint<56, 8> sample3{input[read_index + 3] * lut[lut_index + 3]};
-        output[i] = (sample0 + sample1 + sample2 + sample3).to_int_floor();
-        fraction += sample_rate_ratio;
-        read_index += static_cast<u32>(fraction.to_int_floor());
-        fraction.clear_int();
-    }
+    ResamplePolyphase<4>(output, input, get_lut(), sample_rate_ratio, fraction,
+                          samples_to_write);
 }
 
 static void ResampleHighQuality(std::span<s32> output, std::span<const s16> input,
@@ -842,24 +927,8 @@ static void ResampleHighQuality(std::span<s32> output, std::span<const s16> inpu
         }
     };
 
-    auto lut{get_lut()};
-    u32 read_index{0};
-    for (u32 i = 0; i < samples_to_write; i++) {
-        const auto lut_index{(fraction.get_frac() >> 8) * 8};
-        const Common::FixedPoint<56, 8> sample0{input[read_index + 0] * lut[lut_index + 0]};
-        const Common::FixedPoint<56, 8> sample1{input[read_index + 1] * lut[lut_index + 1]};
-        const Common::FixedPoint<56, 8> sample2{input[read_index + 2] * lut[lut_index + 2]};
-        const Common::FixedPoint<56, 8> sample3{input[read_index + 3] * lut[lut_index + 3]};
-        const Common::FixedPoint<56, 8> sample4{input[read_index + 4] * lut[lut_index + 4]};
-        const Common::FixedPoint<56, 8> sample5{input[read_index + 5] * lut[lut_index + 5]};
-        const Common::FixedPoint<56, 8> sample6{input[read_index + 6] * lut[lut_index + 6]};
-        const Common::FixedPoint<56, 8> sample7{input[read_index + 7] * lut[lut_index + 7]};
-        output[i] = (sample0 + sample1 + sample2 + sample3 + sample4 + sample5 + sample6 + sample7)
-                        .to_int_floor();
-        fraction += sample_rate_ratio;
-        read_index += static_cast<u32>(fraction.to_int_floor());
-        fraction.clear_int();
-    }
+    ResamplePolyphase<8>(output, input, get_lut(), sample_rate_ratio, fraction,
+                          samples_to_write);
 }
 
 void Resample(std::span<s32> output, std::span<const s16> input,
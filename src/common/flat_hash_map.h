@@ -0,0 +1,314 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Hash map with open addressing and linear probing, storing its entries in a single array.
+ * Next to the entries, a byte per slot holds 7 bits of the hash of its key, so probing mostly
+ * touches that byte array instead of the entries.
+ *
+ * It implements the subset of std::unordered_map used by the emulator. Unlike std::unordered_map,
+ * inserting an entry invalidates every iterator and reference into the map. Erasing an entry only
+ * invalidates the iterators and references to that entry.
+ */
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = size_t;
+
+    template <bool IsConst>
+    class IteratorBase {
+        friend FlatHashMap;
+        template <bool>
+        friend class IteratorBase;
+
+        using Map = std::conditional_t<IsConst, const FlatHashMap, FlatHashMap>;
+        using Value = std::conditional_t<IsConst, const FlatHashMap::value_type,
+                                         FlatHashMap::value_type>;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        IteratorBase() = default;
+
+        /// Converts an iterator to a const iterator
+        template <bool OtherIsConst>
+            requires(IsConst && !OtherIsConst)
+        IteratorBase(const IteratorBase<OtherIsConst>& other) noexcept
+            : map{other.map}, index{other.index} {}
+
+        reference operator*() const noexcept {
+            return map->slots[index];
+        }
+
+        pointer operator->() const noexcept {
+            return &map->slots[index];
+        }
+
+        IteratorBase& operator++() noexcept {
+            index = map->NextFull(index + 1);
+            return *this;
+        }
+
+        IteratorBase operator++(int) noexcept {
+            const IteratorBase copy{*this};
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const IteratorBase& other) const noexcept {
+            return index == other.index;
+        }
+
+    private:
+        IteratorBase(Map* map_, size_t index_) noexcept : map{map_}, index{index_} {}
+
+        Map* map{};
+        size_t index{};
+    };
+
+    using iterator = IteratorBase<false>;
+    using const_iterator = IteratorBase<true>;
+
+    FlatHashMap() = default;
+
+    ~FlatHashMap() {
+        Deallocate();
+    }
+
+    FlatHashMap(const FlatHashMap&) = delete;
+    FlatHashMap& operator=(const FlatHashMap&) = delete;
+
+    FlatHashMap(FlatHashMap&& other) noexcept {
+        Swap(other);
+    }
+
+    FlatHashMap& operator=(FlatHashMap&& other) noexcept {
+        if (this != &other) {
+            Deallocate();
+            Swap(other);
+        }
+        return *this;
+    }
+
+    [[nodiscard]] iterator begin() noexcept {
+        return iterator{this, NextFull(0)};
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return const_iterator{this, NextFull(0)};
+    }
+
+    [[nodiscard]] iterator end() noexcept {
+        return iterator{this, capacity};
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept {
+        return const_iterator{this, capacity};
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return num_entries;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return num_entries == 0;
+    }
+
+    [[nodiscard]] iterator find(const Key& key) noexcept {
+        return iterator{this, FindIndex(key)};
+    }
+
+    [[nodiscard]] const_iterator find(const Key& key) const noexcept {
+        return const_iterator{this, FindIndex(key)};
+    }
+
+    [[nodiscard]] bool contains(const Key& key) const noexcept {
+        return FindIndex(key) != capacity;
+    }
+
+    /// Inserts an entry constructed from args if the key is not in the map
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        const u64 hash = HashKey(key);
+        if (const size_t index = FindIndex(key, hash); index != capacity) {
+            return {iterator{this, index}, false};
+        }
+        if ((num_entries + num_deleted + 1) * 8 > capacity * 7) {
+            // Grow when the map is full of entries, otherwise only clear the erased slots
+            Rehash((num_entries + 1) * 16 > capacity * 7 ? std::max<size_t>(capacity * 2, 16)
+                                                         : capacity);
+        }
+        size_t index = static_cast<size_t>(hash >> shift);
+        while (IsFull(control[index])) {
+            index = (index + 1) & (capacity - 1);
+        }
+        num_deleted -= control[index] == DELETED ? 1 : 0;
+        control[index] = static_cast<u8>(hash & 0x7F);
+        std::construct_at(&slots[index], std::piecewise_construct, std::forward_as_tuple(key),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+        ++num_entries;
+        return {iterator{this, index}, true};
+    }
+
+    T& operator[](const Key& key) {
+        return try_emplace(key).first->second;
+    }
+
+    /// Erases the entry at an iterator, returns an iterator to the next entry
+    iterator erase(const_iterator it) noexcept {
+        const size_t index = it.index;
+        std::destroy_at(&slots[index]);
+        // A probe sequence reaching an empty slot stops there anyway, so no tombstone is needed
+        if (control[(index + 1) & (capacity - 1)] == EMPTY) {
+            control[index] = EMPTY;
+        } else {
+            control[index] = DELETED;
+            ++num_deleted;
+        }
+        --num_entries;
+        return iterator{this, NextFull(index + 1)};
+    }
+
+    size_t erase(const Key& key) noexcept {
+        const size_t index = FindIndex(key);
+        if (index == capacity) {
+            return 0;
+        }
+        erase(const_iterator{this, index});
+        return 1;
+    }
+
+    void clear() noexcept {
+        for (size_t index = 0; index < capacity; ++index) {
+            if (IsFull(control[index])) {
+                std::destroy_at(&slots[index]);
+            }
+        }
+        std::fill_n(control.get(), capacity, EMPTY);
+        num_entries = 0;
+        num_deleted = 0;
+    }
+
+    /// Makes room for a number of entries without rehashing
+    void reserve(size_t count) {
+        const size_t new_capacity = std::bit_ceil(std::max<size_t>(count * 8 / 7 + 1, 16));
+        if (new_capacity > capacity) {
+            Rehash(new_capacity);
+        }
+    }
+
+private:
+    static constexpr u8 EMPTY = 0x80;
+    static constexpr u8 DELETED = 0xFE;
+
+    static constexpr bool IsFull(u8 control_byte) noexcept {
+        return (control_byte & 0x80) == 0;
+    }
+
+    static u64 HashKey(const Key& key) noexcept {
+        // Fibonacci hashing spreads identity hashes of sequential keys over the table
+        return static_cast<u64>(Hash{}(key)) * 0x9E3779B97F4A7C15ULL;
+    }
+
+    size_t FindIndex(const Key& key) const noexcept {
+        return FindIndex(key, HashKey(key));
+    }
+
+    size_t FindIndex(const Key& key, u64 hash) const noexcept {
+        if (num_entries == 0) {
+            return capacity;
+        }
+        const u8 fragment = static_cast<u8>(hash & 0x7F);
+        size_t index = static_cast<size_t>(hash >> shift);
+        while (control[index] != EMPTY) {
+            if (control[index] == fragment && KeyEqual{}(slots[index].first, key)) {
+                return index;
+            }
+            index = (index + 1) & (capacity - 1);
+        }
+        return capacity;
+    }
+
+    size_t NextFull(size_t index) const noexcept {
+        while (index < capacity && !IsFull(control[index])) {
+            ++index;
+        }
+        return index;
+    }
+
+    void Rehash(size_t new_capacity) {
+        FlatHashMap other;
+        other.control = std::make_unique<u8[]>(new_capacity);
+        std::fill_n(other.control.get(), new_capacity, EMPTY);
+        other.slots = std::allocator<value_type>{}.allocate(new_capacity);
+        other.capacity = new_capacity;
+        other.shift = 64 - std::countr_zero(new_capacity);
+        for (size_t index = 0; index < capacity; ++index) {
+            if (!IsFull(control[index])) {
+                continue;
+            }
+            const u64 hash = HashKey(slots[index].first);
+            size_t new_index = static_cast<size_t>(hash >> other.shift);
+            while (other.control[new_index] != EMPTY) {
+                new_index = (new_index + 1) & (new_capacity - 1);
+            }
+            other.control[new_index] = static_cast<u8>(hash & 0x7F);
+            std::construct_at(&other.slots[new_index], std::move(slots[index]));
+            ++other.num_entries;
+        }
+        Deallocate();
+        Swap(other);
+    }
+
+    void Deallocate() noexcept {
+        if (slots == nullptr) {
+            return;
+        }
+        clear();
+        std::allocator<value_type>{}.deallocate(slots, capacity);
+        slots = nullptr;
+        control.reset();
+        capacity = 0;
+        shift = 64;
+    }
+
+    void Swap(FlatHashMap& other) noexcept {
+        std::swap(control, other.control);
+        std::swap(slots, other.slots);
+        std::swap(capacity, other.capacity);
+        std::swap(shift, other.shift);
+        std::swap(num_entries, other.num_entries);
+        std::swap(num_deleted, other.num_deleted);
+    }
+
+    std::unique_ptr<u8[]> control;
+    value_type* slots{};
+    size_t capacity{};
+    int shift{64};
+    size_t num_entries{};
+    size_t num_deleted{};
+};
+
+} // namespace Common
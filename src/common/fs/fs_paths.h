@@ -30,3 +30,4 @@
 // suyu-specific files
 
 #define LOG_FILE "suyu_log.txt"
+#define LOG_BINARY_FILE "suyu_log.bin"
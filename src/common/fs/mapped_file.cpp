@@ -0,0 +1,215 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#include "common/fs/fs_util.h"
+#include "common/fs/mapped_file.h"
+#ifdef ANDROID
+#include "common/fs/fs_android.h"
+#endif
+#include "common/logging/log.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Common::FS {
+
+namespace fs = std::filesystem;
+
+MappedFile::MappedFile() = default;
+
+MappedFile::MappedFile(const fs::path& path) {
+    Open(path);
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+#ifdef _WIN32
+
+void MappedFile::Open(const fs::path& path) {
+    Close();
+
+    const HANDLE handle =
+        CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        LOG_ERROR(Common_Filesystem, "Failed to open the file at path={}, error={}",
+                  PathToUTF8String(path), GetLastError());
+        return;
+    }
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(handle, &size)) {
+        LOG_ERROR(Common_Filesystem, "Failed to get the size of the file at path={}, error={}",
+                  PathToUTF8String(path), GetLastError());
+        CloseHandle(handle);
+        return;
+    }
+    file_handle = handle;
+    file_size = static_cast<u64>(size.QuadPart);
+
+    // Empty files cannot be mapped, they are read with positional reads which return nothing.
+    if (file_size == 0) {
+        return;
+    }
+
+    const HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        LOG_WARNING(Common_Filesystem, "Failed to map the file at path={}, error={}",
+                    PathToUTF8String(path), GetLastError());
+        return;
+    }
+    mapped_data = static_cast<const u8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    // The view keeps the mapping alive on its own.
+    CloseHandle(mapping);
+    if (mapped_data == nullptr) {
+        LOG_WARNING(Common_Filesystem, "Failed to map a view of the file at path={}, error={}",
+                    PathToUTF8String(path), GetLastError());
+    }
+}
+
+void MappedFile::Close() {
+    if (mapped_data != nullptr) {
+        UnmapViewOfFile(mapped_data);
+        mapped_data = nullptr;
+    }
+    if (file_handle != nullptr) {
+        CloseHandle(file_handle);
+        file_handle = nullptr;
+    }
+    file_size = 0;
+}
+
+bool MappedFile::IsOpen() const {
+    return file_handle != nullptr;
+}
+
+#else
+
+void MappedFile::Open(const fs::path& path) {
+    Close();
+
+#ifdef ANDROID
+    const int fd = Android::IsContentUri(path)
+                       ? Android::OpenContentUri(path, Android::OpenMode::Read)
+                       : open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#else
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+    if (fd == -1) {
+        LOG_ERROR(Common_Filesystem, "Failed to open the file at path={}, ec_message={}",
+                  PathToUTF8String(path), std::strerror(errno));
+        return;
+    }
+
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) != 0) {
+        LOG_ERROR(Common_Filesystem, "Failed to get the size of the file at path={}, ec_message={}",
+                  PathToUTF8String(path), std::strerror(errno));
+        close(fd);
+        return;
+    }
+    file_descriptor = fd;
+    file_size = static_cast<u64>(file_stat.st_size);
+
+    // Empty files cannot be mapped, they are read with positional reads which return nothing.
+    if (file_size == 0 || file_size > std::numeric_limits<size_t>::max()) {
+        return;
+    }
+
+    void* const data = mmap(nullptr, static_cast<size_t>(file_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        LOG_WARNING(Common_Filesystem, "Failed to map the file at path={}, ec_message={}",
+                    PathToUTF8String(path), std::strerror(errno));
+        return;
+    }
+    mapped_data = static_cast<const u8*>(data);
+
+    // The mapping does not need the file descriptor, close it to not count against the limit.
+    close(fd);
+    file_descriptor = -1;
+}
+
+void MappedFile::Close() {
+    if (mapped_data != nullptr) {
+        munmap(const_cast<u8*>(mapped_data), static_cast<size_t>(file_size));
+        mapped_data = nullptr;
+    }
+    if (file_descriptor != -1) {
+        close(file_descriptor);
+        file_descriptor = -1;
+    }
+    file_size = 0;
+}
+
+bool MappedFile::IsOpen() const {
+    return mapped_data != nullptr || file_descriptor != -1;
+}
+
+#endif
+
+u64 MappedFile::GetSize() const {
+    return file_size;
+}
+
+std::span<const u8> MappedFile::GetMappedSpan() const {
+    if (mapped_data == nullptr) {
+        return {};
+    }
+    return {mapped_data, static_cast<size_t>(file_size)};
+}
+
+size_t MappedFile::ReadAt(std::span<u8> data, u64 offset) const {
+    if (offset >= file_size) {
+        return 0;
+    }
+    const size_t length = static_cast<size_t>(std::min<u64>(data.size(), file_size - offset));
+
+    if (mapped_data != nullptr) {
+        std::memcpy(data.data(), mapped_data + offset, length);
+        return length;
+    }
+
+    size_t read_size = 0;
+    while (read_size < length) {
+        const u64 read_offset = offset + read_size;
+#ifdef _WIN32
+        const DWORD chunk_size = static_cast<DWORD>(
+            std::min<size_t>(length - read_size, std::numeric_limits<DWORD>::max()));
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(read_offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(read_offset >> 32);
+        DWORD chunk_read = 0;
+        if (!ReadFile(file_handle, data.data() + read_size, chunk_size, &chunk_read,
+                      &overlapped) ||
+            chunk_read == 0) {
+            break;
+        }
+#else
+        const ssize_t chunk_read = pread(file_descriptor, data.data() + read_size,
+                                         length - read_size, static_cast<off_t>(read_offset));
+        if (chunk_read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (chunk_read <= 0) {
+            break;
+        }
+#endif
+        read_size += static_cast<size_t>(chunk_read);
+    }
+    return read_size;
+}
+
+} // namespace Common::FS
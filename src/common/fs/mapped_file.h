@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include "common/common_types.h"
+#include "common/concepts.h"
+#include "common/fs/fs_util.h"
+
+namespace Common::FS {
+
+/**
+ * A read-only file that is read at explicit offsets and has no file position, so it may be read
+ * from several threads at once without locking.
+ * The file is memory mapped when possible and read with positional reads otherwise.
+ * The file must not be truncated while it is open, as reading pages past the end of a mapped file
+ * raises an access violation.
+ */
+class MappedFile {
+public:
+    MappedFile();
+
+    /**
+     * Opens and maps the file at path.
+     *
+     * @param path Filesystem path
+     */
+    explicit MappedFile(const std::filesystem::path& path);
+
+#ifdef _WIN32
+    template <typename Path>
+    explicit MappedFile(const Path& path) {
+        Open(path);
+    }
+#endif
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    /**
+     * Opens and maps the file at path, closing any previously opened file.
+     *
+     * @param path Filesystem path
+     */
+    void Open(const std::filesystem::path& path);
+
+#ifdef _WIN32
+    template <typename Path>
+    void Open(const Path& path) {
+        if constexpr (IsChar<typename Path::value_type>) {
+            Open(ToU8String(path));
+        } else {
+            Open(std::filesystem::path{path});
+        }
+    }
+#endif
+
+    /// Unmaps and closes the file.
+    void Close();
+
+    /**
+     * Checks whether the file is open.
+     *
+     * @returns True if the file is open, false otherwise.
+     */
+    [[nodiscard]] bool IsOpen() const;
+
+    /**
+     * Gets the size of the file when it was opened.
+     *
+     * @returns The file size in bytes of the file. Returns 0 if the file is not open.
+     */
+    [[nodiscard]] u64 GetSize() const;
+
+    /**
+     * Gets the mapped contents of the file, which stay valid until the file is closed.
+     *
+     * @returns A span over the whole file, or an empty span if the file is not mapped.
+     */
+    [[nodiscard]] std::span<const u8> GetMappedSpan() const;
+
+    /**
+     * Reads data from the file at an offset, without using or changing any file position.
+     *
+     * @param data Span of the buffer to read into
+     * @param offset Offset in the file to read from
+     *
+     * @returns Number of bytes successfully read.
+     */
+    [[nodiscard]] size_t ReadAt(std::span<u8> data, u64 offset) const;
+
+private:
+    u64 file_size{};
+    const u8* mapped_data{};
+
+#ifdef _WIN32
+    void* file_handle{};
+#else
+    int file_descriptor{-1};
+#endif
+};
+
+} // namespace Common::FS
@@ -1,12 +1,19 @@
 // SPDX-FileCopyrightText: 2014 Citra Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <climits>
+#include <cstring>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
+#include <fmt/args.h>
 #include <fmt/format.h>
 
 #ifdef _WIN32
@@ -16,12 +23,15 @@
 #include "common/fs/file.h"
 #include "common/fs/fs.h"
 #include "common/fs/fs_paths.h"
+#include "common/alignment.h"
 #include "common/fs/path_util.h"
 #include "common/literals.h"
 #include "common/polyfill_thread.h"
 #include "common/thread.h"
 
 #include "common/logging/backend.h"
+#include "common/logging/deferred.h"
+#include "common/logging/deferred_ring.h"
 #include "common/logging/log.h"
 #include "common/logging/log_entry.h"
 #include "common/logging/text_formatter.h"
@@ -35,6 +45,78 @@ namespace Common::Log {
 
 namespace {
 
+using namespace Common::Literals;
+
+/// Owns the ring buffer of a thread and hands it over to the logging thread when the thread exits.
+struct ThreadDeferredRing {
+    ~ThreadDeferredRing() {
+        if (ring) {
+            ring->abandoned.store(true, std::memory_order_release);
+        }
+    }
+
+    std::shared_ptr<DeferredRing> ring;
+};
+
+thread_local ThreadDeferredRing thread_deferred_ring;
+thread_local bool is_logging_thread = false;
+
+template <typename T>
+T ReadDeferredArg(const u8*& in) {
+    T value;
+    std::memcpy(&value, in, sizeof(value));
+    in += sizeof(value);
+    return value;
+}
+
+/// Formats the message of a deferred record, see WriteArg in deferred.h for the argument layout.
+std::string FormatDeferredMessage(const DeferredRecord& record) {
+    fmt::dynamic_format_arg_store<fmt::format_context> args;
+    args.reserve(record.num_args, 0);
+
+    const u8* in = record.Args();
+    for (u32 arg = 0; arg < record.num_args; ++arg) {
+        switch (static_cast<ArgType>(*in++)) {
+        case ArgType::Bool:
+            args.push_back(ReadDeferredArg<u8>(in) != 0);
+            break;
+        case ArgType::Char:
+            args.push_back(static_cast<char>(ReadDeferredArg<u8>(in)));
+            break;
+        case ArgType::Signed:
+            args.push_back(ReadDeferredArg<s64>(in));
+            break;
+        case ArgType::Unsigned:
+            args.push_back(ReadDeferredArg<u64>(in));
+            break;
+        case ArgType::Float32:
+            args.push_back(ReadDeferredArg<float>(in));
+            break;
+        case ArgType::Float64:
+            args.push_back(ReadDeferredArg<double>(in));
+            break;
+        case ArgType::String: {
+            const u32 size = ReadDeferredArg<u32>(in);
+            // String views are not copied, the record outlives the formatting
+            args.push_back(std::string_view{reinterpret_cast<const char*>(in), size});
+            in += size;
+            break;
+        }
+        case ArgType::Pointer:
+            args.push_back(
+                reinterpret_cast<const void*>(static_cast<uintptr_t>(ReadDeferredArg<u64>(in))));
+            break;
+        }
+    }
+
+    const std::string_view format{record.format, record.format_size};
+    try {
+        return fmt::vformat(fmt::string_view{format.data(), format.size()}, args);
+    } catch (const fmt::format_error& e) {
+        return fmt::format("{} (format error: {})", format, e.what());
+    }
+}
+
 /**
  * Interface for logging backends.
  */
@@ -76,6 +158,10 @@ public:
         enabled = enabled_;
     }
 
+    bool IsEnabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
 private:
     std::atomic_bool enabled{false};
 };
@@ -107,7 +193,6 @@ public:
 
         bytes_written += file->WriteString(FormatLogMessage(entry).append(1, '\n'));
 
-        using namespace Common::Literals;
         // Prevent logs from exceeding a set maximum size in the event that log entries are spammed.
         const auto write_limit = Settings::values.extended_logging.GetValue() ? 1_GiB : 100_MiB;
         const bool write_limit_exceeded = bytes_written > write_limit;
@@ -136,6 +221,174 @@ private:
     std::size_t bytes_written = 0;
 };
 
+/**
+ * Backend that writes a compact binary log, which tools/decode-binary-log.py turns back into text.
+ * Deferred messages are stored with their packed arguments and are never formatted.
+ *
+ * The log starts with the magic, the format version and the names of the log classes and levels.
+ * It is followed by records, which start with their RecordKind:
+ *  - String: u32 id, u32 size and the characters, defines a string used by later records.
+ *  - Text: the common fields, u32 size and the characters of an already formatted message.
+ *  - Message: the common fields, u32 format id, u32 argument count, u32 argument size and the
+ *    arguments as packed by WriteArg in deferred.h.
+ * The common fields are the s64 timestamp in microseconds, u8 class, u8 level, u32 line and the
+ * u32 ids of the file and function names. All values are little endian.
+ */
+class BinaryFileBackend final : public Backend {
+public:
+    static constexpr std::array<char, 8> MAGIC{'S', 'U', 'Y', 'U', 'L', 'O', 'G', '\0'};
+    static constexpr u32 VERSION = 1;
+
+    enum class RecordKind : u8 {
+        String,
+        Text,
+        Message,
+    };
+
+    explicit BinaryFileBackend(const std::filesystem::path& filename) {
+        auto old_filename = filename;
+        old_filename += ".old.bin";
+
+        static_cast<void>(FS::RemoveFile(old_filename));
+        static_cast<void>(FS::RenameFile(filename, old_filename));
+
+        file = std::make_unique<FS::IOFile>(filename, FS::FileAccessMode::Write,
+                                            FS::FileType::BinaryFile);
+        WriteHeader();
+    }
+
+    ~BinaryFileBackend() override = default;
+
+    void Write(const Entry& entry) override {
+        if (!enabled) {
+            return;
+        }
+        const u32 filename_id = InternString(entry.filename);
+        const u32 function_id = InternString(entry.function);
+
+        Put(RecordKind::Text);
+        PutCommon(entry.timestamp.count(), entry.log_class, entry.log_level, entry.line_num,
+                  filename_id, function_id);
+        PutString(entry.message);
+        Submit(entry.log_level);
+    }
+
+    void WriteDeferred(const DeferredRecord& record) {
+        if (!enabled) {
+            return;
+        }
+        const u32 filename_id = InternPointer(record.filename, std::strlen(record.filename));
+        const u32 function_id = InternPointer(record.function, std::strlen(record.function));
+        const u32 format_id = InternPointer(record.format, record.format_size);
+
+        Put(RecordKind::Message);
+        PutCommon(record.timestamp, record.log_class, record.log_level, record.line_num,
+                  filename_id, function_id);
+        Put(format_id);
+        Put(record.num_args);
+        Put(record.args_size);
+        PutBytes(record.Args(), record.args_size);
+        Submit(record.log_level);
+    }
+
+    void Flush() override {
+        WriteBuffer();
+        file->Flush();
+    }
+
+    void EnableForStacktrace() override {
+        enabled = true;
+        bytes_written = 0;
+    }
+
+private:
+    void WriteHeader() {
+        PutBytes(MAGIC.data(), MAGIC.size());
+        Put(VERSION);
+        Put(static_cast<u32>(Class::Count));
+        for (size_t index = 0; index < static_cast<size_t>(Class::Count); ++index) {
+            PutString(GetLogClassName(static_cast<Class>(index)));
+        }
+        Put(static_cast<u32>(Level::Count));
+        for (size_t index = 0; index < static_cast<size_t>(Level::Count); ++index) {
+            PutString(GetLevelName(static_cast<Level>(index)));
+        }
+        WriteBuffer();
+    }
+
+    /// Strings of deferred messages are literals, so their address identifies them
+    u32 InternPointer(const char* string, size_t size) {
+        const auto [it, inserted] = pointer_ids.try_emplace(string);
+        if (inserted) {
+            it->second = InternString({string, size});
+        }
+        return it->second;
+    }
+
+    u32 InternString(std::string_view string) {
+        const auto [it, inserted] =
+            string_ids.try_emplace(std::string{string}, static_cast<u32>(string_ids.size()));
+        if (inserted) {
+            Put(RecordKind::String);
+            Put(it->second);
+            PutString(string);
+        }
+        return it->second;
+    }
+
+    void PutCommon(s64 timestamp, Class log_class, Level log_level, u32 line_num, u32 filename_id,
+                   u32 function_id) {
+        Put(timestamp);
+        Put(log_class);
+        Put(log_level);
+        Put(line_num);
+        Put(filename_id);
+        Put(function_id);
+    }
+
+    template <typename T>
+    void Put(const T& value) {
+        PutBytes(&value, sizeof(value));
+    }
+
+    void PutString(std::string_view string) {
+        Put(static_cast<u32>(string.size()));
+        PutBytes(string.data(), string.size());
+    }
+
+    void PutBytes(const void* data, size_t size) {
+        const auto* const bytes = static_cast<const u8*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    void Submit(Level log_level) {
+        const auto write_limit = Settings::values.extended_logging.GetValue() ? 1_GiB : 100_MiB;
+        const bool write_limit_exceeded = bytes_written + buffer.size() > write_limit;
+        if (log_level >= Level::Error || write_limit_exceeded) {
+            if (write_limit_exceeded) {
+                enabled = false;
+            }
+            Flush();
+        } else if (buffer.size() >= BUFFER_SIZE) {
+            WriteBuffer();
+        }
+    }
+
+    void WriteBuffer() {
+        bytes_written += file->WriteSpan(std::span<const u8>{buffer});
+        buffer.clear();
+    }
+
+    static constexpr size_t BUFFER_SIZE = 64_KiB;
+
+    std::unique_ptr<FS::IOFile> file;
+    std::vector<u8> buffer;
+    std::unordered_map<const char*, u32> pointer_ids;
+    std::unordered_map<std::string, u32> string_ids;
+    bool enabled = true;
+    std::size_t bytes_written = 0;
+};
+
 /**
  * Backend that writes to Visual Studio's output window
  */
@@ -200,8 +453,7 @@ public:
         void(CreateDir(log_dir));
         Filter filter;
         filter.ParseFilterString(Settings::values.log_filter.GetValue());
-        instance = std::unique_ptr<Impl, decltype(&Deleter)>(new Impl(log_dir / LOG_FILE, filter),
-                                                             Deleter);
+        instance = std::unique_ptr<Impl, decltype(&Deleter)>(new Impl(log_dir, filter), Deleter);
         initialization_in_progress_suppress_logging = false;
     }
 
@@ -236,22 +488,83 @@ public:
         auto entry =
             CreateEntry(log_class, log_level, filename, line_num, function, std::move(message));
         if (Settings::values.log_async) {
-            message_queue.EmplaceWait(entry);
+            if (thread_deferred_ring.ring) {
+                // Keeps the message after the deferred messages this thread logged before it
+                PushThreadEntry(entry, function);
+            } else {
+                message_queue.EmplaceWait(entry);
+            }
         } else {
             std::scoped_lock l{sync_mutex};
             ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
         }
     }
 
+    DeferredState GetDeferredState(Class log_class, Level log_level) const {
+        if (!filter.CheckMessage(log_class, log_level)) {
+            return DeferredState::Filtered;
+        }
+        // Synchronous logging has to write the message before returning
+        if (!Settings::values.log_async.GetValue() || !Settings::values.log_deferred.GetValue()) {
+            return DeferredState::Disabled;
+        }
+        return DeferredState::Enabled;
+    }
+
+    u8* BeginDeferredRecord(Class log_class, Level log_level, const char* filename,
+                            unsigned int line_num, const char* function, std::string_view format,
+                            size_t num_args, size_t args_size) {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        using std::chrono::steady_clock;
+
+        const size_t size = Common::AlignUp(sizeof(DeferredRecord) + args_size,
+                                            alignof(DeferredRecord));
+        DeferredRecord* const record = GetThreadDeferredRing().Reserve(size);
+        if (record == nullptr) {
+            return nullptr;
+        }
+        std::construct_at(
+            record,
+            DeferredRecord{
+                .size = static_cast<u32>(size),
+                .num_args = static_cast<u32>(num_args),
+                .args_size = static_cast<u32>(args_size),
+                .format_size = static_cast<u32>(format.size()),
+                .timestamp = duration_cast<microseconds>(steady_clock::now() - time_origin).count(),
+                .filename = filename,
+                .function = function,
+                .format = format.data(),
+                .line_num = line_num,
+                .log_class = log_class,
+                .log_level = log_level,
+            });
+        return record->Args();
+    }
+
+    void CommitDeferredRecord() {
+        thread_deferred_ring.ring->Commit();
+        NotifyDeferredRecord();
+    }
+
 private:
-    Impl(const std::filesystem::path& file_backend_filename, const Filter& filter_)
-        : filter{filter_}, file_backend{file_backend_filename} {}
+    Impl(const std::filesystem::path& log_dir, const Filter& filter_) : filter{filter_} {
+        if (Settings::values.log_binary.GetValue()) {
+            auto binary_backend = std::make_unique<BinaryFileBackend>(log_dir / LOG_BINARY_FILE);
+            binary_file_backend = binary_backend.get();
+            file_backend = std::move(binary_backend);
+        } else {
+            file_backend = std::make_unique<FileBackend>(log_dir / LOG_FILE);
+        }
+    }
 
     ~Impl() = default;
 
     void StartBackendThread() {
+        backend_running.store(true, std::memory_order_release);
         backend_thread = std::jthread([this](std::stop_token stop_token) {
             Common::SetCurrentThreadName("Logger");
+            is_logging_thread = true;
             Entry entry;
             const auto write_logs = [this, &entry]() {
                 ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
@@ -261,13 +574,22 @@ private:
                 if (entry.filename != nullptr) {
                     write_logs();
                 }
+                if (deferred_pending.exchange(false, std::memory_order_relaxed)) {
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    int max_deferred_logs = INT_MAX;
+                    WriteDeferredLogs(max_deferred_logs);
+                }
             }
             // Drain the logging queue. Only writes out up to MAX_LOGS_TO_WRITE to prevent a
             // case where a system is repeatedly spamming logs even on close.
             int max_logs_to_write = filter.IsDebug() ? INT_MAX : 100;
-            while (max_logs_to_write-- && message_queue.TryPop(entry)) {
-                write_logs();
+            while (max_logs_to_write > 0 && message_queue.TryPop(entry)) {
+                if (entry.filename != nullptr) {
+                    write_logs();
+                    --max_logs_to_write;
+                }
             }
+            WriteDeferredLogs(max_logs_to_write);
         });
     }
 
@@ -276,10 +598,143 @@ private:
         if (backend_thread.joinable()) {
             backend_thread.join();
         }
+        backend_running.store(false, std::memory_order_release);
 
         ForEachBackend([](Backend& backend) { backend.Flush(); });
     }
 
+    DeferredRing& GetThreadDeferredRing() {
+        if (!thread_deferred_ring.ring) {
+            thread_deferred_ring.ring = std::make_shared<DeferredRing>();
+            std::scoped_lock lock{deferred_rings_mutex};
+            deferred_rings.push_back(thread_deferred_ring.ring);
+        }
+        return *thread_deferred_ring.ring;
+    }
+
+    /// Wakes up the logging thread to write the records of the ring buffers.
+    void NotifyDeferredRecord() {
+        // Pairs with the fence in WriteDeferredLogs, either the logging thread sees the record or
+        // this thread sees that it has to be woken up.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (deferred_pending.load(std::memory_order_relaxed) ||
+            deferred_pending.exchange(true, std::memory_order_relaxed)) {
+            return;
+        }
+        // Entries without a filename only wake up the logging thread
+        message_queue.EmplaceWait(Entry{});
+    }
+
+    /// Passes a message formatted at the call site through the ring buffer of the calling thread.
+    void PushThreadEntry(const Entry& entry, const char* function) {
+        DeferredRing& ring = *thread_deferred_ring.ring;
+        const DeferredRecord header{
+            .timestamp = entry.timestamp.count(),
+            .filename = entry.filename,
+            .function = function,
+            .line_num = entry.line_num,
+            .log_class = entry.log_class,
+            .log_level = entry.log_level,
+        };
+        if (ring.PushText(header, entry.message)) {
+            NotifyDeferredRecord();
+            return;
+        }
+        // The ring is full or the message does not fit in it, the earlier messages of this thread
+        // have to be written first.
+        WaitForDeferredRing(ring);
+        if (ring.PushText(header, entry.message)) {
+            NotifyDeferredRecord();
+            return;
+        }
+        message_queue.EmplaceWait(entry);
+    }
+
+    void WaitForDeferredRing(const DeferredRing& ring) {
+        // The logging thread can't wait for itself, and nothing drains the ring once it stopped
+        if (is_logging_thread) {
+            return;
+        }
+        while (!ring.IsEmpty() && backend_running.load(std::memory_order_acquire)) {
+            NotifyDeferredRecord();
+            std::this_thread::yield();
+        }
+    }
+
+    /// Writes the deferred messages of all threads in the order they were logged.
+    void WriteDeferredLogs(int& max_logs_to_write) {
+        {
+            std::scoped_lock lock{deferred_rings_mutex};
+            std::erase_if(deferred_rings, [](const std::shared_ptr<DeferredRing>& ring) {
+                return ring->abandoned.load(std::memory_order_acquire) && !ring->Front();
+            });
+            drain_rings = deferred_rings;
+        }
+        while (max_logs_to_write > 0) {
+            DeferredRing* oldest_ring = nullptr;
+            const DeferredRecord* oldest = nullptr;
+            for (const auto& ring : drain_rings) {
+                const DeferredRecord* const record = ring->Front();
+                if (record != nullptr && (!oldest || record->timestamp < oldest->timestamp)) {
+                    oldest_ring = ring.get();
+                    oldest = record;
+                }
+            }
+            if (oldest == nullptr) {
+                break;
+            }
+            WriteDeferred(*oldest);
+            oldest_ring->Pop();
+            --max_logs_to_write;
+        }
+        drain_rings.clear();
+    }
+
+    void WriteDeferred(const DeferredRecord& record) {
+        if (record.IsText()) {
+            const Entry entry{
+                .timestamp = std::chrono::microseconds{record.timestamp},
+                .log_class = record.log_class,
+                .log_level = record.log_level,
+                .filename = record.filename,
+                .line_num = record.line_num,
+                .function = record.function,
+                .message = std::string{record.Text()},
+            };
+            ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
+            return;
+        }
+        if (binary_file_backend != nullptr) {
+            binary_file_backend->WriteDeferred(record);
+            if (!NeedsTextForDeferred()) {
+                return;
+            }
+        }
+        const Entry entry{
+            .timestamp = std::chrono::microseconds{record.timestamp},
+            .log_class = record.log_class,
+            .log_level = record.log_level,
+            .filename = record.filename,
+            .line_num = record.line_num,
+            .function = record.function,
+            .message = FormatDeferredMessage(record),
+        };
+        if (binary_file_backend != nullptr) {
+            ForEachTextBackend([&entry](Backend& backend) { backend.Write(entry); });
+        } else {
+            ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
+        }
+    }
+
+    /// Whether a backend besides the binary log shows messages, so they have to be formatted.
+    bool NeedsTextForDeferred() const {
+#if defined(_WIN32) || defined(ANDROID)
+        return true;
+#else
+        return color_console_backend.IsEnabled();
+#endif
+    }
+
     Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
                       const char* function, std::string&& message) const {
         using std::chrono::duration_cast;
@@ -298,9 +753,14 @@ private:
     }
 
     void ForEachBackend(auto lambda) {
+        ForEachTextBackend(lambda);
+        lambda(*file_backend);
+    }
+
+    /// Visits the backends other than the log file.
+    void ForEachTextBackend(auto lambda) {
         lambda(static_cast<Backend&>(debugger_backend));
         lambda(static_cast<Backend&>(color_console_backend));
-        lambda(static_cast<Backend&>(file_backend));
 #ifdef ANDROID
         lambda(static_cast<Backend&>(lc_backend));
 #endif
@@ -315,7 +775,8 @@ private:
     Filter filter;
     DebuggerBackend debugger_backend{};
     ColorConsoleBackend color_console_backend{};
-    FileBackend file_backend;
+    std::unique_ptr<Backend> file_backend;
+    BinaryFileBackend* binary_file_backend = nullptr;
 #ifdef ANDROID
     LogcatBackend lc_backend{};
 #endif
@@ -323,6 +784,11 @@ private:
     MPSCQueue<Entry> message_queue{};
     std::mutex sync_mutex;
     std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
+    std::atomic_bool deferred_pending{false};
+    std::atomic_bool backend_running{false};
+    std::mutex deferred_rings_mutex;
+    std::vector<std::shared_ptr<DeferredRing>> deferred_rings;
+    std::vector<std::shared_ptr<DeferredRing>> drain_rings;
     std::jthread backend_thread;
 };
 } // namespace
@@ -351,6 +817,24 @@ void SetColorConsoleBackendEnabled(bool enabled) {
     Impl::Instance().SetColorConsoleBackendEnabled(enabled);
 }
 
+DeferredState GetDeferredState(Class log_class, Level log_level) {
+    if (initialization_in_progress_suppress_logging) {
+        return DeferredState::Filtered;
+    }
+    return Impl::Instance().GetDeferredState(log_class, log_level);
+}
+
+u8* BeginDeferredRecord(Class log_class, Level log_level, const char* filename,
+                        unsigned int line_num, const char* function, std::string_view format,
+                        size_t num_args, size_t args_size) {
+    return Impl::Instance().BeginDeferredRecord(log_class, log_level, filename, line_num, function,
+                                                format, num_args, args_size);
+}
+
+void CommitDeferredRecord() {
+    Impl::Instance().CommitDeferredRecord();
+}
+
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, fmt::string_view format,
                        const fmt::format_args& args) {
@@ -0,0 +1,208 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <fmt/format.h>
+
+#include "common/common_types.h"
+#include "common/logging/types.h"
+
+namespace Common::Log {
+
+/**
+ * Type of an argument packed by a deferred log call. Arguments are stored as the type followed by
+ * the value, which is one byte for Bool and Char, four bytes for Float32, a 32-bit size followed
+ * by the characters for String, and eight bytes otherwise. Binary logs store them the same way.
+ */
+enum class ArgType : u8 {
+    Bool,
+    Char,
+    Signed,
+    Unsigned,
+    Float32,
+    Float64,
+    String,
+    Pointer,
+};
+
+enum class DeferredState {
+    Disabled, ///< Messages are formatted at the call site.
+    Filtered, ///< The message is dropped by the filter.
+    Enabled,  ///< Arguments are packed and formatted on the logging thread.
+};
+
+/// Returns how a message of this class and level has to be logged.
+DeferredState GetDeferredState(Class log_class, Level log_level);
+
+/**
+ * Reserves a record for a deferred message in the ring buffer of the calling thread.
+ * The format, file and function strings are stored as pointers and must outlive the logger, which
+ * holds for string literals.
+ *
+ * @returns Where the packed arguments have to be written, or nullptr if the record is too large.
+ */
+u8* BeginDeferredRecord(Class log_class, Level log_level, const char* filename,
+                        unsigned int line_num, const char* function, std::string_view format,
+                        size_t num_args, size_t args_size);
+
+/// Publishes the record reserved by the last BeginDeferredRecord call to the logging thread.
+void CommitDeferredRecord();
+
+namespace Detail {
+
+template <typename T>
+constexpr bool IsStringArg =
+    std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+    std::is_same_v<T, fmt::string_view> || std::is_same_v<T, const char*> ||
+    std::is_same_v<T, char*> ||
+    (std::is_array_v<T> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<T>>, char>);
+
+/// Enums only format as their value if they use the generic formatter from formatter.h
+template <typename T>
+constexpr bool IsValueEnum = [] {
+    if constexpr (std::is_enum_v<T>) {
+        return std::is_base_of_v<fmt::formatter<std::underlying_type_t<T>>, fmt::formatter<T>>;
+    } else {
+        return false;
+    }
+}();
+
+template <typename T>
+constexpr ArgType GetArgType() {
+    if constexpr (std::is_same_v<T, bool>) {
+        return ArgType::Bool;
+    } else if constexpr (std::is_same_v<T, char>) {
+        return ArgType::Char;
+    } else if constexpr (std::is_same_v<T, float>) {
+        return ArgType::Float32;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return ArgType::Float64;
+    } else if constexpr (IsStringArg<T>) {
+        return ArgType::String;
+    } else if constexpr (std::is_pointer_v<T> || std::is_null_pointer_v<T>) {
+        return ArgType::Pointer;
+    } else if constexpr (IsValueEnum<T>) {
+        return GetArgType<std::underlying_type_t<T>>();
+    } else {
+        return std::is_signed_v<T> ? ArgType::Signed : ArgType::Unsigned;
+    }
+}
+
+template <typename T>
+constexpr bool IsDeferrableArg = [] {
+    if constexpr (IsStringArg<T> || IsValueEnum<T>) {
+        return true;
+    } else if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char> ||
+                         std::is_same_v<T, float> || std::is_same_v<T, double>) {
+        return true;
+    } else if constexpr (std::is_pointer_v<T>) {
+        // Only void pointers are formatted as addresses, see fmt::ptr
+        return std::is_void_v<std::remove_pointer_t<T>>;
+    } else if constexpr (std::is_null_pointer_v<T>) {
+        return true;
+    } else if constexpr (std::is_integral_v<T>) {
+        // Wide characters and 128-bit integers are left to the call site
+        return sizeof(T) <= sizeof(u64) && !std::is_same_v<T, wchar_t> &&
+               !std::is_same_v<T, char8_t> && !std::is_same_v<T, char16_t> &&
+               !std::is_same_v<T, char32_t>;
+    } else {
+        return false;
+    }
+}();
+
+template <typename T>
+std::string_view ToStringArg(const T& value) {
+    if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) {
+        return value != nullptr ? std::string_view{value} : std::string_view{};
+    } else if constexpr (std::is_array_v<T>) {
+        return std::string_view{value};
+    } else {
+        return std::string_view{value.data(), value.size()};
+    }
+}
+
+template <typename T>
+size_t GetArgSize(const T& value) {
+    constexpr ArgType type = GetArgType<T>();
+    if constexpr (type == ArgType::String) {
+        return 1 + sizeof(u32) + ToStringArg(value).size();
+    } else if constexpr (type == ArgType::Bool || type == ArgType::Char) {
+        return 1 + sizeof(u8);
+    } else if constexpr (type == ArgType::Float32) {
+        return 1 + sizeof(float);
+    } else {
+        return 1 + sizeof(u64);
+    }
+}
+
+template <typename T>
+u8* WriteArg(u8* out, const T& value) {
+    constexpr ArgType type = GetArgType<T>();
+    *out++ = static_cast<u8>(type);
+
+    const auto write = [&out](const auto& raw) {
+        std::memcpy(out, &raw, sizeof(raw));
+        out += sizeof(raw);
+    };
+    if constexpr (type == ArgType::String) {
+        const std::string_view string = ToStringArg(value);
+        write(static_cast<u32>(string.size()));
+        std::memcpy(out, string.data(), string.size());
+        out += string.size();
+    } else if constexpr (type == ArgType::Bool || type == ArgType::Char) {
+        write(static_cast<u8>(value));
+    } else if constexpr (type == ArgType::Float32 || type == ArgType::Float64) {
+        write(value);
+    } else if constexpr (std::is_null_pointer_v<T>) {
+        write(u64{0});
+    } else if constexpr (type == ArgType::Pointer) {
+        write(static_cast<u64>(reinterpret_cast<uintptr_t>(value)));
+    } else if constexpr (type == ArgType::Signed) {
+        write(static_cast<s64>(value));
+    } else {
+        write(static_cast<u64>(value));
+    }
+    return out;
+}
+
+} // namespace Detail
+
+/// Whether every argument can be packed for the logging thread to format it later.
+template <typename... Args>
+constexpr bool IsDeferrable = (Detail::IsDeferrableArg<std::remove_cvref_t<Args>> && ...);
+
+/**
+ * Packs a message for the logging thread.
+ *
+ * @returns True if the message was handled, false if it has to be formatted at the call site.
+ */
+template <typename... Args>
+bool LogDeferred(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                 const char* function, std::string_view format, const Args&... args) {
+    switch (GetDeferredState(log_class, log_level)) {
+    case DeferredState::Disabled:
+        return false;
+    case DeferredState::Filtered:
+        return true;
+    case DeferredState::Enabled:
+        break;
+    }
+
+    const size_t args_size = (size_t{0} + ... + Detail::GetArgSize(args));
+    u8* out = BeginDeferredRecord(log_class, log_level, filename, line_num, function, format,
+                                  sizeof...(Args), args_size);
+    if (out == nullptr) {
+        return false;
+    }
+    ((out = Detail::WriteArg(out, args)), ...);
+    CommitDeferredRecord();
+    return true;
+}
+
+} // namespace Common::Log
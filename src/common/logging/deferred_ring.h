@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+#include "common/alignment.h"
+#include "common/common_types.h"
+#include "common/literals.h"
+#include "common/logging/types.h"
+
+namespace Common::Log {
+
+using namespace Common::Literals;
+
+/**
+ * Header of a message in the ring buffer of a thread. It is followed either by the packed
+ * arguments of a deferred message, or by the text of a message that was formatted at the call
+ * site, so that the messages of a thread are written in the order they were logged.
+ */
+struct DeferredRecord {
+    u32 size = 0; ///< Size of the record including the arguments, aligned to the header.
+    u32 num_args = 0;
+    u32 args_size = 0; ///< Size of the arguments or of the text.
+    u32 format_size = 0;
+    s64 timestamp = 0; ///< Microseconds since the logger was created.
+    const char* filename = nullptr; ///< Null for the padding at the end of a ring buffer.
+    const char* function = nullptr;
+    const char* format = nullptr; ///< Null for messages that are already formatted.
+    unsigned int line_num = 0;
+    Class log_class{};
+    Level log_level{};
+
+    u8* Args() {
+        return reinterpret_cast<u8*>(this + 1);
+    }
+
+    const u8* Args() const {
+        return reinterpret_cast<const u8*>(this + 1);
+    }
+
+    bool IsText() const {
+        return format == nullptr;
+    }
+
+    std::string_view Text() const {
+        return {reinterpret_cast<const char*>(Args()), args_size};
+    }
+};
+
+/**
+ * Ring buffer of the messages of one thread. The owning thread produces records and the logging
+ * thread consumes them. A record that does not fit before the end of the buffer starts at the
+ * beginning instead, and the skipped space is marked with a padding record.
+ */
+class DeferredRing {
+public:
+    static constexpr size_t CAPACITY = 64_KiB;
+    /// Larger messages are formatted at the call site.
+    static constexpr size_t MAX_RECORD_SIZE = CAPACITY / 4;
+
+    /// Reserves an aligned record, returns nullptr if there is no space for it.
+    DeferredRecord* Reserve(size_t size) {
+        if (size > MAX_RECORD_SIZE) {
+            return nullptr;
+        }
+        size_t write = write_index.load(std::memory_order_relaxed);
+        const size_t used = write - read_index.load(std::memory_order_acquire);
+        const size_t tail = CAPACITY - write % CAPACITY;
+        if (used + (size > tail ? tail + size : size) > CAPACITY) {
+            return nullptr;
+        }
+        if (size > tail) {
+            std::construct_at(RecordAt(write), DeferredRecord{.size = static_cast<u32>(tail)});
+            write += tail;
+        }
+        pending_index = write + size;
+        return RecordAt(write);
+    }
+
+    /// Publishes the last reserved record.
+    void Commit() {
+        write_index.store(pending_index, std::memory_order_release);
+    }
+
+    /**
+     * Copies a message that was formatted at the call site into the ring.
+     *
+     * @returns False if there is no space for it.
+     */
+    bool PushText(DeferredRecord header, std::string_view text) {
+        const size_t size =
+            Common::AlignUp(sizeof(DeferredRecord) + text.size(), alignof(DeferredRecord));
+        DeferredRecord* const record = Reserve(size);
+        if (record == nullptr) {
+            return false;
+        }
+        header.size = static_cast<u32>(size);
+        header.num_args = 0;
+        header.args_size = static_cast<u32>(text.size());
+        header.format_size = 0;
+        header.format = nullptr;
+        std::memcpy(std::construct_at(record, header)->Args(), text.data(), text.size());
+        Commit();
+        return true;
+    }
+
+    /// Producer: returns true once the consumer has released every published record.
+    bool IsEmpty() const {
+        return read_index.load(std::memory_order_acquire) ==
+               write_index.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the oldest record or nullptr if the ring is empty.
+    const DeferredRecord* Front() {
+        for (;;) {
+            const size_t read = read_index.load(std::memory_order_relaxed);
+            if (read == write_index.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            const DeferredRecord* const record = RecordAt(read);
+            if (record->filename != nullptr) {
+                return record;
+            }
+            read_index.store(read + record->size, std::memory_order_release);
+        }
+    }
+
+    /// Releases the record returned by Front.
+    void Pop() {
+        const size_t read = read_index.load(std::memory_order_relaxed);
+        read_index.store(read + RecordAt(read)->size, std::memory_order_release);
+    }
+
+    /// Set when the owning thread exits, the ring is released once it has been drained.
+    std::atomic_bool abandoned{false};
+
+private:
+    DeferredRecord* RecordAt(size_t index) {
+        return reinterpret_cast<DeferredRecord*>(buffer.data() + index % CAPACITY);
+    }
+
+    alignas(128) std::atomic_size_t write_index{0};
+    size_t pending_index{0};
+    alignas(128) std::atomic_size_t read_index{0};
+    // The extra space lets a padding record start right before the end of the buffer
+    alignas(DeferredRecord) std::array<u8, CAPACITY + sizeof(DeferredRecord)> buffer{};
+};
+
+} // namespace Common::Log
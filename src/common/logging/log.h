@@ -8,6 +8,7 @@
 
 #include <fmt/format.h>
 
+#include "common/logging/deferred.h"
 #include "common/logging/formatter.h"
 #include "common/logging/types.h"
 
@@ -30,6 +31,13 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, fmt::format_string<Args...> format, const Args&... args) {
+    if constexpr (IsDeferrable<Args...>) {
+        const fmt::string_view format_view = format;
+        if (LogDeferred(log_class, log_level, filename, line_num, function,
+                        {format_view.data(), format_view.size()}, args...)) {
+            return;
+        }
+    }
     FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
                       fmt::make_format_args(args...));
 }
@@ -251,6 +251,7 @@ struct Values {
                                               Category::CpuDebug};
     Setting<bool> cpuopt_ignore_memory_aborts{linkage, true, "cpuopt_ignore_memory_aborts",
                                               Category::CpuDebug};
+    Setting<bool> cpu_jit_profile{linkage, true, "cpu_jit_profile", Category::CpuDebug};
 
     SwitchableSetting<bool> cpuopt_unsafe_unfuse_fma{linkage, true, "cpuopt_unsafe_unfuse_fma",
                                                      Category::CpuUnsafe};
@@ -385,6 +386,19 @@ struct Values {
                                                                   AstcRecompression::Bc3,
                                                                   "astc_recompression",
                                                                   Category::RendererAdvanced};
+    SwitchableSetting<bool> use_disk_texture_cache{linkage, false, "use_disk_texture_cache",
+                                                   Category::RendererAdvanced,
+                                                   Specialization::Paired};
+    SwitchableSetting<u16, true> disk_texture_cache_size{linkage,
+                                                         2048,
+                                                         64,
+                                                         32768,
+                                                         "disk_texture_cache_size",
+                                                         Category::RendererAdvanced,
+                                                         Specialization::Countable,
+                                                         true,
+                                                         false,
+                                                         &use_disk_texture_cache};
     SwitchableSetting<VramUsageMode, true> vram_usage_mode{linkage,
                                                            VramUsageMode::Conservative,
                                                            VramUsageMode::Conservative,
@@ -585,6 +599,9 @@ struct Values {
     Setting<bool> dump_macros{
         linkage, false, "dump_macros", Category::DebuggingGraphics, Specialization::Default, false};
     Setting<bool> enable_fs_access_log{linkage, false, "enable_fs_access_log", Category::Debugging};
+    Setting<bool> record_svc_statistics{linkage, false, "record_svc_statistics",
+                                        Category::Debugging, Specialization::Default, false,
+                                        true};
     Setting<bool> reporting_services{
         linkage, false, "reporting_services", Category::Debugging, Specialization::Default, false};
     Setting<bool> quest_flag{linkage, false, "quest_flag", Category::Debugging};
@@ -604,6 +621,8 @@ struct Values {
     // Miscellaneous
     Setting<std::string> log_filter{linkage, "*:Info", "log_filter", Category::Miscellaneous};
     Setting<bool> log_async{linkage, true, "log_async", Category::Miscellaneous};
+    Setting<bool> log_deferred{linkage, true, "log_deferred", Category::Miscellaneous};
+    Setting<bool> log_binary{linkage, false, "log_binary", Category::Miscellaneous};
     Setting<bool> use_dev_keys{linkage, false, "use_dev_keys", Category::Miscellaneous};
 
     // Network
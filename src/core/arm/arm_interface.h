@@ -72,6 +72,10 @@ public:
     // Clear a range of the instruction cache for this CPU.
     virtual void InvalidateCacheRange(u64 addr, std::size_t size) = 0;
 
+    // Translate the block at this address ahead of time, without executing it.
+    // This should not be called if the CPU is running.
+    virtual void PrecompileBlock(u64 pc, u32 fpcr) {}
+
     // Get the current architecture.
     // This returns AArch64 when PSTATE.nRW == 0 and AArch32 when PSTATE.nRW == 1.
     virtual Architecture GetArchitecture() const = 0;
@@ -5,6 +5,8 @@
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/arm/dynarmic/arm_dynarmic_64.h"
 #include "core/arm/dynarmic/dynarmic_exclusive_monitor.h"
+#include "core/arm/jit_profile.h"
+#include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/kernel/k_process.h"
 
@@ -19,7 +21,10 @@ public:
         : m_parent{parent}, m_memory(process->GetMemory()),
           m_process(process), m_debugger_enabled{parent.m_system.DebuggerEnabled()},
           m_check_memory_access{m_debugger_enabled ||
-                                !Settings::values.cpuopt_ignore_memory_aborts.GetValue()} {}
+                                !Settings::values.cpuopt_ignore_memory_aborts.GetValue()},
+          m_jit_profile{process->IsApplication() && Settings::values.cpu_jit_profile.GetValue()
+                            ? &parent.m_system.GetJitProfile()
+                            : nullptr} {}
 
     u8 MemoryRead8(u64 vaddr) override {
         CheckMemoryAccess(vaddr, 1, Kernel::DebugWatchpointType::Read);
@@ -45,7 +50,11 @@ public:
         if (!m_memory.IsValidVirtualAddressRange(vaddr, sizeof(u32))) {
             return std::nullopt;
         }
-        return m_memory.Read32(vaddr);
+        const u32 instruction = m_memory.Read32(vaddr);
+        if (m_jit_profile) {
+            RecordCodeRead(vaddr, instruction);
+        }
+        return instruction;
     }
 
     void MemoryWrite8(u64 vaddr, u8 value) override {
@@ -206,6 +215,24 @@ public:
         return true;
     }
 
+    /// Whether Dynarmic ends the block it is translating at this instruction.
+    static bool EndsBlock(u32 instruction) {
+        return (instruction & 0x7C000000) == 0x14000000 || // B, BL
+               (instruction & 0x7C000000) == 0x34000000 || // CBZ, CBNZ, TBZ, TBNZ
+               (instruction & 0xFF000010) == 0x54000000 || // B.cond
+               (instruction & 0xFF000000) == 0xD4000000 || // SVC, BRK and other exceptions
+               (instruction & 0xFE000000) == 0xD6000000;   // BR, BLR, RET, ERET
+    }
+
+    void RecordCodeRead(u64 vaddr, u32 instruction) {
+        // Blocks are translated by reading their instructions in order, so a read that does not
+        // follow the previous instruction of the block starts a new one
+        if (vaddr != m_next_code_address) {
+            m_jit_profile->RecordBlock(vaddr, m_parent.m_jit->GetFpcr());
+        }
+        m_next_code_address = EndsBlock(instruction) ? 0 : vaddr + sizeof(u32);
+    }
+
     void ReturnException(u64 pc, Dynarmic::HaltReason hr) {
         m_parent.GetContext(m_parent.m_breakpoint_context);
         m_parent.m_breakpoint_context.pc = pc;
@@ -219,6 +246,8 @@ public:
     Kernel::KProcess* m_process{};
     const bool m_debugger_enabled{};
     const bool m_check_memory_access{};
+    JitProfile* const m_jit_profile{};
+    u64 m_next_code_address{};
     static constexpr u64 MinimumRunCycles = 10000U;
 };
 
@@ -368,6 +397,21 @@ HaltReason ArmDynarmic64::RunThread(Kernel::KThread* thread) {
     return TranslateHaltReason(m_jit->Run());
 }
 
+void ArmDynarmic64::PrecompileBlock(u64 pc, u32 fpcr) {
+    ScopedJitExecution sj(m_cb->m_process);
+
+    Kernel::Svc::ThreadContext ctx{};
+    GetContext(ctx);
+
+    // Run translates the block at PC, then returns before executing it as a halt is pending
+    m_jit->HaltExecution(BreakLoop);
+    m_jit->SetPC(pc);
+    m_jit->SetFpcr(fpcr);
+    m_jit->Run();
+
+    SetContext(ctx);
+}
+
 HaltReason ArmDynarmic64::StepThread(Kernel::KThread* thread) {
     ScopedJitExecution sj(thread->GetOwnerProcess());
 
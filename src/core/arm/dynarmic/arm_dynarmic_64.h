@@ -47,6 +47,7 @@ public:
     void SignalInterrupt(Kernel::KThread* thread) override;
     void ClearInstructionCache() override;
     void InvalidateCacheRange(u64 addr, std::size_t size) override;
+    void PrecompileBlock(u64 pc, u32 fpcr) override;
 
 protected:
     const Kernel::DebugWatchpoint* HaltedWatchpoint() const override;
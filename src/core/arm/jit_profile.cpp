@@ -0,0 +1,267 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#include <fmt/format.h>
+
+#include "common/common_funcs.h"
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "core/arm/jit_profile.h"
+#include "core/file_sys/content_index.h"
+
+namespace Core {
+
+namespace {
+constexpr u32 JIT_PROFILE_MAGIC = Common::MakeMagic('S', 'J', 'P', 'F');
+
+/// Bumped whenever the layout of the profile file changes
+constexpr u32 JIT_PROFILE_VERSION = 1;
+
+/// Bounds the size of a profile and the time spent translating it at boot
+constexpr std::size_t MAX_BLOCKS = 32768;
+
+/// Blocks translated on demand within this time after boot are reported as startup hitches
+constexpr std::chrono::seconds STARTUP_WINDOW{60};
+
+std::filesystem::path GetProfilePath(u64 program_id) {
+    return Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) / "jit_profile" /
+           fmt::format("{:016X}.bin", program_id);
+}
+} // Anonymous namespace
+
+JitProfile::JitProfile() = default;
+
+JitProfile::~JitProfile() = default;
+
+void JitProfile::Reset() {
+    std::scoped_lock lock{mutex};
+    program_id = 0;
+    build_ids.clear();
+    modules.clear();
+    loaded.clear();
+    recorded.clear();
+    recorded_set.clear();
+    is_recording = false;
+    is_startup_reported = false;
+    warmed_blocks = 0;
+    warmup_duration = {};
+    startup_translations = 0;
+    session_translations = 0;
+}
+
+void JitProfile::RegisterModule(const BuildID& build_id, u64 base, u64 size) {
+    std::scoped_lock lock{mutex};
+    modules.push_back(Module{
+        .build_index = GetBuildIndex(build_id),
+        .base = base,
+        .size = size,
+    });
+}
+
+void JitProfile::Load(u64 program_id_) {
+    std::scoped_lock lock{mutex};
+    program_id = program_id_;
+    if (program_id == 0) {
+        return;
+    }
+
+    const auto path = GetProfilePath(program_id);
+    std::vector<u8> data;
+    {
+        Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read,
+                                Common::FS::FileType::BinaryFile};
+        if (!file.IsOpen()) {
+            return;
+        }
+        data.resize(file.GetSize());
+        if (file.ReadSpan(std::span{data}) != data.size()) {
+            return;
+        }
+    }
+
+    FileSys::ContentIndexReader reader{data};
+    if (reader.Read<u32>() != JIT_PROFILE_MAGIC || reader.Read<u32>() != JIT_PROFILE_VERSION) {
+        LOG_INFO(Core_ARM, "Ignoring outdated JIT profile {}", Common::FS::PathToUTF8String(path));
+        return;
+    }
+    // Map the build indices of the file to the ones of this session
+    const auto num_build_ids = reader.Read<u64>();
+    std::vector<u32> build_indices;
+    for (u64 i = 0; i < num_build_ids && reader.IsValid(); ++i) {
+        build_indices.push_back(GetBuildIndex(reader.Read<BuildID>()));
+    }
+    const auto num_blocks = std::min<u64>(reader.Read<u64>(), MAX_BLOCKS);
+    for (u64 i = 0; i < num_blocks && reader.IsValid(); ++i) {
+        const auto build_index = reader.Read<u32>();
+        const auto offset = reader.Read<u32>();
+        const auto fpcr = reader.Read<u32>();
+        if (reader.IsValid() && build_index < build_indices.size()) {
+            loaded.push_back(Entry{
+                .build_index = build_indices[build_index],
+                .offset = offset,
+                .fpcr = fpcr,
+            });
+        }
+    }
+    if (!reader.IsValid()) {
+        LOG_WARNING(Core_ARM, "JIT profile {} is truncated, some blocks were dropped",
+                    Common::FS::PathToUTF8String(path));
+    }
+}
+
+std::vector<JitProfile::Block> JitProfile::GetWarmupBlocks() const {
+    std::scoped_lock lock{mutex};
+    std::vector<Block> blocks;
+    blocks.reserve(loaded.size());
+    for (const Entry& entry : loaded) {
+        const auto it = std::ranges::find(modules, entry.build_index, &Module::build_index);
+        if (it != modules.end() && entry.offset < it->size) {
+            blocks.push_back(Block{
+                .address = it->base + entry.offset,
+                .fpcr = entry.fpcr,
+            });
+        }
+    }
+    return blocks;
+}
+
+void JitProfile::BeginSession(std::size_t num_warmed, std::chrono::nanoseconds warmup_time) {
+    std::scoped_lock lock{mutex};
+    is_recording = program_id != 0 && !modules.empty();
+    session_start = std::chrono::steady_clock::now();
+    warmed_blocks = num_warmed;
+    warmup_duration = warmup_time;
+}
+
+void JitProfile::RecordBlock(u64 address, u32 fpcr) {
+    std::scoped_lock lock{mutex};
+    if (!is_recording) {
+        return;
+    }
+    ++session_translations;
+    if (!is_startup_reported) {
+        if (std::chrono::steady_clock::now() - session_start < STARTUP_WINDOW) {
+            ++startup_translations;
+        } else {
+            ReportStartup();
+        }
+    }
+    if (recorded.size() >= MAX_BLOCKS) {
+        return;
+    }
+    const auto it = std::ranges::find_if(modules, [address](const Module& module) {
+        return address >= module.base && address - module.base < module.size;
+    });
+    if (it == modules.end()) {
+        return;
+    }
+    const Entry entry{
+        .build_index = it->build_index,
+        .offset = static_cast<u32>(address - it->base),
+        .fpcr = fpcr,
+    };
+    if (recorded_set.insert(entry).second) {
+        recorded.push_back(entry);
+    }
+}
+
+void JitProfile::Save() {
+    std::scoped_lock lock{mutex};
+    if (!is_recording) {
+        return;
+    }
+    is_recording = false;
+    if (!is_startup_reported) {
+        ReportStartup();
+    }
+    LOG_INFO(Core_ARM, "JIT profile {:016X}: {} blocks translated on demand this session",
+             program_id, session_translations);
+
+    // Blocks of this session go first, then the ones of previous boots that were not translated
+    // again because they were warmed up. Blocks of modules that are not loaded anymore are dropped.
+    std::vector<Entry> entries = recorded;
+    for (const Entry& entry : loaded) {
+        if (entries.size() >= MAX_BLOCKS) {
+            break;
+        }
+        if (IsRegistered(entry.build_index) && !recorded_set.contains(entry)) {
+            entries.push_back(entry);
+        }
+    }
+
+    // Only the build IDs of the loaded modules are written, numbered in the order of the modules
+    std::vector<u32> file_indices(build_ids.size());
+    for (u32 i = 0; i < modules.size(); ++i) {
+        file_indices[modules[i].build_index] = i;
+    }
+
+    FileSys::ContentIndexWriter writer;
+    writer.Write(JIT_PROFILE_MAGIC);
+    writer.Write(JIT_PROFILE_VERSION);
+    writer.Write(static_cast<u64>(modules.size()));
+    for (const Module& module : modules) {
+        writer.Write(build_ids[module.build_index]);
+    }
+    writer.Write(static_cast<u64>(entries.size()));
+    for (const Entry& entry : entries) {
+        writer.Write(file_indices[entry.build_index]);
+        writer.Write(entry.offset);
+        writer.Write(entry.fpcr);
+    }
+    const auto data = writer.Release();
+
+    const auto path = GetProfilePath(program_id);
+    if (!Common::FS::CreateParentDirs(path)) {
+        LOG_ERROR(Core_ARM, "Failed to create the directory of the JIT profile {}",
+                  Common::FS::PathToUTF8String(path));
+        return;
+    }
+    auto temp_path = path;
+    temp_path += ".tmp";
+    bool is_written{};
+    {
+        Common::FS::IOFile file{temp_path, Common::FS::FileAccessMode::Write,
+                                Common::FS::FileType::BinaryFile};
+        is_written = file.IsOpen() && file.WriteSpan(std::span{data}) == data.size();
+    }
+    std::error_code ec;
+    if (is_written) {
+        std::filesystem::rename(temp_path, path, ec);
+    }
+    if (!is_written || ec) {
+        LOG_ERROR(Core_ARM, "Failed to write the JIT profile {}",
+                  Common::FS::PathToUTF8String(path));
+        Common::FS::RemoveFile(temp_path);
+    }
+}
+
+u32 JitProfile::GetBuildIndex(const BuildID& build_id) {
+    const auto it = std::ranges::find(build_ids, build_id);
+    if (it != build_ids.end()) {
+        return static_cast<u32>(it - build_ids.begin());
+    }
+    build_ids.push_back(build_id);
+    return static_cast<u32>(build_ids.size() - 1);
+}
+
+bool JitProfile::IsRegistered(u32 build_index) const {
+    return std::ranges::find(modules, build_index, &Module::build_index) != modules.end();
+}
+
+void JitProfile::ReportStartup() {
+    is_startup_reported = true;
+    LOG_INFO(Core_ARM,
+             "JIT profile {:016X}: {} blocks translated ahead of time in {} ms, {} blocks "
+             "translated on demand in the first {} s",
+             program_id, warmed_blocks,
+             std::chrono::duration_cast<std::chrono::milliseconds>(warmup_duration).count(),
+             startup_translations, STARTUP_WINDOW.count());
+}
+
+} // namespace Core
@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Core {
+
+/**
+ * Per-title profile of the guest blocks the JIT translated, so that the next boot of the title
+ * can translate them before the guest first reaches them.
+ * Blocks are recorded as offsets into the loaded modules, identified by their NSO build ID, so a
+ * profile stays valid when the modules are loaded at a different address and entries of modules
+ * that changed are dropped. Dynarmic does not count block executions, so blocks are kept in the
+ * order they were first translated, which puts the code run at boot first.
+ */
+class JitProfile {
+public:
+    using BuildID = std::array<u8, 0x20>;
+
+    /// Guest block to translate ahead of time.
+    struct Block {
+        u64 address;
+        u32 fpcr;
+    };
+
+    JitProfile();
+    ~JitProfile();
+
+    JitProfile(const JitProfile&) = delete;
+    JitProfile& operator=(const JitProfile&) = delete;
+
+    /// Forgets the modules and blocks of the previously loaded title.
+    void Reset();
+
+    /**
+     * Registers the code segment of a module loaded into the application process.
+     *
+     * @param build_id NSO build ID of the module
+     * @param base Guest address of the code segment
+     * @param size Size of the code segment in bytes
+     */
+    void RegisterModule(const BuildID& build_id, u64 base, u64 size);
+
+    /**
+     * Loads the profile saved by a previous boot of a title.
+     *
+     * @param program_id Program ID of the title
+     */
+    void Load(u64 program_id);
+
+    /// Gets the loaded blocks that belong to a registered module, at their current address.
+    [[nodiscard]] std::vector<Block> GetWarmupBlocks() const;
+
+    /**
+     * Starts recording the blocks translated on demand and reports the warm-up.
+     *
+     * @param num_warmed Number of blocks translated ahead of time
+     * @param warmup_time Time spent translating them
+     */
+    void BeginSession(std::size_t num_warmed, std::chrono::nanoseconds warmup_time);
+
+    /**
+     * Records a block the JIT translated on demand. Thread safe.
+     *
+     * @param address Guest address of the first instruction of the block
+     * @param fpcr FPCR the block was translated for
+     */
+    void RecordBlock(u64 address, u32 fpcr);
+
+    /// Stops recording and writes the profile of the current title.
+    void Save();
+
+private:
+    struct Entry {
+        u32 build_index;
+        u32 offset;
+        u32 fpcr;
+
+        bool operator==(const Entry&) const = default;
+    };
+
+    struct EntryHash {
+        std::size_t operator()(const Entry& entry) const noexcept {
+            const u64 key = (u64{entry.build_index} << 32) | entry.offset;
+            return static_cast<std::size_t>((key ^ (u64{entry.fpcr} << 16)) *
+                                            0x9E3779B97F4A7C15ULL);
+        }
+    };
+
+    struct Module {
+        u32 build_index;
+        u64 base;
+        u64 size;
+    };
+
+    u32 GetBuildIndex(const BuildID& build_id);
+    bool IsRegistered(u32 build_index) const;
+    void ReportStartup();
+
+    mutable std::mutex mutex;
+    u64 program_id{};
+    std::vector<BuildID> build_ids;
+    std::vector<Module> modules;
+    std::vector<Entry> loaded;
+    std::vector<Entry> recorded;
+    std::unordered_set<Entry, EntryHash> recorded_set;
+
+    bool is_recording{};
+    bool is_startup_reported{};
+    std::chrono::steady_clock::time_point session_start{};
+    std::size_t warmed_blocks{};
+    std::chrono::nanoseconds warmup_duration{};
+    std::size_t startup_translations{};
+    std::size_t session_translations{};
+};
+
+} // namespace Core
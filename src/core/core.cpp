@@ -3,8 +3,11 @@
 
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "audio_core/audio_core.h"
 #include "common/fs/fs.h"
@@ -14,6 +17,7 @@
 #include "common/settings_enums.h"
 #include "common/string_util.h"
 #include "core/arm/exclusive_monitor.h"
+#include "core/arm/jit_profile.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/cpu_manager.h"
@@ -33,6 +37,7 @@
 #include "core/hle/kernel/k_scheduler.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/physical_core.h"
+#include "core/hle/kernel/svc_statistics.h"
 #include "core/hle/service/acc/profile_manager.h"
 #include "core/hle/service/am/applet_manager.h"
 #include "core/hle/service/am/frontend/applets.h"
@@ -306,6 +311,9 @@ struct System::Impl {
                             Service::AM::FrontendAppletParameters& params) {
         InitializeKernel(system);
 
+        // The modules of the application are registered while it is loaded
+        jit_profile.Reset();
+
         const auto file = GetGameFileFromPath(virtual_filesystem, filepath);
 
         // Create the application process
@@ -356,6 +364,9 @@ struct System::Impl {
             cheat_engine->Initialize();
         }
 
+        // Translate the code the previous boots ran before the application starts
+        PrewarmJit(*process->GetHandle(), params.program_id);
+
         // Register with applet manager
         // All threads are started, begin main process execution, now that we're in the clear
         applet_manager.CreateAndInsertByFrontendAppletParameters(std::move(process), params);
@@ -393,6 +404,27 @@ struct System::Impl {
         return status;
     }
 
+    void PrewarmJit(Kernel::KProcess& process, u64 program_id) {
+        if (!Settings::values.cpu_jit_profile.GetValue()) {
+            return;
+        }
+        jit_profile.Load(program_id);
+        const auto blocks = jit_profile.GetWarmupBlocks();
+        const auto start = std::chrono::steady_clock::now();
+        if (!blocks.empty()) {
+            // Every core has its own code cache, so they are filled in parallel
+            std::vector<std::jthread> workers;
+            for (size_t core = 0; core < Core::Hardware::NUM_CPU_CORES; ++core) {
+                workers.emplace_back([&blocks, interface = process.GetArmInterface(core)] {
+                    for (const auto& block : blocks) {
+                        interface->PrecompileBlock(block.address, block.fpcr);
+                    }
+                });
+            }
+        }
+        jit_profile.BeginSession(blocks.size(), std::chrono::steady_clock::now() - start);
+    }
+
     void ShutdownMainProcess() {
         SetShuttingDown(true);
 
@@ -410,6 +442,7 @@ struct System::Impl {
         kernel.SuspendEmulation(true);
         kernel.CloseServices();
         kernel.ShutdownCores();
+        jit_profile.Save();
         services.reset();
         service_manager.reset();
         fs_controller.Reset();
@@ -539,6 +572,8 @@ struct System::Impl {
     std::array<Core::GPUDirtyMemoryManager, Core::Hardware::NUM_CPU_CORES>
         gpu_dirty_memory_managers;
 
+    Core::JitProfile jit_profile;
+
     std::deque<std::vector<u8>> user_channel;
 };
 
@@ -745,6 +780,10 @@ const Core::PerfStats& System::GetPerfStats() const {
     return *impl->perf_stats;
 }
 
+Core::JitProfile& System::GetJitProfile() {
+    return impl->jit_profile;
+}
+
 Core::SpeedLimiter& System::SpeedLimiter() {
     return impl->speed_limiter;
 }
@@ -988,6 +1027,14 @@ void System::ApplySettings() {
 
     if (IsPoweredOn()) {
         Renderer().RefreshBaseSettings();
+
+        // Turning SVC statistics off while running saves what was recorded so far
+        auto& svc_statistics = Kernel().SvcStatistics();
+        const bool record_svc_statistics = Settings::values.record_svc_statistics.GetValue();
+        if (svc_statistics.IsEnabled() && !record_svc_statistics) {
+            void(svc_statistics.SaveReport(GetApplicationProcessProgramID()));
+        }
+        svc_statistics.SetEnabled(record_svc_statistics);
     }
 }
 
@@ -119,6 +119,7 @@ class Debugger;
 class DeviceMemory;
 class ExclusiveMonitor;
 class GPUDirtyMemoryManager;
+class JitProfile;
 class PerfStats;
 class Reporter;
 class SpeedLimiter;
@@ -313,6 +314,9 @@ public:
     /// Provides a constant reference to the internal PerfStats instance.
     [[nodiscard]] const Core::PerfStats& GetPerfStats() const;
 
+    /// Provides a reference to the JIT profile of the running application.
+    [[nodiscard]] Core::JitProfile& GetJitProfile();
+
     /// Provides a reference to the speed limiter;
     [[nodiscard]] Core::SpeedLimiter& SpeedLimiter();
 
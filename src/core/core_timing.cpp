@@ -2,9 +2,13 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <array>
+#include <limits>
 #include <mutex>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #ifdef _WIN32
 #include "common/windows/timer_resolution.h"
@@ -14,6 +18,8 @@
 #include "common/x64/cpu_wait.h"
 #endif
 
+#include "common/assert.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "core/core_timing.h"
 #include "core/hardware_properties.h"
@@ -26,25 +32,193 @@ std::shared_ptr<EventType> CreateEvent(std::string name, TimedCallback&& callbac
     return std::make_shared<EventType>(std::move(callback), std::move(name));
 }
 
+namespace {
+constexpr u32 INVALID_EVENT = std::numeric_limits<u32>::max();
+} // Anonymous namespace
+
 struct CoreTiming::Event {
     s64 time;
     u64 fifo_order;
     std::weak_ptr<EventType> type;
     s64 reschedule_time;
-    heap_t::handle_type handle{};
+    /// Sequence number of the event type when this was scheduled
+    size_t sequence_number;
+
+    u32 next_pending{INVALID_EVENT};
+    std::atomic<u32> next_free{INVALID_EVENT};
+
+    /// Returns true when the event type was destroyed or unscheduled after this was scheduled
+    bool IsStale() const {
+        const auto event_type{type.lock()};
+        return !event_type || event_type->sequence_number != sequence_number;
+    }
 
     // Sort by time, unless the times are the same, in which case sort by
     // the order added to the queue
     friend bool operator>(const Event& left, const Event& right) {
         return std::tie(left.time, left.fifo_order) > std::tie(right.time, right.fifo_order);
     }
+};
+
+/// Queue of pending events, scheduled from any thread and consumed by the thread advancing time.
+///
+/// Events are pooled nodes addressed by index. Producers take a node from a free list and push it
+/// to a pending stack, each with a single CAS. The free list head carries a tag bumped on every
+/// change to rule out ABA. Only the consumer takes the pending stack, all at once, and merges it
+/// into a binary heap nobody else touches.
+class CoreTiming::EventQueue {
+public:
+    /// Takes an unused event from the pool, returns INVALID_EVENT when it is exhausted, thread-safe
+    u32 Allocate() {
+        u64 head = free_head.load(std::memory_order_acquire);
+        while (true) {
+            const u32 index = static_cast<u32>(head);
+            if (index == INVALID_EVENT) {
+                return Grow();
+            }
+            // The event might be taken and modified meanwhile, the tag makes the exchange fail then
+            const u32 next = Get(index).next_free.load(std::memory_order_relaxed);
+            if (free_head.compare_exchange_weak(head, NextTag(head) | next,
+                                                std::memory_order_acquire)) {
+                return index;
+            }
+        }
+    }
+
+    /// Returns an event to the pool, thread-safe
+    void Free(u32 index) {
+        Event& evt = Get(index);
+        evt.type.reset();
+        u64 head = free_head.load(std::memory_order_relaxed);
+        do {
+            evt.next_free.store(static_cast<u32>(head), std::memory_order_relaxed);
+        } while (!free_head.compare_exchange_weak(head, NextTag(head) | index,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed));
+    }
+
+    /// Hands a filled event to the consumer, thread-safe
+    void Push(u32 index) {
+        Event& evt = Get(index);
+        u32 head = pending_head.load(std::memory_order_relaxed);
+        do {
+            evt.next_pending = head;
+        } while (!pending_head.compare_exchange_weak(head, index, std::memory_order_release,
+                                                     std::memory_order_relaxed));
+    }
+
+    Event& Get(u32 index) {
+        return chunks[index / CHUNK_SIZE]->events[index % CHUNK_SIZE];
+    }
+
+    /// Merges the events pushed by producers into the heap, consumer only
+    void Drain() {
+        u32 index = pending_head.exchange(INVALID_EVENT, std::memory_order_acquire);
+        while (index != INVALID_EVENT) {
+            const u32 next = Get(index).next_pending;
+            Insert(index);
+            index = next;
+        }
+        if (heap.size() >= compact_threshold) {
+            Compact();
+        }
+    }
+
+    /// Adds an event to the heap, consumer only
+    void Insert(u32 index) {
+        heap.push_back(index);
+        std::ranges::push_heap(heap, Compare{this});
+    }
+
+    /// Returns the index of the earliest event in the heap, consumer only
+    u32 Top() const {
+        return heap.empty() ? INVALID_EVENT : heap.front();
+    }
+
+    /// Removes the earliest event from the heap without freeing it, consumer only
+    void Pop() {
+        std::ranges::pop_heap(heap, Compare{this});
+        heap.pop_back();
+    }
+
+    /// Frees every event in the heap and returns how many there were, consumer only
+    size_t Clear() {
+        Drain();
+        const size_t count = heap.size();
+        for (const u32 index : heap) {
+            Free(index);
+        }
+        heap.clear();
+        return count;
+    }
+
+    /// Number of events freed by the last compaction
+    size_t TakeCompacted() {
+        return std::exchange(num_compacted, 0);
+    }
+
+private:
+    static constexpr u32 CHUNK_SIZE = 256;
+    static constexpr u32 MAX_CHUNKS = 4096;
+    static constexpr size_t MIN_COMPACT_THRESHOLD = 256;
+
+    struct Chunk {
+        std::array<Event, CHUNK_SIZE> events;
+    };
+
+    struct Compare {
+        EventQueue* queue;
+
+        bool operator()(u32 left, u32 right) const {
+            return queue->Get(left) > queue->Get(right);
+        }
+    };
 
-    friend bool operator<(const Event& left, const Event& right) {
-        return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
+    static u64 NextTag(u64 head) {
+        return ((head >> 32) + 1) << 32;
     }
+
+    u32 Grow() {
+        std::scoped_lock lock{grow_mutex};
+        if (num_chunks == MAX_CHUNKS) {
+            return INVALID_EVENT;
+        }
+        const u32 base = num_chunks * CHUNK_SIZE;
+        chunks[num_chunks++] = std::make_unique<Chunk>();
+        for (u32 i = 1; i < CHUNK_SIZE; ++i) {
+            Free(base + i);
+        }
+        return base;
+    }
+
+    /// Frees unscheduled events, which are otherwise only dropped once they reach the top
+    void Compact() {
+        const auto stale_begin = std::ranges::partition(heap, [this](u32 index) {
+                                     return !Get(index).IsStale();
+                                 }).begin();
+        num_compacted += static_cast<size_t>(std::distance(stale_begin, heap.end()));
+        for (auto it = stale_begin; it != heap.end(); ++it) {
+            Free(*it);
+        }
+        heap.erase(stale_begin, heap.end());
+        std::ranges::make_heap(heap, Compare{this});
+        compact_threshold = std::max(MIN_COMPACT_THRESHOLD, heap.size() * 2);
+    }
+
+    std::array<std::unique_ptr<Chunk>, MAX_CHUNKS> chunks;
+    u32 num_chunks{};
+    std::mutex grow_mutex;
+
+    std::atomic<u64> free_head{INVALID_EVENT};
+    std::atomic<u32> pending_head{INVALID_EVENT};
+
+    std::vector<u32> heap;
+    size_t compact_threshold{MIN_COMPACT_THRESHOLD};
+    size_t num_compacted{};
 };
 
-CoreTiming::CoreTiming() : clock{Common::CreateOptimalClock()} {}
+CoreTiming::CoreTiming()
+    : clock{Common::CreateOptimalClock()}, event_queue{std::make_unique<EventQueue>()} {}
 
 CoreTiming::~CoreTiming() {
     Reset();
@@ -72,8 +246,8 @@ void CoreTiming::Initialize(std::function<void()>&& on_thread_init_) {
 }
 
 void CoreTiming::ClearPendingEvents() {
-    std::scoped_lock lock{advance_lock, basic_lock};
-    event_queue.clear();
+    std::scoped_lock lock{advance_lock};
+    num_queued_events -= event_queue->Clear() + event_queue->TakeCompacted();
     event.Set();
 }
 
@@ -111,58 +285,50 @@ bool CoreTiming::IsRunning() const {
 }
 
 bool CoreTiming::HasPendingEvents() const {
-    std::scoped_lock lock{basic_lock};
-    return !(wait_set && event_queue.empty());
+    return !(wait_set && num_queued_events == 0);
 }
 
 void CoreTiming::ScheduleEvent(std::chrono::nanoseconds ns_into_future,
                                const std::shared_ptr<EventType>& event_type, bool absolute_time) {
-    {
-        std::scoped_lock scope{basic_lock};
-        const auto next_time{absolute_time ? ns_into_future : GetGlobalTimeNs() + ns_into_future};
-
-        auto h{event_queue.emplace(Event{next_time.count(), event_fifo_id++, event_type, 0})};
-        (*h).handle = h;
-    }
-
-    event.Set();
+    const auto next_time{absolute_time ? ns_into_future : GetGlobalTimeNs() + ns_into_future};
+    PushEvent(next_time.count(), event_type, 0);
 }
 
 void CoreTiming::ScheduleLoopingEvent(std::chrono::nanoseconds start_time,
                                       std::chrono::nanoseconds resched_time,
                                       const std::shared_ptr<EventType>& event_type,
                                       bool absolute_time) {
-    {
-        std::scoped_lock scope{basic_lock};
-        const auto next_time{absolute_time ? start_time : GetGlobalTimeNs() + start_time};
+    const auto next_time{absolute_time ? start_time : GetGlobalTimeNs() + start_time};
+    PushEvent(next_time.count(), event_type, resched_time.count());
+}
 
-        auto h{event_queue.emplace(
-            Event{next_time.count(), event_fifo_id++, event_type, resched_time.count()})};
-        (*h).handle = h;
+void CoreTiming::PushEvent(s64 time, const std::shared_ptr<EventType>& event_type,
+                           s64 reschedule_time) {
+    const u32 index = event_queue->Allocate();
+    if (index == INVALID_EVENT) [[unlikely]] {
+        LOG_ERROR(Core_Timing, "Too many events are scheduled, dropping event '{}'",
+                  event_type->name);
+        return;
     }
+    ++num_queued_events;
+
+    Event& evt = event_queue->Get(index);
+    evt.time = time;
+    evt.fifo_order = event_fifo_id++;
+    evt.type = event_type;
+    evt.reschedule_time = reschedule_time;
+    evt.sequence_number = event_type->sequence_number;
+    event_queue->Push(index);
 
     event.Set();
 }
 
 void CoreTiming::UnscheduleEvent(const std::shared_ptr<EventType>& event_type,
                                  UnscheduleEventType type) {
-    {
-        std::scoped_lock lk{basic_lock};
-
-        std::vector<heap_t::handle_type> to_remove;
-        for (auto itr = event_queue.begin(); itr != event_queue.end(); itr++) {
-            const Event& e = *itr;
-            if (e.type.lock().get() == event_type.get()) {
-                to_remove.push_back(itr->handle);
-            }
-        }
-
-        for (auto& h : to_remove) {
-            event_queue.erase(h);
-        }
-
-        event_type->sequence_number++;
-    }
+    // Pending events of the previous sequence are discarded by the timer thread, wake it up in
+    // case it's waiting for one of them
+    event_type->sequence_number++;
+    event.Set();
 
     // Force any in-progress events to finish
     if (type == UnscheduleEventType::Wait) {
@@ -198,59 +364,75 @@ u64 CoreTiming::GetGPUTicks() const {
 }
 
 std::optional<s64> CoreTiming::Advance() {
-    std::scoped_lock lock{advance_lock, basic_lock};
+    std::scoped_lock lock{advance_lock};
     global_timer = GetGlobalTimeNs().count();
 
-    while (!event_queue.empty() && event_queue.top().time <= global_timer) {
-        const Event& evt = event_queue.top();
-
-        if (const auto event_type{evt.type.lock()}) {
-            const auto evt_time = evt.time;
-            const auto evt_sequence_num = event_type->sequence_number;
-
-            if (evt.reschedule_time == 0) {
-                event_queue.pop();
-
-                basic_lock.unlock();
+    while (true) {
+        event_queue->Drain();
+        num_queued_events -= event_queue->TakeCompacted();
 
-                event_type->callback(
-                    evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time});
+        const u32 index = event_queue->Top();
+        if (index == INVALID_EVENT) {
+            break;
+        }
+        Event& evt = event_queue->Get(index);
+        const auto event_type{evt.type.lock()};
+        if (!event_type || event_type->sequence_number != evt.sequence_number) {
+            // Unscheduled, drop it without waiting for its time to come
+            event_queue->Pop();
+            event_queue->Free(index);
+            --num_queued_events;
+            continue;
+        }
+        if (evt.time > global_timer) {
+            break;
+        }
 
-                basic_lock.lock();
-            } else {
-                basic_lock.unlock();
+        const auto evt_time = evt.time;
+        const auto evt_sequence_num = evt.sequence_number;
+        event_queue->Pop();
 
-                const auto new_schedule_time{event_type->callback(
-                    evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time})};
+        if (evt.reschedule_time == 0) {
+            event_queue->Free(index);
 
-                basic_lock.lock();
+            event_type->callback(evt_time,
+                                 std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time});
 
-                if (evt_sequence_num != event_type->sequence_number) {
-                    // Heap handle is invalidated after external modification.
-                    continue;
-                }
+            --num_queued_events;
+        } else {
+            const auto new_schedule_time{event_type->callback(
+                evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time})};
 
-                const auto next_schedule_time{new_schedule_time.has_value()
-                                                  ? new_schedule_time.value().count()
-                                                  : evt.reschedule_time};
+            if (evt_sequence_num != event_type->sequence_number) {
+                // Unscheduled from within the callback.
+                event_queue->Free(index);
+                --num_queued_events;
+                continue;
+            }
 
-                // If this event was scheduled into a pause, its time now is going to be way
-                // behind. Re-set this event to continue from the end of the pause.
-                auto next_time{evt.time + next_schedule_time};
-                if (evt.time < pause_end_time) {
-                    next_time = pause_end_time + next_schedule_time;
-                }
+            const auto next_schedule_time{new_schedule_time.has_value()
+                                              ? new_schedule_time.value().count()
+                                              : evt.reschedule_time};
 
-                event_queue.update(evt.handle, Event{next_time, event_fifo_id++, evt.type,
-                                                     next_schedule_time, evt.handle});
+            // If this event was scheduled into a pause, its time now is going to be way
+            // behind. Re-set this event to continue from the end of the pause.
+            auto next_time{evt.time + next_schedule_time};
+            if (evt.time < pause_end_time) {
+                next_time = pause_end_time + next_schedule_time;
             }
+
+            evt.time = next_time;
+            evt.fifo_order = event_fifo_id++;
+            evt.reschedule_time = next_schedule_time;
+            event_queue->Insert(index);
         }
 
         global_timer = GetGlobalTimeNs().count();
     }
 
-    if (!event_queue.empty()) {
-        return event_queue.top().time;
+    const u32 index = event_queue->Top();
+    if (index != INVALID_EVENT) {
+        return event_queue->Get(index).time;
     } else {
         return std::nullopt;
     }
@@ -12,8 +12,6 @@
 #include <string>
 #include <thread>
 
-#include <boost/heap/fibonacci_heap.hpp>
-
 #include "common/common_types.h"
 #include "common/thread.h"
 #include "common/wall_clock.h"
@@ -34,8 +32,8 @@ struct EventType {
     /// A pointer to the name of the event.
     const std::string name;
     /// A monotonic sequence number, incremented when this event is
-    /// changed externally.
-    size_t sequence_number;
+    /// changed externally. Scheduled events of an older sequence are discarded.
+    std::atomic<size_t> sequence_number;
 };
 
 enum class UnscheduleEventType {
@@ -95,7 +93,7 @@ public:
     /// Checks if there are any pending time events.
     bool HasPendingEvents() const;
 
-    /// Schedules an event in core timing
+    /// Schedules an event in core timing, never blocks on the timer thread
     void ScheduleEvent(std::chrono::nanoseconds ns_into_future,
                        const std::shared_ptr<EventType>& event_type, bool absolute_time = false);
 
@@ -106,6 +104,7 @@ public:
                               const std::shared_ptr<EventType>& event_type,
                               bool absolute_time = false);
 
+    /// Unschedules every pending instance of an event in constant time
     void UnscheduleEvent(const std::shared_ptr<EventType>& event_type,
                          UnscheduleEventType type = UnscheduleEventType::Wait);
 
@@ -140,6 +139,7 @@ public:
 
 private:
     struct Event;
+    class EventQueue;
 
     static void ThreadEntry(CoreTiming& instance);
     void ThreadLoop();
@@ -154,15 +154,15 @@ private:
     s64 timer_resolution_ns;
 #endif
 
-    using heap_t =
-        boost::heap::fibonacci_heap<CoreTiming::Event, boost::heap::compare<std::greater<>>>;
+    void PushEvent(s64 time, const std::shared_ptr<EventType>& event_type, s64 reschedule_time);
 
-    heap_t event_queue;
-    u64 event_fifo_id = 0;
+    std::unique_ptr<EventQueue> event_queue;
+    std::atomic<u64> event_fifo_id{};
+    /// Number of events scheduled and not yet retired by Advance
+    std::atomic<size_t> num_queued_events{};
 
     Common::Event event{};
     Common::Event pause_event{};
-    mutable std::mutex basic_lock;
     std::mutex advance_lock;
     std::unique_ptr<std::jthread> timer_thread;
     std::atomic<bool> paused{};
@@ -0,0 +1,235 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <latch>
+#include <thread>
+#include <mbedtls/aes.h>
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/div_ceil.h"
+#include "common/literals.h"
+#include "common/thread_worker.h"
+#include "core/crypto/aes_ctr_xts.h"
+
+#if defined(ARCHITECTURE_x86_64)
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Core::Crypto {
+
+namespace {
+using namespace Common::Literals;
+
+/// Inputs smaller than this are transcoded on the calling thread
+constexpr size_t ParallelThreshold = 1_MiB;
+
+/// Smallest amount of data worth handing to a worker thread
+constexpr size_t MinChunkSize = 256_KiB;
+
+using Block = std::array<u8, 0x10>;
+
+/// Adds a value to a 128-bit big endian counter
+Block AddCounter(Block counter, u64 value) {
+    for (size_t i = counter.size(); i-- > 0 && value != 0;) {
+        const u64 sum = u64{counter[i]} + (value & 0xFF);
+        counter[i] = static_cast<u8>(sum);
+        value = (value >> 8) + (sum >> 8);
+    }
+    return counter;
+}
+
+Common::ThreadWorker& GetWorkers() {
+    static Common::ThreadWorker workers(
+        std::max(std::thread::hardware_concurrency(), 2U) - 1, "AesWorker");
+    return workers;
+}
+
+/**
+ * Splits a transcode across the calling thread and the worker threads, and waits for all of it.
+ *
+ * @param size Size of the data in bytes
+ * @param granularity Size in bytes every chunk except the last one is a multiple of
+ * @param func Callable transcoding the chunk at an offset, taking the offset and size in bytes
+ */
+template <typename Func>
+void TranscodeParallel(size_t size, size_t granularity, const Func& func) {
+    const size_t max_chunks = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const size_t num_chunks = std::min(size / MinChunkSize, max_chunks);
+    if (size < ParallelThreshold || num_chunks <= 1) {
+        func(size_t{0}, size);
+        return;
+    }
+
+    const size_t chunk_size = Common::AlignUp(Common::DivCeil(size, num_chunks), granularity);
+    auto& workers = GetWorkers();
+    std::latch done{static_cast<std::ptrdiff_t>(Common::DivCeil(size, chunk_size) - 1)};
+    for (size_t offset = chunk_size; offset < size; offset += chunk_size) {
+        workers.QueueWork([&func, &done, offset, chunk = std::min(chunk_size, size - offset)] {
+            func(offset, chunk);
+            done.count_down();
+        });
+    }
+    func(size_t{0}, chunk_size);
+    done.wait();
+}
+
+AesKernelLevel ClampKernelLevel(AesKernelLevel level) {
+    return std::min(level, GetHostAesKernelLevel());
+}
+} // Anonymous namespace
+
+AesKernelLevel GetHostAesKernelLevel() {
+#if defined(ARCHITECTURE_x86_64)
+    static const AesKernelLevel level = [] {
+        const auto& caps = Common::GetCPUCaps();
+        if (!caps.aes) {
+            return AesKernelLevel::Generic;
+        }
+        return caps.vaes && caps.avx2 ? AesKernelLevel::VAES : AesKernelLevel::AESNI;
+    }();
+    return level;
+#else
+    return AesKernelLevel::Generic;
+#endif
+}
+
+struct AesCtrCipher::Context {
+    AesKernelLevel level;
+    AesRoundKeys keys;
+    mbedtls_aes_context aes;
+};
+
+AesCtrCipher::AesCtrCipher(const std::array<u8, 0x10>& key, AesKernelLevel level)
+    : ctx(std::make_unique<Context>()) {
+    ctx->level = ClampKernelLevel(level);
+    mbedtls_aes_init(&ctx->aes);
+    ASSERT(mbedtls_aes_setkey_enc(&ctx->aes, key.data(), 128) == 0);
+#if defined(ARCHITECTURE_x86_64)
+    if (ctx->level != AesKernelLevel::Generic) {
+        AesRoundKeys decrypt_keys;
+        AESNI::ExpandKey(key.data(), ctx->keys, decrypt_keys);
+    }
+#endif
+}
+
+AesCtrCipher::~AesCtrCipher() {
+    mbedtls_aes_free(&ctx->aes);
+}
+
+void AesCtrCipher::Transcode(const u8* src, size_t size, u8* dest,
+                             const std::array<u8, BlockSize>& counter) const {
+    TranscodeParallel(size, BlockSize, [&](size_t offset, size_t chunk_size) {
+        TranscodeSerial(src + offset, chunk_size, dest + offset,
+                        AddCounter(counter, offset / BlockSize));
+    });
+}
+
+void AesCtrCipher::TranscodeSerial(const u8* src, size_t size, u8* dest,
+                                   const std::array<u8, BlockSize>& counter) const {
+    switch (ctx->level) {
+#if defined(ARCHITECTURE_x86_64)
+    case AesKernelLevel::VAES:
+        VAES::CtrTranscode(ctx->keys, src, size, dest, counter.data());
+        return;
+    case AesKernelLevel::AESNI:
+        AESNI::CtrTranscode(ctx->keys, src, size, dest, counter.data());
+        return;
+#endif
+    default: {
+        // The counter and key stream live on the stack, the context is only read
+        size_t stream_offset = 0;
+        Block nonce_counter = counter;
+        Block stream_block{};
+        mbedtls_aes_crypt_ctr(&ctx->aes, size, &stream_offset, nonce_counter.data(),
+                              stream_block.data(), src, dest);
+        return;
+    }
+    }
+}
+
+struct AesXtsCipher::Context {
+    AesKernelLevel level;
+    AesRoundKeys encrypt_keys;
+    AesRoundKeys decrypt_keys;
+    AesRoundKeys tweak_keys;
+    mbedtls_aes_xts_context encrypt_xts;
+    mbedtls_aes_xts_context decrypt_xts;
+};
+
+AesXtsCipher::AesXtsCipher(const std::array<u8, 0x20>& key, AesKernelLevel level)
+    : ctx(std::make_unique<Context>()) {
+    ctx->level = ClampKernelLevel(level);
+    mbedtls_aes_xts_init(&ctx->encrypt_xts);
+    mbedtls_aes_xts_init(&ctx->decrypt_xts);
+    ASSERT(mbedtls_aes_xts_setkey_enc(&ctx->encrypt_xts, key.data(), 256) == 0);
+    ASSERT(mbedtls_aes_xts_setkey_dec(&ctx->decrypt_xts, key.data(), 256) == 0);
+#if defined(ARCHITECTURE_x86_64)
+    if (ctx->level != AesKernelLevel::Generic) {
+        AesRoundKeys unused_keys;
+        AESNI::ExpandKey(key.data(), ctx->encrypt_keys, ctx->decrypt_keys);
+        AESNI::ExpandKey(key.data() + 0x10, ctx->tweak_keys, unused_keys);
+    }
+#endif
+}
+
+AesXtsCipher::~AesXtsCipher() {
+    mbedtls_aes_xts_free(&ctx->encrypt_xts);
+    mbedtls_aes_xts_free(&ctx->decrypt_xts);
+}
+
+void AesXtsCipher::Decrypt(const u8* src, size_t size, u8* dest,
+                           const std::array<u8, BlockSize>& tweak, size_t sector_size) const {
+    Transcode(src, size, dest, tweak, sector_size, true);
+}
+
+void AesXtsCipher::Encrypt(const u8* src, size_t size, u8* dest,
+                           const std::array<u8, BlockSize>& tweak, size_t sector_size) const {
+    Transcode(src, size, dest, tweak, sector_size, false);
+}
+
+void AesXtsCipher::Transcode(const u8* src, size_t size, u8* dest,
+                             const std::array<u8, BlockSize>& tweak, size_t sector_size,
+                             bool decrypt) const {
+    ASSERT(size % BlockSize == 0);
+    ASSERT(sector_size != 0 && sector_size % BlockSize == 0);
+
+    // Chunks are split on sector boundaries, so every chunk starts with a full tweak
+    TranscodeParallel(size, sector_size, [&](size_t offset, size_t chunk_size) {
+        TranscodeSerial(src + offset, chunk_size, dest + offset,
+                        AddCounter(tweak, offset / sector_size), sector_size, decrypt);
+    });
+}
+
+void AesXtsCipher::TranscodeSerial(const u8* src, size_t size, u8* dest,
+                                   const std::array<u8, BlockSize>& tweak, size_t sector_size,
+                                   bool decrypt) const {
+    [[maybe_unused]] const auto& data_keys = decrypt ? ctx->decrypt_keys : ctx->encrypt_keys;
+    switch (ctx->level) {
+#if defined(ARCHITECTURE_x86_64)
+    case AesKernelLevel::VAES:
+        VAES::XtsTranscode(data_keys, ctx->tweak_keys, src, size, dest, tweak.data(), sector_size,
+                           decrypt);
+        return;
+    case AesKernelLevel::AESNI:
+        AESNI::XtsTranscode(data_keys, ctx->tweak_keys, src, size, dest, tweak.data(),
+                            sector_size, decrypt);
+        return;
+#endif
+    default: {
+        auto* const xts = decrypt ? &ctx->decrypt_xts : &ctx->encrypt_xts;
+        const int mode = decrypt ? MBEDTLS_AES_DECRYPT : MBEDTLS_AES_ENCRYPT;
+        Block sector_tweak = tweak;
+        for (size_t offset = 0; offset < size; offset += sector_size) {
+            const size_t block_size = std::min(sector_size, size - offset);
+            mbedtls_aes_crypt_xts(xts, mode, block_size, sector_tweak.data(), src + offset,
+                                  dest + offset);
+            sector_tweak = AddCounter(sector_tweak, 1);
+        }
+        return;
+    }
+    }
+}
+
+} // namespace Core::Crypto
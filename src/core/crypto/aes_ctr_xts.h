@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+#include "common/common_types.h"
+
+namespace Core::Crypto {
+
+/// AES-128 round keys, one per round plus the initial whitening key
+using AesRoundKeys = std::array<std::array<u8, 0x10>, 11>;
+
+enum class AesKernelLevel {
+    Generic,
+    AESNI,
+    VAES,
+};
+
+/**
+ * Gets the best AES kernel level supported by the host CPU.
+ *
+ * @returns The kernel level.
+ */
+[[nodiscard]] AesKernelLevel GetHostAesKernelLevel();
+
+/**
+ * AES-128-CTR with a 128-bit big endian counter.
+ * The cipher holds no state besides its key, so one instance may transcode from several threads at
+ * once. Large inputs are split across worker threads.
+ */
+class AesCtrCipher {
+public:
+    static constexpr size_t BlockSize = 0x10;
+
+    explicit AesCtrCipher(const std::array<u8, 0x10>& key,
+                          AesKernelLevel level = GetHostAesKernelLevel());
+    ~AesCtrCipher();
+
+    AesCtrCipher(const AesCtrCipher&) = delete;
+    AesCtrCipher& operator=(const AesCtrCipher&) = delete;
+
+    /**
+     * Encrypts or decrypts data, which are the same operation in CTR mode.
+     *
+     * @param src Source data
+     * @param size Size of the data in bytes
+     * @param dest Destination of the data, may be the same as the source
+     * @param counter Counter of the first block of the data
+     */
+    void Transcode(const u8* src, size_t size, u8* dest,
+                   const std::array<u8, BlockSize>& counter) const;
+
+private:
+    struct Context;
+
+    void TranscodeSerial(const u8* src, size_t size, u8* dest,
+                         const std::array<u8, BlockSize>& counter) const;
+
+    std::unique_ptr<Context> ctx;
+};
+
+/**
+ * AES-128-XTS over sectors whose tweak is a 128-bit big endian sector number, as used by NCAs.
+ * The cipher holds no state besides its keys, so one instance may transcode from several threads
+ * at once. Large inputs are split across worker threads.
+ */
+class AesXtsCipher {
+public:
+    static constexpr size_t BlockSize = 0x10;
+
+    /**
+     * @param key Data key followed by the tweak key
+     * @param level Kernel level to use
+     */
+    explicit AesXtsCipher(const std::array<u8, 0x20>& key,
+                          AesKernelLevel level = GetHostAesKernelLevel());
+    ~AesXtsCipher();
+
+    AesXtsCipher(const AesXtsCipher&) = delete;
+    AesXtsCipher& operator=(const AesXtsCipher&) = delete;
+
+    /**
+     * Decrypts consecutive sectors.
+     *
+     * @param src Source data
+     * @param size Size of the data in bytes, must be a multiple of the block size. Only the last
+     *             sector may be shorter than the sector size.
+     * @param dest Destination of the data, may be the same as the source
+     * @param tweak Tweak of the first sector, incremented for every following sector
+     * @param sector_size Size of a sector in bytes, must be a multiple of the block size
+     */
+    void Decrypt(const u8* src, size_t size, u8* dest, const std::array<u8, BlockSize>& tweak,
+                 size_t sector_size) const;
+
+    /// Encrypts consecutive sectors, see Decrypt.
+    void Encrypt(const u8* src, size_t size, u8* dest, const std::array<u8, BlockSize>& tweak,
+                 size_t sector_size) const;
+
+private:
+    struct Context;
+
+    void Transcode(const u8* src, size_t size, u8* dest, const std::array<u8, BlockSize>& tweak,
+                   size_t sector_size, bool decrypt) const;
+    void TranscodeSerial(const u8* src, size_t size, u8* dest,
+                         const std::array<u8, BlockSize>& tweak, size_t sector_size,
+                         bool decrypt) const;
+
+    std::unique_ptr<Context> ctx;
+};
+
+#if defined(ARCHITECTURE_x86_64)
+namespace AESNI {
+void ExpandKey(const u8* key, AesRoundKeys& encrypt_keys, AesRoundKeys& decrypt_keys);
+void CtrTranscode(const AesRoundKeys& keys, const u8* src, size_t size, u8* dest,
+                  const u8* counter);
+void XtsTranscode(const AesRoundKeys& data_keys, const AesRoundKeys& tweak_keys, const u8* src,
+                  size_t size, u8* dest, const u8* tweak, size_t sector_size, bool decrypt);
+} // namespace AESNI
+
+namespace VAES {
+void CtrTranscode(const AesRoundKeys& keys, const u8* src, size_t size, u8* dest,
+                  const u8* counter);
+void XtsTranscode(const AesRoundKeys& data_keys, const AesRoundKeys& tweak_keys, const u8* src,
+                  size_t size, u8* dest, const u8* tweak, size_t sector_size, bool decrypt);
+} // namespace VAES
+#endif
+
+} // namespace Core::Crypto
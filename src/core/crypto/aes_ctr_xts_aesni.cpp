@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// This file is compiled with AES-NI enabled, it must only be called after checking the host CPU.
+
+#include "core/crypto/aes_ctr_xts.h"
+#include "core/crypto/aes_ctr_xts_x64.h"
+
+namespace Core::Crypto::AESNI {
+
+namespace {
+using namespace X64;
+
+/// Number of blocks processed together, enough to hide the latency of the AES instructions
+constexpr size_t Lanes = 8;
+
+template <int rcon>
+__m128i ExpandRound(__m128i key) {
+    __m128i assist = _mm_aeskeygenassist_si128(key, rcon);
+    assist = _mm_shuffle_epi32(assist, 0xFF);
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, assist);
+}
+
+void Store(AesRoundKeys& round_keys, size_t round, __m128i key) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(round_keys[round].data()), key);
+}
+
+template <bool decrypt>
+void XtsSector(const RoundKeys& data_keys, const RoundKeys& tweak_keys, const u8* src,
+               size_t size, u8* dest, const Counter& sector) {
+    __m128i tweak = EncryptBlock(tweak_keys, Counter{sector}.Next());
+
+    size_t offset = 0;
+    for (; offset + Lanes * BlockSize <= size; offset += Lanes * BlockSize) {
+        __m128i tweaks[Lanes];
+        __m128i blocks[Lanes];
+        for (size_t i = 0; i < Lanes; ++i) {
+            tweaks[i] = tweak;
+            tweak = MultiplyTweak(tweak);
+            const auto* const in = reinterpret_cast<const __m128i*>(src + offset) + i;
+            blocks[i] = _mm_xor_si128(_mm_loadu_si128(in), tweaks[i]);
+        }
+        for (size_t i = 0; i < Lanes; ++i) {
+            blocks[i] = _mm_xor_si128(blocks[i], data_keys.keys[0]);
+        }
+        for (size_t round = 1; round < 10; ++round) {
+            for (size_t i = 0; i < Lanes; ++i) {
+                blocks[i] = decrypt ? _mm_aesdec_si128(blocks[i], data_keys.keys[round])
+                                    : _mm_aesenc_si128(blocks[i], data_keys.keys[round]);
+            }
+        }
+        for (size_t i = 0; i < Lanes; ++i) {
+            blocks[i] = decrypt ? _mm_aesdeclast_si128(blocks[i], data_keys.keys[10])
+                                : _mm_aesenclast_si128(blocks[i], data_keys.keys[10]);
+            auto* const out = reinterpret_cast<__m128i*>(dest + offset) + i;
+            _mm_storeu_si128(out, _mm_xor_si128(blocks[i], tweaks[i]));
+        }
+    }
+    for (; offset < size; offset += BlockSize) {
+        const auto* const in = reinterpret_cast<const __m128i*>(src + offset);
+        const __m128i block = XtsBlock<decrypt>(data_keys, _mm_loadu_si128(in), tweak);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + offset), block);
+        tweak = MultiplyTweak(tweak);
+    }
+}
+
+template <bool decrypt>
+void XtsSectors(const AesRoundKeys& data_round_keys, const AesRoundKeys& tweak_round_keys,
+                const u8* src, size_t size, u8* dest, const u8* tweak, size_t sector_size) {
+    const RoundKeys data_keys = LoadRoundKeys(data_round_keys);
+    const RoundKeys tweak_keys = LoadRoundKeys(tweak_round_keys);
+    Counter sector = Counter::Load(tweak);
+    for (size_t offset = 0; offset < size; offset += sector_size) {
+        const size_t block_size = std::min(sector_size, size - offset);
+        XtsSector<decrypt>(data_keys, tweak_keys, src + offset, block_size, dest + offset, sector);
+        sector.Add(1);
+    }
+}
+} // Anonymous namespace
+
+void ExpandKey(const u8* key, AesRoundKeys& encrypt_keys, AesRoundKeys& decrypt_keys) {
+    __m128i round_key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+    __m128i keys[11];
+    keys[0] = round_key;
+    keys[1] = round_key = ExpandRound<0x01>(round_key);
+    keys[2] = round_key = ExpandRound<0x02>(round_key);
+    keys[3] = round_key = ExpandRound<0x04>(round_key);
+    keys[4] = round_key = ExpandRound<0x08>(round_key);
+    keys[5] = round_key = ExpandRound<0x10>(round_key);
+    keys[6] = round_key = ExpandRound<0x20>(round_key);
+    keys[7] = round_key = ExpandRound<0x40>(round_key);
+    keys[8] = round_key = ExpandRound<0x80>(round_key);
+    keys[9] = round_key = ExpandRound<0x1B>(round_key);
+    keys[10] = ExpandRound<0x36>(round_key);
+
+    // The equivalent inverse cipher runs the rounds backwards with InvMixColumns applied to the
+    // inner round keys
+    for (size_t round = 0; round < 11; ++round) {
+        Store(encrypt_keys, round, keys[round]);
+        const bool is_inner = round != 0 && round != 10;
+        Store(decrypt_keys, 10 - round, is_inner ? _mm_aesimc_si128(keys[round]) : keys[round]);
+    }
+}
+
+void CtrTranscode(const AesRoundKeys& round_keys, const u8* src, size_t size, u8* dest,
+                  const u8* counter_bytes) {
+    const RoundKeys keys = LoadRoundKeys(round_keys);
+    Counter counter = Counter::Load(counter_bytes);
+
+    size_t offset = 0;
+    for (; offset + Lanes * BlockSize <= size; offset += Lanes * BlockSize) {
+        __m128i blocks[Lanes];
+        for (size_t i = 0; i < Lanes; ++i) {
+            blocks[i] = _mm_xor_si128(counter.Next(), keys.keys[0]);
+        }
+        for (size_t round = 1; round < 10; ++round) {
+            for (size_t i = 0; i < Lanes; ++i) {
+                blocks[i] = _mm_aesenc_si128(blocks[i], keys.keys[round]);
+            }
+        }
+        for (size_t i = 0; i < Lanes; ++i) {
+            const auto* const in = reinterpret_cast<const __m128i*>(src + offset) + i;
+            const __m128i stream = _mm_aesenclast_si128(blocks[i], keys.keys[10]);
+            auto* const out = reinterpret_cast<__m128i*>(dest + offset) + i;
+            _mm_storeu_si128(out, _mm_xor_si128(_mm_loadu_si128(in), stream));
+        }
+    }
+    for (; offset + BlockSize <= size; offset += BlockSize) {
+        const __m128i stream = EncryptBlock(keys, counter.Next());
+        const auto* const in = reinterpret_cast<const __m128i*>(src + offset);
+        const __m128i block = _mm_xor_si128(_mm_loadu_si128(in), stream);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + offset), block);
+    }
+    if (offset < size) {
+        alignas(16) u8 stream[BlockSize];
+        _mm_store_si128(reinterpret_cast<__m128i*>(stream), EncryptBlock(keys, counter.Next()));
+        for (size_t i = 0; offset + i < size; ++i) {
+            dest[offset + i] = static_cast<u8>(src[offset + i] ^ stream[i]);
+        }
+    }
+}
+
+void XtsTranscode(const AesRoundKeys& data_keys, const AesRoundKeys& tweak_keys, const u8* src,
+                  size_t size, u8* dest, const u8* tweak, size_t sector_size, bool decrypt) {
+    if (decrypt) {
+        XtsSectors<true>(data_keys, tweak_keys, src, size, dest, tweak, sector_size);
+    } else {
+        XtsSectors<false>(data_keys, tweak_keys, src, size, dest, tweak, sector_size);
+    }
+}
+
+} // namespace Core::Crypto::AESNI
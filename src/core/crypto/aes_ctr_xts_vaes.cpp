@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// This file is compiled with VAES and AVX2 enabled, it must only be called after checking the host
+// CPU.
+
+#include "core/crypto/aes_ctr_xts.h"
+#include "core/crypto/aes_ctr_xts_x64.h"
+
+namespace Core::Crypto::VAES {
+
+namespace {
+using namespace X64;
+
+/// Number of 256-bit registers processed together, each holding two blocks
+constexpr size_t Lanes = 8;
+constexpr size_t StrideSize = Lanes * 2 * BlockSize;
+
+struct WideRoundKeys {
+    __m256i keys[11];
+};
+
+WideRoundKeys Broadcast(const RoundKeys& keys) {
+    WideRoundKeys out;
+    for (size_t round = 0; round < 11; ++round) {
+        out.keys[round] = _mm256_broadcastsi128_si256(keys.keys[round]);
+    }
+    return out;
+}
+
+__m256i Combine(__m128i low, __m128i high) {
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+}
+
+template <bool decrypt>
+void XtsSector(const RoundKeys& data_keys, const WideRoundKeys& wide_keys,
+               const RoundKeys& tweak_keys, const u8* src, size_t size, u8* dest,
+               const Counter& sector) {
+    __m128i tweak = EncryptBlock(tweak_keys, Counter{sector}.Next());
+
+    size_t offset = 0;
+    for (; offset + StrideSize <= size; offset += StrideSize) {
+        __m256i tweaks[Lanes];
+        __m256i blocks[Lanes];
+        for (size_t i = 0; i < Lanes; ++i) {
+            const __m128i next = MultiplyTweak(tweak);
+            tweaks[i] = Combine(tweak, next);
+            tweak = MultiplyTweak(next);
+            const auto* const in = reinterpret_cast<const __m256i*>(src + offset) + i;
+            blocks[i] = _mm256_xor_si256(_mm256_loadu_si256(in), tweaks[i]);
+        }
+        for (size_t i = 0; i < Lanes; ++i) {
+            blocks[i] = _mm256_xor_si256(blocks[i], wide_keys.keys[0]);
+        }
+        for (size_t round = 1; round < 10; ++round) {
+            for (size_t i = 0; i < Lanes; ++i) {
+                blocks[i] = decrypt ? _mm256_aesdec_epi128(blocks[i], wide_keys.keys[round])
+                                    : _mm256_aesenc_epi128(blocks[i], wide_keys.keys[round]);
+            }
+        }
+        for (size_t i = 0; i < Lanes; ++i) {
+            blocks[i] = decrypt ? _mm256_aesdeclast_epi128(blocks[i], wide_keys.keys[10])
+                                : _mm256_aesenclast_epi128(blocks[i], wide_keys.keys[10]);
+            auto* const out = reinterpret_cast<__m256i*>(dest + offset) + i;
+            _mm256_storeu_si256(out, _mm256_xor_si256(blocks[i], tweaks[i]));
+        }
+    }
+    for (; offset < size; offset += BlockSize) {
+        const auto* const in = reinterpret_cast<const __m128i*>(src + offset);
+        const __m128i block = XtsBlock<decrypt>(data_keys, _mm_loadu_si128(in), tweak);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + offset), block);
+        tweak = MultiplyTweak(tweak);
+    }
+}
+
+template <bool decrypt>
+void XtsSectors(const AesRoundKeys& data_round_keys, const AesRoundKeys& tweak_round_keys,
+                const u8* src, size_t size, u8* dest, const u8* tweak, size_t sector_size) {
+    const RoundKeys data_keys = LoadRoundKeys(data_round_keys);
+    const WideRoundKeys wide_keys = Broadcast(data_keys);
+    const RoundKeys tweak_keys = LoadRoundKeys(tweak_round_keys);
+    Counter sector = Counter::Load(tweak);
+    for (size_t offset = 0; offset < size; offset += sector_size) {
+        const size_t block_size = std::min(sector_size, size - offset);
+        XtsSector<decrypt>(data_keys, wide_keys, tweak_keys, src + offset, block_size,
+                           dest + offset, sector);
+        sector.Add(1);
+    }
+}
+} // Anonymous namespace
+
+void CtrTranscode(const AesRoundKeys& round_keys, const u8* src, size_t size, u8* dest,
+                  const u8* counter_bytes) {
+    const WideRoundKeys keys = Broadcast(LoadRoundKeys(round_keys));
+    Counter counter = Counter::Load(counter_bytes);
+
+    size_t offset = 0;
+    for (; offset + StrideSize <= size; offset += StrideSize) {
+        __m256i blocks[Lanes];
+        for (size_t i = 0; i < Lanes; ++i) {
+            const __m128i low = counter.Next();
+            const __m128i high = counter.Next();
+            blocks[i] = _mm256_xor_si256(Combine(low, high), keys.keys[0]);
+        }
+        for (size_t round = 1; round < 10; ++round) {
+            for (size_t i = 0; i < Lanes; ++i) {
+                blocks[i] = _mm256_aesenc_epi128(blocks[i], keys.keys[round]);
+            }
+        }
+        for (size_t i = 0; i < Lanes; ++i) {
+            const auto* const in = reinterpret_cast<const __m256i*>(src + offset) + i;
+            const __m256i stream = _mm256_aesenclast_epi128(blocks[i], keys.keys[10]);
+            auto* const out = reinterpret_cast<__m256i*>(dest + offset) + i;
+            _mm256_storeu_si256(out, _mm256_xor_si256(_mm256_loadu_si256(in), stream));
+        }
+    }
+    if (offset < size) {
+        alignas(16) u8 tail_counter[BlockSize];
+        counter.Store(tail_counter);
+        AESNI::CtrTranscode(round_keys, src + offset, size - offset, dest + offset, tail_counter);
+    }
+}
+
+void XtsTranscode(const AesRoundKeys& data_keys, const AesRoundKeys& tweak_keys, const u8* src,
+                  size_t size, u8* dest, const u8* tweak, size_t sector_size, bool decrypt) {
+    if (decrypt) {
+        XtsSectors<true>(data_keys, tweak_keys, src, size, dest, tweak, sector_size);
+    } else {
+        XtsSectors<false>(data_keys, tweak_keys, src, size, dest, tweak, sector_size);
+    }
+}
+
+} // namespace Core::Crypto::VAES
@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Helpers shared by the AES kernels. This header must only be included from files compiled with
+// AES-NI enabled.
+
+#pragma once
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/swap.h"
+#include "core/crypto/aes_ctr_xts.h"
+
+namespace Core::Crypto::X64 {
+
+// The helpers are compiled with the instruction set of each file including them, so they must not
+// be merged across files by the linker, which could pick a copy using instructions the CPU lacks.
+namespace {
+
+constexpr size_t BlockSize = 0x10;
+
+struct RoundKeys {
+    __m128i keys[11];
+};
+
+inline RoundKeys LoadRoundKeys(const AesRoundKeys& round_keys) {
+    RoundKeys out;
+    for (size_t i = 0; i < round_keys.size(); ++i) {
+        out.keys[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(round_keys[i].data()));
+    }
+    return out;
+}
+
+inline __m128i EncryptBlock(const RoundKeys& k, __m128i block) {
+    block = _mm_xor_si128(block, k.keys[0]);
+    for (size_t round = 1; round < 10; ++round) {
+        block = _mm_aesenc_si128(block, k.keys[round]);
+    }
+    return _mm_aesenclast_si128(block, k.keys[10]);
+}
+
+inline __m128i DecryptBlock(const RoundKeys& k, __m128i block) {
+    block = _mm_xor_si128(block, k.keys[0]);
+    for (size_t round = 1; round < 10; ++round) {
+        block = _mm_aesdec_si128(block, k.keys[round]);
+    }
+    return _mm_aesdeclast_si128(block, k.keys[10]);
+}
+
+/// A 128-bit big endian counter kept in native halves, so it is cheap to increment
+struct Counter {
+    u64 high;
+    u64 low;
+
+    static Counter Load(const u8* bytes) {
+        u64 high_be;
+        u64 low_be;
+        std::memcpy(&high_be, bytes, sizeof(u64));
+        std::memcpy(&low_be, bytes + sizeof(u64), sizeof(u64));
+        return {Common::swap64(high_be), Common::swap64(low_be)};
+    }
+
+    void Store(u8* bytes) const {
+        const u64 high_be = Common::swap64(high);
+        const u64 low_be = Common::swap64(low);
+        std::memcpy(bytes, &high_be, sizeof(u64));
+        std::memcpy(bytes + sizeof(u64), &low_be, sizeof(u64));
+    }
+
+    /// Returns the current value as a block and increments the counter
+    __m128i Next() {
+        const __m128i block = _mm_set_epi64x(static_cast<s64>(Common::swap64(low)),
+                                             static_cast<s64>(Common::swap64(high)));
+        Add(1);
+        return block;
+    }
+
+    void Add(u64 value) {
+        const u64 old_low = low;
+        low += value;
+        high += low < old_low ? 1 : 0;
+    }
+};
+
+/// Multiplies an XTS tweak by the primitive element of GF(2^128), x^128 + x^7 + x^2 + x + 1
+inline __m128i MultiplyTweak(__m128i tweak) {
+    // Every dword takes the carry of the dword below it, the top carry folds into the polynomial
+    const __m128i carries = _mm_shuffle_epi32(_mm_srai_epi32(tweak, 31), 0x93);
+    const __m128i doubled = _mm_add_epi32(tweak, tweak);
+    return _mm_xor_si128(doubled, _mm_and_si128(carries, _mm_set_epi32(1, 1, 1, 0x87)));
+}
+
+template <bool decrypt>
+__m128i XtsBlock(const RoundKeys& k, __m128i block, __m128i tweak) {
+    block = _mm_xor_si128(block, tweak);
+    block = decrypt ? DecryptBlock(k, block) : EncryptBlock(k, block);
+    return _mm_xor_si128(block, tweak);
+}
+
+} // Anonymous namespace
+
+} // namespace Core::Crypto::X64
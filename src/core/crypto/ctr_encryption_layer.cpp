@@ -9,7 +9,7 @@ namespace Core::Crypto {
 
 CTREncryptionLayer::CTREncryptionLayer(FileSys::VirtualFile base_, Key128 key_,
                                        std::size_t base_offset_)
-    : EncryptionLayer(std::move(base_)), base_offset(base_offset_), cipher(key_, Mode::CTR) {}
+    : EncryptionLayer(std::move(base_)), base_offset(base_offset_), cipher(key_) {}
 
 std::size_t CTREncryptionLayer::Read(u8* data, std::size_t length, std::size_t offset) const {
     if (length == 0)
@@ -17,16 +17,15 @@ std::size_t CTREncryptionLayer::Read(u8* data, std::size_t length, std::size_t o
 
     const auto sector_offset = offset & 0xF;
     if (sector_offset == 0) {
-        UpdateIV(base_offset + offset);
         std::vector<u8> raw = base->ReadBytes(length, offset);
-        cipher.Transcode(raw.data(), raw.size(), data, Op::Decrypt);
+        cipher.Transcode(raw.data(), raw.size(), data, GetCounter(base_offset + offset));
         return length;
     }
 
     // offset does not fall on block boundary (0x10)
     std::vector<u8> block = base->ReadBytes(0x10, offset - sector_offset);
-    UpdateIV(base_offset + offset - sector_offset);
-    cipher.Transcode(block.data(), block.size(), block.data(), Op::Decrypt);
+    cipher.Transcode(block.data(), block.size(), block.data(),
+                     GetCounter(base_offset + offset - sector_offset));
     std::size_t read = 0x10 - sector_offset;
 
     if (length + sector_offset < 0x10) {
@@ -41,12 +40,13 @@ void CTREncryptionLayer::SetIV(const IVData& iv_) {
     iv = iv_;
 }
 
-void CTREncryptionLayer::UpdateIV(std::size_t offset) const {
+CTREncryptionLayer::IVData CTREncryptionLayer::GetCounter(std::size_t offset) const {
+    IVData counter = iv;
     offset >>= 4;
     for (std::size_t i = 0; i < 8; ++i) {
-        iv[16 - i - 1] = offset & 0xFF;
+        counter[16 - i - 1] = offset & 0xFF;
         offset >>= 8;
     }
-    cipher.SetIV(iv);
+    return counter;
 }
 } // namespace Core::Crypto
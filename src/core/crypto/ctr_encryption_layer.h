@@ -5,7 +5,7 @@
 
 #include <array>
 
-#include "core/crypto/aes_util.h"
+#include "core/crypto/aes_ctr_xts.h"
 #include "core/crypto/encryption_layer.h"
 #include "core/crypto/key_manager.h"
 
@@ -25,11 +25,10 @@ public:
 private:
     std::size_t base_offset;
 
-    // Must be mutable as operations modify cipher contexts.
-    mutable AESCipher<Key128> cipher;
-    mutable IVData iv{};
+    AesCtrCipher cipher;
+    IVData iv{};
 
-    void UpdateIV(std::size_t offset) const;
+    IVData GetCounter(std::size_t offset) const;
 };
 
 } // namespace Core::Crypto
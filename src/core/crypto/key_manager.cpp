@@ -8,6 +8,8 @@
 #include <fstream>
 #include <locale>
 #include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
 #include <tuple>
 #include <vector>
@@ -825,25 +827,31 @@ bool KeyManager::BaseDeriveNecessary() const {
 }
 
 bool KeyManager::HasKey(S128KeyType id, u64 field1, u64 field2) const {
+    std::shared_lock lock{key_mutex};
     return s128_keys.find({id, field1, field2}) != s128_keys.end();
 }
 
 bool KeyManager::HasKey(S256KeyType id, u64 field1, u64 field2) const {
+    std::shared_lock lock{key_mutex};
     return s256_keys.find({id, field1, field2}) != s256_keys.end();
 }
 
 Key128 KeyManager::GetKey(S128KeyType id, u64 field1, u64 field2) const {
-    if (!HasKey(id, field1, field2)) {
+    std::shared_lock lock{key_mutex};
+    const auto it = s128_keys.find({id, field1, field2});
+    if (it == s128_keys.end()) {
         return {};
     }
-    return s128_keys.at({id, field1, field2});
+    return it->second;
 }
 
 Key256 KeyManager::GetKey(S256KeyType id, u64 field1, u64 field2) const {
-    if (!HasKey(id, field1, field2)) {
+    std::shared_lock lock{key_mutex};
+    const auto it = s256_keys.find({id, field1, field2});
+    if (it == s256_keys.end()) {
         return {};
     }
-    return s256_keys.at({id, field1, field2});
+    return it->second;
 }
 
 Key256 KeyManager::GetBISKey(u8 partition_id) const {
@@ -851,10 +859,9 @@ Key256 KeyManager::GetBISKey(u8 partition_id) const {
 
     for (const auto& bis_type : {BISKeyType::Crypto, BISKeyType::Tweak}) {
         if (HasKey(S128KeyType::BIS, partition_id, static_cast<u64>(bis_type))) {
-            std::memcpy(
-                out.data() + sizeof(Key128) * static_cast<u64>(bis_type),
-                s128_keys.at({S128KeyType::BIS, partition_id, static_cast<u64>(bis_type)}).data(),
-                sizeof(Key128));
+            const auto key = GetKey(S128KeyType::BIS, partition_id, static_cast<u64>(bis_type));
+            std::memcpy(out.data() + sizeof(Key128) * static_cast<u64>(bis_type), key.data(),
+                        sizeof(Key128));
         }
     }
 
@@ -862,6 +869,7 @@ Key256 KeyManager::GetBISKey(u8 partition_id) const {
 }
 
 void KeyManager::SetKey(S128KeyType id, Key128 key, u64 field1, u64 field2) {
+    std::scoped_lock lock{key_mutex};
     if (s128_keys.find({id, field1, field2}) != s128_keys.end() || key == Key128{}) {
         return;
     }
@@ -875,6 +883,7 @@ void KeyManager::SetKey(S128KeyType id, Key128 key, u64 field1, u64 field2) {
 }
 
 void KeyManager::SetKey(S256KeyType id, Key256 key, u64 field1, u64 field2) {
+    std::scoped_lock lock{key_mutex};
     if (s256_keys.find({id, field1, field2}) != s256_keys.end() || key == Key256{}) {
         return;
     }
@@ -1269,11 +1278,13 @@ void KeyManager::PopulateFromPartitionData(PartitionDataManager& data) {
     DeriveBase();
 }
 
-const std::map<u128, Ticket>& KeyManager::GetCommonTickets() const {
+std::map<u128, Ticket> KeyManager::GetCommonTickets() const {
+    std::shared_lock lock{key_mutex};
     return common_tickets;
 }
 
-const std::map<u128, Ticket>& KeyManager::GetPersonalizedTickets() const {
+std::map<u128, Ticket> KeyManager::GetPersonalizedTickets() const {
+    std::shared_lock lock{key_mutex};
     return personal_tickets;
 }
 
@@ -1286,10 +1297,13 @@ bool KeyManager::AddTicket(const Ticket& ticket) {
     const auto& rid = ticket.GetData().rights_id;
     u128 rights_id;
     std::memcpy(rights_id.data(), rid.data(), rid.size());
-    if (ticket.GetData().type == Core::Crypto::TitleKeyType::Common) {
-        common_tickets[rights_id] = ticket;
-    } else {
-        personal_tickets[rights_id] = ticket;
+    {
+        std::scoped_lock lock{key_mutex};
+        if (ticket.GetData().type == Core::Crypto::TitleKeyType::Common) {
+            common_tickets[rights_id] = ticket;
+        } else {
+            personal_tickets[rights_id] = ticket;
+        }
     }
 
     if (HasKey(S128KeyType::Titlekey, rights_id[1], rights_id[0])) {
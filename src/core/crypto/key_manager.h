@@ -7,6 +7,7 @@
 #include <filesystem>
 #include <map>
 #include <optional>
+#include <shared_mutex>
 #include <span>
 #include <string>
 
@@ -287,8 +288,9 @@ public:
 
     void PopulateFromPartitionData(PartitionDataManager& data);
 
-    const std::map<u128, Ticket>& GetCommonTickets() const;
-    const std::map<u128, Ticket>& GetPersonalizedTickets() const;
+    // Tickets are returned by copy, as they may be added while they are read.
+    std::map<u128, Ticket> GetCommonTickets() const;
+    std::map<u128, Ticket> GetPersonalizedTickets() const;
 
     bool AddTicket(const Ticket& ticket);
 
@@ -298,6 +300,10 @@ public:
 private:
     KeyManager();
 
+    // Guards the keys and tickets against content that is parsed from several threads at once,
+    // which reads keys and adds the title keys of the tickets it contains.
+    mutable std::shared_mutex key_mutex;
+
     std::map<KeyIndex<S128KeyType>, Key128> s128_keys;
     std::map<KeyIndex<S256KeyType>, Key256> s256_keys;
 
@@ -9,8 +9,20 @@ namespace Core::Crypto {
 
 constexpr u64 XTS_SECTOR_SIZE = 0x4000;
 
+namespace {
+// The tweak of a sector is its big endian index.
+std::array<u8, 16> CalculateNintendoTweak(std::size_t sector_id) {
+    std::array<u8, 16> out{};
+    for (std::size_t i = 0xF; i <= 0xF; --i) {
+        out[i] = static_cast<u8>(sector_id & 0xFF);
+        sector_id >>= 8;
+    }
+    return out;
+}
+} // Anonymous namespace
+
 XTSEncryptionLayer::XTSEncryptionLayer(FileSys::VirtualFile base_, Key256 key_)
-    : EncryptionLayer(std::move(base_)), cipher(key_, Mode::XTS) {}
+    : EncryptionLayer(std::move(base_)), cipher(key_) {}
 
 std::size_t XTSEncryptionLayer::Read(u8* data, std::size_t length, std::size_t offset) const {
     if (length == 0)
@@ -20,8 +32,8 @@ std::size_t XTSEncryptionLayer::Read(u8* data, std::size_t length, std::size_t o
     if (sector_offset == 0) {
         if (length % XTS_SECTOR_SIZE == 0) {
             std::vector<u8> raw = base->ReadBytes(length, offset);
-            cipher.XTSTranscode(raw.data(), raw.size(), data, offset / XTS_SECTOR_SIZE,
-                                XTS_SECTOR_SIZE, Op::Decrypt);
+            cipher.Decrypt(raw.data(), raw.size(), data,
+                           CalculateNintendoTweak(offset / XTS_SECTOR_SIZE), XTS_SECTOR_SIZE);
             return raw.size();
         }
         if (length > XTS_SECTOR_SIZE) {
@@ -32,8 +44,8 @@ std::size_t XTSEncryptionLayer::Read(u8* data, std::size_t length, std::size_t o
         std::vector<u8> buffer = base->ReadBytes(XTS_SECTOR_SIZE, offset);
         if (buffer.size() < XTS_SECTOR_SIZE)
             buffer.resize(XTS_SECTOR_SIZE);
-        cipher.XTSTranscode(buffer.data(), buffer.size(), buffer.data(), offset / XTS_SECTOR_SIZE,
-                            XTS_SECTOR_SIZE, Op::Decrypt);
+        cipher.Decrypt(buffer.data(), buffer.size(), buffer.data(),
+                       CalculateNintendoTweak(offset / XTS_SECTOR_SIZE), XTS_SECTOR_SIZE);
         std::memcpy(data, buffer.data(), std::min(buffer.size(), length));
         return std::min(buffer.size(), length);
     }
@@ -42,8 +54,9 @@ std::size_t XTSEncryptionLayer::Read(u8* data, std::size_t length, std::size_t o
     std::vector<u8> block = base->ReadBytes(0x4000, offset - sector_offset);
     if (block.size() < XTS_SECTOR_SIZE)
         block.resize(XTS_SECTOR_SIZE);
-    cipher.XTSTranscode(block.data(), block.size(), block.data(),
-                        (offset - sector_offset) / XTS_SECTOR_SIZE, XTS_SECTOR_SIZE, Op::Decrypt);
+    cipher.Decrypt(block.data(), block.size(), block.data(),
+                   CalculateNintendoTweak((offset - sector_offset) / XTS_SECTOR_SIZE),
+                   XTS_SECTOR_SIZE);
     const std::size_t read = XTS_SECTOR_SIZE - sector_offset;
 
     if (length + sector_offset < XTS_SECTOR_SIZE) {
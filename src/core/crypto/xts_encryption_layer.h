@@ -3,7 +3,7 @@
 
 #pragma once
 
-#include "core/crypto/aes_util.h"
+#include "core/crypto/aes_ctr_xts.h"
 #include "core/crypto/encryption_layer.h"
 #include "core/crypto/key_manager.h"
 
@@ -17,8 +17,7 @@ public:
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
 
 private:
-    // Must be mutable as operations modify cipher contexts.
-    mutable AESCipher<Key256> cipher;
+    AesXtsCipher cipher;
 };
 
 } // namespace Core::Crypto
@@ -0,0 +1,166 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <system_error>
+
+#include "common/common_funcs.h"
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/fs_util.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "core/file_sys/content_index.h"
+#include "core/file_sys/vfs/vfs_real.h"
+
+namespace FileSys {
+
+namespace {
+constexpr u32 CONTENT_INDEX_MAGIC = Common::MakeMagic('S', 'C', 'I', 'X');
+
+/// Bumped whenever the layout of the index file changes
+constexpr u32 CONTENT_INDEX_VERSION = 1;
+} // Anonymous namespace
+
+std::optional<ContentIndexStamp> GetContentIndexStamp(const std::filesystem::path& path) {
+    std::error_code ec;
+    const auto status = std::filesystem::status(path, ec);
+    if (ec || !std::filesystem::is_regular_file(status)) {
+        return std::nullopt;
+    }
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto modification_time = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    return ContentIndexStamp{
+        .size = size,
+        .modification_time = static_cast<s64>(modification_time.time_since_epoch().count()),
+    };
+}
+
+std::optional<ContentIndexStamp> GetContentIndexStamp(const VirtualFile& file) {
+    if (dynamic_cast<const RealVfsFile*>(file.get()) == nullptr) {
+        return std::nullopt;
+    }
+    return GetContentIndexStamp(std::filesystem::path{Common::FS::ToU8String(file->GetFullPath())});
+}
+
+ContentIndex::ContentIndex(std::filesystem::path path_) : path{std::move(path_)} {
+    Load();
+}
+
+ContentIndex::~ContentIndex() = default;
+
+std::optional<std::vector<u8>> ContentIndex::Find(const std::string& key,
+                                                  const ContentIndexStamp& stamp) {
+    std::scoped_lock lock{mutex};
+    const auto it = entries.find(key);
+    if (it == entries.end() || it->second.stamp != stamp) {
+        return std::nullopt;
+    }
+    it->second.is_used = true;
+    return it->second.data;
+}
+
+void ContentIndex::Insert(std::string key, const ContentIndexStamp& stamp, std::vector<u8> data) {
+    std::scoped_lock lock{mutex};
+    entries.insert_or_assign(std::move(key), Entry{
+                                                 .stamp = stamp,
+                                                 .data = std::move(data),
+                                                 .is_used = true,
+                                             });
+    is_dirty = true;
+}
+
+bool ContentIndex::Commit() {
+    std::scoped_lock lock{mutex};
+    const auto removed_count =
+        std::erase_if(entries, [](const auto& entry) { return !entry.second.is_used; });
+    is_dirty |= removed_count != 0;
+    for (auto& [key, entry] : entries) {
+        entry.is_used = false;
+    }
+    if (!is_dirty) {
+        return true;
+    }
+
+    ContentIndexWriter writer;
+    writer.Write(CONTENT_INDEX_MAGIC);
+    writer.Write(CONTENT_INDEX_VERSION);
+    writer.Write(static_cast<u64>(entries.size()));
+    for (const auto& [key, entry] : entries) {
+        writer.WriteString(key);
+        writer.Write(entry.stamp.size);
+        writer.Write(entry.stamp.modification_time);
+        writer.WriteBytes(entry.data);
+    }
+    const auto data = writer.Release();
+
+    if (!Common::FS::CreateParentDirs(path)) {
+        LOG_ERROR(Loader, "Failed to create the directory of the content index {}",
+                  Common::FS::PathToUTF8String(path));
+        return false;
+    }
+    auto temp_path = path;
+    temp_path += ".tmp";
+    bool is_written{};
+    {
+        Common::FS::IOFile file{temp_path, Common::FS::FileAccessMode::Write,
+                                Common::FS::FileType::BinaryFile};
+        is_written = file.IsOpen() && file.WriteSpan(std::span{data}) == data.size();
+    }
+    // The index is replaced at once, so an interrupted write never leaves a truncated one behind
+    std::error_code ec;
+    if (is_written) {
+        std::filesystem::rename(temp_path, path, ec);
+    }
+    if (!is_written || ec) {
+        LOG_ERROR(Loader, "Failed to write the content index {}",
+                  Common::FS::PathToUTF8String(path));
+        Common::FS::RemoveFile(temp_path);
+        return false;
+    }
+    is_dirty = false;
+    return true;
+}
+
+void ContentIndex::Load() {
+    std::vector<u8> data;
+    {
+        Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read,
+                                Common::FS::FileType::BinaryFile};
+        if (!file.IsOpen()) {
+            return;
+        }
+        data.resize(file.GetSize());
+        if (file.ReadSpan(std::span{data}) != data.size()) {
+            return;
+        }
+    }
+
+    ContentIndexReader reader{data};
+    if (reader.Read<u32>() != CONTENT_INDEX_MAGIC || reader.Read<u32>() != CONTENT_INDEX_VERSION) {
+        LOG_INFO(Loader, "Ignoring outdated content index {}", Common::FS::PathToUTF8String(path));
+        return;
+    }
+    const auto count = reader.Read<u64>();
+    for (u64 i = 0; i < count && reader.IsValid(); ++i) {
+        auto key = reader.ReadString();
+        Entry entry{};
+        entry.stamp.size = reader.Read<u64>();
+        entry.stamp.modification_time = reader.Read<s64>();
+        entry.data = reader.ReadBytes();
+        if (reader.IsValid()) {
+            entries.insert_or_assign(std::move(key), std::move(entry));
+        }
+    }
+    if (!reader.IsValid()) {
+        LOG_WARNING(Loader, "Content index {} is truncated, some entries were dropped",
+                    Common::FS::PathToUTF8String(path));
+    }
+}
+
+} // namespace FileSys
@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+#include "core/file_sys/vfs/vfs_types.h"
+
+namespace FileSys {
+
+/// Identifies one version of a file on the host filesystem.
+struct ContentIndexStamp {
+    u64 size{};
+    s64 modification_time{};
+
+    bool operator==(const ContentIndexStamp&) const = default;
+};
+
+/**
+ * Gets the stamp of a host file.
+ *
+ * @param path Host path of the file
+ * @returns The stamp, or std::nullopt if the file does not exist or has no modification time.
+ */
+[[nodiscard]] std::optional<ContentIndexStamp> GetContentIndexStamp(
+    const std::filesystem::path& path);
+
+/**
+ * Gets the stamp of the host file backing a virtual file.
+ *
+ * @param file Virtual file, which must be a file of the real filesystem to have a stamp
+ * @returns The stamp, or std::nullopt if the file is not backed by a single host file.
+ */
+[[nodiscard]] std::optional<ContentIndexStamp> GetContentIndexStamp(const VirtualFile& file);
+
+/**
+ * Persistent index of data parsed from content files, so that unchanged files do not have to be
+ * opened and parsed again on the next start.
+ * Every entry is keyed by a string, usually the host path of the file, and is only returned while
+ * the file still has the stamp it had when the entry was inserted.
+ * Lookups and insertions are thread safe, so the index can be filled from parallel scans.
+ */
+class ContentIndex {
+public:
+    /**
+     * Loads the index from a file. A missing or invalid file results in an empty index.
+     *
+     * @param path_ Host path of the index file
+     */
+    explicit ContentIndex(std::filesystem::path path_);
+    ~ContentIndex();
+
+    ContentIndex(const ContentIndex&) = delete;
+    ContentIndex& operator=(const ContentIndex&) = delete;
+
+    /**
+     * Finds the data of an entry and marks it as used.
+     *
+     * @param key Key of the entry
+     * @param stamp Current stamp of the file the entry was parsed from
+     * @returns The data of the entry, or std::nullopt if there is no entry for this stamp.
+     */
+    [[nodiscard]] std::optional<std::vector<u8>> Find(const std::string& key,
+                                                      const ContentIndexStamp& stamp);
+
+    /**
+     * Inserts or replaces an entry and marks it as used.
+     *
+     * @param key Key of the entry
+     * @param stamp Stamp of the file the data was parsed from
+     * @param data Data of the entry
+     */
+    void Insert(std::string key, const ContentIndexStamp& stamp, std::vector<u8> data);
+
+    /**
+     * Drops the entries that were not used since the last commit, so entries of removed files do
+     * not accumulate, and writes the index if it changed.
+     *
+     * @returns True if the index is up to date on disk, false otherwise.
+     */
+    bool Commit();
+
+private:
+    struct Entry {
+        ContentIndexStamp stamp;
+        std::vector<u8> data;
+        bool is_used{};
+    };
+
+    void Load();
+
+    std::filesystem::path path;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    bool is_dirty{};
+};
+
+/// Appends values to the data of a content index entry.
+class ContentIndexWriter {
+public:
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void Write(const T& value) {
+        const auto* const bytes = reinterpret_cast<const u8*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    void WriteBytes(std::span<const u8> bytes) {
+        Write(static_cast<u64>(bytes.size()));
+        data.insert(data.end(), bytes.begin(), bytes.end());
+    }
+
+    void WriteString(std::string_view string) {
+        WriteBytes({reinterpret_cast<const u8*>(string.data()), string.size()});
+    }
+
+    [[nodiscard]] std::vector<u8> Release() {
+        return std::move(data);
+    }
+
+private:
+    std::vector<u8> data;
+};
+
+/**
+ * Reads values back from the data of a content index entry.
+ * Reads past the end of the data return empty values and make IsValid return false.
+ */
+class ContentIndexReader {
+public:
+    explicit ContentIndexReader(std::span<const u8> data_) : data{data_} {}
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    [[nodiscard]] T Read() {
+        T value{};
+        if (sizeof(T) > data.size() - offset) {
+            is_valid = false;
+            return value;
+        }
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    [[nodiscard]] std::vector<u8> ReadBytes() {
+        const auto size = Read<u64>();
+        if (size > data.size() - offset) {
+            is_valid = false;
+            return {};
+        }
+        const auto bytes = data.subspan(offset, static_cast<size_t>(size));
+        offset += static_cast<size_t>(size);
+        return {bytes.begin(), bytes.end()};
+    }
+
+    [[nodiscard]] std::string ReadString() {
+        const auto bytes = ReadBytes();
+        return {bytes.begin(), bytes.end()};
+    }
+
+    /// Whether every read so far was within the data.
+    [[nodiscard]] bool IsValid() const {
+        return is_valid;
+    }
+
+private:
+    std::span<const u8> data;
+    size_t offset{};
+    bool is_valid{true};
+};
+
+} // namespace FileSys
@@ -76,6 +76,8 @@ struct RomFSBuildFileContext {
     std::shared_ptr<RomFSBuildDirectoryContext> parent;
     std::shared_ptr<RomFSBuildFileContext> sibling;
     VirtualFile source;
+    VirtualFile original;
+    VirtualFile ips_patch;
 };
 
 static u32 romfs_calc_path_hash(u32 parent, std::string_view path, u32 start,
@@ -124,11 +126,13 @@ void RomFSBuildContext::VisitDirectory(VirtualDir romfs_dir, VirtualDir ext_dir,
         ASSERT(child->path_len < FS_MAX_PATH);
 
         child->source = std::move(child_romfs_file);
+        child->original = child->source;
 
         if (ext_dir != nullptr) {
-            if (const auto ips = ext_dir->GetFile(name + ".ips")) {
+            if (auto ips = ext_dir->GetFile(name + ".ips")) {
                 if (auto patched = PatchIPS(child->source, ips)) {
                     child->source = std::move(patched);
+                    child->ips_patch = std::move(ips);
                 }
             }
         }
@@ -305,7 +309,7 @@ std::vector<std::pair<u64, VirtualFile>> RomFSBuildContext::Build() {
 
         cur_entry.name_size = name_size;
 
-        out.emplace_back(cur_file->offset + ROMFS_FILEPARTITION_OFS, std::move(cur_file->source));
+        out.emplace_back(cur_file->offset + ROMFS_FILEPARTITION_OFS, cur_file->source);
         std::memcpy(file_table.data() + cur_file->entry_offset, &cur_entry, sizeof(RomFSFileEntry));
         std::memset(file_table.data() + cur_file->entry_offset + sizeof(RomFSFileEntry), 0,
                     Common::AlignUp(cur_entry.name_size, 4));
@@ -351,4 +355,17 @@ std::vector<std::pair<u64, VirtualFile>> RomFSBuildContext::Build() {
     return out;
 }
 
+std::vector<RomFSBuildFileSource> RomFSBuildContext::GetFileSources() const {
+    std::vector<RomFSBuildFileSource> out;
+    out.reserve(files.size());
+    for (const auto& cur_file : files) {
+        out.push_back({
+            .file = cur_file->source,
+            .original = cur_file->original,
+            .ips_patch = cur_file->ips_patch,
+        });
+    }
+    return out;
+}
+
 } // namespace FileSys
@@ -16,6 +16,17 @@ struct RomFSBuildFileContext;
 struct RomFSDirectoryEntry;
 struct RomFSFileEntry;
 
+// Where a file of a built RomFS comes from, so the build can be reproduced without visiting the
+// directories again.
+struct RomFSBuildFileSource {
+    // File placed in the RomFS, with the IPS patch applied
+    VirtualFile file;
+    // File as found in the directories
+    VirtualFile original;
+    // IPS patch applied to the original file, nullptr if there is none
+    VirtualFile ips_patch;
+};
+
 class RomFSBuildContext {
 public:
     explicit RomFSBuildContext(VirtualDir base, VirtualDir ext = nullptr);
@@ -24,6 +35,9 @@ public:
     // This finalizes the context.
     std::vector<std::pair<u64, VirtualFile>> Build();
 
+    // Sources of the files returned by Build, only valid after it was called.
+    std::vector<RomFSBuildFileSource> GetFileSources() const;
+
 private:
     VirtualDir base;
     VirtualDir ext;
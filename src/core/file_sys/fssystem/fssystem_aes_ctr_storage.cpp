@@ -4,6 +4,7 @@
 #include "common/alignment.h"
 #include "common/swap.h"
 #include "core/file_sys/fssystem/fssystem_aes_ctr_storage.h"
+#include "core/file_sys/fssystem/fssystem_decrypted_sector_cache.h"
 #include "core/file_sys/fssystem/fssystem_pooled_buffer.h"
 #include "core/file_sys/fssystem/fssystem_utility.h"
 
@@ -22,7 +23,7 @@ void AesCtrStorage::MakeIv(void* dst, size_t dst_size, u64 upper, s64 offset) {
 
 AesCtrStorage::AesCtrStorage(VirtualFile base, const void* key, size_t key_size, const void* iv,
                              size_t iv_size)
-    : m_base_storage(std::move(base)) {
+    : m_base_storage(std::move(base)), m_cache_id(DecryptedSectorCache::AllocateStorageId()) {
     ASSERT(m_base_storage != nullptr);
     ASSERT(key != nullptr);
     ASSERT(iv != nullptr);
@@ -32,7 +33,11 @@ AesCtrStorage::AesCtrStorage(VirtualFile base, const void* key, size_t key_size,
     std::memcpy(m_key.data(), key, KeySize);
     std::memcpy(m_iv.data(), iv, IvSize);
 
-    m_cipher.emplace(m_key, Core::Crypto::Mode::CTR);
+    m_cipher.emplace(m_key);
+}
+
+AesCtrStorage::~AesCtrStorage() {
+    DecryptedSectorCache::GetInstance().Invalidate(m_cache_id);
 }
 
 size_t AesCtrStorage::Read(u8* buffer, size_t size, size_t offset) const {
@@ -48,8 +53,27 @@ size_t AesCtrStorage::Read(u8* buffer, size_t size, size_t offset) const {
     ASSERT(Common::IsAligned(offset, BlockSize));
     ASSERT(Common::IsAligned(size, BlockSize));
 
-    // Read the data.
-    m_base_storage->Read(buffer, size, offset);
+    // Serve small reads from the cache of decrypted sectors.
+    const auto decrypt_sector = [this](u8* sector, size_t sector_offset) {
+        this->ReadUncached(sector, DecryptedSectorCache::SectorSize, sector_offset);
+    };
+    if (DecryptedSectorCache::GetInstance().Read(m_cache_id, buffer, size, offset, this->GetSize(),
+                                                 decrypt_sector)) {
+        return size;
+    }
+
+    return this->ReadUncached(buffer, size, offset);
+}
+
+size_t AesCtrStorage::ReadUncached(u8* buffer, size_t size, size_t offset) const {
+    // Decrypt straight from the base storage if it is mapped in memory, otherwise read the data.
+    const u8* source = buffer;
+    if (const auto mapped = m_base_storage->GetMappedSpan();
+        offset <= mapped.size() && size <= mapped.size() - offset) {
+        source = mapped.data() + offset;
+    } else {
+        m_base_storage->Read(buffer, size, offset);
+    }
 
     // Setup the counter.
     std::array<u8, IvSize> ctr;
@@ -57,8 +81,7 @@ size_t AesCtrStorage::Read(u8* buffer, size_t size, size_t offset) const {
     AddCounter(ctr.data(), IvSize, offset / BlockSize);
 
     // Decrypt.
-    m_cipher->SetIV(ctr);
-    m_cipher->Transcode(buffer, size, buffer, Core::Crypto::Op::Decrypt);
+    m_cipher->Transcode(source, size, buffer, ctr);
 
     return size;
 }
@@ -76,6 +99,9 @@ size_t AesCtrStorage::Write(const u8* buffer, size_t size, size_t offset) {
     ASSERT(Common::IsAligned(offset, BlockSize));
     ASSERT(Common::IsAligned(size, BlockSize));
 
+    // Drop the decrypted sectors this write replaces.
+    DecryptedSectorCache::GetInstance().Invalidate(m_cache_id, offset, size);
+
     // Get a pooled buffer.
     PooledBuffer pooled_buffer;
     const bool use_work_buffer = true;
@@ -104,9 +130,8 @@ size_t AesCtrStorage::Write(const u8* buffer, size_t size, size_t offset) {
         }
 
         // Encrypt the data.
-        m_cipher->SetIV(ctr);
-        m_cipher->Transcode(buffer, write_size, reinterpret_cast<u8*>(write_buf),
-                            Core::Crypto::Op::Encrypt);
+        m_cipher->Transcode(buffer + cur_offset, write_size, reinterpret_cast<u8*>(write_buf),
+                            ctr);
 
         // Write the encrypted data.
         m_base_storage->Write(reinterpret_cast<u8*>(write_buf), write_size, offset + cur_offset);
@@ -5,7 +5,7 @@
 
 #include <optional>
 
-#include "core/crypto/aes_util.h"
+#include "core/crypto/aes_ctr_xts.h"
 #include "core/crypto/key_manager.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/fssystem/fs_i_storage.h"
@@ -28,16 +28,21 @@ public:
 public:
     AesCtrStorage(VirtualFile base, const void* key, size_t key_size, const void* iv,
                   size_t iv_size);
+    ~AesCtrStorage() override;
 
     virtual size_t Read(u8* buffer, size_t size, size_t offset) const override;
     virtual size_t Write(const u8* buffer, size_t size, size_t offset) override;
     virtual size_t GetSize() const override;
 
+private:
+    size_t ReadUncached(u8* buffer, size_t size, size_t offset) const;
+
 private:
     VirtualFile m_base_storage;
     std::array<u8, KeySize> m_key;
     std::array<u8, IvSize> m_iv;
-    mutable std::optional<Core::Crypto::AESCipher<Core::Crypto::Key128>> m_cipher;
+    std::optional<Core::Crypto::AesCtrCipher> m_cipher;
+    const u64 m_cache_id;
 };
 
 } // namespace FileSys
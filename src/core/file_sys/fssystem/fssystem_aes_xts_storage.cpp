@@ -5,6 +5,7 @@
 #include "common/swap.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/fssystem/fssystem_aes_xts_storage.h"
+#include "core/file_sys/fssystem/fssystem_decrypted_sector_cache.h"
 #include "core/file_sys/fssystem/fssystem_pooled_buffer.h"
 #include "core/file_sys/fssystem/fssystem_utility.h"
 
@@ -22,7 +23,8 @@ void AesXtsStorage::MakeAesXtsIv(void* dst, size_t dst_size, s64 offset, size_t
 
 AesXtsStorage::AesXtsStorage(VirtualFile base, const void* key1, const void* key2, size_t key_size,
                              const void* iv, size_t iv_size, size_t block_size)
-    : m_base_storage(std::move(base)), m_block_size(block_size), m_mutex() {
+    : m_base_storage(std::move(base)), m_block_size(block_size),
+      m_cache_id(DecryptedSectorCache::AllocateStorageId()) {
     ASSERT(m_base_storage != nullptr);
     ASSERT(key1 != nullptr);
     ASSERT(key2 != nullptr);
@@ -35,7 +37,11 @@ AesXtsStorage::AesXtsStorage(VirtualFile base, const void* key1, const void* key
     std::memcpy(m_key.data() + 0x10, key2, KeySize / 2);
     std::memcpy(m_iv.data(), iv, IvSize);
 
-    m_cipher.emplace(m_key, Core::Crypto::Mode::XTS);
+    m_cipher.emplace(m_key);
+}
+
+AesXtsStorage::~AesXtsStorage() {
+    DecryptedSectorCache::GetInstance().Invalidate(m_cache_id);
 }
 
 size_t AesXtsStorage::Read(u8* buffer, size_t size, size_t offset) const {
@@ -51,6 +57,19 @@ size_t AesXtsStorage::Read(u8* buffer, size_t size, size_t offset) const {
     ASSERT(Common::IsAligned(offset, AesBlockSize));
     ASSERT(Common::IsAligned(size, AesBlockSize));
 
+    // Serve small reads from the cache of decrypted sectors.
+    const auto decrypt_sector = [this](u8* sector, size_t sector_offset) {
+        this->ReadUncached(sector, DecryptedSectorCache::SectorSize, sector_offset);
+    };
+    if (DecryptedSectorCache::GetInstance().Read(m_cache_id, buffer, size, offset, this->GetSize(),
+                                                 decrypt_sector)) {
+        return size;
+    }
+
+    return this->ReadUncached(buffer, size, offset);
+}
+
+size_t AesXtsStorage::ReadUncached(u8* buffer, size_t size, size_t offset) const {
     // Read the data.
     m_base_storage->Read(buffer, size, offset);
 
@@ -75,9 +94,8 @@ size_t AesXtsStorage::Read(u8* buffer, size_t size, size_t offset) const {
             std::memset(tmp_buf.GetBuffer(), 0, skip_size);
             std::memcpy(tmp_buf.GetBuffer() + skip_size, buffer, data_size);
 
-            m_cipher->SetIV(ctr);
-            m_cipher->Transcode(tmp_buf.GetBuffer(), m_block_size, tmp_buf.GetBuffer(),
-                                Core::Crypto::Op::Decrypt);
+            u8* const tmp = reinterpret_cast<u8*>(tmp_buf.GetBuffer());
+            m_cipher->Decrypt(tmp, m_block_size, tmp, ctr, m_block_size);
 
             std::memcpy(buffer, tmp_buf.GetBuffer() + skip_size, data_size);
         }
@@ -87,20 +105,9 @@ size_t AesXtsStorage::Read(u8* buffer, size_t size, size_t offset) const {
         ASSERT(processed_size == std::min(size, m_block_size - skip_size));
     }
 
-    // Decrypt aligned chunks.
-    char* cur = reinterpret_cast<char*>(buffer) + processed_size;
-    size_t remaining = size - processed_size;
-    while (remaining > 0) {
-        const size_t cur_size = std::min(m_block_size, remaining);
-
-        m_cipher->SetIV(ctr);
-        m_cipher->Transcode(cur, cur_size, cur, Core::Crypto::Op::Decrypt);
-
-        remaining -= cur_size;
-        cur += cur_size;
-
-        AddCounter(ctr.data(), IvSize, 1);
-    }
+    // Decrypt the aligned blocks, the cipher increments the tweak for every block.
+    u8* const cur = buffer + processed_size;
+    m_cipher->Decrypt(cur, size - processed_size, cur, ctr, m_block_size);
 
     return size;
 }
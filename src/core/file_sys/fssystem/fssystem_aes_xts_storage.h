@@ -3,10 +3,9 @@
 
 #pragma once
 
-#include <mutex>
 #include <optional>
 
-#include "core/crypto/aes_util.h"
+#include "core/crypto/aes_ctr_xts.h"
 #include "core/crypto/key_manager.h"
 #include "core/file_sys/fssystem/fs_i_storage.h"
 
@@ -27,17 +26,21 @@ public:
 public:
     AesXtsStorage(VirtualFile base, const void* key1, const void* key2, size_t key_size,
                   const void* iv, size_t iv_size, size_t block_size);
+    ~AesXtsStorage() override;
 
     virtual size_t Read(u8* buffer, size_t size, size_t offset) const override;
     virtual size_t GetSize() const override;
 
+private:
+    size_t ReadUncached(u8* buffer, size_t size, size_t offset) const;
+
 private:
     VirtualFile m_base_storage;
     std::array<u8, KeySize> m_key;
     std::array<u8, IvSize> m_iv;
     const size_t m_block_size;
-    std::mutex m_mutex;
-    mutable std::optional<Core::Crypto::AESCipher<Core::Crypto::Key256>> m_cipher;
+    std::optional<Core::Crypto::AesXtsCipher> m_cipher;
+    const u64 m_cache_id;
 };
 
 } // namespace FileSys
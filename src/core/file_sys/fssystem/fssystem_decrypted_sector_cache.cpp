@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <atomic>
+
+#include "common/container_hash.h"
+#include "core/file_sys/fssystem/fssystem_decrypted_sector_cache.h"
+
+namespace FileSys {
+
+namespace {
+constexpr size_t SectorsPerShard =
+    DecryptedSectorCache::CacheSize / DecryptedSectorCache::SectorSize /
+    DecryptedSectorCache::ShardCount;
+} // Anonymous namespace
+
+DecryptedSectorCache& DecryptedSectorCache::GetInstance() {
+    static DecryptedSectorCache instance;
+    return instance;
+}
+
+u64 DecryptedSectorCache::AllocateStorageId() {
+    static std::atomic<u64> next_id{1};
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+DecryptedSectorCache::DecryptedSectorCache() = default;
+DecryptedSectorCache::~DecryptedSectorCache() = default;
+
+size_t DecryptedSectorCache::KeyHash::operator()(const Key& key) const noexcept {
+    size_t seed = 0;
+    Common::HashCombine(seed, key.storage_id);
+    Common::HashCombine(seed, key.sector_offset);
+    return seed;
+}
+
+void DecryptedSectorCache::Invalidate(u64 storage_id, size_t offset, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    const size_t first_sector = offset - offset % SectorSize;
+    for (size_t sector_offset = first_sector; sector_offset < offset + size;
+         sector_offset += SectorSize) {
+        const Key key{storage_id, sector_offset};
+        auto& shard = this->GetShard(key);
+        std::scoped_lock lk{shard.mutex};
+        if (const auto it = shard.entries.find(key); it != shard.entries.end()) {
+            shard.lru.erase(it->second);
+            shard.entries.erase(it);
+        }
+    }
+}
+
+void DecryptedSectorCache::Invalidate(u64 storage_id) {
+    for (auto& shard : m_shards) {
+        std::scoped_lock lk{shard.mutex};
+        for (auto it = shard.lru.begin(); it != shard.lru.end();) {
+            if (it->key.storage_id == storage_id) {
+                shard.entries.erase(it->key);
+                it = shard.lru.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+bool DecryptedSectorCache::Find(u64 storage_id, size_t sector_offset, u8* buffer, size_t size,
+                                size_t offset_in_sector) {
+    const Key key{storage_id, sector_offset};
+    auto& shard = this->GetShard(key);
+    std::scoped_lock lk{shard.mutex};
+    const auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+        return false;
+    }
+
+    // Move the entry to the front of the list, the back is evicted first.
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    std::memcpy(buffer, it->second->data.data() + offset_in_sector, size);
+    return true;
+}
+
+void DecryptedSectorCache::Insert(u64 storage_id, size_t sector_offset, const u8* data) {
+    const Key key{storage_id, sector_offset};
+    auto& shard = this->GetShard(key);
+    std::scoped_lock lk{shard.mutex};
+    if (shard.entries.contains(key)) {
+        // Another thread decrypted the same sector at the same time.
+        return;
+    }
+
+    // Reuse the buffer of the least recently used entry once the shard is full.
+    std::vector<u8> buffer;
+    if (shard.entries.size() >= SectorsPerShard) {
+        auto& last = shard.lru.back();
+        shard.entries.erase(last.key);
+        buffer = std::move(last.data);
+        shard.lru.pop_back();
+    }
+    buffer.assign(data, data + SectorSize);
+
+    shard.lru.push_front(Entry{key, std::move(buffer)});
+    shard.entries.emplace(key, shard.lru.begin());
+}
+
+DecryptedSectorCache::Shard& DecryptedSectorCache::GetShard(const Key& key) {
+    return m_shards[KeyHash{}(key) % ShardCount];
+}
+
+} // namespace FileSys
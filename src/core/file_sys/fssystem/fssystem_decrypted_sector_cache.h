@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/literals.h"
+#include "core/file_sys/fssystem/fssystem_pooled_buffer.h"
+
+namespace FileSys {
+
+/**
+ * Small process wide LRU cache of decrypted sectors, shared by the AES storages.
+ * Games tend to read the same metadata and hash blocks many times, the cache saves decrypting them
+ * again. Entries are keyed by the id of the storage and the offset of the sector.
+ */
+class DecryptedSectorCache {
+    SUYU_NON_COPYABLE(DecryptedSectorCache);
+    SUYU_NON_MOVEABLE(DecryptedSectorCache);
+
+public:
+    static constexpr size_t SectorSize = 16_KiB;
+    static constexpr size_t CacheSize = 8_MiB;
+    static constexpr size_t ShardCount = 8;
+
+public:
+    static DecryptedSectorCache& GetInstance();
+
+    /// Allocates an id for a storage, which is never reused.
+    static u64 AllocateStorageId();
+
+    /**
+     * Reads data within a single sector through the cache.
+     *
+     * @param storage_id Id of the storage
+     * @param buffer Destination of the data
+     * @param size Size of the data in bytes
+     * @param offset Offset of the data in the storage
+     * @param storage_size Size of the storage in bytes
+     * @param decrypt_sector Callable decrypting a whole sector on a miss, taking the destination
+     *                       buffer and the offset of the sector
+     * @returns True if the read was done, false if it must be done without the cache.
+     */
+    template <typename Func>
+    bool Read(u64 storage_id, u8* buffer, size_t size, size_t offset, size_t storage_size,
+              const Func& decrypt_sector) {
+        const size_t sector_offset = offset - offset % SectorSize;
+        if (size > SectorSize - (offset - sector_offset) || storage_size < SectorSize ||
+            sector_offset > storage_size - SectorSize) {
+            return false;
+        }
+        if (this->Find(storage_id, sector_offset, buffer, size, offset - sector_offset)) {
+            return true;
+        }
+
+        PooledBuffer sector(SectorSize, SectorSize);
+        u8* const data = reinterpret_cast<u8*>(sector.GetBuffer());
+        decrypt_sector(data, sector_offset);
+        std::memcpy(buffer, data + (offset - sector_offset), size);
+        this->Insert(storage_id, sector_offset, data);
+        return true;
+    }
+
+    /// Drops the sectors overlapping a range of a storage, after it was written.
+    void Invalidate(u64 storage_id, size_t offset, size_t size);
+
+    /// Drops every sector of a storage.
+    void Invalidate(u64 storage_id);
+
+private:
+    DecryptedSectorCache();
+    ~DecryptedSectorCache();
+
+    struct Key {
+        u64 storage_id;
+        size_t sector_offset;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const noexcept;
+    };
+
+    struct Entry {
+        Key key;
+        std::vector<u8> data;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> entries;
+    };
+
+    bool Find(u64 storage_id, size_t sector_offset, u8* buffer, size_t size,
+              size_t offset_in_sector);
+    void Insert(u64 storage_id, size_t sector_offset, const u8* data);
+    Shard& GetShard(const Key& key);
+
+private:
+    std::array<Shard, ShardCount> m_shards;
+};
+
+} // namespace FileSys
@@ -0,0 +1,433 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/thread_worker.h"
+#include "core/file_sys/content_index.h"
+#include "core/file_sys/fsmitm_romfsbuild.h"
+#include "core/file_sys/ips_layer.h"
+#include "core/file_sys/layered_romfs.h"
+#include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs/vfs_cached.h"
+#include "core/file_sys/vfs/vfs_concat.h"
+#include "core/file_sys/vfs/vfs_layered.h"
+#include "core/file_sys/vfs/vfs_offset.h"
+#include "core/file_sys/vfs/vfs_real.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+constexpr u32 LAYOUT_MAGIC = Common::MakeMagic('S', 'L', 'F', 'S');
+
+/// Bumped whenever the layout of the cache file changes
+constexpr u32 LAYOUT_VERSION = 1;
+
+/// A file of a mod directory on the host filesystem
+struct HostFile {
+    /// Path relative to the root of the tree, separated by '/'
+    std::string path;
+    u64 size;
+    s64 modification_time;
+};
+
+/// Listing of a mod directory on the host filesystem, sorted by path
+struct HostTree {
+    std::shared_ptr<RealVfsDirectory> root;
+    std::vector<std::string> directories;
+    std::vector<HostFile> files;
+};
+
+/// A file of a mod directory, by index of its tree and of the file in the tree
+struct HostFileRef {
+    u32 tree;
+    u32 file;
+};
+
+/// Where a part of the layered RomFS comes from
+enum class PartKind : u8 {
+    Data, ///< Header and metadata generated by the build, stored in the cache
+    Base, ///< File of the base RomFS
+    Mod,  ///< File of a mod directory
+};
+
+std::string_view ParentPath(std::string_view path) {
+    const auto separator = path.rfind('/');
+    return separator == std::string_view::npos ? std::string_view{} : path.substr(0, separator);
+}
+
+std::string_view FileName(std::string_view path) {
+    const auto separator = path.rfind('/');
+    return separator == std::string_view::npos ? path : path.substr(separator + 1);
+}
+
+/// Lists every file and directory of the given directories, one directory per task
+std::optional<std::vector<HostTree>> WalkHostTrees(const std::vector<VirtualDir>& dirs) {
+    std::vector<HostTree> trees(dirs.size());
+    for (size_t i = 0; i < dirs.size(); ++i) {
+        trees[i].root = std::dynamic_pointer_cast<RealVfsDirectory>(dirs[i]);
+        if (trees[i].root == nullptr) {
+            return std::nullopt;
+        }
+    }
+
+    std::mutex mutex;
+    Common::ThreadWorker workers(std::max(std::thread::hardware_concurrency(), 1U), "LayeredFS");
+    std::function<void(size_t, std::string)> visit = [&](size_t tree_index,
+                                                         std::string directory) {
+        HostTree& tree = trees[tree_index];
+        std::vector<std::string> directories;
+        std::vector<HostFile> files;
+        auto path = tree.root->GetFullPath();
+        if (!directory.empty()) {
+            path += '/' + directory;
+        }
+        const Common::FS::DirEntryCallable callback =
+            [&](const std::filesystem::directory_entry& entry) {
+                const auto name = Common::FS::PathToUTF8String(entry.path().filename());
+                auto relative = directory.empty() ? name : directory + '/' + name;
+                std::error_code ec;
+                if (entry.is_directory(ec)) {
+                    workers.QueueWork(
+                        [&visit, tree_index, relative] { visit(tree_index, relative); });
+                    directories.push_back(std::move(relative));
+                    return true;
+                }
+                if (!entry.is_regular_file(ec)) {
+                    return true;
+                }
+                const auto size = entry.file_size(ec);
+                if (ec) {
+                    return true;
+                }
+                const auto modification_time = entry.last_write_time(ec);
+                if (ec) {
+                    return true;
+                }
+                files.push_back(HostFile{
+                    .path = std::move(relative),
+                    .size = size,
+                    .modification_time =
+                        static_cast<s64>(modification_time.time_since_epoch().count()),
+                });
+                return true;
+            };
+        Common::FS::IterateDirEntries(path, callback);
+
+        std::scoped_lock lock{mutex};
+        std::ranges::move(directories, std::back_inserter(tree.directories));
+        std::ranges::move(files, std::back_inserter(tree.files));
+    };
+    for (size_t i = 0; i < trees.size(); ++i) {
+        workers.QueueWork([&visit, i] { visit(i, {}); });
+    }
+    workers.WaitForRequests();
+
+    for (HostTree& tree : trees) {
+        std::ranges::sort(tree.directories);
+        std::ranges::sort(tree.files, {}, &HostFile::path);
+    }
+    return trees;
+}
+
+u64 GetFingerprint(u64 base_hash, size_t num_layers, const std::vector<HostTree>& trees) {
+    ContentIndexWriter writer;
+    writer.Write(base_hash);
+    writer.Write(static_cast<u64>(num_layers));
+    writer.Write(static_cast<u64>(trees.size()));
+    for (const HostTree& tree : trees) {
+        writer.WriteString(tree.root->GetFullPath());
+        writer.Write(static_cast<u64>(tree.directories.size()));
+        for (const std::string& directory : tree.directories) {
+            writer.WriteString(directory);
+        }
+        writer.Write(static_cast<u64>(tree.files.size()));
+        for (const HostFile& file : tree.files) {
+            writer.WriteString(file.path);
+            writer.Write(file.size);
+            writer.Write(file.modification_time);
+        }
+    }
+    const auto data = writer.Release();
+    return Common::CityHash64(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+/// Builds the directory of a tree in memory, recording which host file every file is
+VirtualDir MakeTreeDirectory(const HostTree& tree, u32 tree_index,
+                             std::unordered_map<const VfsFile*, HostFileRef>& host_files) {
+    struct Contents {
+        std::vector<VirtualDir> subdirectories;
+        std::vector<VirtualFile> files;
+    };
+    std::unordered_map<std::string_view, Contents> contents;
+    for (u32 i = 0; i < tree.files.size(); ++i) {
+        const HostFile& file = tree.files[i];
+        auto vfs_file = tree.root->GetFileRelativeWithSize(file.path, file.size);
+        if (vfs_file == nullptr) {
+            continue;
+        }
+        host_files.insert_or_assign(vfs_file.get(), HostFileRef{tree_index, i});
+        contents[ParentPath(file.path)].files.push_back(std::move(vfs_file));
+    }
+    // A directory sorts after its parent, so in reverse order children are built first
+    for (auto it = tree.directories.rbegin(); it != tree.directories.rend(); ++it) {
+        Contents directory_contents = std::move(contents[*it]);
+        contents.erase(*it);
+        contents[ParentPath(*it)].subdirectories.push_back(std::make_shared<CachedVfsDirectory>(
+            std::string{FileName(*it)}, std::move(directory_contents.subdirectories),
+            std::move(directory_contents.files)));
+    }
+    Contents& root_contents = contents[std::string_view{}];
+    return std::make_shared<CachedVfsDirectory>(tree.root->GetName(),
+                                                std::move(root_contents.subdirectories),
+                                                std::move(root_contents.files));
+}
+
+VirtualFile OpenHostFile(const std::vector<HostTree>& trees, const HostFileRef& ref) {
+    if (ref.tree >= trees.size() || ref.file >= trees[ref.tree].files.size()) {
+        return nullptr;
+    }
+    const HostFile& file = trees[ref.tree].files[ref.file];
+    return trees[ref.tree].root->GetFileRelativeWithSize(file.path, file.size);
+}
+
+/// Builds the layered RomFS and serializes its layout, which is left empty if it cannot be cached
+std::pair<VirtualFile, std::vector<u8>> BuildLayout(const VirtualFile& base_romfs, u64 fingerprint,
+                                                    size_t num_layers,
+                                                    const std::vector<HostTree>& trees) {
+    std::unordered_map<const VfsFile*, HostFileRef> host_files;
+    std::vector<VirtualDir> layers;
+    std::vector<VirtualDir> layers_ext;
+    for (u32 i = 0; i < trees.size(); ++i) {
+        auto dir = MakeTreeDirectory(trees[i], i, host_files);
+        (i < num_layers ? layers : layers_ext).push_back(std::move(dir));
+    }
+
+    auto extracted = ExtractRomFS(base_romfs);
+    if (extracted == nullptr) {
+        return {};
+    }
+    layers.push_back(std::move(extracted));
+
+    auto layered = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers));
+    if (layered == nullptr) {
+        return {};
+    }
+    auto layered_ext = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers_ext));
+    auto name = layered->GetName();
+
+    RomFSBuildContext ctx{std::move(layered), std::move(layered_ext)};
+    auto parts = ctx.Build();
+    const auto sources = ctx.GetFileSources();
+    std::unordered_map<const VfsFile*, const RomFSBuildFileSource*> sources_by_file;
+    for (const RomFSBuildFileSource& source : sources) {
+        sources_by_file.emplace(source.file.get(), &source);
+    }
+
+    ContentIndexWriter writer;
+    writer.Write(LAYOUT_MAGIC);
+    writer.Write(LAYOUT_VERSION);
+    writer.Write(fingerprint);
+    writer.WriteString(name);
+    writer.Write(static_cast<u64>(parts.size()));
+    bool is_cacheable = true;
+    for (const auto& [offset, file] : parts) {
+        writer.Write(offset);
+        const auto source_it = sources_by_file.find(file.get());
+        if (source_it == sources_by_file.end()) {
+            writer.Write(PartKind::Data);
+            writer.WriteBytes(file->ReadAllBytes());
+            continue;
+        }
+        const RomFSBuildFileSource& source = *source_it->second;
+        if (const auto host_it = host_files.find(source.original.get());
+            host_it != host_files.end()) {
+            writer.Write(PartKind::Mod);
+            writer.Write(host_it->second);
+        } else if (const auto* base_file =
+                       dynamic_cast<const OffsetVfsFile*>(source.original.get())) {
+            // Only the extracted base RomFS is made of offset files
+            writer.Write(PartKind::Base);
+            writer.Write(static_cast<u64>(base_file->GetOffset()));
+            writer.Write(static_cast<u64>(base_file->GetSize()));
+        } else {
+            is_cacheable = false;
+        }
+        writer.Write(static_cast<u8>(source.ips_patch != nullptr));
+        if (source.ips_patch != nullptr) {
+            const auto ips_it = host_files.find(source.ips_patch.get());
+            is_cacheable &= ips_it != host_files.end();
+            writer.Write(ips_it != host_files.end() ? ips_it->second : HostFileRef{});
+        }
+        writer.Write(static_cast<u64>(file->GetSize()));
+    }
+
+    auto romfs = ConcatenatedVfsFile::MakeConcatenatedFile(0, std::move(name), std::move(parts));
+    return {std::move(romfs), is_cacheable ? writer.Release() : std::vector<u8>{}};
+}
+
+/// Rebuilds the layered RomFS from a cached layout, returns nullptr if it does not match
+VirtualFile LoadLayout(std::span<const u8> layout, const VirtualFile& base_romfs, u64 fingerprint,
+                       const std::vector<HostTree>& trees) {
+    ContentIndexReader reader{layout};
+    if (reader.Read<u32>() != LAYOUT_MAGIC || reader.Read<u32>() != LAYOUT_VERSION ||
+        reader.Read<u64>() != fingerprint) {
+        return nullptr;
+    }
+    auto name = reader.ReadString();
+    const auto num_parts = reader.Read<u64>();
+
+    const auto base_size = base_romfs->GetSize();
+    std::vector<std::pair<u64, VirtualFile>> parts;
+    for (u64 i = 0; i < num_parts && reader.IsValid(); ++i) {
+        const auto offset = reader.Read<u64>();
+        const auto kind = reader.Read<PartKind>();
+        VirtualFile file;
+        switch (kind) {
+        case PartKind::Data:
+            parts.emplace_back(offset, std::make_shared<VectorVfsFile>(reader.ReadBytes()));
+            continue;
+        case PartKind::Base: {
+            const auto source_offset = reader.Read<u64>();
+            const auto size = reader.Read<u64>();
+            if (source_offset > base_size || size > base_size - source_offset) {
+                return nullptr;
+            }
+            file = std::make_shared<OffsetVfsFile>(base_romfs, size, source_offset);
+            break;
+        }
+        case PartKind::Mod:
+            file = OpenHostFile(trees, reader.Read<HostFileRef>());
+            break;
+        default:
+            return nullptr;
+        }
+        if (reader.Read<u8>() != 0) {
+            const auto ips = OpenHostFile(trees, reader.Read<HostFileRef>());
+            if (file == nullptr || ips == nullptr) {
+                return nullptr;
+            }
+            if (auto patched = PatchIPS(file, ips)) {
+                file = std::move(patched);
+            }
+        }
+        if (file == nullptr || file->GetSize() != reader.Read<u64>()) {
+            return nullptr;
+        }
+        parts.emplace_back(offset, std::move(file));
+    }
+    if (!reader.IsValid()) {
+        return nullptr;
+    }
+    return ConcatenatedVfsFile::MakeConcatenatedFile(0, std::move(name), std::move(parts));
+}
+
+std::optional<std::vector<u8>> ReadLayout(const std::filesystem::path& path) {
+    Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read,
+                            Common::FS::FileType::BinaryFile};
+    if (!file.IsOpen()) {
+        return std::nullopt;
+    }
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadSpan(std::span{data}) != data.size()) {
+        return std::nullopt;
+    }
+    return data;
+}
+
+void WriteLayout(const std::filesystem::path& path, std::span<const u8> layout) {
+    if (!Common::FS::CreateParentDirs(path)) {
+        LOG_ERROR(Loader, "Failed to create the directory of the LayeredFS cache {}",
+                  Common::FS::PathToUTF8String(path));
+        return;
+    }
+    auto temp_path = path;
+    temp_path += ".tmp";
+    bool is_written{};
+    {
+        Common::FS::IOFile file{temp_path, Common::FS::FileAccessMode::Write,
+                                Common::FS::FileType::BinaryFile};
+        is_written = file.IsOpen() && file.WriteSpan(layout) == layout.size();
+    }
+    std::error_code ec;
+    if (is_written) {
+        std::filesystem::rename(temp_path, path, ec);
+    }
+    if (!is_written || ec) {
+        LOG_ERROR(Loader, "Failed to write the LayeredFS cache {}",
+                  Common::FS::PathToUTF8String(path));
+        Common::FS::RemoveFile(temp_path);
+    }
+}
+
+VirtualFile CreateUncachedLayeredRomFS(const VirtualFile& base_romfs,
+                                       std::vector<VirtualDir> layers,
+                                       std::vector<VirtualDir> layers_ext) {
+    for (auto& layer : layers) {
+        layer = std::make_shared<CachedVfsDirectory>(std::move(layer));
+    }
+    for (auto& layer : layers_ext) {
+        layer = std::make_shared<CachedVfsDirectory>(std::move(layer));
+    }
+
+    auto extracted = ExtractRomFS(base_romfs);
+    if (extracted == nullptr) {
+        return nullptr;
+    }
+    layers.push_back(std::move(extracted));
+
+    auto layered = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers));
+    if (layered == nullptr) {
+        return nullptr;
+    }
+    auto layered_ext = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers_ext));
+    return CreateRomFS(std::move(layered), std::move(layered_ext));
+}
+} // Anonymous namespace
+
+VirtualFile CreateLayeredRomFS(VirtualFile base_romfs, std::vector<VirtualDir> layers,
+                               std::vector<VirtualDir> layers_ext,
+                               const std::filesystem::path& cache_path) {
+    const size_t num_layers = layers.size();
+    std::vector<VirtualDir> dirs = layers;
+    dirs.insert(dirs.end(), layers_ext.begin(), layers_ext.end());
+
+    // Only directories of the host filesystem can be fingerprinted
+    const auto base_hash = HashRomFSMetadata(base_romfs);
+    auto trees = base_hash ? WalkHostTrees(dirs) : std::nullopt;
+    if (!trees) {
+        return CreateUncachedLayeredRomFS(base_romfs, std::move(layers), std::move(layers_ext));
+    }
+
+    const u64 fingerprint = GetFingerprint(*base_hash, num_layers, *trees);
+    if (const auto layout = ReadLayout(cache_path)) {
+        if (auto romfs = LoadLayout(*layout, base_romfs, fingerprint, *trees)) {
+            LOG_INFO(Loader, "    RomFS: LayeredFS layout loaded from {}",
+                     Common::FS::PathToUTF8String(cache_path));
+            return romfs;
+        }
+    }
+
+    auto [romfs, layout] = BuildLayout(base_romfs, fingerprint, num_layers, *trees);
+    if (romfs != nullptr && !layout.empty()) {
+        WriteLayout(cache_path, layout);
+    }
+    return romfs;
+}
+
+} // namespace FileSys
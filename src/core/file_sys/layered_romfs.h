@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "core/file_sys/vfs/vfs_types.h"
+
+namespace FileSys {
+
+/**
+ * Builds a RomFS with LayeredFS mod directories applied on top of a base RomFS.
+ * Mod directories on the host filesystem are walked in parallel. The layout of the built RomFS is
+ * stored in a cache file, keyed by a fingerprint of the base RomFS metadata and of the paths,
+ * sizes and modification times of the mod files, so an unchanged mod set loads its layout with a
+ * single read instead of being built again.
+ *
+ * @param base_romfs Base RomFS binary blob
+ * @param layers Directories replacing files of the base RomFS, highest priority first
+ * @param layers_ext Directories with .stub and .ips files applied to the base RomFS
+ * @param cache_path Host path of the layout cache file
+ * @returns The layered RomFS, or nullptr on failure.
+ */
+[[nodiscard]] VirtualFile CreateLayeredRomFS(VirtualFile base_romfs, std::vector<VirtualDir> layers,
+                                             std::vector<VirtualDir> layers_ext,
+                                             const std::filesystem::path& cache_path);
+
+} // namespace FileSys
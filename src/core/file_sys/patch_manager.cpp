@@ -6,6 +6,8 @@
 #include <cstddef>
 #include <cstring>
 
+#include "common/cityhash.h"
+#include "common/fs/path_util.h"
 #include "common/hex_util.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
@@ -18,10 +20,10 @@
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/ips_layer.h"
+#include "core/file_sys/layered_romfs.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/romfs.h"
-#include "core/file_sys/vfs/vfs_cached.h"
 #include "core/file_sys/vfs/vfs_layered.h"
 #include "core/file_sys/vfs/vfs_vector.h"
 #include "core/hle/service/filesystem/filesystem.h"
@@ -114,6 +116,14 @@ void AppendCommaIfNotEmpty(std::string& to, std::string_view with) {
 bool IsDirValidAndNonEmpty(const VirtualDir& dir) {
     return dir != nullptr && (!dir->GetFiles().empty() || !dir->GetSubdirectories().empty());
 }
+
+// Looks up the disabled add-ons without inserting into the map, as patch managers of different
+// titles may be used from several threads at once while scanning the game list.
+const std::vector<std::string>& GetDisabledAddons(u64 title_id) {
+    static const std::vector<std::string> none;
+    const auto it = Settings::values.disabled_addons.find(title_id);
+    return it != Settings::values.disabled_addons.end() ? it->second : none;
+}
 } // Anonymous namespace
 
 PatchManager::PatchManager(u64 title_id_,
@@ -133,7 +143,7 @@ VirtualDir PatchManager::PatchExeFS(VirtualDir exefs) const {
     if (exefs == nullptr)
         return exefs;
 
-    const auto& disabled = Settings::values.disabled_addons[title_id];
+    const auto& disabled = GetDisabledAddons(title_id);
     const auto update_disabled =
         std::find(disabled.cbegin(), disabled.cend(), "Update") != disabled.cend();
 
@@ -192,7 +202,7 @@ VirtualDir PatchManager::PatchExeFS(VirtualDir exefs) const {
 
 std::vector<VirtualFile> PatchManager::CollectPatches(const std::vector<VirtualDir>& patch_dirs,
                                                       const std::string& build_id) const {
-    const auto& disabled = Settings::values.disabled_addons[title_id];
+    const auto& disabled = GetDisabledAddons(title_id);
     const auto nso_build_id = fmt::format("{:0<64}", build_id);
 
     std::vector<VirtualFile> out;
@@ -313,6 +323,34 @@ bool PatchManager::HasNSOPatch(const BuildID& build_id_, std::string_view name)
     return !CollectPatches(patch_dirs, build_id).empty();
 }
 
+std::optional<u64> PatchManager::GetNSOPatchHash(const BuildID& build_id_) const {
+    const auto build_id_raw = Common::HexToString(build_id_);
+    const auto build_id = build_id_raw.substr(0, build_id_raw.find_last_not_of('0') + 1);
+
+    const auto load_dir = fs_controller.GetModificationLoadRoot(title_id);
+    if (load_dir == nullptr) {
+        return std::nullopt;
+    }
+
+    auto patch_dirs = load_dir->GetSubdirectories();
+    std::sort(patch_dirs.begin(), patch_dirs.end(),
+              [](const VirtualDir& l, const VirtualDir& r) { return l->GetName() < r->GetName(); });
+    const auto patches = CollectPatches(patch_dirs, build_id);
+    if (patches.empty()) {
+        return std::nullopt;
+    }
+
+    u64 hash = patches.size();
+    for (const auto& patch_file : patches) {
+        const auto name = patch_file->GetName();
+        const auto data = patch_file->ReadAllBytes();
+        hash = Common::CityHash64WithSeed(name.data(), name.size(), hash);
+        hash = Common::CityHash64WithSeed(reinterpret_cast<const char*>(data.data()), data.size(),
+                                          hash);
+    }
+    return hash;
+}
+
 std::vector<Core::Memory::CheatEntry> PatchManager::CreateCheatList(
     const BuildID& build_id_) const {
     const auto load_dir = fs_controller.GetModificationLoadRoot(title_id);
@@ -321,7 +359,7 @@ std::vector<Core::Memory::CheatEntry> PatchManager::CreateCheatList(
         return {};
     }
 
-    const auto& disabled = Settings::values.disabled_addons[title_id];
+    const auto& disabled = GetDisabledAddons(title_id);
     auto patch_dirs = load_dir->GetSubdirectories();
     std::sort(patch_dirs.begin(), patch_dirs.end(),
               [](const VirtualDir& l, const VirtualDir& r) { return l->GetName() < r->GetName(); });
@@ -358,7 +396,7 @@ static void ApplyLayeredFS(VirtualFile& romfs, u64 title_id, ContentRecordType t
         return;
     }
 
-    const auto& disabled = Settings::values.disabled_addons[title_id];
+    const auto& disabled = GetDisabledAddons(title_id);
     std::vector<VirtualDir> patch_dirs = load_dir->GetSubdirectories();
     if (std::find(disabled.cbegin(), disabled.cend(), "SDMC") == disabled.cend()) {
         patch_dirs.push_back(sdmc_load_dir);
@@ -377,16 +415,16 @@ static void ApplyLayeredFS(VirtualFile& romfs, u64 title_id, ContentRecordType t
 
         auto romfs_dir = FindSubdirectoryCaseless(subdir, "romfs");
         if (romfs_dir != nullptr)
-            layers.emplace_back(std::make_shared<CachedVfsDirectory>(std::move(romfs_dir)));
+            layers.emplace_back(std::move(romfs_dir));
 
         auto ext_dir = FindSubdirectoryCaseless(subdir, "romfs_ext");
         if (ext_dir != nullptr)
-            layers_ext.emplace_back(std::make_shared<CachedVfsDirectory>(std::move(ext_dir)));
+            layers_ext.emplace_back(std::move(ext_dir));
 
         if (type == ContentRecordType::HtmlDocument) {
             auto manual_dir = FindSubdirectoryCaseless(subdir, "manual_html");
             if (manual_dir != nullptr)
-                layers.emplace_back(std::make_shared<CachedVfsDirectory>(std::move(manual_dir)));
+                layers.emplace_back(std::move(manual_dir));
         }
     }
 
@@ -395,21 +433,9 @@ static void ApplyLayeredFS(VirtualFile& romfs, u64 title_id, ContentRecordType t
         return;
     }
 
-    auto extracted = ExtractRomFS(romfs);
-    if (extracted == nullptr) {
-        return;
-    }
-
-    layers.emplace_back(std::move(extracted));
-
-    auto layered = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers));
-    if (layered == nullptr) {
-        return;
-    }
-
-    auto layered_ext = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers_ext));
-
-    auto packed = CreateRomFS(std::move(layered), std::move(layered_ext));
+    const auto cache_path = Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) / "layered_fs" /
+                            fmt::format("{:016X}_{:02X}.bin", title_id, static_cast<u8>(type));
+    auto packed = CreateLayeredRomFS(romfs, std::move(layers), std::move(layers_ext), cache_path);
     if (packed == nullptr) {
         return;
     }
@@ -435,7 +461,7 @@ VirtualFile PatchManager::PatchRomFS(const NCA* base_nca, VirtualFile base_romfs
     const auto update_tid = GetUpdateTitleID(title_id);
     const auto update_raw = content_provider.GetEntryRaw(update_tid, type);
 
-    const auto& disabled = Settings::values.disabled_addons[title_id];
+    const auto& disabled = GetDisabledAddons(title_id);
     const auto update_disabled =
         std::find(disabled.cbegin(), disabled.cend(), "Update") != disabled.cend();
 
@@ -472,7 +498,7 @@ std::vector<Patch> PatchManager::GetPatches(VirtualFile update_raw) const {
     }
 
     std::vector<Patch> out;
-    const auto& disabled = Settings::values.disabled_addons[title_id];
+    const auto& disabled = GetDisabledAddons(title_id);
 
     // Game Updates
     const auto update_tid = GetUpdateTitleID(title_id);
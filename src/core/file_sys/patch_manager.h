@@ -66,6 +66,10 @@ public:
     // Used to prevent expensive copies in NSO loader.
     [[nodiscard]] bool HasNSOPatch(const BuildID& build_id, std::string_view name) const;
 
+    // Hashes the names and contents of the patches PatchNSO() applies given the NSO's build ID,
+    // or returns std::nullopt if there are none. Used to key caches of patched NSOs.
+    [[nodiscard]] std::optional<u64> GetNSOPatchHash(const BuildID& build_id) const;
+
     // Creates a CheatList object with all
     [[nodiscard]] std::vector<Core::Memory::CheatEntry> CreateCheatList(
         const BuildID& build_id) const;
@@ -4,20 +4,25 @@
 #include <algorithm>
 #include <random>
 #include <regex>
+#include <thread>
 #include <mbedtls/sha256.h>
 #include "common/assert.h"
+#include "common/cityhash.h"
 #include "common/fs/path_util.h"
 #include "common/hex_util.h"
 #include "common/logging/log.h"
 #include "common/scope_exit.h"
+#include "common/thread_worker.h"
 #include "core/crypto/key_manager.h"
 #include "core/file_sys/card_image.h"
 #include "core/file_sys/common_funcs.h"
 #include "core/file_sys/content_archive.h"
+#include "core/file_sys/content_index.h"
 #include "core/file_sys/nca_metadata.h"
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/submission_package.h"
 #include "core/file_sys/vfs/vfs_concat.h"
+#include "core/file_sys/vfs/vfs_vector.h"
 #include "core/loader/loader.h"
 
 namespace FileSys {
@@ -25,6 +30,66 @@ namespace FileSys {
 // The size of blocks to use when vfs raw copying into nand.
 constexpr size_t VFS_RC_LARGE_COPY_BLOCK = 0x400000;
 
+namespace {
+// What a refresh needs to know about an NCA of a registered cache, kept in its content index.
+struct ProcessedNCA {
+    bool is_meta{};
+    u64 title_id{};
+    // Raw contents of the CNMT file of a meta NCA
+    std::vector<u8> cnmt;
+};
+
+std::vector<u8> SerializeProcessedNCA(const ProcessedNCA& processed) {
+    ContentIndexWriter writer;
+    writer.Write(static_cast<u8>(processed.is_meta));
+    writer.Write(processed.title_id);
+    writer.WriteBytes(processed.cnmt);
+    return writer.Release();
+}
+
+std::optional<ProcessedNCA> DeserializeProcessedNCA(std::span<const u8> data) {
+    ContentIndexReader reader{data};
+    ProcessedNCA processed{
+        .is_meta = reader.Read<u8>() != 0,
+        .title_id = reader.Read<u64>(),
+        .cnmt = reader.ReadBytes(),
+    };
+    if (!reader.IsValid()) {
+        return std::nullopt;
+    }
+    return processed;
+}
+
+// Returns std::nullopt when the NCA could not be parsed, which may be fixed by adding keys later,
+// so such results must not be kept in the index.
+std::optional<ProcessedNCA> ProcessNCA(const VirtualFile& file) {
+    const NCA nca{file};
+    if (nca.GetStatus() != Loader::ResultStatus::Success) {
+        return std::nullopt;
+    }
+    if (nca.GetType() != NCAContentType::Meta) {
+        return ProcessedNCA{};
+    }
+    if (nca.GetSubdirectories().empty()) {
+        return std::nullopt;
+    }
+
+    const auto section0 = nca.GetSubdirectories()[0];
+    for (const auto& section0_file : section0->GetFiles()) {
+        if (section0_file->GetExtension() != "cnmt") {
+            continue;
+        }
+
+        return ProcessedNCA{
+            .is_meta = true,
+            .title_id = nca.GetTitleId(),
+            .cnmt = section0_file->ReadAllBytes(),
+        };
+    }
+    return std::nullopt;
+}
+} // Anonymous namespace
+
 std::string ContentProviderEntry::DebugInfo() const {
     return fmt::format("title_id={:016X}, content_type={:02X}", title_id, static_cast<u8>(type));
 }
@@ -413,28 +478,79 @@ std::vector<NcaID> RegisteredCache::AccumulateFiles() const {
 }
 
 void RegisteredCache::ProcessFiles(const std::vector<NcaID>& ids) {
-    for (const auto& id : ids) {
-        const auto file = GetFileAtID(id);
+    struct FileToProcess {
+        NcaID id;
+        VirtualFile file;
+        std::optional<ContentIndexStamp> stamp;
+        std::optional<ProcessedNCA> processed;
+        bool is_indexed{};
+    };
 
-        if (file == nullptr)
-            continue;
-        const auto nca = std::make_shared<NCA>(parser(file, id));
-        if (nca->GetStatus() != Loader::ResultStatus::Success ||
-            nca->GetType() != NCAContentType::Meta || nca->GetSubdirectories().empty()) {
+    std::vector<FileToProcess> files;
+    files.reserve(ids.size());
+    for (const auto& id : ids) {
+        auto file = GetFileAtID(id);
+        if (file == nullptr) {
             continue;
         }
 
-        const auto section0 = nca->GetSubdirectories()[0];
+        auto stamp = GetContentIndexStamp(file);
+        FileToProcess& to_process = files.emplace_back(FileToProcess{
+            .id = id,
+            .file = std::move(file),
+            .stamp = std::move(stamp),
+        });
+        if (!to_process.stamp) {
+            continue;
+        }
+        if (const auto data = index->Find(Common::HexToString(id, false), *to_process.stamp)) {
+            to_process.processed = DeserializeProcessedNCA(*data);
+            to_process.is_indexed = to_process.processed.has_value();
+        }
+    }
 
-        for (const auto& section0_file : section0->GetFiles()) {
-            if (section0_file->GetExtension() != "cnmt")
-                continue;
+    const auto process = [this](FileToProcess& to_process) {
+        to_process.processed = ProcessNCA(parser(to_process.file, to_process.id));
+    };
+    const auto unindexed_count = std::ranges::count(files, false, &FileToProcess::is_indexed);
+    if (unindexed_count > 1) {
+        // Parsing is dominated by reading and decrypting headers, which scales across threads
+        const size_t num_workers =
+            std::min(static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1U)),
+                     static_cast<size_t>(unindexed_count));
+        Common::ThreadWorker workers(num_workers, "RegisteredCache");
+        for (auto& to_process : files) {
+            if (!to_process.is_indexed) {
+                workers.QueueWork([&process, &to_process] { process(to_process); });
+            }
+        }
+        workers.WaitForRequests();
+    } else {
+        for (auto& to_process : files) {
+            if (!to_process.is_indexed) {
+                process(to_process);
+            }
+        }
+    }
 
-            meta.insert_or_assign(nca->GetTitleId(), CNMT(section0_file));
-            meta_id.insert_or_assign(nca->GetTitleId(), id);
-            break;
+    for (auto& to_process : files) {
+        if (!to_process.processed) {
+            continue;
         }
+        if (!to_process.is_indexed && to_process.stamp) {
+            index->Insert(Common::HexToString(to_process.id, false), *to_process.stamp,
+                          SerializeProcessedNCA(*to_process.processed));
+        }
+        if (!to_process.processed->is_meta) {
+            continue;
+        }
+
+        meta.insert_or_assign(to_process.processed->title_id,
+                              CNMT(std::make_shared<VectorVfsFile>(
+                                  std::move(to_process.processed->cnmt), "meta.cnmt")));
+        meta_id.insert_or_assign(to_process.processed->title_id, to_process.id);
     }
+    index->Commit();
 }
 
 void RegisteredCache::AccumulateSuyuMeta() {
@@ -465,6 +581,12 @@ void RegisteredCache::Refresh() {
 
 RegisteredCache::RegisteredCache(VirtualDir dir_, ContentProviderParsingFunction parsing_function)
     : dir(std::move(dir_)), parser(std::move(parsing_function)) {
+    if (dir != nullptr) {
+        const auto full_path = dir->GetFullPath();
+        index = std::make_unique<ContentIndex>(
+            Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) / "content_index" /
+            fmt::format("{:016X}.bin", Common::CityHash64(full_path.data(), full_path.size())));
+    }
     Refresh();
 }
 
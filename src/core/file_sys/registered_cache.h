@@ -15,6 +15,7 @@
 
 namespace FileSys {
 class CNMT;
+class ContentIndex;
 class NCA;
 class NSP;
 class XCI;
@@ -195,6 +196,10 @@ private:
     VirtualDir dir;
     ContentProviderParsingFunction parser;
 
+    // Parse results of the NCAs in dir that are kept across sessions, so a refresh only has to
+    // parse the NCAs that were added or changed since.
+    std::unique_ptr<ContentIndex> index;
+
     // maps tid -> NcaID of meta
     std::map<u64, NcaID> meta_id;
     // maps tid -> meta
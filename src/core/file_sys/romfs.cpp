@@ -4,6 +4,7 @@
 #include <memory>
 
 #include "common/assert.h"
+#include "common/cityhash.h"
 #include "common/common_types.h"
 #include "common/string_util.h"
 #include "common/swap.h"
@@ -164,4 +165,30 @@ VirtualFile CreateRomFS(VirtualDir dir, VirtualDir ext) {
     return ConcatenatedVfsFile::MakeConcatenatedFile(0, dir->GetName(), ctx.Build());
 }
 
+std::optional<u64> HashRomFSMetadata(const VirtualFile& file) {
+    if (file == nullptr) {
+        return std::nullopt;
+    }
+
+    RomFSHeader header{};
+    if (file->ReadObject(&header) != sizeof(RomFSHeader) ||
+        header.header_size != sizeof(RomFSHeader)) {
+        return std::nullopt;
+    }
+
+    const auto directory_meta =
+        file->ReadBytes(header.directory_meta.size, header.directory_meta.offset);
+    const auto file_meta = file->ReadBytes(header.file_meta.size, header.file_meta.offset);
+    if (directory_meta.size() != header.directory_meta.size ||
+        file_meta.size() != header.file_meta.size) {
+        return std::nullopt;
+    }
+
+    u64 hash = Common::CityHash64(reinterpret_cast<const char*>(&header), sizeof(header));
+    hash = Common::CityHash64WithSeed(reinterpret_cast<const char*>(directory_meta.data()),
+                                      directory_meta.size(), hash);
+    return Common::CityHash64WithSeed(reinterpret_cast<const char*>(file_meta.data()),
+                                      file_meta.size(), hash);
+}
+
 } // namespace FileSys
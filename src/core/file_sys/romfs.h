@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include "core/file_sys/vfs/vfs.h"
 
 namespace FileSys {
@@ -15,4 +17,9 @@ VirtualDir ExtractRomFS(VirtualFile file);
 // Returns nullptr on failure
 VirtualFile CreateRomFS(VirtualDir dir, VirtualDir ext = nullptr);
 
+// Hashes the header and the directory and file tables of a RomFS binary blob, which identify its
+// layout without reading any file data
+// Returns std::nullopt on failure
+std::optional<u64> HashRomFSMetadata(const VirtualFile& file);
+
 } // namespace FileSys
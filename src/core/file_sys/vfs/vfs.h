@@ -7,6 +7,7 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -118,6 +119,11 @@ public:
     // 0)'
     virtual std::vector<u8> ReadAllBytes() const;
 
+    // Returns the whole contents of the file if they can be accessed in memory without a copy, such
+    // as a memory mapped file, or an empty span otherwise. The span is only valid as long as the
+    // file is alive and not written to.
+    virtual std::span<const u8> GetMappedSpan() const;
+
     // Reads an array of type T, size number_elements starting at offset.
     // Returns the number of bytes (sizeof(T)*number_elements) read successfully.
     template <typename T>
@@ -16,6 +16,17 @@ CachedVfsDirectory::CachedVfsDirectory(VirtualDir&& source_dir)
     }
 }
 
+CachedVfsDirectory::CachedVfsDirectory(std::string name_, std::vector<VirtualDir> subdirectories,
+                                       std::vector<VirtualFile> files_)
+    : name(std::move(name_)) {
+    for (auto& dir : subdirectories) {
+        dirs.emplace(dir->GetName(), std::move(dir));
+    }
+    for (auto& file : files_) {
+        files.emplace(file->GetName(), std::move(file));
+    }
+}
+
 CachedVfsDirectory::~CachedVfsDirectory() = default;
 
 VirtualFile CachedVfsDirectory::GetFile(std::string_view file_name) const {
@@ -12,6 +12,8 @@ namespace FileSys {
 class CachedVfsDirectory : public ReadOnlyVfsDirectory {
 public:
     CachedVfsDirectory(VirtualDir&& source_directory);
+    CachedVfsDirectory(std::string name, std::vector<VirtualDir> subdirectories,
+                       std::vector<VirtualFile> files);
 
     ~CachedVfsDirectory() override;
     VirtualFile GetFile(std::string_view file_name) const override;
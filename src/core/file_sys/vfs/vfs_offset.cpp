@@ -71,6 +71,14 @@ std::vector<u8> OffsetVfsFile::ReadAllBytes() const {
     return file->ReadBytes(size, offset);
 }
 
+std::span<const u8> OffsetVfsFile::GetMappedSpan() const {
+    const auto mapped = file->GetMappedSpan();
+    if (offset > mapped.size() || size > mapped.size() - offset) {
+        return {};
+    }
+    return mapped.subspan(offset, size);
+}
+
 bool OffsetVfsFile::WriteByte(u8 data, std::size_t r_offset) {
     if (r_offset < size)
         return file->WriteByte(data, offset + r_offset);
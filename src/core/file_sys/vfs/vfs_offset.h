@@ -30,6 +30,7 @@ public:
     std::optional<u8> ReadByte(std::size_t offset) const override;
     std::vector<u8> ReadBytes(std::size_t size, std::size_t offset) const override;
     std::vector<u8> ReadAllBytes() const override;
+    std::span<const u8> GetMappedSpan() const override;
     bool WriteByte(u8 data, std::size_t offset) override;
     std::size_t WriteBytes(const std::vector<u8>& data, std::size_t offset) override;
 
@@ -0,0 +1,317 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "common/thread_worker.h"
+#include "core/file_sys/vfs/vfs_read_ahead.h"
+
+namespace FileSys {
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/// Serializes the accesses to the backing files, see ReadAheadVfsFile
+std::mutex& GetBackingFileMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+Common::ThreadWorker& GetWorkers() {
+    // Backing file reads are serialized, so more threads would only wait for each other
+    static Common::ThreadWorker workers(1, "FS:ReadAhead");
+    return workers;
+}
+
+u64 ElapsedNs(Clock::time_point start) {
+    return static_cast<u64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+} // Anonymous namespace
+
+struct ReadAheadVfsFile::State {
+    struct Block {
+        std::vector<u8> data;
+        bool ready{};
+        u64 read_ns{};
+        u64 last_use{};
+    };
+
+    State(VirtualFile file_, std::shared_ptr<ReadAheadStatistics> statistics_)
+        : file{std::move(file_)}, size{file->GetSize()}, statistics{std::move(statistics_)} {}
+
+    size_t BlockLength(size_t index) const {
+        return std::min(BlockSize, size - index * BlockSize);
+    }
+
+    /// Returns true when a read continues one of the tracked streams, and tracks the read
+    bool TrackStream(size_t offset, size_t length) {
+        const auto it = std::ranges::find(stream_ends, offset);
+        if (it != stream_ends.end()) {
+            *it = offset + length;
+            return true;
+        }
+        // Replace the least recently started stream
+        stream_ends[next_stream] = offset + length;
+        next_stream = (next_stream + 1) % NumStreams;
+        return false;
+    }
+
+    /// Removes the least recently used block that is not being read, returns false if none is
+    bool EvictBlock() {
+        auto victim = blocks.end();
+        for (auto it = blocks.begin(); it != blocks.end(); ++it) {
+            if (it->second.ready && (victim == blocks.end() ||
+                                     it->second.last_use < victim->second.last_use)) {
+                victim = it;
+            }
+        }
+        if (victim == blocks.end()) {
+            return false;
+        }
+        blocks.erase(victim);
+        return true;
+    }
+
+    /// Queues reads of the blocks following a sequential read
+    void ReadAhead(const std::shared_ptr<State>& self, size_t next_offset) {
+        const size_t num_blocks = (size + BlockSize - 1) / BlockSize;
+        const size_t first = next_offset / BlockSize;
+        const size_t last = std::min(first + NumReadAheadBlocks, num_blocks);
+        for (size_t index = first; index < last; ++index) {
+            if (blocks.contains(index)) {
+                continue;
+            }
+            if (blocks.size() >= MaxCachedBlocks && !EvictBlock()) {
+                return;
+            }
+            blocks.emplace(index, Block{.last_use = ++use_counter});
+            GetWorkers().QueueWork([weak = std::weak_ptr<State>(self), index] {
+                const auto state = weak.lock();
+                if (state) {
+                    state->ReadBlock(index);
+                }
+            });
+        }
+    }
+
+    void ReadBlock(size_t index) {
+        std::vector<u8> data(BlockLength(index));
+        const auto start = Clock::now();
+        {
+            std::scoped_lock backing_lk{GetBackingFileMutex()};
+            data.resize(file->Read(data.data(), data.size(), index * BlockSize));
+        }
+        const u64 read_ns = ElapsedNs(start);
+        statistics->bytes_prefetched.fetch_add(data.size(), std::memory_order_relaxed);
+        {
+            std::scoped_lock lk{mutex};
+            Block& block = blocks.at(index);
+            block.data = std::move(data);
+            block.read_ns = read_ns;
+            block.ready = true;
+        }
+        block_ready.notify_all();
+    }
+
+    const VirtualFile file;
+    const size_t size;
+    const std::shared_ptr<ReadAheadStatistics> statistics;
+
+    std::mutex mutex;
+    std::condition_variable block_ready;
+    std::map<size_t, Block> blocks;
+    std::array<size_t, NumStreams> stream_ends{};
+    size_t next_stream{};
+    u64 use_counter{};
+};
+
+VirtualFile ReadAheadVfsFile::Create(VirtualFile file,
+                                     std::shared_ptr<ReadAheadStatistics> statistics) {
+    // Memory mapped files are already as fast to read as the prefetched blocks
+    if (file == nullptr || statistics == nullptr || !file->GetMappedSpan().empty()) {
+        return file;
+    }
+    // Writes would have to invalidate the blocks read ahead, and small files fit in a single read.
+    // They can still share storage layers with the files read ahead.
+    if (file->IsWritable() || file->GetSize() <= BlockSize * 2) {
+        return std::make_shared<SerializedVfsFile>(std::move(file));
+    }
+    return std::make_shared<ReadAheadVfsFile>(std::move(file), std::move(statistics));
+}
+
+ReadAheadVfsFile::ReadAheadVfsFile(VirtualFile file,
+                                   std::shared_ptr<ReadAheadStatistics> statistics)
+    : state{std::make_shared<State>(std::move(file), std::move(statistics))} {}
+
+ReadAheadVfsFile::~ReadAheadVfsFile() = default;
+
+std::string ReadAheadVfsFile::GetName() const {
+    return state->file->GetName();
+}
+
+std::size_t ReadAheadVfsFile::GetSize() const {
+    return state->size;
+}
+
+bool ReadAheadVfsFile::Resize(std::size_t new_size) {
+    return false;
+}
+
+VirtualDir ReadAheadVfsFile::GetContainingDirectory() const {
+    return state->file->GetContainingDirectory();
+}
+
+bool ReadAheadVfsFile::IsWritable() const {
+    return false;
+}
+
+bool ReadAheadVfsFile::IsReadable() const {
+    return true;
+}
+
+std::size_t ReadAheadVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    if (offset >= state->size) {
+        return 0;
+    }
+    length = std::min(length, state->size - offset);
+    if (length == 0) {
+        return 0;
+    }
+
+    std::unique_lock lk{state->mutex};
+    const bool is_sequential = state->TrackStream(offset, length);
+    const size_t first = offset / BlockSize;
+    const size_t last = (offset + length - 1) / BlockSize;
+    const auto is_cached = [&] {
+        for (size_t index = first; index <= last; ++index) {
+            if (!state->blocks.contains(index)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    size_t read_size = 0;
+    bool is_hit = is_cached();
+    if (is_hit) {
+        // Wait for blocks still being read, which is still faster than reading them again.
+        // Blocks can only be evicted by other readers of this file while waiting.
+        const auto wait_start = Clock::now();
+        state->block_ready.wait(lk, [&] {
+            for (size_t index = first; index <= last; ++index) {
+                const auto it = state->blocks.find(index);
+                if (it != state->blocks.end() && !it->second.ready) {
+                    return false;
+                }
+            }
+            return true;
+        });
+        const u64 wait_ns = ElapsedNs(wait_start);
+        is_hit = is_cached();
+
+        u64 read_ns = 0;
+        for (size_t index = first; index <= last && is_hit; ++index) {
+            State::Block& block = state->blocks.at(index);
+            block.last_use = ++state->use_counter;
+            const size_t block_offset = offset + read_size - index * BlockSize;
+            const size_t wanted = std::min(state->BlockLength(index) - block_offset,
+                                           length - read_size);
+            const size_t available =
+                block.data.size() > block_offset ? block.data.size() - block_offset : 0;
+            const size_t copy_size = std::min(wanted, available);
+            std::memcpy(data + read_size, block.data.data() + block_offset, copy_size);
+            read_size += copy_size;
+            read_ns += block.read_ns * copy_size / BlockSize;
+            if (copy_size < wanted) {
+                // The backing file returned less than it should have, stop like it did
+                break;
+            }
+        }
+        if (is_hit) {
+            state->statistics->hits.fetch_add(1, std::memory_order_relaxed);
+            if (read_ns > wait_ns) {
+                state->statistics->saved_ns.fetch_add(read_ns - wait_ns,
+                                                      std::memory_order_relaxed);
+            }
+        }
+    }
+    if (!is_hit) {
+        if (is_sequential) {
+            state->statistics->misses.fetch_add(1, std::memory_order_relaxed);
+        }
+        lk.unlock();
+        {
+            std::scoped_lock backing_lk{GetBackingFileMutex()};
+            read_size = state->file->Read(data, length, offset);
+        }
+        lk.lock();
+    }
+
+    if (is_sequential) {
+        state->ReadAhead(state, offset + length);
+    }
+    return read_size;
+}
+
+std::size_t ReadAheadVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
+    return 0;
+}
+
+bool ReadAheadVfsFile::Rename(std::string_view new_name) {
+    return false;
+}
+
+SerializedVfsFile::SerializedVfsFile(VirtualFile file_) : file{std::move(file_)} {}
+
+SerializedVfsFile::~SerializedVfsFile() = default;
+
+std::string SerializedVfsFile::GetName() const {
+    return file->GetName();
+}
+
+std::size_t SerializedVfsFile::GetSize() const {
+    std::scoped_lock lk{GetBackingFileMutex()};
+    return file->GetSize();
+}
+
+bool SerializedVfsFile::Resize(std::size_t new_size) {
+    std::scoped_lock lk{GetBackingFileMutex()};
+    return file->Resize(new_size);
+}
+
+VirtualDir SerializedVfsFile::GetContainingDirectory() const {
+    return file->GetContainingDirectory();
+}
+
+bool SerializedVfsFile::IsWritable() const {
+    return file->IsWritable();
+}
+
+bool SerializedVfsFile::IsReadable() const {
+    return file->IsReadable();
+}
+
+std::size_t SerializedVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    std::scoped_lock lk{GetBackingFileMutex()};
+    return file->Read(data, length, offset);
+}
+
+std::size_t SerializedVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
+    std::scoped_lock lk{GetBackingFileMutex()};
+    return file->Write(data, length, offset);
+}
+
+bool SerializedVfsFile::Rename(std::string_view new_name) {
+    std::scoped_lock lk{GetBackingFileMutex()};
+    return file->Rename(new_name);
+}
+
+} // namespace FileSys
@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "common/literals.h"
+#include "core/file_sys/vfs/vfs.h"
+
+namespace FileSys {
+
+using namespace Common::Literals;
+
+/// Counters of the read-ahead of all the files opened by a title
+struct ReadAheadStatistics {
+    std::atomic<u64> hits;             ///< Reads served from prefetched blocks
+    std::atomic<u64> misses;           ///< Sequential reads that went to the backing file
+    std::atomic<u64> bytes_prefetched; ///< Bytes read ahead in the background
+    std::atomic<u64> saved_ns;         ///< Backing file read time taken off the reading threads
+};
+
+/**
+ * Read-only file that detects sequential reads of its backing file and reads the blocks following
+ * them in the background, so streaming reads are served from memory instead of going through
+ * decryption and decompression when they are made.
+ *
+ * Reads of the backing files of every read-ahead file are serialized, like the reads of the
+ * filesystem service thread always were, since the storage layers below them keep caches that
+ * are not safe to use from several threads at once. Files opened next to them that are not read
+ * ahead are wrapped in a SerializedVfsFile for the same reason.
+ */
+class ReadAheadVfsFile : public VfsFile {
+public:
+    static constexpr size_t BlockSize = 256_KiB;
+    /// Number of blocks read ahead of a sequential stream
+    static constexpr size_t NumReadAheadBlocks = 4;
+    /// Maximum number of blocks kept in memory per file
+    static constexpr size_t MaxCachedBlocks = 8;
+    /// Number of interleaved sequential streams tracked per file
+    static constexpr size_t NumStreams = 4;
+
+    /// Wraps a file in a read-ahead file, or in a SerializedVfsFile when reading ahead would not
+    /// help. Memory mapped files share no state with other files and are returned as is.
+    static VirtualFile Create(VirtualFile file, std::shared_ptr<ReadAheadStatistics> statistics);
+
+    explicit ReadAheadVfsFile(VirtualFile file, std::shared_ptr<ReadAheadStatistics> statistics);
+    ~ReadAheadVfsFile() override;
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    VirtualDir GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    bool Rename(std::string_view new_name) override;
+
+private:
+    struct State;
+
+    std::shared_ptr<State> state;
+};
+
+/// File whose reads and writes are serialized with the backing reads of the read-ahead files
+class SerializedVfsFile : public VfsFile {
+public:
+    explicit SerializedVfsFile(VirtualFile file);
+    ~SerializedVfsFile() override;
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    VirtualDir GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    bool Rename(std::string_view new_name) override;
+
+private:
+    VirtualFile file;
+};
+
+} // namespace FileSys
@@ -8,8 +8,10 @@
 #include "common/assert.h"
 #include "common/fs/file.h"
 #include "common/fs/fs.h"
+#include "common/fs/mapped_file.h"
 #include "common/fs/path_util.h"
 #include "common/logging/log.h"
+#include "common/string_util.h"
 #include "core/file_sys/vfs/vfs.h"
 #include "core/file_sys/vfs/vfs_real.h"
 
@@ -32,6 +34,19 @@ namespace {
 
 constexpr size_t MaxOpenFiles = 512;
 
+/// Returns true for game content files, which nothing writes to while they are open. Save data and
+/// other files another handle may write or truncate must not be memory mapped.
+bool IsImmutableContent(std::string_view name, std::string_view parent_name) {
+    const auto is_content = [](std::string_view file_name) {
+        const auto extension =
+            Common::ToLower(std::string{FS::GetExtensionFromFilename(file_name)});
+        return extension == "nca" || extension == "nsp" || extension == "xci" ||
+               extension == "nso";
+    };
+    // Split NCAs are directories named like the NCA holding numbered parts
+    return is_content(name) || is_content(parent_name);
+}
+
 constexpr FS::FileAccessMode ModeFlagsToFileAccessMode(OpenMode mode) {
     switch (mode) {
     case OpenMode::Read:
@@ -292,6 +307,9 @@ std::size_t RealVfsFile::GetSize() const {
     if (size) {
         return *size;
     }
+    if (const auto* mapped = GetMappedFile()) {
+        return mapped->GetSize();
+    }
     auto lk = base.RefreshReference(path, perms, *reference);
     return reference->file ? reference->file->GetSize() : 0;
 }
@@ -315,6 +333,9 @@ bool RealVfsFile::IsReadable() const {
 }
 
 std::size_t RealVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    if (const auto* mapped = GetMappedFile()) {
+        return mapped->ReadAt(std::span{data, length}, offset);
+    }
     auto lk = base.RefreshReference(path, perms, *reference);
     if (!reference->file || !reference->file->Seek(static_cast<s64>(offset))) {
         return 0;
@@ -331,10 +352,35 @@ std::size_t RealVfsFile::Write(const u8* data, std::size_t length, std::size_t o
     return reference->file->WriteSpan(std::span{data, length});
 }
 
+std::span<const u8> RealVfsFile::GetMappedSpan() const {
+    const auto* mapped = GetMappedFile();
+    return mapped ? mapped->GetMappedSpan() : std::span<const u8>{};
+}
+
 bool RealVfsFile::Rename(std::string_view name) {
     return base.MoveFile(path, parent_path + '/' + std::string(name)) != nullptr;
 }
 
+const FS::MappedFile* RealVfsFile::GetMappedFile() const {
+    if (perms != OpenMode::Read) {
+        return nullptr;
+    }
+    std::call_once(mapped_file_flag, [this] {
+        const std::string_view parent_name =
+            path_components.size() >= 2 ? path_components[path_components.size() - 2] : "";
+        if (!IsImmutableContent(GetName(), parent_name)) {
+            return;
+        }
+        // Files that could not be mapped are read through the open file list instead, so their
+        // descriptors count against its limit.
+        auto file = std::make_unique<FS::MappedFile>(path);
+        if (!file->GetMappedSpan().empty()) {
+            mapped_file = std::move(file);
+        }
+    });
+    return mapped_file.get();
+}
+
 // TODO(DarkLordZach): MSVC would not let me combine the following two functions using 'if
 // constexpr' because there is a compile error in the branch not used.
 
@@ -401,6 +447,12 @@ VirtualFile RealVfsDirectory::GetFileRelative(std::string_view relative_path) co
     return base.OpenFile(full_path, perms);
 }
 
+VirtualFile RealVfsDirectory::GetFileRelativeWithSize(std::string_view relative_path,
+                                                      u64 size) const {
+    return base.OpenFileFromEntry(path + '/' + std::string(relative_path), size, std::nullopt,
+                                  perms);
+}
+
 VirtualDir RealVfsDirectory::GetDirectoryRelative(std::string_view relative_path) const {
     const auto full_path = FS::SanitizePath(path + '/' + std::string(relative_path));
     if (!FS::Exists(full_path) || !FS::IsDir(full_path)) {
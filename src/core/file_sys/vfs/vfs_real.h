@@ -13,7 +13,8 @@
 
 namespace Common::FS {
 class IOFile;
-}
+class MappedFile;
+} // namespace Common::FS
 
 namespace FileSys {
 
@@ -87,6 +88,7 @@ public:
     bool IsReadable() const override;
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
     std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    std::span<const u8> GetMappedSpan() const override;
     bool Rename(std::string_view name) override;
 
 private:
@@ -94,6 +96,10 @@ private:
                 const std::string& path, OpenMode perms = OpenMode::Read,
                 std::optional<u64> size = {}, std::optional<std::string> parent_path = {});
 
+    // Read-only game content files are memory mapped on first use and read without the reference
+    // list lock. Returns nullptr for other files, or if the file could not be mapped.
+    const Common::FS::MappedFile* GetMappedFile() const;
+
     RealVfsFilesystem& base;
     std::unique_ptr<FileReference> reference;
     std::string path;
@@ -101,6 +107,9 @@ private:
     std::vector<std::string> path_components;
     std::optional<u64> size;
     OpenMode perms;
+
+    mutable std::once_flag mapped_file_flag;
+    mutable std::unique_ptr<Common::FS::MappedFile> mapped_file;
 };
 
 // An implementation of VfsDirectory that represents a directory on the user's computer.
@@ -132,6 +141,10 @@ public:
     std::string GetFullPath() const override;
     std::map<std::string, VfsEntryType, std::less<>> GetEntries() const override;
 
+    /// Opens a file of this directory tree whose size is already known, e.g. from a directory
+    /// listing, without checking that it exists.
+    VirtualFile GetFileRelativeWithSize(std::string_view relative_path, u64 size) const;
+
 private:
     RealVfsDirectory(RealVfsFilesystem& base, const std::string& path,
                      OpenMode perms = OpenMode::Read);
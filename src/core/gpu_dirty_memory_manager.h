@@ -3,120 +3,185 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <bit>
 #include <functional>
-#include <mutex>
 #include <utility>
-#include <vector>
 
 #include "core/device_memory_manager.h"
 
 namespace Core {
 
+/**
+ * Tracks the device memory written by the CPU since the last Gather, with a granularity of
+ * align_size bytes. Marking is lock-free: every device page owns a word of dirty bits in a
+ * lazily allocated chunk, and two levels of summary bits record which words and chunks have
+ * anything set, so Gather only visits what was touched.
+ */
 class GPUDirtyMemoryManager {
 public:
-    GPUDirtyMemoryManager() : current{default_transform} {
-        back_buffer.reserve(256);
-        front_buffer.reserve(256);
+    GPUDirtyMemoryManager() = default;
+
+    ~GPUDirtyMemoryManager() {
+        for (auto& chunk : chunks) {
+            delete chunk.load(std::memory_order_relaxed);
+        }
     }
 
-    ~GPUDirtyMemoryManager() = default;
+    GPUDirtyMemoryManager(const GPUDirtyMemoryManager&) = delete;
+    GPUDirtyMemoryManager& operator=(const GPUDirtyMemoryManager&) = delete;
 
     void Collect(PAddr address, size_t size) {
-        TransformAddress t = BuildTransform(address, size);
-        TransformAddress tmp, original;
-        do {
-            tmp = current.load(std::memory_order_acquire);
-            original = tmp;
-            if (tmp.address != t.address) {
-                if (IsValid(tmp.address)) {
-                    std::scoped_lock lk(guard);
-                    back_buffer.emplace_back(tmp);
-                    current.exchange(t, std::memory_order_relaxed);
-                    return;
-                }
-                tmp.address = t.address;
-                tmp.mask = 0;
-            }
-            if ((tmp.mask | t.mask) == tmp.mask) {
-                return;
-            }
-            tmp.mask |= t.mask;
-        } while (!current.compare_exchange_weak(original, tmp, std::memory_order_release,
-                                                std::memory_order_relaxed));
+        const size_t page_offset = address & page_mask;
+        if (page_offset + size <= page_size && IsValid(address)) [[likely]] {
+            MarkPage(address >> page_bits, BuildMask(page_offset, size));
+            return;
+        }
+        CollectPages(address, size);
     }
 
     void Gather(std::function<void(PAddr, size_t)>& callback) {
-        {
-            std::scoped_lock lk(guard);
-            TransformAddress t = current.exchange(default_transform, std::memory_order_relaxed);
-            front_buffer.swap(back_buffer);
-            if (IsValid(t.address)) {
-                front_buffer.emplace_back(t);
+        PAddr run_address = 0;
+        size_t run_size = 0;
+        const auto emit = [&](PAddr address, size_t size) {
+            if (run_size != 0 && run_address + run_size == address) {
+                run_size += size;
+                return;
             }
-        }
-        for (auto& transform : front_buffer) {
-            size_t offset = 0;
-            u64 mask = transform.mask;
-            while (mask != 0) {
-                const size_t empty_bits = std::countr_zero(mask);
-                offset += empty_bits << align_bits;
-                mask = mask >> empty_bits;
-
-                const size_t continuous_bits = std::countr_one(mask);
-                callback((static_cast<PAddr>(transform.address) << page_bits) + offset,
-                         continuous_bits << align_bits);
-                mask = continuous_bits < align_size ? (mask >> continuous_bits) : 0;
-                offset += continuous_bits << align_bits;
+            if (run_size != 0) {
+                callback(run_address, run_size);
+            }
+            run_address = address;
+            run_size = size;
+        };
+        for (size_t summary_index = 0; summary_index < chunk_summary.size(); ++summary_index) {
+            u64 dirty_chunks = chunk_summary[summary_index].exchange(0, std::memory_order_acq_rel);
+            while (dirty_chunks != 0) {
+                const size_t bit = std::countr_zero(dirty_chunks);
+                dirty_chunks &= dirty_chunks - 1;
+                const size_t chunk_index = summary_index * 64 + bit;
+                GatherChunk(chunk_index, *chunks[chunk_index].load(std::memory_order_acquire),
+                            emit);
             }
         }
-        front_buffer.clear();
+        if (run_size != 0) {
+            callback(run_address, run_size);
+        }
     }
 
 private:
-    struct alignas(8) TransformAddress {
-        u32 address;
-        u32 mask;
-    };
-
-    constexpr static size_t page_bits = DEVICE_PAGEBITS - 1;
+    constexpr static size_t page_bits = DEVICE_PAGEBITS;
     constexpr static size_t page_size = 1ULL << page_bits;
     constexpr static size_t page_mask = page_size - 1;
 
     constexpr static size_t align_bits = 6U;
     constexpr static size_t align_size = 1U << align_bits;
     constexpr static size_t align_mask = align_size - 1;
-    constexpr static TransformAddress default_transform = {.address = ~0U, .mask = 0U};
+    static_assert(page_size >> align_bits == 64, "a page must fit in a single word of dirty bits");
+
+    /// Size of the device address space of the GPU, see MaxwellDeviceTraits
+    constexpr static size_t address_space_bits = 34;
+    constexpr static size_t chunk_bits = 12;
+    constexpr static size_t chunk_pages = 1ULL << chunk_bits;
+    constexpr static size_t chunk_page_mask = chunk_pages - 1;
+    constexpr static size_t num_chunks = 1ULL << (address_space_bits - page_bits - chunk_bits);
+
+    struct Chunk {
+        std::array<std::atomic<u64>, chunk_pages> pages{};
+        std::array<std::atomic<u64>, chunk_pages / 64> summary{};
+    };
+
+    void CollectPages(PAddr address, size_t size) {
+        if (!IsValid(address) || size == 0) {
+            return;
+        }
+        const PAddr end = std::min<PAddr>(address + size, 1ULL << address_space_bits);
+        while (address < end) {
+            const size_t page_offset = address & page_mask;
+            const size_t copy_amount = std::min<size_t>(page_size - page_offset, end - address);
+            MarkPage(address >> page_bits, BuildMask(page_offset, copy_amount));
+            address += copy_amount;
+        }
+    }
+
+    static bool IsValid(PAddr address) {
+        return address < (1ULL << address_space_bits);
+    }
 
-    bool IsValid(PAddr address) {
-        return address < (1ULL << 39);
+    static u64 BuildMask(size_t page_offset, size_t size) {
+        const size_t minor_bit = page_offset >> align_bits;
+        const size_t top_bit = (page_offset + size + align_mask) >> align_bits;
+        const u64 top_mask = top_bit >= 64 ? ~0ULL : (1ULL << top_bit) - 1;
+        return top_mask & ~((1ULL << minor_bit) - 1);
     }
 
-    template <typename T>
-    T CreateMask(size_t top_bit, size_t minor_bit) {
-        T mask = ~T(0);
-        mask <<= (sizeof(T) * 8 - top_bit);
-        mask >>= (sizeof(T) * 8 - top_bit);
-        mask >>= minor_bit;
-        mask <<= minor_bit;
-        return mask;
+    Chunk& GetChunk(size_t chunk_index) {
+        auto& slot = chunks[chunk_index];
+        Chunk* chunk = slot.load(std::memory_order_acquire);
+        if (chunk) [[likely]] {
+            return *chunk;
+        }
+        Chunk* const new_chunk = new Chunk;
+        if (slot.compare_exchange_strong(chunk, new_chunk, std::memory_order_acq_rel,
+                                         std::memory_order_acquire)) {
+            return *new_chunk;
+        }
+        // Another core installed the chunk first
+        delete new_chunk;
+        return *chunk;
     }
 
-    TransformAddress BuildTransform(PAddr address, size_t size) {
-        const size_t minor_address = address & page_mask;
-        const size_t minor_bit = minor_address >> align_bits;
-        const size_t top_bit = (minor_address + size + align_mask) >> align_bits;
-        TransformAddress result{};
-        result.address = static_cast<u32>(address >> page_bits);
-        result.mask = CreateMask<u32>(top_bit, minor_bit);
-        return result;
+    void MarkPage(size_t page, u64 mask) {
+        const size_t chunk_index = page >> chunk_bits;
+        const size_t page_index = page & chunk_page_mask;
+        Chunk& chunk = GetChunk(chunk_index);
+        auto& word = chunk.pages[page_index];
+        if ((word.load(std::memory_order_relaxed) & mask) == mask) [[likely]] {
+            return;
+        }
+        if (word.fetch_or(mask, std::memory_order_acq_rel) != 0) {
+            // The summary bits were set by whoever dirtied the page first
+            return;
+        }
+        const u64 page_bit = 1ULL << (page_index % 64);
+        if ((chunk.summary[page_index / 64].fetch_or(page_bit, std::memory_order_acq_rel) &
+             page_bit) != 0) {
+            return;
+        }
+        const u64 chunk_bit = 1ULL << (chunk_index % 64);
+        chunk_summary[chunk_index / 64].fetch_or(chunk_bit, std::memory_order_release);
+    }
+
+    template <typename Func>
+    void GatherChunk(size_t chunk_index, Chunk& chunk, Func&& emit) {
+        const PAddr chunk_address = static_cast<PAddr>(chunk_index) << (chunk_bits + page_bits);
+        for (size_t summary_index = 0; summary_index < chunk.summary.size(); ++summary_index) {
+            u64 dirty_pages = chunk.summary[summary_index].exchange(0, std::memory_order_acq_rel);
+            while (dirty_pages != 0) {
+                const size_t bit = std::countr_zero(dirty_pages);
+                dirty_pages &= dirty_pages - 1;
+                const size_t page_index = summary_index * 64 + bit;
+                u64 mask = chunk.pages[page_index].exchange(0, std::memory_order_acq_rel);
+                const PAddr page_address = chunk_address + (page_index << page_bits);
+                size_t offset = 0;
+                while (mask != 0) {
+                    const size_t empty_bits = std::countr_zero(mask);
+                    offset += empty_bits << align_bits;
+                    mask = mask >> empty_bits;
+
+                    const size_t continuous_bits = std::countr_one(mask);
+                    emit(page_address + offset, continuous_bits << align_bits);
+                    mask = continuous_bits < 64 ? (mask >> continuous_bits) : 0;
+                    offset += continuous_bits << align_bits;
+                }
+            }
+        }
     }
 
-    std::atomic<TransformAddress> current{};
-    std::mutex guard;
-    std::vector<TransformAddress> back_buffer;
-    std::vector<TransformAddress> front_buffer;
+    std::array<std::atomic<Chunk*>, num_chunks> chunks{};
+    std::array<std::atomic<u64>, (num_chunks + 63) / 64> chunk_summary{};
 };
 
 } // namespace Core
@@ -5,12 +5,15 @@
 
 #include <atomic>
 #include "common/assert.h"
+#include "common/microprofile.h"
 #include "core/hle/kernel/k_interrupt_manager.h"
 #include "core/hle/kernel/k_spin_lock.h"
 #include "core/hle/kernel/k_thread.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/physical_core.h"
 
+MICROPROFILE_DECLARE(Kernel_SchedulerLock);
+
 namespace Kernel {
 
 class KernelCore;
@@ -40,6 +43,11 @@ public:
 
             // Take ownership of the lock.
             m_owner_thread = GetCurrentThreadPointer(m_kernel);
+
+            // Profile how long the lock is held, and how often it had to be waited for.
+            // Scheduling is disabled while it is held, so it is released on this host thread.
+            m_hold_tick = MicroProfileEnter(MICROPROFILE_TOKEN(Kernel_SchedulerLock));
+            MICROPROFILE_META_CPU("Contended", m_spin_lock.WasContended() ? 1 : 0);
         }
 
         // Increment the lock count.
@@ -60,6 +68,7 @@ public:
                 SchedulerType::UpdateHighestPriorityThreads(m_kernel);
 
             // Note that we no longer hold the lock, and unlock the spinlock.
+            MicroProfileLeave(MICROPROFILE_TOKEN(Kernel_SchedulerLock), m_hold_tick);
             m_owner_thread = nullptr;
             m_spin_lock.Unlock();
 
@@ -75,6 +84,7 @@ private:
     KAlignedSpinLock m_spin_lock{};
     s32 m_lock_count{};
     std::atomic<KThread*> m_owner_thread{};
+    u64 m_hold_tick{};
 };
 
 } // namespace Kernel
@@ -1146,8 +1146,14 @@ Result KServerSession::ReceiveRequest(uintptr_t server_message, uintptr_t server
         }
         Core::Memory::Memory& memory{client_thread->GetOwnerProcess()->GetMemory()};
         u32* cmd_buf{reinterpret_cast<u32*>(memory.GetPointer(client_message))};
-        *out_context =
-            std::make_shared<Service::HLERequestContext>(m_kernel, memory, this, client_thread);
+        // Reuse the context of the previous request, unless something still holds on to it
+        if (*out_context && out_context->use_count() == 1 &&
+            &(*out_context)->GetMemory() == &memory) {
+            (*out_context)->Reset(client_thread);
+        } else {
+            *out_context = std::make_shared<Service::HLERequestContext>(m_kernel, memory, this,
+                                                                        client_thread);
+        }
         (*out_context)->SetSessionRequestManager(manager);
         (*out_context)->PopulateFromIncomingCommandBuffer(cmd_buf);
         // We succeeded.
@@ -1,20 +1,95 @@
 // SPDX-FileCopyrightText: Copyright 2021 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+
+#include "common/microprofile.h"
+#include "common/spin_lock.h"
 #include "core/hle/kernel/k_spin_lock.h"
 
+MICROPROFILE_DEFINE(Kernel_SpinLockWait, "Kernel", "Spin lock wait", MP_RGB(200, 100, 70));
+
 namespace Kernel {
 
+namespace {
+// Bounds of the number of pauses a waiter spins for before parking
+constexpr u32 MinSpinCount = 16;
+constexpr u32 MaxSpinCount = 1024;
+} // Anonymous namespace
+
 void KSpinLock::Lock() {
-    m_lock.lock();
+    const u32 ticket = m_next_ticket.fetch_add(1, std::memory_order_relaxed);
+    const bool contended = m_serving.load(std::memory_order_acquire) != ticket;
+    if (contended) [[unlikely]] {
+        this->WaitForTicket(ticket);
+        Increment(m_contended_count);
+    }
+    m_was_contended = contended;
+    Increment(m_acquire_count);
 }
 
 void KSpinLock::Unlock() {
-    m_lock.unlock();
+    // The store and the load below pair with the ones in WaitForTicket, so either a parked waiter
+    // sees the new ticket or this sees the waiter.
+    m_serving.store(m_serving.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+    if (m_num_parked.load(std::memory_order_seq_cst) != 0) {
+        m_serving.notify_all();
+    }
 }
 
 bool KSpinLock::TryLock() {
-    return m_lock.try_lock();
+    // The lock is free when no ticket was handed out past the one being served.
+    u32 ticket = m_serving.load(std::memory_order_acquire);
+    if (!m_next_ticket.compare_exchange_strong(ticket, ticket + 1, std::memory_order_acquire,
+                                               std::memory_order_relaxed)) {
+        return false;
+    }
+    m_was_contended = false;
+    Increment(m_acquire_count);
+    return true;
+}
+
+KSpinLockStatistics KSpinLock::GetStatistics() const {
+    return {
+        .acquire_count = m_acquire_count.load(std::memory_order_relaxed),
+        .contended_count = m_contended_count.load(std::memory_order_relaxed),
+        .parked_count = m_parked_count.load(std::memory_order_relaxed),
+    };
+}
+
+void KSpinLock::WaitForTicket(u32 ticket) {
+    MICROPROFILE_SCOPE(Kernel_SpinLockWait);
+
+    // Spin for about twice as long as recent waits took, like adaptive mutexes do.
+    const u32 spin_estimate = m_spin_estimate.load(std::memory_order_relaxed);
+    const u32 spin_limit = std::min(spin_estimate * 2 + MinSpinCount, MaxSpinCount);
+    u32 num_spins = 0;
+    bool parked = false;
+    while (true) {
+        const u32 serving = m_serving.load(std::memory_order_acquire);
+        if (serving == ticket) {
+            break;
+        }
+        // Only the next waiter in line spins, the others have to wait for several holders.
+        if (ticket - serving == 1 && num_spins < spin_limit) {
+            ++num_spins;
+            Common::ThreadPause();
+            continue;
+        }
+        parked = true;
+        m_num_parked.fetch_add(1, std::memory_order_seq_cst);
+        m_serving.wait(serving, std::memory_order_seq_cst);
+        m_num_parked.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // The lock is held from here, so the holder-only state can be updated.
+    const u32 observed_spins = parked ? spin_limit : num_spins;
+    const s32 delta = static_cast<s32>(observed_spins) - static_cast<s32>(spin_estimate);
+    m_spin_estimate.store(static_cast<u32>(static_cast<s32>(spin_estimate) + delta / 8),
+                          std::memory_order_relaxed);
+    if (parked) {
+        Increment(m_parked_count);
+    }
 }
 
 } // namespace Kernel
@@ -3,13 +3,25 @@
 
 #pragma once
 
-#include <mutex>
+#include <atomic>
 
 #include "common/common_funcs.h"
+#include "common/common_types.h"
 #include "core/hle/kernel/k_scoped_lock.h"
 
 namespace Kernel {
 
+struct KSpinLockStatistics {
+    u64 acquire_count;   ///< Number of times the lock was taken
+    u64 contended_count; ///< Number of times the lock was already held when it was requested
+    u64 parked_count;    ///< Number of contended acquires that stopped spinning and slept
+};
+
+/**
+ * Ticket lock that spins while the lock is handed over quickly and parks the waiting host thread
+ * otherwise. The number of spins adapts to how long recent contended acquires had to wait, so
+ * locks held for long periods stop burning host cores.
+ */
 class KSpinLock {
 public:
     explicit KSpinLock() = default;
@@ -21,12 +33,38 @@ public:
     void Unlock();
     bool TryLock();
 
+    /// Returns true when the last acquire of the lock had to wait. Only valid while holding it.
+    bool WasContended() const {
+        return m_was_contended;
+    }
+
+    KSpinLockStatistics GetStatistics() const;
+
 private:
-    std::mutex m_lock;
+    void WaitForTicket(u32 ticket);
+
+    /// Increments a counter only written while holding the lock
+    static void Increment(std::atomic<u64>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::atomic<u32> m_next_ticket{};
+    std::atomic<u32> m_serving{};
+    std::atomic<u32> m_num_parked{};
+    std::atomic<u32> m_spin_estimate{};
+    bool m_was_contended{};
+
+    std::atomic<u64> m_acquire_count{};
+    std::atomic<u64> m_contended_count{};
+    std::atomic<u64> m_parked_count{};
+};
+
+/// Spin lock on its own cache line, so waiters spinning on it do not slow down unrelated data
+class alignas(64) KAlignedSpinLock : public KSpinLock {
+public:
+    explicit KAlignedSpinLock() = default;
 };
 
-// TODO(bunnei): Alias for now, in case we want to implement these accurately in the future.
-using KAlignedSpinLock = KSpinLock;
 using KNotAlignedSpinLock = KSpinLock;
 
 using KScopedSpinLock = KScopedLock<KSpinLock>;
@@ -14,6 +14,7 @@
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
+#include "common/settings.h"
 #include "common/thread.h"
 #include "common/thread_worker.h"
 #include "core/arm/arm_interface.h"
@@ -41,12 +42,14 @@
 #include "core/hle/kernel/k_worker_task_manager.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/physical_core.h"
+#include "core/hle/kernel/svc_statistics.h"
 #include "core/hle/result.h"
 #include "core/hle/service/server_manager.h"
 #include "core/hle/service/sm/sm.h"
 #include "core/memory.h"
 
 MICROPROFILE_DEFINE(Kernel_SVC, "Kernel", "SVC", MP_RGB(70, 200, 70));
+MICROPROFILE_DEFINE(Kernel_SchedulerLock, "Kernel", "Scheduler lock held", MP_RGB(200, 70, 70));
 
 namespace Kernel {
 
@@ -68,6 +71,8 @@ struct KernelCore::Impl {
 
         global_object_list_container = std::make_unique<KAutoObjectWithListContainer>(kernel);
         global_scheduler_context = std::make_unique<Kernel::GlobalSchedulerContext>(kernel);
+        svc_statistics = std::make_unique<Kernel::SvcStatistics>();
+        svc_statistics->SetEnabled(Settings::values.record_svc_statistics.GetValue());
 
         is_phantom_mode_for_singlecore = false;
 
@@ -115,6 +120,13 @@ struct KernelCore::Impl {
 
         CloseServices();
 
+        // The cores are stopped, so the statistics of the session are final.
+        if (svc_statistics && svc_statistics->IsEnabled()) {
+            void(svc_statistics->SaveReport(
+                application_process ? application_process->GetProgramId() : 0));
+            svc_statistics->Reset();
+        }
+
         if (application_process) {
             application_process->Close();
             application_process = nullptr;
@@ -782,6 +794,7 @@ struct KernelCore::Impl {
     KProcess* application_process{};
     std::unique_ptr<Kernel::GlobalSchedulerContext> global_scheduler_context;
     std::unique_ptr<Kernel::KHardwareTimer> hardware_timer;
+    std::unique_ptr<Kernel::SvcStatistics> svc_statistics;
 
     Init::KSlabResourceCounts slab_resource_counts{};
     KResourceLimit* system_resource_limit{};
@@ -1278,6 +1291,14 @@ void KernelCore::ExceptionalExitApplication() {
     SuspendEmulation(true);
 }
 
+Kernel::SvcStatistics& KernelCore::SvcStatistics() {
+    return *impl->svc_statistics;
+}
+
+const Kernel::SvcStatistics& KernelCore::SvcStatistics() const {
+    return *impl->svc_statistics;
+}
+
 void KernelCore::EnterSVCProfile() {
     impl->svc_ticks[CurrentPhysicalCoreIndex()] = MicroProfileEnter(MICROPROFILE_TOKEN(Kernel_SVC));
 }
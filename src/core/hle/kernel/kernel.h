@@ -72,6 +72,7 @@ class KTransferMemory;
 class KWorkerTaskManager;
 class KCodeMemory;
 class PhysicalCore;
+class SvcStatistics;
 
 namespace Init {
 struct KSlabResourceCounts;
@@ -271,6 +272,12 @@ public:
 
     bool IsShuttingDown() const;
 
+    /// Gets the per-SVC call statistics
+    Kernel::SvcStatistics& SvcStatistics();
+
+    /// Gets the per-SVC call statistics
+    const Kernel::SvcStatistics& SvcStatistics() const;
+
     void EnterSVCProfile();
 
     void ExitSVCProfile();
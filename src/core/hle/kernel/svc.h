@@ -535,4 +535,7 @@ void SvcWrap_CallSecureMonitor64(Core::System& system, std::span<uint64_t, 8> ar
 // Perform a supervisor call by index.
 void Call(Core::System& system, u32 imm);
 
+// Returns the name of a supervisor call, or nullptr if the index is unknown.
+const char* GetSvcName(u32 imm);
+
 } // namespace Kernel::Svc
@@ -0,0 +1,228 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "core/hle/kernel/k_process.h"
+#include "core/hle/kernel/k_thread.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/svc.h"
+#include "core/hle/kernel/svc_statistics.h"
+
+namespace Kernel {
+
+namespace {
+size_t GetHistogramBucket(u64 ns) {
+    return std::min<size_t>(std::bit_width(ns >> 8), SvcStatistics::NumHistogramBuckets - 1);
+}
+
+/// Adds to a counter only written by the host thread of its core
+void Add(std::atomic<u64>& counter, u64 value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+} // Anonymous namespace
+
+SvcStatistics::SvcStatistics() {
+    for (auto& core : m_cores) {
+        core = std::make_unique<CoreCounters>();
+    }
+}
+
+SvcStatistics::~SvcStatistics() = default;
+
+void SvcStatistics::End(KernelCore& kernel, u32 svc_id,
+                        std::optional<Clock::time_point> start_time) {
+    if (!start_time) {
+        return;
+    }
+    const u64 ns = static_cast<u64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - *start_time).count());
+
+    std::optional<Caller> caller;
+    if (const KThread* const thread = GetCurrentThreadPointer(kernel)) {
+        const KProcess* const process = thread->GetOwnerProcess();
+        caller = Caller{
+            .thread_id = thread->GetThreadId(),
+            .process_id = process != nullptr ? process->GetProcessId() : 0,
+        };
+    }
+    // Blocking calls can return on another core than the one they were made on, so the counters
+    // of the core returning from the call are the ones owned by this host thread.
+    this->Record(kernel.CurrentPhysicalCoreIndex(), svc_id, ns, caller);
+}
+
+void SvcStatistics::Record(size_t core_index, u32 svc_id, u64 latency_ns,
+                           std::optional<Caller> caller) {
+    if (svc_id >= NumSvcIds) {
+        return;
+    }
+    CoreCounters& core = *m_cores[core_index];
+    SvcCoreCounters& svc = core.svcs[svc_id];
+    Add(svc.count, 1);
+    Add(svc.total_ns, latency_ns);
+    if (latency_ns > svc.max_ns.load(std::memory_order_relaxed)) {
+        svc.max_ns.store(latency_ns, std::memory_order_relaxed);
+    }
+    Add(svc.histogram[GetHistogramBucket(latency_ns)], 1);
+
+    if (!caller) {
+        return;
+    }
+    // The lock is only contended while the statistics are read
+    std::scoped_lock lk{core.thread_lock};
+    ThreadCounters& counters = core.threads[caller->thread_id];
+    counters.process_id = caller->process_id;
+    ++counters.count;
+    counters.total_ns += latency_ns;
+}
+
+SvcStatistics::SvcCounters SvcStatistics::GetSvcCounters(u32 svc_id) const {
+    SvcCounters result{};
+    if (svc_id >= NumSvcIds) {
+        return result;
+    }
+    for (const auto& core : m_cores) {
+        const SvcCoreCounters& svc = core->svcs[svc_id];
+        result.count += svc.count.load(std::memory_order_relaxed);
+        result.total_ns += svc.total_ns.load(std::memory_order_relaxed);
+        result.max_ns = std::max(result.max_ns, svc.max_ns.load(std::memory_order_relaxed));
+        for (size_t bucket = 0; bucket < NumHistogramBuckets; ++bucket) {
+            result.histogram[bucket] += svc.histogram[bucket].load(std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+std::optional<SvcStatistics::ThreadCounters> SvcStatistics::GetThreadCounters(
+    u64 thread_id) const {
+    std::optional<ThreadCounters> result;
+    for (const auto& core : m_cores) {
+        std::scoped_lock lk{core->thread_lock};
+        const auto it = core->threads.find(thread_id);
+        if (it == core->threads.end()) {
+            continue;
+        }
+        if (!result) {
+            result = ThreadCounters{.process_id = it->second.process_id};
+        }
+        result->count += it->second.count;
+        result->total_ns += it->second.total_ns;
+    }
+    return result;
+}
+
+std::string SvcStatistics::ToJson() const {
+    auto svcs = nlohmann::json::array();
+    for (u32 svc_id = 0; svc_id < NumSvcIds; ++svc_id) {
+        const SvcCounters counters = this->GetSvcCounters(svc_id);
+        if (counters.count == 0) {
+            continue;
+        }
+        const char* const name = Svc::GetSvcName(svc_id);
+        svcs.push_back({
+            {"id", svc_id},
+            {"name", name != nullptr ? name : fmt::format("Unknown{:02X}", svc_id)},
+            {"count", counters.count},
+            {"total_ns", counters.total_ns},
+            {"average_ns", counters.total_ns / counters.count},
+            {"max_ns", counters.max_ns},
+            {"histogram", counters.histogram},
+        });
+    }
+    std::sort(svcs.begin(), svcs.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs["total_ns"].template get<u64>() > rhs["total_ns"].template get<u64>();
+    });
+
+    // Merge the threads seen by every core
+    Common::FlatHashMap<u64, ThreadCounters> threads;
+    auto cores = nlohmann::json::array();
+    for (size_t core_index = 0; core_index < m_cores.size(); ++core_index) {
+        const CoreCounters& core = *m_cores[core_index];
+        u64 core_count = 0;
+        for (const SvcCoreCounters& svc : core.svcs) {
+            core_count += svc.count.load(std::memory_order_relaxed);
+        }
+        cores.push_back({{"core", core_index}, {"count", core_count}});
+
+        std::scoped_lock lk{core.thread_lock};
+        for (const auto& [thread_id, counters] : core.threads) {
+            const auto [it, is_new] = threads.try_emplace(thread_id, counters);
+            if (!is_new) {
+                it->second.count += counters.count;
+                it->second.total_ns += counters.total_ns;
+            }
+        }
+    }
+    auto thread_list = nlohmann::json::array();
+    for (const auto& [thread_id, counters] : threads) {
+        thread_list.push_back({
+            {"thread_id", thread_id},
+            {"process_id", counters.process_id},
+            {"count", counters.count},
+            {"total_ns", counters.total_ns},
+        });
+    }
+    std::sort(thread_list.begin(), thread_list.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs["total_ns"].template get<u64>() > rhs["total_ns"].template get<u64>();
+    });
+
+    const nlohmann::json json{
+        {"histogram_bucket_base_ns", 256},
+        {"svcs", std::move(svcs)},
+        {"cores", std::move(cores)},
+        {"threads", std::move(thread_list)},
+    };
+    return json.dump(4);
+}
+
+std::optional<std::filesystem::path> SvcStatistics::SaveReport(u64 title_id) const {
+    const auto time = std::time(nullptr);
+    const auto path = Common::FS::GetSuyuPath(Common::FS::SuyuPath::LogDir) / "svc_statistics" /
+                      fmt::format("{:016X}_{:%FT%H-%M-%S}.json", title_id, *std::localtime(&time));
+    if (!Common::FS::CreateParentDirs(path)) {
+        LOG_ERROR(Kernel, "Failed to create path for '{}' to save SVC statistics!",
+                  Common::FS::PathToUTF8String(path));
+        return std::nullopt;
+    }
+
+    std::ofstream file;
+    Common::FS::OpenFileStream(file, path, std::ios_base::out | std::ios_base::trunc);
+    file << this->ToJson() << std::endl;
+    if (!file) {
+        LOG_ERROR(Kernel, "Failed to write SVC statistics to '{}'",
+                  Common::FS::PathToUTF8String(path));
+        return std::nullopt;
+    }
+    LOG_INFO(Kernel, "Saved SVC statistics to '{}'", Common::FS::PathToUTF8String(path));
+    return path;
+}
+
+void SvcStatistics::Reset() {
+    for (auto& core : m_cores) {
+        for (SvcCoreCounters& svc : core->svcs) {
+            svc.count.store(0, std::memory_order_relaxed);
+            svc.total_ns.store(0, std::memory_order_relaxed);
+            svc.max_ns.store(0, std::memory_order_relaxed);
+            for (auto& bucket : svc.histogram) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+        std::scoped_lock lk{core->thread_lock};
+        core->threads.clear();
+    }
+}
+
+} // namespace Kernel
@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/flat_hash_map.h"
+#include "common/spin_lock.h"
+#include "core/hardware_properties.h"
+
+namespace Kernel {
+
+class KernelCore;
+
+/**
+ * Records how often each supervisor call is made, how long it takes in host time, and which guest
+ * threads make them. Every emulated core records into its own counters, which only its host
+ * thread writes, so recording takes no locks shared between cores.
+ */
+class SvcStatistics {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Number of latency histogram buckets. Bucket 0 holds calls shorter than 256ns, and each
+    /// following bucket covers twice the latency of the previous one.
+    static constexpr size_t NumHistogramBuckets = 24;
+
+    /// Supervisor call numbers that are tracked, larger numbers are not valid calls
+    static constexpr size_t NumSvcIds = 0x100;
+
+    struct SvcCounters {
+        u64 count;
+        u64 total_ns;
+        u64 max_ns;
+        std::array<u64, NumHistogramBuckets> histogram;
+    };
+
+    struct ThreadCounters {
+        u64 process_id;
+        u64 count;
+        u64 total_ns;
+    };
+
+    /// Guest thread making a supervisor call
+    struct Caller {
+        u64 thread_id;
+        u64 process_id;
+    };
+
+    explicit SvcStatistics();
+    ~SvcStatistics();
+
+    SUYU_NON_COPYABLE(SvcStatistics);
+    SUYU_NON_MOVEABLE(SvcStatistics);
+
+    void SetEnabled(bool enabled) {
+        m_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool IsEnabled() const {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /// Starts timing a supervisor call, returns nothing when recording is disabled
+    std::optional<Clock::time_point> Begin() const {
+        if (!this->IsEnabled()) {
+            return std::nullopt;
+        }
+        return Clock::now();
+    }
+
+    /// Records a supervisor call started with Begin, from the core that returns from it
+    void End(KernelCore& kernel, u32 svc_id, std::optional<Clock::time_point> start_time);
+
+    /// Records a supervisor call that took the given host time. Only the host thread of the core
+    /// may record into its counters.
+    void Record(size_t core_index, u32 svc_id, u64 latency_ns, std::optional<Caller> caller);
+
+    /// Sums the counters of a supervisor call over all cores
+    SvcCounters GetSvcCounters(u32 svc_id) const;
+
+    /// Sums the counters of a guest thread over all cores
+    std::optional<ThreadCounters> GetThreadCounters(u64 thread_id) const;
+
+    /// Returns the statistics as a JSON document
+    std::string ToJson() const;
+
+    /// Writes the statistics of a title into the log directory, returns the path of the report
+    std::optional<std::filesystem::path> SaveReport(u64 title_id) const;
+
+    /// Clears all counters. Must not be called while guest code is running.
+    void Reset();
+
+private:
+    struct SvcCoreCounters {
+        std::atomic<u64> count;
+        std::atomic<u64> total_ns;
+        std::atomic<u64> max_ns;
+        std::array<std::atomic<u64>, NumHistogramBuckets> histogram;
+    };
+
+    struct alignas(64) CoreCounters {
+        std::array<SvcCoreCounters, NumSvcIds> svcs{};
+        /// Guards the thread table against readers, the host thread of the core is the only
+        /// writer. Tables grow when new threads appear, which atomics can't cover.
+        mutable Common::SpinLock thread_lock;
+        Common::FlatHashMap<u64, ThreadCounters> threads;
+    };
+
+    std::atomic<bool> m_enabled{};
+    std::array<std::unique_ptr<CoreCounters>, Core::Hardware::NUM_CPU_CORES> m_cores;
+};
+
+} // namespace Kernel
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "common/alignment.h"
 #include "common/div_ceil.h"
 
 #include "core/hle/service/cmif_types.h"
@@ -239,7 +240,51 @@ constexpr RequestLayout GetReplyOutLayout(bool is_domain) {
     return is_domain ? GetDomainReplyOutLayout<MethodArguments>() : GetNonDomainReplyOutLayout<MethodArguments>();
 }
 
-using OutTemporaryBuffers = std::array<Common::ScratchBuffer<u8>, 3>;
+using OutTemporaryBuffers = std::array<Common::ScratchBuffer<u8>, HLERequestContext::NumOutTemporaryBuffers>;
+
+// Returns the memory an output buffer is written to by the handler. Guest memory is written
+// directly when possible, the scratch buffer stays empty then. Guest buffers that are not aligned
+// for the element type go through the scratch buffer as well.
+template <typename ElementType, BufferAttr Attr, typename Context>
+std::span<ElementType> GetOutBufferStorage(Context& ctx, size_t buffer_index, Common::ScratchBuffer<u8>& scratch) {
+    std::span<u8> direct;
+    if constexpr (Attr & BufferAttr_HipcAutoSelect) {
+        direct = ctx.GetWriteBufferSpan(buffer_index);
+    } else if constexpr (Attr & BufferAttr_HipcMapAlias) {
+        direct = ctx.GetWriteBufferSpanB(buffer_index);
+    } else /* if (Attr & BufferAttr_HipcPointer) */ {
+        direct = ctx.GetWriteBufferSpanC(buffer_index);
+    }
+    if (!Common::IsAligned(reinterpret_cast<uintptr_t>(direct.data()), alignof(ElementType))) {
+        direct = {};
+    }
+
+    if (direct.empty() && ctx.CanWriteBuffer(buffer_index)) {
+        scratch.resize_destructive(ctx.GetWriteBufferSize(buffer_index));
+    } else {
+        scratch.resize_destructive(0);
+    }
+
+    u8* const data = direct.empty() ? scratch.data() : direct.data();
+    const size_t data_size = direct.empty() ? scratch.size() : direct.size();
+    return std::span(reinterpret_cast<ElementType*>(data), data_size / sizeof(ElementType));
+}
+
+// Copies an output buffer that was written to the scratch buffer to guest memory.
+template <BufferAttr Attr, typename Context>
+void WriteOutBufferStorage(Context& ctx, size_t buffer_index, const Common::ScratchBuffer<u8>& scratch) {
+    const size_t size = scratch.size();
+    if (size == 0 || !ctx.CanWriteBuffer(buffer_index)) {
+        return;
+    }
+    if constexpr (Attr & BufferAttr_HipcAutoSelect) {
+        ctx.WriteBuffer(scratch.data(), size, buffer_index);
+    } else if constexpr (Attr & BufferAttr_HipcMapAlias) {
+        ctx.WriteBufferB(scratch.data(), size, buffer_index);
+    } else /* if (Attr & BufferAttr_HipcPointer) */ {
+        ctx.WriteBufferC(scratch.data(), size, buffer_index);
+    }
+}
 
 template <typename MethodArguments, typename CallArguments, size_t PrevAlign = 1, size_t DataOffset = 0, size_t HandleIndex = 0, size_t InBufferIndex = 0, size_t OutBufferIndex = 0, bool RawDataFinished = false, size_t ArgIndex = 0>
 void ReadInArgument(bool is_domain, CallArguments& args, const u8* raw_data, HLERequestContext& ctx, OutTemporaryBuffers& temp) {
@@ -338,18 +383,7 @@ void ReadInArgument(bool is_domain, CallArguments& args, const u8* raw_data, HLE
         } else if constexpr (ArgumentTraits<ArgType>::Type == ArgumentType::OutBuffer) {
             using ElementType = typename ArgType::Type;
 
-            // Set up scratch buffer.
-            auto& buffer = temp[OutBufferIndex];
-            if (ctx.CanWriteBuffer(OutBufferIndex)) {
-                buffer.resize_destructive(ctx.GetWriteBufferSize(OutBufferIndex));
-            } else {
-                buffer.resize_destructive(0);
-            }
-
-            ElementType* ptr = (ElementType*) buffer.data();
-            size_t size = buffer.size() / sizeof(ElementType);
-
-            std::get<ArgIndex>(args) = std::span(ptr, size);
+            std::get<ArgIndex>(args) = GetOutBufferStorage<ElementType, ArgType::Attr>(ctx, OutBufferIndex, temp[OutBufferIndex]);
 
             return ReadInArgument<MethodArguments, CallArguments, PrevAlign, DataOffset, HandleIndex, InBufferIndex, OutBufferIndex + 1, RawDataFinished, ArgIndex + 1>(is_domain, args, raw_data, ctx, temp);
         } else {
@@ -412,18 +446,7 @@ void WriteOutArgument(bool is_domain, CallArguments& args, u8* raw_data, HLERequ
 
             return WriteOutArgument<MethodArguments, CallArguments, PrevAlign, DataOffset, OutBufferIndex + 1, RawDataFinished, ArgIndex + 1>(is_domain, args, raw_data, ctx, temp);
         } else if constexpr (ArgumentTraits<ArgType>::Type == ArgumentType::OutBuffer) {
-            auto& buffer = temp[OutBufferIndex];
-            const size_t size = buffer.size();
-
-            if (size > 0 && ctx.CanWriteBuffer(OutBufferIndex)) {
-                if constexpr (ArgType::Attr & BufferAttr_HipcAutoSelect) {
-                    ctx.WriteBuffer(buffer.data(), size, OutBufferIndex);
-                } else if constexpr (ArgType::Attr & BufferAttr_HipcMapAlias) {
-                    ctx.WriteBufferB(buffer.data(), size, OutBufferIndex);
-                } else /* if (ArgType::Attr & BufferAttr_HipcPointer) */ {
-                    ctx.WriteBufferC(buffer.data(), size, OutBufferIndex);
-                }
-            }
+            WriteOutBufferStorage<ArgType::Attr>(ctx, OutBufferIndex, temp[OutBufferIndex]);
 
             return WriteOutArgument<MethodArguments, CallArguments, PrevAlign, DataOffset, OutBufferIndex + 1, RawDataFinished, ArgIndex + 1>(is_domain, args, raw_data, ctx, temp);
         } else {
@@ -443,7 +466,7 @@ void CmifReplyWrapImpl(HLERequestContext& ctx, T& t, Result (T::*f)(A...)) {
     static_assert(ConstIfReference<A...>(), "Arguments taken by reference must be const");
     using MethodArguments = std::tuple<std::remove_cvref_t<A>...>;
 
-    OutTemporaryBuffers buffers{};
+    OutTemporaryBuffers& buffers = ctx.GetOutTemporaryBuffers();
     auto call_arguments = std::tuple<typename UnwrapArg<A>::Type...>();
 
     // Read inputs.
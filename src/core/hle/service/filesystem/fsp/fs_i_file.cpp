@@ -7,8 +7,11 @@
 
 namespace Service::FileSystem {
 
-IFile::IFile(Core::System& system_, FileSys::VirtualFile file_)
-    : ServiceFramework{system_, "IFile"}, backend{std::make_unique<FileSys::Fsa::IFile>(file_)} {
+IFile::IFile(Core::System& system_, FileSys::VirtualFile file_,
+             std::shared_ptr<FileSys::ReadAheadStatistics> read_ahead_statistics)
+    : ServiceFramework{system_, "IFile"},
+      backend{std::make_unique<FileSys::Fsa::IFile>(FileSys::ReadAheadVfsFile::Create(
+          std::move(file_), std::move(read_ahead_statistics)))} {
     // clang-format off
     static const FunctionInfo functions[] = {
         {0, D<&IFile::Read>, "Read"},
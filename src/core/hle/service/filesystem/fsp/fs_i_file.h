@@ -4,6 +4,7 @@
 #pragma once
 
 #include "core/file_sys/fsa/fs_i_file.h"
+#include "core/file_sys/vfs/vfs_read_ahead.h"
 #include "core/hle/service/cmif_types.h"
 #include "core/hle/service/filesystem/filesystem.h"
 #include "core/hle/service/service.h"
@@ -12,7 +13,8 @@ namespace Service::FileSystem {
 
 class IFile final : public ServiceFramework<IFile> {
 public:
-    explicit IFile(Core::System& system_, FileSys::VirtualFile file_);
+    explicit IFile(Core::System& system_, FileSys::VirtualFile file_,
+                   std::shared_ptr<FileSys::ReadAheadStatistics> read_ahead_statistics = {});
 
 private:
     std::unique_ptr<FileSys::Fsa::IFile> backend;
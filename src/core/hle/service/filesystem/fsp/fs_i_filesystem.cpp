@@ -10,10 +10,12 @@
 
 namespace Service::FileSystem {
 
-IFileSystem::IFileSystem(Core::System& system_, FileSys::VirtualDir dir_, SizeGetter size_getter_)
+IFileSystem::IFileSystem(Core::System& system_, FileSys::VirtualDir dir_, SizeGetter size_getter_,
+                         std::shared_ptr<FileSys::ReadAheadStatistics> read_ahead_statistics_)
     : ServiceFramework{system_, "IFileSystem"}, backend{std::make_unique<FileSys::Fsa::IFileSystem>(
                                                     dir_)},
-      size_getter{std::move(size_getter_)} {
+      size_getter{std::move(size_getter_)},
+      read_ahead_statistics{std::move(read_ahead_statistics_)} {
     static const FunctionInfo functions[] = {
         {0, D<&IFileSystem::CreateFile>, "CreateFile"},
         {1, D<&IFileSystem::DeleteFile>, "DeleteFile"},
@@ -94,7 +96,7 @@ Result IFileSystem::OpenFile(OutInterface<IFile> out_interface,
     R_TRY(backend->OpenFile(&vfs_file, FileSys::Path(path->str),
                             static_cast<FileSys::OpenMode>(mode)));
 
-    *out_interface = std::make_shared<IFile>(system, vfs_file);
+    *out_interface = std::make_shared<IFile>(system, vfs_file, read_ahead_statistics);
     R_SUCCEED();
 }
 
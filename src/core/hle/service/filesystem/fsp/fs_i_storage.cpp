@@ -7,8 +7,11 @@
 
 namespace Service::FileSystem {
 
-IStorage::IStorage(Core::System& system_, FileSys::VirtualFile backend_)
-    : ServiceFramework{system_, "IStorage"}, backend(std::move(backend_)) {
+IStorage::IStorage(Core::System& system_, FileSys::VirtualFile backend_,
+                   std::shared_ptr<FileSys::ReadAheadStatistics> read_ahead_statistics)
+    : ServiceFramework{system_, "IStorage"},
+      backend(FileSys::ReadAheadVfsFile::Create(std::move(backend_),
+                                                std::move(read_ahead_statistics))) {
     static const FunctionInfo functions[] = {
         {0, D<&IStorage::Read>, "Read"},
         {1, nullptr, "Write"},
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "core/file_sys/vfs/vfs.h"
+#include "core/file_sys/vfs/vfs_read_ahead.h"
 #include "core/hle/service/cmif_types.h"
 #include "core/hle/service/filesystem/filesystem.h"
 #include "core/hle/service/service.h"
@@ -12,7 +13,8 @@ namespace Service::FileSystem {
 
 class IStorage final : public ServiceFramework<IStorage> {
 public:
-    explicit IStorage(Core::System& system_, FileSys::VirtualFile backend_);
+    explicit IStorage(Core::System& system_, FileSys::VirtualFile backend_,
+                      std::shared_ptr<FileSys::ReadAheadStatistics> read_ahead_statistics = {});
 
 private:
     FileSys::VirtualFile backend;
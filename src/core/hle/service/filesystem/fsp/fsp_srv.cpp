@@ -26,6 +26,7 @@
 #include "core/file_sys/savedata_factory.h"
 #include "core/file_sys/system_archive/system_archive.h"
 #include "core/file_sys/vfs/vfs.h"
+#include "core/file_sys/vfs/vfs_read_ahead.h"
 #include "core/hle/result.h"
 #include "core/hle/service/cmif_serialization.h"
 #include "core/hle/service/filesystem/filesystem.h"
@@ -46,7 +47,8 @@ namespace Service::FileSystem {
 
 FSP_SRV::FSP_SRV(Core::System& system_)
     : ServiceFramework{system_, "fsp-srv"}, fsc{system.GetFileSystemController()},
-      content_provider{system.GetContentProvider()}, reporter{system.GetReporter()} {
+      content_provider{system.GetContentProvider()}, reporter{system.GetReporter()},
+      read_ahead_statistics{std::make_shared<FileSys::ReadAheadStatistics>()} {
     // clang-format off
     static const FunctionInfo functions[] = {
         {0, nullptr, "OpenFileSystem"},
@@ -182,7 +184,20 @@ FSP_SRV::FSP_SRV(Core::System& system_)
     }
 }
 
-FSP_SRV::~FSP_SRV() = default;
+FSP_SRV::~FSP_SRV() {
+    const u64 hits = read_ahead_statistics->hits.load(std::memory_order_relaxed);
+    const u64 misses = read_ahead_statistics->misses.load(std::memory_order_relaxed);
+    if (hits + misses == 0) {
+        return;
+    }
+    LOG_INFO(Service_FS,
+             "Read-ahead for program_id={:016X}: {} of {} sequential reads hit ({:.1f}%), "
+             "{} KiB read ahead, {} ms of reads saved",
+             program_id, hits, hits + misses,
+             100.0 * static_cast<double>(hits) / static_cast<double>(hits + misses),
+             read_ahead_statistics->bytes_prefetched.load(std::memory_order_relaxed) / 1024,
+             read_ahead_statistics->saved_ns.load(std::memory_order_relaxed) / 1'000'000);
+}
 
 Result FSP_SRV::SetCurrentProcess(ClientProcessId pid) {
     current_process_id = *pid;
@@ -209,7 +224,8 @@ Result FSP_SRV::OpenFileSystemWithPatch(OutInterface<IFileSystem> out_interface,
     ASSERT(extracted_romfs != nullptr);
 
     *out_interface = std::make_shared<IFileSystem>(
-        system, extracted_romfs, SizeGetter::FromStorageId(fsc, FileSys::StorageId::NandUser));
+        system, extracted_romfs, SizeGetter::FromStorageId(fsc, FileSys::StorageId::NandUser),
+        read_ahead_statistics);
 
     R_SUCCEED();
 }
@@ -221,7 +237,8 @@ Result FSP_SRV::OpenSdCardFileSystem(OutInterface<IFileSystem> out_interface) {
     fsc.OpenSDMC(&sdmc_dir);
 
     *out_interface = std::make_shared<IFileSystem>(
-        system, sdmc_dir, SizeGetter::FromStorageId(fsc, FileSys::StorageId::SdCard));
+        system, sdmc_dir, SizeGetter::FromStorageId(fsc, FileSys::StorageId::SdCard),
+        read_ahead_statistics);
 
     R_SUCCEED();
 }
@@ -417,7 +434,7 @@ Result FSP_SRV::OpenDataStorageByCurrentProcess(OutInterface<IStorage> out_inter
         romfs = current_romfs;
     }
 
-    *out_interface = std::make_shared<IStorage>(system, romfs);
+    *out_interface = std::make_shared<IStorage>(system, romfs, read_ahead_statistics);
 
     R_SUCCEED();
 }
@@ -449,7 +466,8 @@ Result FSP_SRV::OpenDataStorageByDataId(OutInterface<IStorage> out_interface,
     auto base =
         romfs_controller->OpenBaseNca(title_id, storage_id, FileSys::ContentRecordType::Data);
     auto storage = std::make_shared<IStorage>(
-        system, pm.PatchRomFS(base.get(), std::move(data), FileSys::ContentRecordType::Data));
+        system, pm.PatchRomFS(base.get(), std::move(data), FileSys::ContentRecordType::Data),
+        read_ahead_statistics);
 
     *out_interface = std::move(storage);
     R_SUCCEED();
@@ -476,7 +494,8 @@ Result FSP_SRV::OpenDataStorageWithProgramIndex(OutInterface<IStorage> out_inter
         R_RETURN(ResultUnknown);
     }
 
-    *out_interface = std::make_shared<IStorage>(system, std::move(patched_romfs));
+    *out_interface =
+        std::make_shared<IStorage>(system, std::move(patched_romfs), read_ahead_statistics);
 
     R_SUCCEED();
 }
@@ -16,6 +16,7 @@ class Reporter;
 namespace FileSys {
 class ContentProvider;
 class FileSystemBackend;
+struct ReadAheadStatistics;
 } // namespace FileSys
 
 namespace Service::FileSystem {
@@ -119,6 +120,7 @@ private:
     u64 program_id = 0;
     std::shared_ptr<SaveDataController> save_data_controller;
     std::shared_ptr<RomFsController> romfs_controller;
+    std::shared_ptr<FileSys::ReadAheadStatistics> read_ahead_statistics;
 };
 
 } // namespace Service::FileSystem
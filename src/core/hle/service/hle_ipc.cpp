@@ -134,6 +134,38 @@ HLERequestContext::HLERequestContext(Kernel::KernelCore& kernel_, Core::Memory::
 
 HLERequestContext::~HLERequestContext() = default;
 
+void HLERequestContext::Reset(Kernel::KThread* thread_) {
+    thread = thread_;
+    client_handle_table = nullptr;
+    cmd_buf[0] = 0;
+
+    incoming_move_handles.clear();
+    incoming_copy_handles.clear();
+    outgoing_move_objects.clear();
+    outgoing_copy_objects.clear();
+    outgoing_domain_objects.clear();
+
+    command_header.reset();
+    handle_descriptor_header.reset();
+    data_payload_header.reset();
+    domain_message_header.reset();
+    buffer_x_descriptors.clear();
+    buffer_a_descriptors.clear();
+    buffer_b_descriptors.clear();
+    buffer_w_descriptors.clear();
+    buffer_c_descriptors.clear();
+
+    command = 0;
+    pid = 0;
+    write_size = 0;
+    data_payload_offset = 0;
+    handles_offset = 0;
+    domain_offset = 0;
+
+    manager.reset();
+    is_deferred = false;
+}
+
 void HLERequestContext::ParseCommandBuffer(u32_le* src_cmdbuf, bool incoming) {
     IPC::RequestParser rp(src_cmdbuf);
     command_header = rp.PopRaw<IPC::CommandHeader>();
@@ -152,9 +184,6 @@ void HLERequestContext::ParseCommandBuffer(u32_le* src_cmdbuf, bool incoming) {
         }
         if (incoming) {
             // Populate the object lists with the data in the IPC request.
-            incoming_copy_handles.reserve(handle_descriptor_header->num_handles_to_copy);
-            incoming_move_handles.reserve(handle_descriptor_header->num_handles_to_move);
-
             for (u32 handle = 0; handle < handle_descriptor_header->num_handles_to_copy; ++handle) {
                 incoming_copy_handles.push_back(rp.Pop<Handle>());
             }
@@ -169,11 +198,6 @@ void HLERequestContext::ParseCommandBuffer(u32_le* src_cmdbuf, bool incoming) {
         }
     }
 
-    buffer_x_descriptors.reserve(command_header->num_buf_x_descriptors);
-    buffer_a_descriptors.reserve(command_header->num_buf_a_descriptors);
-    buffer_b_descriptors.reserve(command_header->num_buf_b_descriptors);
-    buffer_w_descriptors.reserve(command_header->num_buf_w_descriptors);
-
     for (u32 i = 0; i < command_header->num_buf_x_descriptors; ++i) {
         buffer_x_descriptors.push_back(rp.PopRaw<IPC::BufferDescriptorX>());
     }
@@ -450,6 +474,46 @@ std::size_t HLERequestContext::WriteBufferC(const void* buffer, std::size_t size
     return size;
 }
 
+std::span<u8> HLERequestContext::GetWriteBufferSpan(std::size_t buffer_index) const {
+    const bool is_buffer_b{BufferDescriptorB().size() > buffer_index &&
+                           BufferDescriptorB()[buffer_index].Size()};
+    if (is_buffer_b) {
+        return GetWriteBufferSpanB(buffer_index);
+    } else {
+        return GetWriteBufferSpanC(buffer_index);
+    }
+}
+
+std::span<u8> HLERequestContext::GetWriteBufferSpanB(std::size_t buffer_index) const {
+    if (buffer_index >= BufferDescriptorB().size()) {
+        return {};
+    }
+    const auto& descriptor = BufferDescriptorB()[buffer_index];
+    return GetDirectWriteSpan(descriptor.Address(), descriptor.Size());
+}
+
+std::span<u8> HLERequestContext::GetWriteBufferSpanC(std::size_t buffer_index) const {
+    if (buffer_index >= BufferDescriptorC().size()) {
+        return {};
+    }
+    const auto& descriptor = BufferDescriptorC()[buffer_index];
+    return GetDirectWriteSpan(descriptor.Address(), descriptor.Size());
+}
+
+std::span<u8> HLERequestContext::GetDirectWriteSpan(VAddr address, u64 size) const {
+    // Writing directly to a buffer that is also an input could clobber it before it is read
+    const auto overlaps = [address, size](const auto& descriptor) {
+        return descriptor.Size() != 0 && address < descriptor.Address() + descriptor.Size() &&
+               descriptor.Address() < address + size;
+    };
+    if (std::ranges::any_of(BufferDescriptorA(), overlaps) ||
+        std::ranges::any_of(BufferDescriptorX(), overlaps)) {
+        return {};
+    }
+    u8* const data = memory.GetUncachedSpan(address, size);
+    return data ? std::span<u8>{data, size} : std::span<u8>{};
+}
+
 std::size_t HLERequestContext::GetReadBufferSize(std::size_t buffer_index) const {
     const bool is_buffer_a{BufferDescriptorA().size() > buffer_index &&
                            BufferDescriptorA()[buffer_index].Size()};
@@ -12,9 +12,12 @@
 #include <type_traits>
 #include <vector>
 
+#include <boost/container/static_vector.hpp>
+
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/concepts.h"
+#include "common/scratch_buffer.h"
 #include "common/swap.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/k_handle_table.h"
@@ -181,10 +184,31 @@ private:
  */
 class HLERequestContext {
 public:
+    /// Most descriptors and handles of each kind that the 4-bit counts of the IPC headers allow
+    static constexpr std::size_t MaxBufferDescriptors = 15;
+    static constexpr std::size_t MaxBufferDescriptorsC = 13;
+    static constexpr std::size_t MaxHandles = 15;
+
+    /// Number of output buffers that CMIF handlers can get scratch memory for
+    static constexpr std::size_t NumOutTemporaryBuffers = 3;
+
+    template <typename T, std::size_t N>
+    using StaticVector = boost::container::static_vector<T, N>;
+
+    using BufferDescriptorXList = StaticVector<IPC::BufferDescriptorX, MaxBufferDescriptors>;
+    using BufferDescriptorABWList = StaticVector<IPC::BufferDescriptorABW, MaxBufferDescriptors>;
+    using BufferDescriptorCList = StaticVector<IPC::BufferDescriptorC, MaxBufferDescriptorsC>;
+
     explicit HLERequestContext(Kernel::KernelCore& kernel, Core::Memory::Memory& memory,
                                Kernel::KServerSession* session, Kernel::KThread* thread);
     ~HLERequestContext();
 
+    /**
+     * Prepares this context for the next request of its session. The buffers of the context are
+     * kept, so that requests do not allocate once they have been seen.
+     */
+    void Reset(Kernel::KThread* thread);
+
     /// Returns a pointer to the IPC command buffer for this request.
     [[nodiscard]] u32* CommandBuffer() {
         return cmd_buf.data();
@@ -233,19 +257,19 @@ public:
         return data_payload_offset;
     }
 
-    [[nodiscard]] const std::vector<IPC::BufferDescriptorX>& BufferDescriptorX() const {
+    [[nodiscard]] const BufferDescriptorXList& BufferDescriptorX() const {
         return buffer_x_descriptors;
     }
 
-    [[nodiscard]] const std::vector<IPC::BufferDescriptorABW>& BufferDescriptorA() const {
+    [[nodiscard]] const BufferDescriptorABWList& BufferDescriptorA() const {
         return buffer_a_descriptors;
     }
 
-    [[nodiscard]] const std::vector<IPC::BufferDescriptorABW>& BufferDescriptorB() const {
+    [[nodiscard]] const BufferDescriptorABWList& BufferDescriptorB() const {
         return buffer_b_descriptors;
     }
 
-    [[nodiscard]] const std::vector<IPC::BufferDescriptorC>& BufferDescriptorC() const {
+    [[nodiscard]] const BufferDescriptorCList& BufferDescriptorC() const {
         return buffer_c_descriptors;
     }
 
@@ -303,6 +327,28 @@ public:
         }
     }
 
+    /**
+     * Helper function to get a span of an output buffer using the appropriate buffer descriptor.
+     * Data written to the span goes directly to guest memory.
+     *
+     * @returns An empty span if the buffer is not contiguous in host memory, is cached by the GPU
+     *          or overlaps an input buffer, in which case the data has to be written with
+     *          WriteBuffer instead.
+     */
+    [[nodiscard]] std::span<u8> GetWriteBufferSpan(std::size_t buffer_index = 0) const;
+
+    /// Helper function to get a span of buffer B, see GetWriteBufferSpan
+    [[nodiscard]] std::span<u8> GetWriteBufferSpanB(std::size_t buffer_index = 0) const;
+
+    /// Helper function to get a span of buffer C, see GetWriteBufferSpan
+    [[nodiscard]] std::span<u8> GetWriteBufferSpanC(std::size_t buffer_index = 0) const;
+
+    /// Returns scratch memory for output buffers, which is kept across requests of the session.
+    [[nodiscard]] std::array<Common::ScratchBuffer<u8>, NumOutTemporaryBuffers>&
+    GetOutTemporaryBuffers() {
+        return out_temporary_buffers;
+    }
+
     /// Helper function to get the size of the input buffer
     [[nodiscard]] std::size_t GetReadBufferSize(std::size_t buffer_index = 0) const;
 
@@ -394,13 +440,15 @@ private:
 
     void ParseCommandBuffer(u32_le* src_cmdbuf, bool incoming);
 
+    std::span<u8> GetDirectWriteSpan(VAddr address, u64 size) const;
+
     std::array<u32, IPC::COMMAND_BUFFER_LENGTH> cmd_buf;
     Kernel::KServerSession* server_session{};
     Kernel::KHandleTable* client_handle_table{};
     Kernel::KThread* thread{};
 
-    std::vector<Handle> incoming_move_handles;
-    std::vector<Handle> incoming_copy_handles;
+    StaticVector<Handle, MaxHandles> incoming_move_handles;
+    StaticVector<Handle, MaxHandles> incoming_copy_handles;
 
     std::vector<Kernel::KAutoObject*> outgoing_move_objects;
     std::vector<Kernel::KAutoObject*> outgoing_copy_objects;
@@ -410,11 +458,11 @@ private:
     std::optional<IPC::HandleDescriptorHeader> handle_descriptor_header;
     std::optional<IPC::DataPayloadHeader> data_payload_header;
     std::optional<IPC::DomainMessageHeader> domain_message_header;
-    std::vector<IPC::BufferDescriptorX> buffer_x_descriptors;
-    std::vector<IPC::BufferDescriptorABW> buffer_a_descriptors;
-    std::vector<IPC::BufferDescriptorABW> buffer_b_descriptors;
-    std::vector<IPC::BufferDescriptorABW> buffer_w_descriptors;
-    std::vector<IPC::BufferDescriptorC> buffer_c_descriptors;
+    BufferDescriptorXList buffer_x_descriptors;
+    BufferDescriptorABWList buffer_a_descriptors;
+    BufferDescriptorABWList buffer_b_descriptors;
+    BufferDescriptorABWList buffer_w_descriptors;
+    BufferDescriptorCList buffer_c_descriptors;
 
     u32_le command{};
     u64 pid{};
@@ -431,6 +479,7 @@ private:
 
     mutable std::array<Common::ScratchBuffer<u8>, 3> read_buffer_data_a{};
     mutable std::array<Common::ScratchBuffer<u8>, 3> read_buffer_data_x{};
+    std::array<Common::ScratchBuffer<u8>, NumOutTemporaryBuffers> out_temporary_buffers{};
 };
 
 } // namespace Service
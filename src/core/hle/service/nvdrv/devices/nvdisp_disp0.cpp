@@ -80,10 +80,14 @@ void nvdisp_disp0::Composite(std::span<const Nvnflinger::HwcLayer> sorted_layers
         }
     }
 
+    auto& perf_stats = system.GetPerfStats();
+    const auto composite_begin = Core::PerfStats::Clock::now();
     system.GPU().RequestComposite(std::move(output_layers), std::move(output_fences));
+    perf_stats.AddGpuWaitTime(Core::PerfStats::Clock::now() - composite_begin);
+
     system.SpeedLimiter().DoSpeedLimiting(system.CoreTiming().GetGlobalTimeUs());
-    system.GetPerfStats().EndSystemFrame();
-    system.GetPerfStats().BeginSystemFrame();
+    perf_stats.EndSystemFrame(system.CoreTiming().GetGlobalTimeUs());
+    perf_stats.BeginSystemFrame();
 }
 
 Kernel::KEvent* nvdisp_disp0::QueryEvent(u32 event_id) {
@@ -234,18 +234,34 @@ AppLoader_DeconstructedRomDirectory::LoadResult AppLoader_DeconstructedRomDirect
     VAddr next_load_addr{base_address};
     const FileSys::PatchManager pm{metadata.GetTitleID(), system.GetFileSystemController(),
                                    system.GetContentProvider()};
+
+    // Decompress and patch the images of all modules at once, they only get relocated in order
+    std::array<NSOModuleSource, static_modules.size()> module_sources;
+    for (size_t i = 0; i < static_modules.size(); i++) {
+        module_sources[i] = NSOModuleSource{
+            .file = dir->GetFile(static_modules[i]),
+            .should_pass_arguments = std::strcmp(static_modules[i], "rtld") == 0,
+            .patch_index = patch_ctx.GetIndex(i),
+        };
+    }
+    auto module_images =
+        AppLoader_NSO::LoadModuleImages(module_sources, &pm, patch_ctx.GetPatchers());
+
     for (size_t i = 0; i < static_modules.size(); i++) {
         const auto& module = static_modules[i];
-        const FileSys::VirtualFile module_file{dir->GetFile(module)};
+        const FileSys::VirtualFile& module_file{module_sources[i].file};
         if (!module_file) {
             continue;
         }
+        if (!module_images[i]) {
+            return {ResultStatus::ErrorLoadingNSO, {}};
+        }
 
         const VAddr load_addr{next_load_addr};
-        const bool should_pass_arguments = std::strcmp(module, "rtld") == 0;
         const auto tentative_next_load_addr = AppLoader_NSO::LoadModule(
-            process, system, *module_file, load_addr, should_pass_arguments, true, pm,
-            patch_ctx.GetPatchers(), patch_ctx.GetIndex(i));
+            process, system, *module_file, load_addr, module_sources[i].should_pass_arguments,
+            true, pm, patch_ctx.GetPatchers(), patch_ctx.GetIndex(i),
+            std::move(module_images[i]));
         if (!tentative_next_load_addr) {
             return {ResultStatus::ErrorLoadingNSO, {}};
         }
@@ -1,16 +1,23 @@
 // SPDX-FileCopyrightText: Copyright 2018 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
+#include <filesystem>
+#include <span>
+#include <thread>
 #include <vector>
 
 #include "common/common_funcs.h"
+#include "common/fs/path_util.h"
 #include "common/hex_util.h"
 #include "common/logging/log.h"
 #include "common/lz4_compression.h"
 #include "common/settings.h"
 #include "common/swap.h"
+#include "common/thread_worker.h"
+#include "core/arm/jit_profile.h"
 #include "core/core.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/hle/kernel/code_set.h"
@@ -18,6 +25,7 @@
 #include "core/hle/kernel/k_process.h"
 #include "core/hle/kernel/k_thread.h"
 #include "core/loader/nso.h"
+#include "core/loader/nso_image_cache.h"
 #include "core/memory.h"
 
 #ifdef HAS_NCE
@@ -37,53 +45,40 @@ struct MODHeader {
 };
 static_assert(sizeof(MODHeader) == 0x1c, "MODHeader has incorrect size.");
 
-std::vector<u8> DecompressSegment(const std::vector<u8>& compressed_data,
-                                  const NSOSegmentHeader& header) {
-    std::vector<u8> uncompressed_data =
-        Common::Compression::DecompressDataLZ4(compressed_data, header.size);
-
-    ASSERT_MSG(uncompressed_data.size() == header.size, "{} != {}", header.size,
-               uncompressed_data.size());
-
-    return uncompressed_data;
-}
-
 constexpr u32 PageAlignSize(u32 size) {
     return static_cast<u32>((size + Core::Memory::SUYU_PAGEMASK) & ~Core::Memory::SUYU_PAGEMASK);
 }
-} // Anonymous namespace
 
-bool NSOHeader::IsSegmentCompressed(size_t segment_num) const {
-    ASSERT_MSG(segment_num < 3, "Invalid segment {}", segment_num);
-    return ((flags >> segment_num) & 1) != 0;
+Common::ThreadWorker& GetWorkers() {
+    static Common::ThreadWorker workers(std::max(std::thread::hardware_concurrency(), 1U),
+                                        "NSOLoader");
+    return workers;
 }
 
-AppLoader_NSO::AppLoader_NSO(FileSys::VirtualFile file_) : AppLoader(std::move(file_)) {}
-
-FileType AppLoader_NSO::IdentifyType(const FileSys::VirtualFile& in_file) {
-    u32 magic = 0;
-    if (in_file->ReadObject(&magic) != sizeof(magic)) {
-        return FileType::Error;
-    }
-
-    if (Common::MakeMagic('N', 'S', 'O', '0') != magic) {
-        return FileType::Error;
+/// Allocates some space at the beginning of the image if we are patching in PreText mode.
+size_t GetModuleStart([[maybe_unused]] std::vector<Core::NCE::Patcher>* patches,
+                      [[maybe_unused]] s32 patch_index,
+                      [[maybe_unused]] bool load_into_process) {
+#ifdef HAS_NCE
+    if (patches && load_into_process) {
+        auto* patch = &patches->operator[](patch_index);
+        if (patch->GetPatchMode() == Core::NCE::PatchMode::PreText) {
+            return patch->GetSectionSize();
+        }
     }
-
-    return FileType::NSO;
+#endif
+    return 0;
 }
 
-std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::KProcess& process, Core::System& system,
-                                               const FileSys::VfsFile& nso_file, VAddr load_base,
-                                               bool should_pass_arguments, bool load_into_process,
-                                               std::optional<FileSys::PatchManager> pm,
-                                               std::vector<Core::NCE::Patcher>* patches,
-                                               s32 patch_index) {
+/// Reads the header of an NSO and lays out its program image, leaving the segments to be loaded.
+std::optional<NSOModuleImage> PrepareImage(const FileSys::VfsFile& nso_file, size_t module_start,
+                                           bool should_pass_arguments) {
     if (nso_file.GetSize() < sizeof(NSOHeader)) {
         return std::nullopt;
     }
 
-    NSOHeader nso_header{};
+    NSOModuleImage image;
+    NSOHeader& nso_header = image.header;
     if (sizeof(NSOHeader) != nso_file.ReadObject(&nso_header)) {
         return std::nullopt;
     }
@@ -92,36 +87,21 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::KProcess& process, Core::
         return std::nullopt;
     }
 
-    // Allocate some space at the beginning if we are patching in PreText mode.
-    const size_t module_start = [&]() -> size_t {
-#ifdef HAS_NCE
-        if (patches && load_into_process) {
-            auto* patch = &patches->operator[](patch_index);
-            if (patch->GetPatchMode() == Core::NCE::PatchMode::PreText) {
-                return patch->GetSectionSize();
-            }
-        }
-#endif
-        return 0;
-    }();
-
     // Build program image
-    Kernel::CodeSet codeset;
-    Kernel::PhysicalMemory program_image;
+    image.module_start = module_start;
+    Kernel::CodeSet& codeset = image.codeset;
+    Kernel::PhysicalMemory& program_image = image.program_image;
+    size_t segments_end = module_start;
     for (std::size_t i = 0; i < nso_header.segments.size(); ++i) {
-        std::vector<u8> data = nso_file.ReadBytes(nso_header.segments_compressed_size[i],
-                                                  nso_header.segments[i].offset);
-        if (nso_header.IsSegmentCompressed(i)) {
-            data = DecompressSegment(data, nso_header.segments[i]);
-        }
-        program_image.resize(module_start + nso_header.segments[i].location +
-                             static_cast<u32>(data.size()));
-        std::memcpy(program_image.data() + module_start + nso_header.segments[i].location,
-                    data.data(), data.size());
-        codeset.segments[i].addr = module_start + nso_header.segments[i].location;
-        codeset.segments[i].offset = module_start + nso_header.segments[i].location;
-        codeset.segments[i].size = nso_header.segments[i].size;
+        const auto& segment = nso_header.segments[i];
+        const u32 size = nso_header.IsSegmentCompressed(i) ? segment.size
+                                                           : nso_header.segments_compressed_size[i];
+        segments_end = std::max<size_t>(segments_end, module_start + segment.location + size);
+        codeset.segments[i].addr = module_start + segment.location;
+        codeset.segments[i].offset = module_start + segment.location;
+        codeset.segments[i].size = segment.size;
     }
+    program_image.resize(segments_end);
 
     if (should_pass_arguments && !Settings::values.program_args.GetValue().empty()) {
         const auto arg_data{Settings::values.program_args.GetValue()};
@@ -138,28 +118,190 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::KProcess& process, Core::
     }
 
     codeset.DataSegment().size += nso_header.segments[2].bss_size;
-    u32 image_size{
-        PageAlignSize(static_cast<u32>(program_image.size()) + nso_header.segments[2].bss_size)};
-    program_image.resize(image_size);
+    program_image.resize(
+        PageAlignSize(static_cast<u32>(program_image.size()) + nso_header.segments[2].bss_size));
 
     for (std::size_t i = 0; i < nso_header.segments.size(); ++i) {
         codeset.segments[i].size = PageAlignSize(codeset.segments[i].size);
     }
+    return image;
+}
+
+/// Loads a segment of an NSO into its place in the program image.
+bool LoadSegment(const FileSys::VfsFile& nso_file, NSOModuleImage& image, size_t segment_index) {
+    const NSOHeader& nso_header = image.header;
+    const NSOSegmentHeader& segment = nso_header.segments[segment_index];
+    const u32 compressed_size = nso_header.segments_compressed_size[segment_index];
+    u8* const dest = image.program_image.data() + image.module_start + segment.location;
+    if (!nso_header.IsSegmentCompressed(segment_index)) {
+        nso_file.Read(dest, compressed_size, segment.offset);
+        return true;
+    }
+
+    // Decompress straight from the mapped file when there is one
+    const auto mapped = nso_file.GetMappedSpan();
+    std::vector<u8> compressed_data;
+    std::span<const u8> compressed;
+    if (segment.offset <= mapped.size() && compressed_size <= mapped.size() - segment.offset) {
+        compressed = mapped.subspan(segment.offset, compressed_size);
+    } else {
+        compressed_data = nso_file.ReadBytes(compressed_size, segment.offset);
+        compressed = compressed_data;
+    }
+    const int size = Common::Compression::DecompressDataLZ4(dest, segment.size, compressed.data(),
+                                                            compressed.size());
+    if (size != static_cast<int>(segment.size)) {
+        LOG_ERROR(Loader, "Failed to decompress segment {} of {}: {} != {}", segment_index,
+                  nso_file.GetName(), segment.size, size);
+        return false;
+    }
+    return true;
+}
+
+std::span<u8> GetPatchableSection(NSOModuleImage& image) {
+    return std::span{image.program_image}.subspan(image.module_start);
+}
+
+void PatchImage(NSOModuleImage& image, const FileSys::PatchManager& pm, const std::string& name) {
+    const auto patchable_section = GetPatchableSection(image);
+    std::vector<u8> pi_header(sizeof(NSOHeader) + patchable_section.size());
+    std::memcpy(pi_header.data(), &image.header, sizeof(NSOHeader));
+    std::memcpy(pi_header.data() + sizeof(NSOHeader), patchable_section.data(),
+                patchable_section.size());
+
+    pi_header = pm.PatchNSO(pi_header, name);
+
+    const size_t patched_size =
+        std::min(pi_header.size() - sizeof(NSOHeader), patchable_section.size());
+    std::copy_n(pi_header.begin() + sizeof(NSOHeader), patched_size, patchable_section.data());
+}
+
+/// Module of BuildImages, with the offset of the module in its program image
+struct ImageRequest {
+    const FileSys::VfsFile* file;
+    size_t module_start;
+    bool should_pass_arguments;
+};
+
+/**
+ * Builds the program images of NSO modules, loading the segments of all modules in parallel, then
+ * applying the NSO patches of the patch manager. Patched images are read from the NSO cache when
+ * it has them, and written to it otherwise.
+ */
+std::vector<std::optional<NSOModuleImage>> BuildImages(std::span<const ImageRequest> requests,
+                                                       const FileSys::PatchManager* pm) {
+    std::vector<std::optional<NSOModuleImage>> images(requests.size());
+    std::vector<std::optional<u64>> patch_hashes(requests.size());
+    std::vector<u8> is_cached(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (requests[i].file != nullptr) {
+            images[i] = PrepareImage(*requests[i].file, requests[i].module_start,
+                                     requests[i].should_pass_arguments);
+        }
+    }
 
-    // Apply patches if necessary
-    const auto name = nso_file.GetName();
-    if (pm && (pm->HasNSOPatch(nso_header.build_id, name) || Settings::values.dump_nso)) {
-        std::span<u8> patchable_section(program_image.data() + module_start,
-                                        program_image.size() - module_start);
-        std::vector<u8> pi_header(sizeof(NSOHeader) + patchable_section.size());
-        std::memcpy(pi_header.data(), &nso_header, sizeof(NSOHeader));
-        std::memcpy(pi_header.data() + sizeof(NSOHeader), patchable_section.data(),
-                    patchable_section.size());
+    // Patches are looked up serially as the patch manager may create the mod directories, only
+    // reading the cached images is done in parallel. Dumping NSOs needs PatchNSO to run.
+    auto& workers = GetWorkers();
+    const bool use_cache = pm && !Settings::values.dump_nso;
+    const NSOImageCache cache{Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) / "nso"};
+    for (size_t i = 0; i < requests.size() && use_cache; ++i) {
+        if (!images[i]) {
+            continue;
+        }
+        patch_hashes[i] = pm->GetNSOPatchHash(images[i]->header.build_id);
+        if (patch_hashes[i]) {
+            workers.QueueWork([&, i] {
+                is_cached[i] = cache.Read(images[i]->header, *patch_hashes[i],
+                                          GetPatchableSection(*images[i]));
+            });
+        }
+    }
+    workers.WaitForRequests();
 
-        pi_header = pm->PatchNSO(pi_header, name);
+    std::vector<u8> is_loaded(requests.size() * 3, 1);
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (!images[i] || is_cached[i]) {
+            continue;
+        }
+        for (size_t segment = 0; segment < 3; ++segment) {
+            workers.QueueWork([&, i, segment] {
+                is_loaded[i * 3 + segment] = LoadSegment(*requests[i].file, *images[i], segment);
+            });
+        }
+    }
+    workers.WaitForRequests();
 
-        std::copy(pi_header.begin() + sizeof(NSOHeader), pi_header.end(), patchable_section.data());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (!images[i]) {
+            continue;
+        }
+        if (!is_loaded[i * 3] || !is_loaded[i * 3 + 1] || !is_loaded[i * 3 + 2]) {
+            images[i].reset();
+            continue;
+        }
+        if (is_cached[i] || !pm || (use_cache && !patch_hashes[i])) {
+            continue;
+        }
+        PatchImage(*images[i], *pm, requests[i].file->GetName());
+        if (patch_hashes[i]) {
+            cache.Write(images[i]->header, *patch_hashes[i], GetPatchableSection(*images[i]));
+        }
     }
+    return images;
+}
+} // Anonymous namespace
+
+bool NSOHeader::IsSegmentCompressed(size_t segment_num) const {
+    ASSERT_MSG(segment_num < 3, "Invalid segment {}", segment_num);
+    return ((flags >> segment_num) & 1) != 0;
+}
+
+AppLoader_NSO::AppLoader_NSO(FileSys::VirtualFile file_) : AppLoader(std::move(file_)) {}
+
+FileType AppLoader_NSO::IdentifyType(const FileSys::VirtualFile& in_file) {
+    u32 magic = 0;
+    if (in_file->ReadObject(&magic) != sizeof(magic)) {
+        return FileType::Error;
+    }
+
+    if (Common::MakeMagic('N', 'S', 'O', '0') != magic) {
+        return FileType::Error;
+    }
+
+    return FileType::NSO;
+}
+
+std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::KProcess& process, Core::System& system,
+                                               const FileSys::VfsFile& nso_file, VAddr load_base,
+                                               bool should_pass_arguments, bool load_into_process,
+                                               std::optional<FileSys::PatchManager> pm,
+                                               std::vector<Core::NCE::Patcher>* patches,
+                                               s32 patch_index,
+                                               std::optional<NSOModuleImage> image) {
+    const size_t module_start = GetModuleStart(patches, patch_index, load_into_process);
+    if (!image) {
+        const ImageRequest request{
+            .file = &nso_file,
+            .module_start = module_start,
+            .should_pass_arguments = should_pass_arguments,
+        };
+        if (!load_into_process && patches == nullptr) {
+            // Only the size of the image is needed to compute the process code layout
+            image = PrepareImage(nso_file, module_start, should_pass_arguments);
+        } else {
+            image = std::move(BuildImages({&request, 1}, pm ? &*pm : nullptr)[0]);
+        }
+        if (!image) {
+            return std::nullopt;
+        }
+    }
+    ASSERT(image->module_start == module_start);
+
+    const NSOHeader& nso_header = image->header;
+    Kernel::CodeSet& codeset = image->codeset;
+    Kernel::PhysicalMemory& program_image = image->program_image;
+    u32 image_size{static_cast<u32>(program_image.size())};
 
 #ifdef HAS_NCE
     // If we are computing the process code layout and using nce backend, patch.
@@ -199,6 +341,12 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::KProcess& process, Core::
         }
     }
 
+    if (Settings::values.cpu_jit_profile.GetValue() && process.IsApplication()) {
+        const auto& code_segment = codeset.CodeSegment();
+        system.GetJitProfile().RegisterModule(
+            nso_header.build_id, load_base + GetInteger(code_segment.addr), code_segment.size);
+    }
+
     // Load codeset for current process
     codeset.memory = std::move(program_image);
     process.LoadModule(std::move(codeset), load_base);
@@ -206,6 +354,21 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::KProcess& process, Core::
     return load_base + image_size;
 }
 
+std::vector<std::optional<NSOModuleImage>> AppLoader_NSO::LoadModuleImages(
+    std::span<const NSOModuleSource> sources, const FileSys::PatchManager* pm,
+    std::vector<Core::NCE::Patcher>* patches) {
+    std::vector<ImageRequest> requests;
+    requests.reserve(sources.size());
+    for (const NSOModuleSource& source : sources) {
+        requests.push_back(ImageRequest{
+            .file = source.file.get(),
+            .module_start = source.file ? GetModuleStart(patches, source.patch_index, true) : 0,
+            .should_pass_arguments = source.should_pass_arguments,
+        });
+    }
+    return BuildImages(requests, pm);
+}
+
 AppLoader_NSO::LoadResult AppLoader_NSO::Load(Kernel::KProcess& process, Core::System& system) {
     if (is_loaded) {
         return {ResultStatus::ErrorAlreadyLoaded, {}};
@@ -5,10 +5,13 @@
 
 #include <array>
 #include <optional>
+#include <span>
 #include <type_traits>
+#include <vector>
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/file_sys/patch_manager.h"
+#include "core/hle/kernel/code_set.h"
 #include "core/loader/loader.h"
 
 namespace Core {
@@ -71,6 +74,22 @@ struct NSOArgumentHeader {
 };
 static_assert(sizeof(NSOArgumentHeader) == 0x20, "NSOArgumentHeader has incorrect size.");
 
+/// Program image of an NSO module, with its segments loaded and its NSO patches applied
+struct NSOModuleImage {
+    NSOHeader header{};
+    Kernel::CodeSet codeset;
+    Kernel::PhysicalMemory program_image;
+    /// Offset of the module in the program image, past the NCE patch section in PreText mode
+    size_t module_start{};
+};
+
+/// NSO module to build the program image of with AppLoader_NSO::LoadModuleImages
+struct NSOModuleSource {
+    FileSys::VirtualFile file;
+    bool should_pass_arguments;
+    s32 patch_index;
+};
+
 /// Loads an NSO file
 class AppLoader_NSO final : public AppLoader {
 public:
@@ -94,7 +113,23 @@ public:
                                            bool should_pass_arguments, bool load_into_process,
                                            std::optional<FileSys::PatchManager> pm = {},
                                            std::vector<Core::NCE::Patcher>* patches = nullptr,
-                                           s32 patch_index = -1);
+                                           s32 patch_index = -1,
+                                           std::optional<NSOModuleImage> image = {});
+
+    /**
+     * Builds the program images of several NSO modules ahead of LoadModule, decompressing the
+     * segments of every module in parallel. Patched images are stored in a cache keyed by the
+     * build ID and the patches, so later boots read them instead of patching the modules again.
+     *
+     * @param sources Modules to build, a source with no file gets no image
+     * @param pm Patch manager applying the NSO patches, or nullptr to load the modules unpatched
+     * @param patches NCE patchers of the modules, or nullptr
+     * @returns The image of every source, to pass to LoadModule with load_into_process set, or
+     *          std::nullopt for the modules that failed to load.
+     */
+    static std::vector<std::optional<NSOModuleImage>> LoadModuleImages(
+        std::span<const NSOModuleSource> sources, const FileSys::PatchManager* pm,
+        std::vector<Core::NCE::Patcher>* patches);
 
     LoadResult Load(Kernel::KProcess& process, Core::System& system) override;
 
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/hex_util.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
+#include "core/file_sys/content_index.h"
+#include "core/loader/nso.h"
+#include "core/loader/nso_image_cache.h"
+
+namespace Loader {
+namespace {
+constexpr u32 NSO_IMAGE_CACHE_MAGIC = Common::MakeMagic('S', 'N', 'S', 'O');
+
+/// Bumped whenever the layout of the cached images changes
+constexpr u32 NSO_IMAGE_CACHE_VERSION = 1;
+
+/// Prefix of the file names of the images of a build ID
+std::string GetFilePrefix(const NSOHeader& header) {
+    return fmt::format("{}_", Common::HexToString(header.build_id));
+}
+} // Anonymous namespace
+
+NSOImageCache::NSOImageCache(std::filesystem::path directory_) : directory{std::move(directory_)} {}
+
+bool NSOImageCache::Read(const NSOHeader& header, u64 patch_hash, std::span<u8> section) const {
+    Common::FS::IOFile file{GetPath(header, patch_hash), Common::FS::FileAccessMode::Read,
+                            Common::FS::FileType::BinaryFile};
+    if (!file.IsOpen()) {
+        return false;
+    }
+    std::array<u8, sizeof(u32) * 2 + sizeof(u64)> header_data{};
+    if (file.ReadSpan(std::span<u8>{header_data}) != header_data.size()) {
+        return false;
+    }
+    FileSys::ContentIndexReader reader{header_data};
+    if (reader.Read<u32>() != NSO_IMAGE_CACHE_MAGIC ||
+        reader.Read<u32>() != NSO_IMAGE_CACHE_VERSION || reader.Read<u64>() != section.size()) {
+        return false;
+    }
+    return file.ReadSpan(section) == section.size();
+}
+
+void NSOImageCache::Write(const NSOHeader& header, u64 patch_hash,
+                          std::span<const u8> section) const {
+    const auto path = GetPath(header, patch_hash);
+    if (!Common::FS::CreateDirs(directory)) {
+        LOG_ERROR(Loader, "Failed to create the NSO cache directory {}",
+                  Common::FS::PathToUTF8String(directory));
+        return;
+    }
+    FileSys::ContentIndexWriter writer;
+    writer.Write(NSO_IMAGE_CACHE_MAGIC);
+    writer.Write(NSO_IMAGE_CACHE_VERSION);
+    writer.Write(static_cast<u64>(section.size()));
+    const auto header_data = writer.Release();
+
+    auto temp_path = path;
+    temp_path += ".tmp";
+    bool is_written{};
+    {
+        Common::FS::IOFile file{temp_path, Common::FS::FileAccessMode::Write,
+                                Common::FS::FileType::BinaryFile};
+        is_written = file.IsOpen() &&
+                     file.WriteSpan(std::span{header_data}) == header_data.size() &&
+                     file.WriteSpan(section) == section.size();
+    }
+    std::error_code ec;
+    if (is_written) {
+        std::filesystem::rename(temp_path, path, ec);
+    }
+    if (!is_written || ec) {
+        LOG_ERROR(Loader, "Failed to write the NSO cache {}", Common::FS::PathToUTF8String(path));
+        Common::FS::RemoveFile(temp_path);
+        return;
+    }
+    RemoveOtherImages(header, path);
+}
+
+std::filesystem::path NSOImageCache::GetPath(const NSOHeader& header, u64 patch_hash) const {
+    // The image also depends on the header and on the program arguments it may contain
+    const auto& args = Settings::values.program_args.GetValue();
+    u64 key = Common::CityHash64WithSeed(reinterpret_cast<const char*>(&header), sizeof(NSOHeader),
+                                         patch_hash);
+    key = Common::CityHash64WithSeed(args.data(), args.size(), key);
+    return directory / fmt::format("{}{:016X}.bin", GetFilePrefix(header), key);
+}
+
+void NSOImageCache::RemoveOtherImages(const NSOHeader& header,
+                                      const std::filesystem::path& keep) const {
+    const std::string prefix = GetFilePrefix(header);
+    std::error_code ec;
+    for (const auto& file : std::filesystem::directory_iterator(directory, ec)) {
+        const auto& path = file.path();
+        if (path != keep && Common::FS::PathToUTF8String(path.filename()).starts_with(prefix)) {
+            Common::FS::RemoveFile(path);
+        }
+    }
+}
+
+} // namespace Loader
@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include "common/common_types.h"
+
+namespace Loader {
+
+struct NSOHeader;
+
+/// On-disk cache of the patched program images of NSO modules.
+///
+/// Images are keyed by the build ID of the module, a hash of the NSO patches applied to it, its
+/// header and the program arguments passed to it. A module only keeps the image of the patches it
+/// was last loaded with, writing an image removes the images of the same build ID.
+class NSOImageCache {
+public:
+    explicit NSOImageCache(std::filesystem::path directory_);
+
+    /// Reads the patched image of a module
+    /// @return True on success, false if it's not cached or its size doesn't match the section
+    bool Read(const NSOHeader& header, u64 patch_hash, std::span<u8> section) const;
+
+    /// Writes the patched image of a module, replacing the ones made with other patches
+    void Write(const NSOHeader& header, u64 patch_hash, std::span<const u8> section) const;
+
+private:
+    std::filesystem::path GetPath(const NSOHeader& header, u64 patch_hash) const;
+
+    /// Removes the images of a build ID other than the given one
+    void RemoveOtherImages(const NSOHeader& header, const std::filesystem::path& keep) const;
+
+    std::filesystem::path directory;
+};
+
+} // namespace Loader
@@ -351,6 +351,29 @@ struct Memory::Impl {
         return nullptr;
     }
 
+    u8* GetUncachedSpan(VAddr src_addr, const std::size_t size) {
+        src_addr &= 0xffffffffffffULL;
+        if (size == 0 || !AddressSpaceContains(*current_page_table, src_addr, size)) {
+            return nullptr;
+        }
+        // Pages of a contiguous host allocation store the same base pointer, while cached and
+        // unmapped pages store none.
+        const u64 first_page = src_addr >> SUYU_PAGEBITS;
+        const u64 last_page = (src_addr + size - 1) >> SUYU_PAGEBITS;
+        const uintptr_t base = Common::PageTable::PageInfo::ExtractPointer(
+            current_page_table->pointers[first_page].Raw());
+        if (base == 0) {
+            return nullptr;
+        }
+        for (u64 page = first_page + 1; page <= last_page; ++page) {
+            if (Common::PageTable::PageInfo::ExtractPointer(
+                    current_page_table->pointers[page].Raw()) != base) {
+                return nullptr;
+            }
+        }
+        return reinterpret_cast<u8*>(base + src_addr);
+    }
+
     template <bool UNSAFE>
     bool WriteBlockImpl(const Common::ProcessAddress dest_addr, const void* src_buffer,
                         const std::size_t size) {
@@ -1033,6 +1056,10 @@ u8* Memory::GetSpan(const VAddr src_addr, const std::size_t size) {
     return impl->GetSpan(src_addr, size);
 }
 
+u8* Memory::GetUncachedSpan(const VAddr src_addr, const std::size_t size) {
+    return impl->GetUncachedSpan(src_addr, size);
+}
+
 bool Memory::WriteBlock(const Common::ProcessAddress dest_addr, const void* src_buffer,
                         const std::size_t size) {
     return impl->WriteBlock(dest_addr, src_buffer, size);
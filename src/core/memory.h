@@ -371,6 +371,15 @@ public:
     const u8* GetSpan(const VAddr src_addr, const std::size_t size) const;
     u8* GetSpan(const VAddr src_addr, const std::size_t size);
 
+    /**
+     * Gets a pointer to a block of memory that can be written directly, without the notification
+     * of GPU cached regions done by WriteBlock.
+     *
+     * @returns The pointer, or nullptr if the block is not contiguous in host memory or any of its
+     *          pages is cached by the GPU.
+     */
+    u8* GetUncachedSpan(const VAddr src_addr, const std::size_t size);
+
     /**
      * Writes a range of bytes into the current process' address space at the specified
      * virtual address.
@@ -57,15 +57,25 @@ void PerfStats::BeginSystemFrame() {
     frame_begin = Clock::now();
 }
 
-void PerfStats::EndSystemFrame() {
+void PerfStats::EndSystemFrame(microseconds current_system_time_us) {
     std::scoped_lock lock{object_mutex};
 
     auto frame_end = Clock::now();
     const auto frame_time = frame_end - frame_begin;
+    const double frame_time_ms = std::chrono::duration<double, std::milli>(frame_time).count();
     if (current_index < perf_history.size()) {
-        perf_history[current_index++] =
-            std::chrono::duration<double, std::milli>(frame_time).count();
+        perf_history[current_index++] = frame_time_ms;
     }
+    if (is_recording_frames) {
+        frame_records.push_back(PerfStatsFrame{
+            .system_time_us = current_system_time_us.count(),
+            .frametime_ms = frame_time_ms,
+            .gpu_wait_ms = std::chrono::duration<double, std::milli>(frame_gpu_wait).count(),
+            .present_ms = std::chrono::duration<double, std::milli>(frame_present).count(),
+        });
+    }
+    frame_gpu_wait = Clock::duration::zero();
+    frame_present = Clock::duration::zero();
     accumulated_frametime += frame_time;
     system_frames += 1;
 
@@ -77,6 +87,43 @@ void PerfStats::EndGameFrame() {
     game_frames.fetch_add(1, std::memory_order_relaxed);
 }
 
+void PerfStats::AddGpuWaitTime(Clock::duration duration) {
+    std::scoped_lock lock{object_mutex};
+
+    frame_gpu_wait += duration;
+}
+
+void PerfStats::AddPresentTime(Clock::duration duration) {
+    std::scoped_lock lock{object_mutex};
+
+    frame_present += duration;
+}
+
+void PerfStats::StartFrameRecording() {
+    std::scoped_lock lock{object_mutex};
+
+    frame_records.clear();
+    is_recording_frames = true;
+}
+
+void PerfStats::StopFrameRecording() {
+    std::scoped_lock lock{object_mutex};
+
+    is_recording_frames = false;
+}
+
+std::size_t PerfStats::GetRecordedFrameCount() const {
+    std::scoped_lock lock{object_mutex};
+
+    return frame_records.size();
+}
+
+std::vector<PerfStatsFrame> PerfStats::GetRecordedFrames() const {
+    std::scoped_lock lock{object_mutex};
+
+    return frame_records;
+}
+
 double PerfStats::GetMeanFrametime() const {
     std::scoped_lock lock{object_mutex};
 
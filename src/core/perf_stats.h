@@ -8,6 +8,7 @@
 #include <chrono>
 #include <cstddef>
 #include <mutex>
+#include <vector>
 #include "common/common_types.h"
 
 namespace Core {
@@ -23,6 +24,17 @@ struct PerfStatsResults {
     double emulation_speed;
 };
 
+struct PerfStatsFrame {
+    /// Emulated time at the end of the system frame, in microseconds
+    s64 system_time_us;
+    /// Walltime of the system frame, in milliseconds
+    double frametime_ms;
+    /// Walltime spent waiting for the GPU to accept the composition, in milliseconds
+    double gpu_wait_ms;
+    /// Walltime spent by the renderer composing and presenting during the frame, in milliseconds
+    double present_ms;
+};
+
 /**
  * Class to manage and query performance/timing statistics. All public functions of this class are
  * thread-safe unless stated otherwise.
@@ -35,9 +47,14 @@ public:
     using Clock = std::chrono::steady_clock;
 
     void BeginSystemFrame();
-    void EndSystemFrame();
+    void EndSystemFrame(std::chrono::microseconds current_system_time_us);
     void EndGameFrame();
 
+    /// Adds time the current system frame spent waiting for the GPU
+    void AddGpuWaitTime(Clock::duration duration);
+    /// Adds time the renderer spent composing and presenting, can be called from any thread
+    void AddPresentTime(Clock::duration duration);
+
     PerfStatsResults GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
     /**
@@ -51,6 +68,21 @@ public:
      */
     double GetLastFrameTimeScale() const;
 
+    /**
+     * Starts keeping the times of every following system frame, discarding any previous records.
+     * This is meant for benchmarks, the records grow without bound until recording is stopped.
+     */
+    void StartFrameRecording();
+
+    /// Stops keeping the times of system frames, the existing records are kept
+    void StopFrameRecording();
+
+    /// Returns the number of system frames recorded since recording was started
+    std::size_t GetRecordedFrameCount() const;
+
+    /// Returns the times of the system frames recorded since recording was started
+    std::vector<PerfStatsFrame> GetRecordedFrames() const;
+
 private:
     mutable std::mutex object_mutex;
 
@@ -82,6 +114,15 @@ private:
     Clock::duration previous_frame_length = Clock::duration::zero();
     /// Previously computed fps
     double previous_fps = 0;
+
+    /// Time spent waiting for the GPU during the current system frame
+    Clock::duration frame_gpu_wait = Clock::duration::zero();
+    /// Time spent presenting since the previous system frame ended
+    Clock::duration frame_present = Clock::duration::zero();
+    /// Whether system frames are being recorded into frame_records
+    bool is_recording_frames = false;
+    /// Times of every system frame since recording was started
+    std::vector<PerfStatsFrame> frame_records;
 };
 
 class SpeedLimiter {
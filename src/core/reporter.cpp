@@ -118,9 +118,8 @@ json GetFullDataAuto(const std::string& timestamp, u64 title_id, Core::System& s
     return out;
 }
 
-template <bool read_value, typename DescriptorType>
-json GetHLEBufferDescriptorData(const std::vector<DescriptorType>& buffer,
-                                Core::Memory::Memory& memory) {
+template <bool read_value, typename DescriptorList>
+json GetHLEBufferDescriptorData(const DescriptorList& buffer, Core::Memory::Memory& memory) {
     auto buffer_out = json::array();
     for (const auto& desc : buffer) {
         auto entry = json{
@@ -0,0 +1,556 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "common/common_types.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/thread_worker.h"
+#include "shader_recompiler/backend/glasm/emit_glasm.h"
+#include "shader_recompiler/backend/glsl/emit_glsl.h"
+#include "shader_recompiler/backend/spirv/emit_spirv.h"
+#include "shader_recompiler/exception.h"
+#include "shader_recompiler/frontend/ir/basic_block.h"
+#include "shader_recompiler/frontend/maxwell/control_flow.h"
+#include "shader_recompiler/frontend/maxwell/translate_program.h"
+#include "shader_recompiler/host_translate_info.h"
+#include "shader_recompiler/object_pool.h"
+#include "shader_recompiler/profile.h"
+#include "shader_recompiler/program_header.h"
+#include "shader_recompiler/runtime_info.h"
+#include "video_core/renderer_opengl/gl_compute_pipeline.h"
+#include "video_core/renderer_opengl/gl_graphics_pipeline.h"
+#include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
+#include "video_core/renderer_vulkan/vk_pipeline_cache.h"
+#include "video_core/shader_environment.h"
+#include "video_core/shader_translation_store.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+namespace {
+
+using VideoCommon::FileEnvironment;
+
+constexpr std::array<char, 8> MAGIC_NUMBER{'y', 'u', 'z', 'u', 'c', 'a', 'c', 'h'};
+
+enum class Backend {
+    SPIRV,
+    GLSL,
+    GLASM,
+};
+
+/// Layout of the pipeline keys stored after each set of environments in a cache file
+struct CacheLayout {
+    std::string_view name;
+    u32 cache_version;
+    size_t graphics_key_size;
+    size_t compute_key_size;
+};
+
+constexpr CacheLayout VULKAN_LAYOUT{
+    .name = "vulkan",
+    .cache_version = VideoCommon::VULKAN_PIPELINE_CACHE_VERSION,
+    .graphics_key_size = sizeof(Vulkan::GraphicsPipelineCacheKey),
+    .compute_key_size = sizeof(Vulkan::ComputePipelineCacheKey),
+};
+
+constexpr CacheLayout OPENGL_LAYOUT{
+    .name = "opengl",
+    .cache_version = VideoCommon::OPENGL_PIPELINE_CACHE_VERSION,
+    .graphics_key_size = sizeof(OpenGL::GraphicsPipelineKey),
+    .compute_key_size = sizeof(OpenGL::ComputePipelineKey),
+};
+
+struct ShaderPools {
+    void ReleaseContents() {
+        flow_block.ReleaseContents();
+        block.ReleaseContents();
+        inst.ReleaseContents();
+    }
+
+    Shader::ObjectPool<Shader::IR::Inst> inst{8192};
+    Shader::ObjectPool<Shader::IR::Block> block{32};
+    Shader::ObjectPool<Shader::Maxwell::Flow::Block> flow_block{32};
+};
+
+struct PipelineResult {
+    std::string file;
+    size_t index{};
+    size_t num_stages{};
+    size_t output_size{};
+    std::chrono::nanoseconds translate_time{};
+    std::chrono::nanoseconds emit_time{};
+    std::string error;
+};
+
+struct Options {
+    Backend backend{Backend::SPIRV};
+    size_t num_threads{std::max(std::thread::hardware_concurrency(), 1U)};
+    bool verbose{};
+};
+
+/// Host capabilities of a generic desktop GPU, used in place of a live device
+Shader::HostTranslateInfo MakeHostInfo() {
+    return Shader::HostTranslateInfo{
+        .support_float64 = true,
+        .support_float16 = true,
+        .support_int64 = true,
+        .needs_demote_reorder = false,
+        .support_snorm_render_buffer = true,
+        .support_viewport_index_layer = true,
+        .min_ssbo_alignment = 16,
+        .support_geometry_shader_passthrough = false,
+        .support_conditional_barrier = true,
+    };
+}
+
+Shader::Profile MakeProfile() {
+    return Shader::Profile{
+        .supported_spirv = 0x00010400,
+        .unified_descriptor_binding = true,
+        .support_descriptor_aliasing = true,
+        .support_int8 = true,
+        .support_int16 = true,
+        .support_int64 = true,
+        .support_vertex_instance_id = false,
+        .support_float_controls = true,
+        .support_separate_denorm_behavior = true,
+        .support_separate_rounding_mode = true,
+        .support_fp16_denorm_preserve = true,
+        .support_fp32_denorm_preserve = true,
+        .support_fp16_denorm_flush = true,
+        .support_fp32_denorm_flush = true,
+        .support_fp16_signed_zero_nan_preserve = true,
+        .support_fp32_signed_zero_nan_preserve = true,
+        .support_fp64_signed_zero_nan_preserve = true,
+        .support_explicit_workgroup_layout = true,
+        .support_vote = true,
+        .support_viewport_index_layer_non_geometry = true,
+        .support_viewport_mask = false,
+        .support_typeless_image_loads = true,
+        .support_demote_to_helper_invocation = true,
+        .support_int64_atomics = true,
+        .support_derivative_control = true,
+        .support_geometry_shader_passthrough = false,
+        .support_native_ndc = false,
+        .support_gl_nv_gpu_shader_5 = true,
+        .support_gl_amd_gpu_shader_half_float = false,
+        .support_gl_texture_shadow_lod = true,
+        .support_gl_warp_intrinsics = true,
+        .support_gl_variable_aoffi = true,
+        .support_gl_sparse_textures = true,
+        .support_gl_derivative_control = true,
+        .support_scaled_attributes = true,
+        .support_multi_viewport = true,
+        .support_geometry_streams = true,
+        .warp_size_potentially_larger_than_guest = false,
+        .lower_left_origin_mode = false,
+        .need_declared_frag_colors = false,
+        .need_fastmath_off = false,
+        .need_gather_subpixel_offset = false,
+        .has_broken_spirv_clamp = false,
+        .has_broken_spirv_position_input = false,
+        .has_broken_unsigned_image_offsets = false,
+        .has_broken_signed_operations = false,
+        .has_broken_fp16_float_controls = false,
+        .has_gl_component_indexing_bug = false,
+        .has_gl_precise_bug = false,
+        .has_gl_cbuf_ftou_bug = false,
+        .has_gl_bool_ref_bug = false,
+        .ignore_nan_fp_comparisons = false,
+        .has_broken_spirv_subgroup_mask_vector_extract_dynamic = false,
+        .gl_max_compute_smem_size = 0xc000,
+        .has_broken_robust = false,
+        .min_ssbo_alignment = 16,
+        .max_user_clip_distances = 8,
+    };
+}
+
+size_t Emit(Backend backend, const Shader::Profile& profile,
+            const Shader::RuntimeInfo& runtime_info, Shader::IR::Program& program,
+            Shader::Backend::Bindings& bindings) {
+    switch (backend) {
+    case Backend::SPIRV:
+        return Shader::Backend::SPIRV::EmitSPIRV(profile, runtime_info, program, bindings).size() *
+               sizeof(u32);
+    case Backend::GLSL:
+        return Shader::Backend::GLSL::EmitGLSL(profile, runtime_info, program, bindings).size();
+    case Backend::GLASM:
+        return Shader::Backend::GLASM::EmitGLASM(profile, runtime_info, program, bindings).size();
+    }
+    return 0;
+}
+
+/// Translates and emits a single pipeline, mirroring what the renderers do on disk cache load.
+/// Fixed function state from the pipeline key is not applied; default runtime info is used.
+void BuildPipeline(ShaderPools& pools, std::span<FileEnvironment> envs, Backend backend,
+                   const Shader::Profile& profile, const Shader::HostTranslateInfo& host_info,
+                   PipelineResult& result) try {
+    using Clock = std::chrono::steady_clock;
+
+    const auto translate_begin{Clock::now()};
+    std::vector<Shader::IR::Program> programs;
+    programs.reserve(envs.size());
+    std::optional<Shader::IR::Program> program_va;
+    for (FileEnvironment& env : envs) {
+        const Shader::Stage stage{env.ShaderStage()};
+        if (stage == Shader::Stage::Compute) {
+            Shader::Maxwell::Flow::CFG cfg{env, pools.flow_block, env.StartAddress()};
+            programs.push_back(
+                Shader::Maxwell::TranslateProgram(pools.inst, pools.block, env, cfg, host_info));
+            continue;
+        }
+        const bool is_vertex_a{stage == Shader::Stage::VertexA};
+        const u32 cfg_offset{static_cast<u32>(env.StartAddress() + sizeof(Shader::ProgramHeader))};
+        Shader::Maxwell::Flow::CFG cfg(env, pools.flow_block, cfg_offset, is_vertex_a);
+        auto program{
+            Shader::Maxwell::TranslateProgram(pools.inst, pools.block, env, cfg, host_info)};
+        if (is_vertex_a) {
+            program_va = std::move(program);
+        } else if (stage == Shader::Stage::VertexB && program_va) {
+            programs.push_back(Shader::Maxwell::MergeDualVertexPrograms(*program_va, program, env));
+        } else {
+            programs.push_back(std::move(program));
+        }
+    }
+    const auto emit_begin{Clock::now()};
+
+    Shader::Backend::Bindings bindings;
+    const Shader::IR::Program* previous_program{};
+    for (Shader::IR::Program& program : programs) {
+        Shader::RuntimeInfo runtime_info;
+        if (previous_program) {
+            runtime_info.previous_stage_stores = previous_program->info.stores;
+            runtime_info.previous_stage_legacy_stores_mapping =
+                previous_program->info.legacy_stores_mapping;
+        } else {
+            runtime_info.previous_stage_stores.mask.set();
+        }
+        runtime_info.glasm_use_storage_buffers = true;
+        if (program.stage != Shader::Stage::Compute) {
+            Shader::Maxwell::ConvertLegacyToGeneric(program, runtime_info);
+        }
+        result.output_size += Emit(backend, profile, runtime_info, program, bindings);
+        previous_program = &program;
+    }
+    const auto emit_end{Clock::now()};
+
+    result.num_stages = programs.size();
+    result.translate_time = emit_begin - translate_begin;
+    result.emit_time = emit_end - emit_begin;
+} catch (const std::exception& exception) {
+    result.error = exception.what();
+}
+
+bool IsCacheFile(const std::filesystem::path& path) {
+    const auto filename{path.filename()};
+    return filename == "vulkan.bin" || filename == "opengl.bin";
+}
+
+const CacheLayout& LayoutForFile(const std::filesystem::path& path) {
+    return path.filename() == "opengl.bin" ? OPENGL_LAYOUT : VULKAN_LAYOUT;
+}
+
+/// Queues every pipeline in a cache file on the workers. The file is never modified.
+/// @return True if the file was loaded, false if it was skipped
+bool QueueCacheFile(const std::filesystem::path& path, const Options& options,
+                    Common::StatefulThreadWorker<ShaderPools>& workers,
+                    std::vector<std::unique_ptr<PipelineResult>>& results) try {
+    const std::string path_string{Common::FS::PathToUTF8String(path)};
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        LOG_ERROR(Frontend, "Failed to open pipeline cache file {}", path_string);
+        return false;
+    }
+    file.exceptions(std::ifstream::failbit);
+    const auto end{file.tellg()};
+    file.seekg(0, std::ios::beg);
+
+    std::array<char, 8> magic_number;
+    u32 cache_version;
+    file.read(magic_number.data(), magic_number.size())
+        .read(reinterpret_cast<char*>(&cache_version), sizeof(cache_version));
+    if (magic_number != MAGIC_NUMBER) {
+        LOG_ERROR(Frontend, "Invalid pipeline cache file {}", path_string);
+        return false;
+    }
+    const CacheLayout& layout{LayoutForFile(path)};
+    if (cache_version != layout.cache_version) {
+        // The renderers delete these files on load, their records may have another layout
+        LOG_WARNING(Frontend, "Skipping outdated pipeline cache file {} (layout={}, version={})",
+                    path_string, layout.name, cache_version);
+        return false;
+    }
+    LOG_INFO(Frontend, "Loading {} (layout={}, version={})", path_string, layout.name,
+             cache_version);
+
+    size_t num_pipelines{};
+    while (file.tellg() != end) {
+        u32 num_envs{};
+        file.read(reinterpret_cast<char*>(&num_envs), sizeof(num_envs));
+        if (num_envs == 0) {
+            // Without environments the size of the key that follows is unknown
+            LOG_ERROR(Frontend, "{} pipeline #{} has no shader environments", path_string,
+                      num_pipelines);
+            return true;
+        }
+        std::vector<FileEnvironment> envs(num_envs);
+        for (FileEnvironment& env : envs) {
+            env.Deserialize(file);
+        }
+        const bool is_compute{envs.front().ShaderStage() == Shader::Stage::Compute};
+        file.seekg(is_compute ? layout.compute_key_size : layout.graphics_key_size,
+                   std::ios::cur);
+
+        auto& result{results.emplace_back(std::make_unique<PipelineResult>())};
+        result->file = path_string;
+        result->index = num_pipelines;
+        workers.QueueWork([&options, envs_ = std::move(envs),
+                           result_ = result.get()](ShaderPools* pools) mutable {
+            static const Shader::Profile profile{MakeProfile()};
+            static const Shader::HostTranslateInfo host_info{MakeHostInfo()};
+            pools->ReleaseContents();
+            BuildPipeline(*pools, envs_, options.backend, profile, host_info, *result_);
+        });
+        ++num_pipelines;
+    }
+    return true;
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Frontend, "Truncated pipeline cache file {}: {}", Common::FS::PathToUTF8String(path),
+              e.what());
+    return false;
+} catch (const std::exception& e) {
+    LOG_ERROR(Frontend, "Invalid pipeline cache file {}: {}", Common::FS::PathToUTF8String(path),
+              e.what());
+    return false;
+}
+
+/// Parses the title ID of a cache file from the name of the directory it is stored in
+std::optional<u64> TitleIdOfCacheFile(const std::filesystem::path& path) {
+    const std::string name{Common::FS::PathToUTF8String(path.parent_path().filename())};
+    u64 title_id{};
+    const auto [end, ec]{std::from_chars(name.data(), name.data() + name.size(), title_id, 16)};
+    if (ec != std::errc{} || end != name.data() + name.size()) {
+        return std::nullopt;
+    }
+    return title_id;
+}
+
+/// Reports how many pipelines of the titles of the Vulkan cache files are already in the shader
+/// translation stores of their shader directories. Stores are opened read-only, so running the
+/// precompiler next to an emulator never modifies them.
+void PrintTranslationStores(std::span<const std::filesystem::path> cache_files) {
+    std::map<std::filesystem::path, std::vector<u64>> titles_per_store;
+    for (const auto& cache_file : cache_files) {
+        if (cache_file.filename() != "vulkan.bin") {
+            continue;
+        }
+        if (const std::optional<u64> title_id{TitleIdOfCacheFile(cache_file)}) {
+            const auto shader_dir{cache_file.parent_path().parent_path()};
+            titles_per_store[shader_dir / VideoCommon::VULKAN_TRANSLATION_STORE_NAME].push_back(
+                *title_id);
+        }
+    }
+    for (const auto& [store_path, title_ids] : titles_per_store) {
+        if (!Common::FS::Exists(store_path)) {
+            continue;
+        }
+        VideoCommon::ShaderTranslationStore store;
+        if (!store.Open(store_path, 0, VideoCommon::ShaderTranslationStore::OpenMode::ReadOnly)) {
+            continue;
+        }
+        fmt::print("Translation store {}: {} pipelines\n",
+                   Common::FS::PathToUTF8String(store_path), store.Size());
+        for (const u64 title_id : title_ids) {
+            fmt::print("  {:016X}: {} pipelines\n", title_id, store.Size(title_id));
+        }
+    }
+}
+
+void PrintHelp(const char* argv0) {
+    fmt::print("Usage: {} [options] <cache file or directory>...\n"
+               "Translates every shader stored in suyu pipeline caches (vulkan.bin/opengl.bin)\n"
+               "without a renderer. Directories are searched recursively for cache files.\n"
+               "Shader translation stores next to the caches are reported, never modified.\n"
+               "-b, --backend     Backend to emit: spirv (default), glsl or glasm\n"
+               "-j, --threads     Number of worker threads (default: all cores)\n"
+               "-V, --verbose     Print the translation time of every pipeline\n"
+               "-h, --help        Display this help and exit\n"
+               "-v, --version     Output version information and exit\n",
+               argv0);
+}
+
+void PrintVersion() {
+    fmt::print("suyu shader precompiler {} {}\n", Common::g_scm_branch, Common::g_scm_desc);
+}
+
+double ToMilliseconds(std::chrono::nanoseconds time) {
+    return std::chrono::duration<double, std::milli>(time).count();
+}
+
+} // Anonymous namespace
+
+/// Application entry point
+int main(int argc, char** argv) {
+    Common::Log::Initialize();
+    Common::Log::SetColorConsoleBackendEnabled(true);
+    Common::Log::Start();
+
+    Options options;
+    int option_index = 0;
+    char* endarg;
+
+    static struct option long_options[] = {
+        {"backend", required_argument, 0, 'b'},
+        {"threads", required_argument, 0, 'j'},
+        {"verbose", no_argument, 0, 'V'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    std::vector<std::filesystem::path> inputs;
+    while (optind < argc) {
+        const int arg = getopt_long(argc, argv, "b:j:Vhv", long_options, &option_index);
+        if (arg == -1) {
+            inputs.emplace_back(argv[optind]);
+            ++optind;
+            continue;
+        }
+        switch (static_cast<char>(arg)) {
+        case 'b': {
+            const std::string_view backend{optarg};
+            if (backend == "spirv") {
+                options.backend = Backend::SPIRV;
+            } else if (backend == "glsl") {
+                options.backend = Backend::GLSL;
+            } else if (backend == "glasm") {
+                options.backend = Backend::GLASM;
+            } else {
+                LOG_ERROR(Frontend, "Unknown backend \"{}\"", backend);
+                PrintHelp(argv[0]);
+                return -1;
+            }
+            break;
+        }
+        case 'j':
+            options.num_threads = std::max<size_t>(strtoul(optarg, &endarg, 0), 1);
+            break;
+        case 'V':
+            options.verbose = true;
+            break;
+        case 'h':
+            PrintHelp(argv[0]);
+            return 0;
+        case 'v':
+            PrintVersion();
+            return 0;
+        default:
+            PrintHelp(argv[0]);
+            return -1;
+        }
+    }
+    if (inputs.empty()) {
+        PrintHelp(argv[0]);
+        return -1;
+    }
+
+    std::vector<std::filesystem::path> cache_files;
+    for (const auto& input : inputs) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(input, ec)) {
+            cache_files.push_back(input);
+            continue;
+        }
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(input, ec)) {
+            if (entry.is_regular_file() && IsCacheFile(entry.path())) {
+                cache_files.push_back(entry.path());
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<PipelineResult>> results;
+    size_t num_skipped_files{};
+    const auto begin{std::chrono::steady_clock::now()};
+    {
+        Common::StatefulThreadWorker<ShaderPools> workers(
+            options.num_threads, "ShaderPrecompiler", [] { return ShaderPools{}; });
+        for (const auto& cache_file : cache_files) {
+            if (!QueueCacheFile(cache_file, options, workers, results)) {
+                ++num_skipped_files;
+            }
+        }
+        workers.WaitForRequests();
+    }
+    const auto wall_time{std::chrono::steady_clock::now() - begin};
+
+    size_t num_failed{};
+    size_t total_output_size{};
+    std::chrono::nanoseconds total_translate_time{};
+    std::chrono::nanoseconds total_emit_time{};
+    const PipelineResult* slowest{};
+    for (const auto& result : results) {
+        if (!result->error.empty()) {
+            ++num_failed;
+            LOG_ERROR(Frontend, "{} pipeline #{}: {}", result->file, result->index, result->error);
+            continue;
+        }
+        total_output_size += result->output_size;
+        total_translate_time += result->translate_time;
+        total_emit_time += result->emit_time;
+        const auto total_time{result->translate_time + result->emit_time};
+        if (!slowest || total_time > slowest->translate_time + slowest->emit_time) {
+            slowest = result.get();
+        }
+        if (options.verbose) {
+            fmt::print("{} #{}: stages={} translate={:.3f}ms emit={:.3f}ms size={}\n",
+                       result->file, result->index, result->num_stages,
+                       ToMilliseconds(result->translate_time), ToMilliseconds(result->emit_time),
+                       result->output_size);
+        }
+    }
+    const size_t num_built{results.size() - num_failed};
+    fmt::print("Cache files: {} loaded, {} skipped\n", cache_files.size() - num_skipped_files,
+               num_skipped_files);
+    fmt::print("Pipelines: {} built, {} failed\n", num_built, num_failed);
+    fmt::print("Translate time: {:.3f}ms total, {:.3f}ms average\n",
+               ToMilliseconds(total_translate_time),
+               num_built ? ToMilliseconds(total_translate_time) / num_built : 0.0);
+    fmt::print("Emit time: {:.3f}ms total, {:.3f}ms average\n", ToMilliseconds(total_emit_time),
+               num_built ? ToMilliseconds(total_emit_time) / num_built : 0.0);
+    if (slowest) {
+        fmt::print("Slowest pipeline: {} #{} ({:.3f}ms)\n", slowest->file, slowest->index,
+                   ToMilliseconds(slowest->translate_time + slowest->emit_time));
+    }
+    fmt::print("Emitted code: {} bytes\n", total_output_size);
+    fmt::print("Wall time: {:.3f}ms on {} threads\n", ToMilliseconds(wall_time),
+               options.num_threads);
+    PrintTranslationStores(cache_files);
+
+    Common::Log::Stop();
+    return num_failed == 0 ? 0 : 1;
+}
@@ -164,6 +164,12 @@ std::unique_ptr<TranslationMap> InitializeTranslations(QWidget* parent) {
            "the emulator to decompress to an intermediate format any card supports, RGBA8.\n"
            "This option recompresses RGBA8 to either the BC1 or BC3 format, saving VRAM but "
            "negatively affecting image quality."));
+    INSERT(Settings, use_disk_texture_cache, QStringLiteral(), QStringLiteral());
+    INSERT(Settings, disk_texture_cache_size, tr("Transcoded texture disk cache size (MiB):"),
+           tr("Saves textures decoded or recompressed on the CPU to storage, so they don't have to "
+              "be converted again in later loads and game boots.\nMostly useful when ASTC "
+              "recompression is in use. Least recently used textures are removed once the cache "
+              "reaches this size."));
     INSERT(Settings, vram_usage_mode, tr("VRAM Usage Mode:"),
            tr("Selects whether the emulator should prefer to conserve memory or make maximum usage "
               "of available video memory for performance. Has no effect on integrated graphics. "
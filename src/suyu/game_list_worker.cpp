@@ -1,8 +1,14 @@
 // SPDX-FileCopyrightText: Copyright 2018 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -11,17 +17,24 @@
 #include <QFileInfo>
 #include <QSettings>
 
+#include "common/cityhash.h"
 #include "common/fs/fs.h"
+#include "common/fs/fs_util.h"
 #include "common/fs/path_util.h"
+#include "common/settings.h"
+#include "common/thread_worker.h"
 #include "core/core.h"
 #include "core/file_sys/card_image.h"
+#include "core/file_sys/common_funcs.h"
 #include "core/file_sys/content_archive.h"
+#include "core/file_sys/content_index.h"
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/fs_filesystem.h"
 #include "core/file_sys/nca_metadata.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/submission_package.h"
+#include "core/hle/service/filesystem/filesystem.h"
 #include "core/loader/loader.h"
 #include "suyu/compatibility_list.h"
 #include "suyu/game_list.h"
@@ -191,12 +204,19 @@ QString FormatPatchNameVersions(const FileSys::PatchManager& patch_manager,
     return out;
 }
 
+QString GetCachedPatchNameVersions(const FileSys::PatchManager& patch, Loader::AppLoader& loader) {
+    return GetGameListCachedObject(
+        fmt::format("{:016X}", patch.GetTitleID()), "pv.txt", [&patch, &loader] {
+            return FormatPatchNameVersions(patch, loader, loader.IsRomFSUpdatable());
+        });
+}
+
 QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::string& name,
                                         const std::size_t size, const std::vector<u8>& icon,
-                                        Loader::AppLoader& loader, u64 program_id,
+                                        Loader::FileType file_type, u64 program_id,
+                                        const QString& patch_versions,
                                         const CompatibilityList& compatibility_list,
-                                        const PlayTime::PlayTimeManager& play_time_manager,
-                                        const FileSys::PatchManager& patch) {
+                                        const PlayTime::PlayTimeManager& play_time_manager) {
     const auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
 
     // The game list uses this as compatibility number for untested games
@@ -205,7 +225,6 @@ QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::stri
         compatibility = it->second.first;
     }
 
-    const auto file_type = loader.GetFileType();
     const auto file_type_string = QString::fromStdString(Loader::GetFileTypeString(file_type));
 
     QList<QStandardItem*> list{
@@ -217,14 +236,272 @@ QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::stri
         new GameListItemPlayTime(play_time_manager.GetPlayTime(program_id)),
     };
 
-    const auto patch_versions = GetGameListCachedObject(
-        fmt::format("{:016X}", patch.GetTitleID()), "pv.txt", [&patch, &loader] {
-            return FormatPatchNameVersions(patch, loader, loader.IsRomFSUpdatable());
-        });
     list.insert(2, new GameListItem(patch_versions));
 
     return list;
 }
+
+/// Content a scanned file adds to the manual content provider
+struct ProviderEntry {
+    FileSys::TitleType title_type;
+    FileSys::ContentRecordType record_type;
+    u64 title_id;
+    FileSys::VirtualFile file;
+};
+
+/// What the game list shows for one program of a scanned file
+struct ScannedProgram {
+    u64 program_id{};
+    std::string name;
+    std::vector<u8> icon;
+    /// Patch key of the updates, DLC and mods that the patch versions were formatted with
+    u64 patch_key{};
+    std::string patch_versions;
+};
+
+/// What the game list shows for a scanned file, which is kept in the game list index
+struct ScannedFile {
+    Loader::FileType file_type{};
+    /// Files with several programs list every program at the root of the game list
+    bool has_multiple_programs{};
+    std::vector<ScannedProgram> programs;
+};
+
+std::vector<u8> SerializeScannedFile(const ScannedFile& scanned) {
+    FileSys::ContentIndexWriter writer;
+    writer.Write(static_cast<u32>(scanned.file_type));
+    writer.Write(static_cast<u8>(scanned.has_multiple_programs));
+    writer.Write(static_cast<u64>(scanned.programs.size()));
+    for (const auto& program : scanned.programs) {
+        writer.Write(program.program_id);
+        writer.WriteString(program.name);
+        writer.WriteBytes(program.icon);
+        writer.Write(program.patch_key);
+        writer.WriteString(program.patch_versions);
+    }
+    return writer.Release();
+}
+
+std::optional<ScannedFile> DeserializeScannedFile(std::span<const u8> data) {
+    FileSys::ContentIndexReader reader{data};
+    ScannedFile scanned{
+        .file_type = static_cast<Loader::FileType>(reader.Read<u32>()),
+        .has_multiple_programs = reader.Read<u8>() != 0,
+    };
+    const auto count = reader.Read<u64>();
+    for (u64 i = 0; i < count && reader.IsValid(); ++i) {
+        auto& program = scanned.programs.emplace_back();
+        program.program_id = reader.Read<u64>();
+        program.name = reader.ReadString();
+        program.icon = reader.ReadBytes();
+        program.patch_key = reader.Read<u64>();
+        program.patch_versions = reader.ReadString();
+    }
+    if (!reader.IsValid()) {
+        return std::nullopt;
+    }
+    return scanned;
+}
+
+/**
+ * Hashes the content of every title by base title ID, so that a patch key changes when an update
+ * or DLC of the title is added, removed or replaced.
+ */
+std::unordered_map<u64, u64> GetContentKeys(const FileSys::ContentProvider& content_provider,
+                                            const FileSys::ManualContentProvider& provider) {
+    std::unordered_map<u64, u64> content_keys;
+    const auto add = [&content_keys](u64 title_id, u64 value0, u64 value1) {
+        const std::array<u64, 3> values{title_id, value0, value1};
+        u64& key = content_keys[FileSys::GetBaseTitleID(title_id)];
+        key = Common::CityHash64WithSeed(reinterpret_cast<const char*>(values.data()),
+                                         sizeof(values), key);
+    };
+    for (const auto& entry : content_provider.ListEntries()) {
+        add(entry.title_id, static_cast<u64>(entry.type),
+            content_provider.GetEntryVersion(entry.title_id).value_or(0));
+    }
+    // Files in the game directories have no version until they are parsed, use their sizes
+    const auto meta_entries =
+        provider.ListEntriesFilter(std::nullopt, FileSys::ContentRecordType::Meta, std::nullopt);
+    for (const auto& entry : meta_entries) {
+        const auto file = provider.GetEntryRaw(entry.title_id, entry.type);
+        add(entry.title_id, static_cast<u64>(entry.type), file != nullptr ? file->GetSize() : 0);
+    }
+    return content_keys;
+}
+
+void AppendModificationStamps(std::string& out, const FileSys::VirtualDir& mod_root) {
+    if (mod_root == nullptr) {
+        return;
+    }
+    // Mods are listed by the directories in the root and their exefs, romfs and cheats
+    // subdirectories, which change their modification time when their entries change.
+    std::error_code ec;
+    auto it = std::filesystem::recursive_directory_iterator(
+        std::filesystem::path{Common::FS::ToU8String(mod_root->GetFullPath())}, ec);
+    for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (it.depth() >= 1) {
+            it.disable_recursion_pending();
+        }
+        const auto modification_time = it->last_write_time(ec);
+        out += fmt::format("{}:{}\n", Common::FS::PathToUTF8String(it->path()),
+                           modification_time.time_since_epoch().count());
+    }
+}
+
+/// Gets a key of everything the cached name, icon and patch versions of a program depend on,
+/// besides its own file
+u64 GetPatchKey(const Core::System& system, const std::unordered_map<u64, u64>& content_keys,
+                u64 program_id) {
+    std::string key_data;
+    const auto content_key = content_keys.find(FileSys::GetBaseTitleID(program_id));
+    key_data += fmt::format(
+        "{:016X}\n", content_key != content_keys.end() ? content_key->second : u64{0});
+
+    // The title name and icon are read in the system language
+    key_data +=
+        fmt::format("{}\n", static_cast<u32>(Settings::values.language_index.GetValue()));
+
+    const auto disabled = Settings::values.disabled_addons.find(program_id);
+    if (disabled != Settings::values.disabled_addons.end()) {
+        for (const auto& name : disabled->second) {
+            key_data += name;
+            key_data += '\n';
+        }
+    }
+
+    const auto& fs_controller = system.GetFileSystemController();
+    AppendModificationStamps(key_data, fs_controller.GetModificationLoadRoot(program_id));
+    AppendModificationStamps(key_data, fs_controller.GetSDMCModificationLoadRoot(program_id));
+
+    return Common::CityHash64(key_data.data(), key_data.size());
+}
+
+/// Parses the content that a file in a game directory adds to the manual content provider
+std::vector<ProviderEntry> GetProviderEntries(Core::System& system,
+                                              const FileSys::VirtualFilesystem& vfs,
+                                              const std::string& physical_name) {
+    const auto file = vfs->OpenFile(physical_name, FileSys::OpenMode::Read);
+    if (!file) {
+        return {};
+    }
+
+    const auto loader = Loader::GetLoader(system, file);
+    if (!loader) {
+        return {};
+    }
+
+    const auto file_type = loader->GetFileType();
+    u64 program_id = 0;
+    if (loader->ReadProgramId(program_id) != Loader::ResultStatus::Success) {
+        return {};
+    }
+
+    std::vector<ProviderEntry> entries;
+    if (file_type == Loader::FileType::NCA) {
+        entries.push_back({
+            .title_type = FileSys::TitleType::Application,
+            .record_type = FileSys::GetCRTypeFromNCAType(FileSys::NCA{file}.GetType()),
+            .title_id = program_id,
+            .file = file,
+        });
+    } else if (file_type == Loader::FileType::XCI || file_type == Loader::FileType::NSP) {
+        const auto nsp = file_type == Loader::FileType::NSP
+                             ? std::make_shared<FileSys::NSP>(file)
+                             : FileSys::XCI{file}.GetSecurePartitionNSP();
+        for (const auto& title : nsp->GetNCAs()) {
+            for (const auto& entry : title.second) {
+                entries.push_back({
+                    .title_type = entry.first.first,
+                    .record_type = entry.first.second,
+                    .title_id = title.first,
+                    .file = entry.second->GetBaseFile(),
+                });
+            }
+        }
+    }
+    return entries;
+}
+
+/// Parses what the game list shows for a file in a game directory
+std::optional<ScannedFile> ScanFile(Core::System& system, const FileSys::VirtualFilesystem& vfs,
+                                    const std::string& physical_name,
+                                    const std::unordered_map<u64, u64>& content_keys) {
+    const auto file = vfs->OpenFile(physical_name, FileSys::OpenMode::Read);
+    if (!file) {
+        return std::nullopt;
+    }
+
+    auto loader = Loader::GetLoader(system, file);
+    if (!loader) {
+        return std::nullopt;
+    }
+
+    ScannedFile scanned{
+        .file_type = loader->GetFileType(),
+    };
+    if (scanned.file_type == Loader::FileType::Unknown ||
+        scanned.file_type == Loader::FileType::Error) {
+        return std::nullopt;
+    }
+
+    const auto scan_program = [&](Loader::AppLoader& program_loader, u64 program_id) {
+        ScannedProgram program{
+            .program_id = program_id,
+            .name = " ",
+            .patch_key = GetPatchKey(system, content_keys, program_id),
+        };
+        [[maybe_unused]] const auto res1 = program_loader.ReadIcon(program.icon);
+        [[maybe_unused]] const auto res3 = program_loader.ReadTitle(program.name);
+
+        const FileSys::PatchManager patch{program_id, system.GetFileSystemController(),
+                                          system.GetContentProvider()};
+        program.patch_versions =
+            FormatPatchNameVersions(patch, program_loader, program_loader.IsRomFSUpdatable())
+                .toStdString();
+        scanned.programs.push_back(std::move(program));
+    };
+
+    u64 program_id = 0;
+    const auto res2 = loader->ReadProgramId(program_id);
+
+    std::vector<u64> program_ids;
+    loader->ReadProgramIds(program_ids);
+
+    if (res2 == Loader::ResultStatus::Success && program_ids.size() > 1 &&
+        (scanned.file_type == Loader::FileType::XCI ||
+         scanned.file_type == Loader::FileType::NSP)) {
+        scanned.has_multiple_programs = true;
+        for (const auto id : program_ids) {
+            loader = Loader::GetLoader(system, file, id);
+            if (!loader) {
+                continue;
+            }
+            scan_program(*loader, id);
+        }
+    } else {
+        scan_program(*loader, program_id);
+    }
+    return scanned;
+}
+
+/// Runs func(i) for every i below count on a pool of worker threads
+template <typename Func>
+void ParallelFor(size_t count, const char* name, Func&& func) {
+    if (count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            func(i);
+        }
+        return;
+    }
+    const size_t num_workers =
+        std::min(static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1U)), count);
+    Common::ThreadWorker workers(num_workers, name);
+    for (size_t i = 0; i < count; ++i) {
+        workers.QueueWork([&func, i] { func(i); });
+    }
+    workers.WaitForRequests();
+}
 } // Anonymous namespace
 
 GameListWorker::GameListWorker(FileSys::VirtualFilesystem vfs_,
@@ -328,8 +605,10 @@ void GameListWorker::AddTitlesToGameList(GameListDir* parent_dir) {
             GetMetadataFromControlNCA(patch, *control, icon, name);
         }
 
-        auto entry = MakeGameListEntry(file->GetFullPath(), name, file->GetSize(), icon, *loader,
-                                       program_id, compatibility_list, play_time_manager, patch);
+        auto entry = MakeGameListEntry(file->GetFullPath(), name, file->GetSize(), icon,
+                                       loader->GetFileType(), program_id,
+                                       GetCachedPatchNameVersions(patch, *loader),
+                                       compatibility_list, play_time_manager);
         RecordEvent([=](GameList* game_list) {
             if (UISettings::values.show_folders_in_list) {
                 game_list->AddEntry(entry, parent_dir);
@@ -342,103 +621,20 @@ void GameListWorker::AddTitlesToGameList(GameListDir* parent_dir) {
 
 void GameListWorker::ScanFileSystem(ScanTarget target, const std::string& dir_path, bool deep_scan,
                                     GameListDir* parent_dir) {
-    const auto callback = [this, target, parent_dir](const std::filesystem::path& path) -> bool {
+    // Gather the files first, so they can be parsed in parallel
+    std::vector<std::string> physical_names;
+    const auto callback = [this, &physical_names](const std::filesystem::path& path) -> bool {
         if (stop_requested) {
             // Breaks the callback loop.
             return false;
         }
 
-        const auto physical_name = Common::FS::PathToUTF8String(path);
+        auto physical_name = Common::FS::PathToUTF8String(path);
         const auto is_dir = Common::FS::IsDir(path);
 
         if (!is_dir &&
             (HasSupportedFileExtension(physical_name) || IsExtractedNCAMain(physical_name))) {
-            const auto file = vfs->OpenFile(physical_name, FileSys::OpenMode::Read);
-            if (!file) {
-                return true;
-            }
-
-            auto loader = Loader::GetLoader(system, file);
-            if (!loader) {
-                return true;
-            }
-
-            const auto file_type = loader->GetFileType();
-            if (file_type == Loader::FileType::Unknown || file_type == Loader::FileType::Error) {
-                return true;
-            }
-
-            u64 program_id = 0;
-            const auto res2 = loader->ReadProgramId(program_id);
-
-            if (target == ScanTarget::FillManualContentProvider) {
-                if (res2 == Loader::ResultStatus::Success && file_type == Loader::FileType::NCA) {
-                    provider->AddEntry(FileSys::TitleType::Application,
-                                       FileSys::GetCRTypeFromNCAType(FileSys::NCA{file}.GetType()),
-                                       program_id, file);
-                } else if (res2 == Loader::ResultStatus::Success &&
-                           (file_type == Loader::FileType::XCI ||
-                            file_type == Loader::FileType::NSP)) {
-                    const auto nsp = file_type == Loader::FileType::NSP
-                                         ? std::make_shared<FileSys::NSP>(file)
-                                         : FileSys::XCI{file}.GetSecurePartitionNSP();
-                    for (const auto& title : nsp->GetNCAs()) {
-                        for (const auto& entry : title.second) {
-                            provider->AddEntry(entry.first.first, entry.first.second, title.first,
-                                               entry.second->GetBaseFile());
-                        }
-                    }
-                }
-            } else {
-                std::vector<u64> program_ids;
-                loader->ReadProgramIds(program_ids);
-
-                if (res2 == Loader::ResultStatus::Success && program_ids.size() > 1 &&
-                    (file_type == Loader::FileType::XCI || file_type == Loader::FileType::NSP)) {
-                    for (const auto id : program_ids) {
-                        loader = Loader::GetLoader(system, file, id);
-                        if (!loader) {
-                            continue;
-                        }
-
-                        std::vector<u8> icon;
-                        [[maybe_unused]] const auto res1 = loader->ReadIcon(icon);
-
-                        std::string name = " ";
-                        [[maybe_unused]] const auto res3 = loader->ReadTitle(name);
-
-                        const FileSys::PatchManager patch{id, system.GetFileSystemController(),
-                                                          system.GetContentProvider()};
-
-                        auto entry = MakeGameListEntry(
-                            physical_name, name, Common::FS::GetSize(physical_name), icon, *loader,
-                            id, compatibility_list, play_time_manager, patch);
-
-                        RecordEvent([=](GameList* game_list) { game_list->AddRootEntry(entry); });
-                    }
-                } else {
-                    std::vector<u8> icon;
-                    [[maybe_unused]] const auto res1 = loader->ReadIcon(icon);
-
-                    std::string name = " ";
-                    [[maybe_unused]] const auto res3 = loader->ReadTitle(name);
-
-                    const FileSys::PatchManager patch{program_id, system.GetFileSystemController(),
-                                                      system.GetContentProvider()};
-
-                    auto entry = MakeGameListEntry(
-                        physical_name, name, Common::FS::GetSize(physical_name), icon, *loader,
-                        program_id, compatibility_list, play_time_manager, patch);
-
-                    RecordEvent([=](GameList* game_list) {
-                        if (UISettings::values.show_folders_in_list) {
-                            game_list->AddEntry(entry, parent_dir);
-                        } else {
-                            game_list->AddRootEntry(entry);
-                        }
-                    });
-                }
-            }
+            physical_names.push_back(std::move(physical_name));
         } else if (is_dir) {
             watch_list.append(QString::fromStdString(physical_name));
         }
@@ -452,12 +648,105 @@ void GameListWorker::ScanFileSystem(ScanTarget target, const std::string& dir_pa
     } else {
         Common::FS::IterateDirEntries(dir_path, callback, Common::FS::DirEntryFilter::File);
     }
+
+    if (target == ScanTarget::FillManualContentProvider) {
+        // Content is parsed in parallel, but added in order so duplicates resolve as before.
+        std::vector<std::vector<ProviderEntry>> provider_entries(physical_names.size());
+        ParallelFor(physical_names.size(), "GameListScan", [&](size_t i) {
+            if (!stop_requested) {
+                provider_entries[i] = GetProviderEntries(system, vfs, physical_names[i]);
+            }
+        });
+        for (const auto& file_entries : provider_entries) {
+            for (const auto& entry : file_entries) {
+                provider->AddEntry(entry.title_type, entry.record_type, entry.title_id,
+                                   entry.file);
+            }
+        }
+        return;
+    }
+
+    const auto content_keys = GetContentKeys(system.GetContentProvider(), *provider);
+
+    // Files that did not change since the last scan are taken from the index, unless any of their
+    // updates, DLC or mods changed. Only the remaining files are parsed, in parallel.
+    std::vector<std::optional<FileSys::ContentIndexStamp>> stamps(physical_names.size());
+    std::vector<std::optional<ScannedFile>> scanned_files(physical_names.size());
+    std::vector<size_t> files_to_scan;
+    for (size_t i = 0; i < physical_names.size(); ++i) {
+        stamps[i] = FileSys::GetContentIndexStamp(
+            std::filesystem::path{Common::FS::ToU8String(physical_names[i])});
+        if (index != nullptr && stamps[i]) {
+            if (const auto data = index->Find(physical_names[i], *stamps[i])) {
+                scanned_files[i] = DeserializeScannedFile(*data);
+            }
+        }
+        const bool is_indexed =
+            scanned_files[i] &&
+            std::ranges::all_of(scanned_files[i]->programs, [&](const ScannedProgram& program) {
+                return program.patch_key ==
+                       GetPatchKey(system, content_keys, program.program_id);
+            });
+        if (!is_indexed) {
+            scanned_files[i].reset();
+            files_to_scan.push_back(i);
+        }
+    }
+
+    ParallelFor(files_to_scan.size(), "GameListScan", [&](size_t i) {
+        const size_t file_index = files_to_scan[i];
+        if (!stop_requested) {
+            scanned_files[file_index] =
+                ScanFile(system, vfs, physical_names[file_index], content_keys);
+        }
+    });
+    if (index != nullptr) {
+        for (const size_t i : files_to_scan) {
+            if (scanned_files[i] && stamps[i]) {
+                index->Insert(physical_names[i], *stamps[i],
+                              SerializeScannedFile(*scanned_files[i]));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < physical_names.size() && !stop_requested; ++i) {
+        if (!scanned_files[i]) {
+            continue;
+        }
+        const auto& scanned = *scanned_files[i];
+        const auto& physical_name = physical_names[i];
+        const auto size = stamps[i] ? stamps[i]->size : Common::FS::GetSize(physical_name);
+
+        for (const auto& program : scanned.programs) {
+            auto entry = MakeGameListEntry(
+                physical_name, program.name, size, program.icon, scanned.file_type,
+                program.program_id, QString::fromStdString(program.patch_versions),
+                compatibility_list, play_time_manager);
+
+            if (scanned.has_multiple_programs) {
+                RecordEvent([=](GameList* game_list) { game_list->AddRootEntry(entry); });
+            } else {
+                RecordEvent([=](GameList* game_list) {
+                    if (UISettings::values.show_folders_in_list) {
+                        game_list->AddEntry(entry, parent_dir);
+                    } else {
+                        game_list->AddRootEntry(entry);
+                    }
+                });
+            }
+        }
+    }
 }
 
 void GameListWorker::run() {
     watch_list.clear();
     provider->ClearAllEntries();
 
+    if (UISettings::values.cache_game_list) {
+        index = std::make_unique<FileSys::ContentIndex>(
+            Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) / "game_list" / "index.bin");
+    }
+
     const auto DirEntryReady = [&](GameListDir* game_list_dir) {
         RecordEvent([=](GameList* game_list) { game_list->AddDirEntry(game_list_dir); });
     };
@@ -502,6 +791,12 @@ void GameListWorker::run() {
         }
     }
 
+    // An interrupted scan did not look at every file, committing it would drop their entries
+    if (index != nullptr && !stop_requested) {
+        index->Commit();
+    }
+    index.reset();
+
     RecordEvent([this](GameList* game_list) { game_list->DonePopulating(watch_list); });
     processing_completed.Set();
 }
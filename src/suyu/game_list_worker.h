@@ -25,6 +25,7 @@ class GameList;
 class QStandardItem;
 
 namespace FileSys {
+class ContentIndex;
 class NCA;
 class VfsFilesystem;
 } // namespace FileSys
@@ -84,6 +85,9 @@ private:
 
     QStringList watch_list;
 
+    /// Scan results of the files in the game directories, kept while the game list is cached
+    std::unique_ptr<FileSys::ContentIndex> index;
+
     std::mutex lock;
     std::condition_variable cv;
     std::deque<std::function<void(GameList*)>> queued_events;
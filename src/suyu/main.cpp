@@ -164,7 +164,9 @@ static FileSys::VirtualFile VfsDirectoryCreateFileWrapper(const FileSys::Virtual
 #include "util/overlay_dialog.h"
 #include "video_core/gpu.h"
 #include "video_core/renderer_base.h"
+#include "video_core/shader_environment.h"
 #include "video_core/shader_notify.h"
+#include "video_core/shader_translation_store.h"
 
 #ifdef SUYU_CRASH_DUMPS
 #include "suyu/breakpad.h"
@@ -2596,6 +2598,7 @@ void GMainWindow::RemoveTransferableShaderCache(u64 program_id, GameListRemoveTa
         return;
     }
     if (Common::FS::RemoveFile(target_file)) {
+        CompactShaderTranslationStore();
         QMessageBox::information(this, tr("Successfully Removed"),
                                  tr("Successfully removed the transferable shader cache."));
     } else {
@@ -2630,6 +2633,7 @@ void GMainWindow::RemoveAllTransferableShaderCaches(u64 program_id) {
         return;
     }
     if (Common::FS::RemoveDirRecursively(program_shader_cache_dir)) {
+        CompactShaderTranslationStore();
         QMessageBox::information(this, tr("Successfully Removed"),
                                  tr("Successfully removed the transferable shader caches."));
     } else {
@@ -2638,6 +2642,18 @@ void GMainWindow::RemoveAllTransferableShaderCaches(u64 program_id) {
     }
 }
 
+void GMainWindow::CompactShaderTranslationStore() {
+    // Translated shaders are shared between titles, drop the ones of titles without a cache.
+    // The running title keeps the store open, it is compacted after a later removal instead.
+    if (emulation_running) {
+        return;
+    }
+    const auto shader_cache_dir = Common::FS::GetSuyuPath(Common::FS::SuyuPath::ShaderDir);
+    VideoCommon::ShaderTranslationStore::Compact(
+        shader_cache_dir / VideoCommon::VULKAN_TRANSLATION_STORE_NAME, "vulkan.bin",
+        VideoCommon::VULKAN_PIPELINE_CACHE_VERSION);
+}
+
 void GMainWindow::RemoveCustomConfiguration(u64 program_id, const std::string& game_path) {
     const auto file_path = std::filesystem::path(Common::FS::ToU8String(game_path));
     const auto config_file_name =
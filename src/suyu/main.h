@@ -451,6 +451,7 @@ private:
     void RemoveTransferableShaderCache(u64 program_id, GameListRemoveTarget target);
     void RemoveVulkanDriverPipelineCache(u64 program_id);
     void RemoveAllTransferableShaderCaches(u64 program_id);
+    void CompactShaderTranslationStore();
     void RemoveCustomConfiguration(u64 program_id, const std::string& game_path);
     void RemovePlayTimeData(u64 program_id);
     void RemoveCacheStorage(u64 program_id);
@@ -0,0 +1,299 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <vector>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/scm_rev.h"
+#include "common/settings.h"
+#include "common/thread.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/perf_stats.h"
+#include "suyu_cmd/benchmark.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using namespace std::chrono_literals;
+using DoubleSecs = std::chrono::duration<double>;
+
+/// Interval at which the watcher thread checks whether the budget is spent
+constexpr auto BudgetPollInterval = 1ms;
+
+BenchmarkCpuTime GetProcessCpuTime() {
+#ifdef _WIN32
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time,
+                         &user_time)) {
+        return {};
+    }
+    // FILETIME counts in units of 100 nanoseconds
+    const auto to_seconds = [](const FILETIME& time) {
+        const u64 ticks = (u64{time.dwHighDateTime} << 32) | time.dwLowDateTime;
+        return static_cast<double>(ticks) / 10'000'000.0;
+    };
+    return {
+        .user_seconds = to_seconds(user_time),
+        .system_seconds = to_seconds(kernel_time),
+    };
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return {};
+    }
+    const auto to_seconds = [](const timeval& time) {
+        return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_usec) / 1'000'000.0;
+    };
+    return {
+        .user_seconds = to_seconds(usage.ru_utime),
+        .system_seconds = to_seconds(usage.ru_stime),
+    };
+#endif
+}
+
+/// Returns the CPU time of every thread of the process by thread id, only supported on Linux
+std::map<u64, BenchmarkThreadCpuTime> GetThreadCpuTimes() {
+    std::map<u64, BenchmarkThreadCpuTime> times;
+#ifdef __linux__
+    const auto ticks_per_second = static_cast<double>(sysconf(_SC_CLK_TCK));
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc/self/task", ec)) {
+        std::ifstream stat_file(entry.path() / "stat");
+        std::string stat;
+        if (!std::getline(stat_file, stat)) {
+            continue;
+        }
+        // The thread name is in parentheses and may contain spaces or parentheses itself
+        const auto name_begin = stat.find('(');
+        const auto name_end = stat.rfind(')');
+        if (name_begin == std::string::npos || name_end == std::string::npos ||
+            name_end < name_begin) {
+            continue;
+        }
+        // Skip the fields from the thread state up to the user and system times
+        std::istringstream fields(stat.substr(name_end + 1));
+        std::string skipped;
+        for (int i = 0; i < 11; i++) {
+            fields >> skipped;
+        }
+        u64 user_ticks{};
+        u64 system_ticks{};
+        if (!(fields >> user_ticks >> system_ticks)) {
+            continue;
+        }
+        times.emplace(std::stoull(entry.path().filename().string()),
+                      BenchmarkThreadCpuTime{
+                          .name = stat.substr(name_begin + 1, name_end - name_begin - 1),
+                          .time{
+                              .user_seconds = static_cast<double>(user_ticks) / ticks_per_second,
+                              .system_seconds =
+                                  static_cast<double>(system_ticks) / ticks_per_second,
+                          },
+                      });
+    }
+#endif
+    return times;
+}
+
+nlohmann::json CpuTimeToJson(const BenchmarkCpuTime& end, const BenchmarkCpuTime& begin) {
+    return {
+        {"user_seconds", end.user_seconds - begin.user_seconds},
+        {"system_seconds", end.system_seconds - begin.system_seconds},
+    };
+}
+
+void StartMicroProfileCapture() {
+#if MICROPROFILE_ENABLED
+    std::scoped_lock lock{MicroProfileGetMutex()};
+    MicroProfileSetForceEnable(true);
+    MicroProfileSetEnableAllGroups(true);
+    // Accumulate from the next flip onwards without ever clearing the totals
+    MicroProfileSetAggregateFrames(0);
+#endif
+}
+
+nlohmann::json GetMicroProfileTotals() {
+    auto totals = nlohmann::json::array();
+#if MICROPROFILE_ENABLED
+    std::scoped_lock lock{MicroProfileGetMutex()};
+    const MicroProfile& profile = *MicroProfileGet();
+    const double to_ms =
+        static_cast<double>(MicroProfileTickToMsMultiplier(MicroProfileTicksPerSecondCpu()));
+    for (u32 i = 0; i < profile.nTotalTimers; i++) {
+        const MicroProfileTimer& timer = profile.AccumTimers[i];
+        if (timer.nCount == 0) {
+            continue;
+        }
+        totals.push_back({
+            {"group", profile.GroupInfo[profile.TimerToGroup[i]].pName},
+            {"name", profile.TimerInfo[i].pName},
+            {"count", timer.nCount},
+            {"total_ms", static_cast<double>(timer.nTicks) * to_ms},
+            {"exclusive_ms", static_cast<double>(profile.AccumTimersExclusive[i]) * to_ms},
+        });
+    }
+#endif
+    return totals;
+}
+
+double Percentile(std::vector<double> values, double percentile) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    const auto index =
+        static_cast<std::size_t>(percentile * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+} // Anonymous namespace
+
+Benchmark::Benchmark(Core::System& system_, BenchmarkParameters parameters_)
+    : system{system_}, parameters{std::move(parameters_)} {}
+
+Benchmark::~Benchmark() = default;
+
+void Benchmark::Start(std::function<void()> on_finished) {
+    StartMicroProfileCapture();
+    start_process_cpu_time = GetProcessCpuTime();
+    start_thread_cpu_times = GetThreadCpuTimes();
+    start_walltime = std::chrono::steady_clock::now();
+    start_system_time = system.CoreTiming().GetGlobalTimeUs();
+    system.GetPerfStats().StartFrameRecording();
+
+    watcher = std::jthread([this, on_finished = std::move(on_finished)](std::stop_token token) {
+        Common::SetCurrentThreadName("BenchmarkWatcher");
+        while (Common::StoppableTimedWait(token, BudgetPollInterval)) {
+            if (IsBudgetSpent()) {
+                LOG_INFO(Frontend, "Benchmark budget spent, stopping emulation");
+                on_finished();
+                return;
+            }
+        }
+    });
+}
+
+bool Benchmark::IsBudgetSpent() const {
+    if (parameters.frame_budget != 0 &&
+        system.GetPerfStats().GetRecordedFrameCount() >= parameters.frame_budget) {
+        return true;
+    }
+    if (parameters.time_budget != std::chrono::microseconds::zero() &&
+        system.CoreTiming().GetGlobalTimeUs() - start_system_time >= parameters.time_budget) {
+        return true;
+    }
+    return false;
+}
+
+bool Benchmark::Finish() {
+    watcher = {};
+
+    const auto walltime = std::chrono::steady_clock::now() - start_walltime;
+    const auto system_time = system.CoreTiming().GetGlobalTimeUs() - start_system_time;
+    const auto process_cpu_time = GetProcessCpuTime();
+    const auto thread_cpu_times = GetThreadCpuTimes();
+
+    auto& perf_stats = system.GetPerfStats();
+    perf_stats.StopFrameRecording();
+    auto frames = perf_stats.GetRecordedFrames();
+
+    // Only report the frames inside the budget, so runs of the same title are comparable even if
+    // emulation went on for a few more frames before it was paused.
+    if (parameters.frame_budget != 0 && frames.size() > parameters.frame_budget) {
+        frames.resize(parameters.frame_budget);
+    }
+    if (parameters.time_budget != std::chrono::microseconds::zero()) {
+        const s64 end_us = (start_system_time + parameters.time_budget).count();
+        std::erase_if(frames,
+                      [end_us](const auto& frame) { return frame.system_time_us > end_us; });
+    }
+
+    auto frames_json = nlohmann::json::array();
+    std::vector<double> frametimes;
+    frametimes.reserve(frames.size());
+    for (const auto& frame : frames) {
+        frames_json.push_back({
+            {"system_time_us", frame.system_time_us - start_system_time.count()},
+            {"frametime_ms", frame.frametime_ms},
+            {"gpu_wait_ms", frame.gpu_wait_ms},
+            {"present_ms", frame.present_ms},
+        });
+        frametimes.push_back(frame.frametime_ms);
+    }
+    const double total_frametime_ms = std::accumulate(frametimes.begin(), frametimes.end(), 0.0);
+
+    auto threads_json = nlohmann::json::array();
+    for (const auto& [thread_id, thread] : thread_cpu_times) {
+        const auto start_it = start_thread_cpu_times.find(thread_id);
+        // Thread ids may be reused, only subtract the start time of the same thread
+        const bool has_start = start_it != start_thread_cpu_times.end() &&
+                               start_it->second.name == thread.name;
+        auto thread_json = CpuTimeToJson(thread.time, has_start ? start_it->second.time
+                                                                : BenchmarkCpuTime{});
+        thread_json["id"] = thread_id;
+        thread_json["name"] = thread.name;
+        threads_json.push_back(std::move(thread_json));
+    }
+
+    auto cpu_time_json = CpuTimeToJson(process_cpu_time, start_process_cpu_time);
+    cpu_time_json["threads"] = std::move(threads_json);
+
+    const nlohmann::json report{
+        {"version", fmt::format("{} {}", Common::g_scm_branch, Common::g_scm_desc)},
+        {"title_id", fmt::format("{:016X}", system.GetApplicationProcessProgramID())},
+        {"renderer", Settings::CanonicalizeEnum(Settings::values.renderer_backend.GetValue())},
+        {"frame_budget", parameters.frame_budget},
+        {"time_budget_us", parameters.time_budget.count()},
+        {"walltime_seconds", std::chrono::duration_cast<DoubleSecs>(walltime).count()},
+        {"system_time_seconds", std::chrono::duration_cast<DoubleSecs>(system_time).count()},
+        {"summary",
+         {
+             {"frames", frames.size()},
+             {"mean_frametime_ms",
+              frames.empty() ? 0.0 : total_frametime_ms / static_cast<double>(frames.size())},
+             {"median_frametime_ms", Percentile(frametimes, 0.5)},
+             {"p99_frametime_ms", Percentile(frametimes, 0.99)},
+             {"max_frametime_ms",
+              frametimes.empty() ? 0.0 : *std::max_element(frametimes.begin(), frametimes.end())},
+         }},
+        {"frames", std::move(frames_json)},
+        {"cpu_time", std::move(cpu_time_json)},
+        {"microprofile", GetMicroProfileTotals()},
+    };
+
+    if (!Common::FS::CreateParentDirs(parameters.report_path)) {
+        LOG_ERROR(Frontend, "Failed to create the directory of the benchmark report {}",
+                  Common::FS::PathToUTF8String(parameters.report_path));
+        return false;
+    }
+    Common::FS::IOFile file(parameters.report_path, Common::FS::FileAccessMode::Write,
+                            Common::FS::FileType::TextFile);
+    const std::string contents = report.dump(4);
+    if (file.WriteString(contents) != contents.size()) {
+        LOG_ERROR(Frontend, "Failed to write the benchmark report {}",
+                  Common::FS::PathToUTF8String(parameters.report_path));
+        return false;
+    }
+
+    LOG_INFO(Frontend, "Benchmark report of {} frames written to {}", frames.size(),
+             Common::FS::PathToUTF8String(parameters.report_path));
+    return true;
+}
@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+
+namespace Core {
+class System;
+}
+
+struct BenchmarkParameters {
+    /// Path where the JSON report is written
+    std::filesystem::path report_path;
+    /// Number of presented frames to run for, zero for no limit
+    u64 frame_budget{};
+    /// Emulated time to run for, zero for no limit
+    std::chrono::microseconds time_budget{};
+};
+
+struct BenchmarkCpuTime {
+    double user_seconds{};
+    double system_seconds{};
+};
+
+struct BenchmarkThreadCpuTime {
+    std::string name;
+    BenchmarkCpuTime time;
+};
+
+/**
+ * Runs a loaded title until a budget of presented frames or emulated time is spent, then writes a
+ * JSON report with the per frame times from PerfStats, the CPU time of the process threads and
+ * the MicroProfile scope totals.
+ */
+class Benchmark {
+public:
+    explicit Benchmark(Core::System& system_, BenchmarkParameters parameters_);
+    ~Benchmark();
+
+    /**
+     * Starts recording, must be called once the title is running.
+     *
+     * @param on_finished - Called from another thread once the budget is spent.
+     */
+    void Start(std::function<void()> on_finished);
+
+    /**
+     * Stops recording and writes the report, must be called while emulation is paused and before
+     * the title is shut down.
+     *
+     * @return Whether the report could be written.
+     */
+    bool Finish();
+
+private:
+    /// Whether the frame or emulated time budget has been spent
+    bool IsBudgetSpent() const;
+
+    Core::System& system;
+    BenchmarkParameters parameters;
+
+    /// Walltime and emulated time when recording started
+    std::chrono::steady_clock::time_point start_walltime;
+    std::chrono::microseconds start_system_time{};
+    /// CPU time of the process and of each of its threads, by id, when recording started
+    BenchmarkCpuTime start_process_cpu_time;
+    std::map<u64, BenchmarkThreadCpuTime> start_thread_cpu_times;
+
+    /// Polls the budget and calls the finished callback once it is spent
+    std::jthread watcher;
+};
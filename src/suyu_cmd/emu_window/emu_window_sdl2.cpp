@@ -232,6 +232,14 @@ void EmuWindow_SDL2::WaitEvent() {
     }
 }
 
+void EmuWindow_SDL2::RequestClose() {
+    SDL_Event event{};
+    event.type = SDL_QUIT;
+    if (SDL_PushEvent(&event) < 0) {
+        LOG_ERROR(Frontend, "Failed to push quit event: {}", SDL_GetError());
+    }
+}
+
 // Credits to Samantas5855 and others for this function.
 void EmuWindow_SDL2::SetWindowIcon() {
     SDL_RWops* const suyu_icon_stream = SDL_RWFromConstMem((void*)suyu_icon, suyu_icon_size);
@@ -2,8 +2,10 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <regex>
 #include <sstream>
 #include <string>
@@ -36,6 +38,7 @@
 #include "input_common/main.h"
 #include "network/network.h"
 #include "sdl_config.h"
+#include "suyu_cmd/benchmark.h"
 #include "suyu_cmd/emu_window/emu_window_sdl2.h"
 #include "suyu_cmd/emu_window/emu_window_sdl2_gl.h"
 #include "suyu_cmd/emu_window/emu_window_sdl2_null.h"
@@ -87,7 +90,24 @@ static void PrintHelp(const char* argv0) {
                  "\"program_id,applet_id,applet_type,launch_type,prog_index,prev_prog_index\"\n"
                  "                      Numerical parameters for launching an applet. If no\n"
                  "                      game is provided, then the applet will launch off of\n"
-                 "                      the applet_id.\n";
+                 "                      the applet_id.\n"
+                 "--renderer=backend    Override the configured renderer: opengl, vulkan or null\n"
+                 "--benchmark=report    Run without speed limit until the benchmark budget is\n"
+                 "                      spent, then exit and write a JSON report to this path\n"
+                 "--benchmark-frames=N  Stop the benchmark after N presented frames. Defaults\n"
+                 "                      to 600 frames when no budget is given\n"
+                 "--benchmark-seconds=T Stop the benchmark after T seconds of emulated time\n";
+}
+
+static std::optional<Settings::RendererBackend> ParseRendererBackend(const std::string& name) {
+    const auto lowercase_name = Common::ToLower(name);
+    for (const auto& [backend_name, backend] :
+         Settings::EnumMetadata<Settings::RendererBackend>::Canonicalizations()) {
+        if (Common::ToLower(backend_name) == lowercase_name) {
+            return backend;
+        }
+    }
+    return std::nullopt;
 }
 
 static void PrintVersion() {
@@ -219,6 +239,8 @@ int main(int argc, char** argv) {
     std::optional<std::string> config_path;
     std::string program_args;
     std::optional<int> selected_user;
+    std::optional<Settings::RendererBackend> renderer_backend;
+    std::optional<BenchmarkParameters> benchmark_parameters;
 
     bool use_multiplayer = false;
     bool fullscreen = false;
@@ -239,6 +261,10 @@ int main(int argc, char** argv) {
         {"program", optional_argument, 0, 'p'},
         {"user", required_argument, 0, 'u'},
         {"version", no_argument, 0, 'v'},
+        {"renderer", required_argument, 0, 'r'},
+        {"benchmark", required_argument, 0, 'B'},
+        {"benchmark-frames", required_argument, 0, 'N'},
+        {"benchmark-seconds", required_argument, 0, 'T'},
         {0, 0, 0, 0},
         // clang-format on
     };
@@ -326,6 +352,49 @@ int main(int argc, char** argv) {
             case 'v':
                 PrintVersion();
                 return 0;
+            case 'r':
+                renderer_backend = ParseRendererBackend(optarg);
+                if (!renderer_backend) {
+                    std::cout << "Unknown renderer " << optarg << "\n";
+                    PrintHelp(argv[0]);
+                    return 0;
+                }
+                break;
+            case 'B':
+                if (!benchmark_parameters) {
+                    benchmark_parameters.emplace();
+                }
+                benchmark_parameters->report_path = std::filesystem::absolute(optarg);
+                break;
+            case 'N': {
+                if (!benchmark_parameters) {
+                    benchmark_parameters.emplace();
+                }
+                char* end = nullptr;
+                benchmark_parameters->frame_budget = std::strtoull(optarg, &end, 10);
+                if (end == optarg || *end != '\0') {
+                    std::cout << "Wrong format for option --benchmark-frames\n";
+                    PrintHelp(argv[0]);
+                    return 0;
+                }
+                break;
+            }
+            case 'T': {
+                if (!benchmark_parameters) {
+                    benchmark_parameters.emplace();
+                }
+                char* end = nullptr;
+                const double seconds = std::strtod(optarg, &end);
+                if (end == optarg || *end != '\0' || seconds < 0.0) {
+                    std::cout << "Wrong format for option --benchmark-seconds\n";
+                    PrintHelp(argv[0]);
+                    return 0;
+                }
+                benchmark_parameters->time_budget =
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::duration<double>(seconds));
+                break;
+            }
             }
         } else {
 #ifdef _WIN32
@@ -353,6 +422,23 @@ int main(int argc, char** argv) {
         Settings::values.current_user = std::clamp(*selected_user, 0, 7);
     }
 
+    if (renderer_backend.has_value()) {
+        Settings::values.renderer_backend.SetValue(*renderer_backend);
+    }
+
+    if (benchmark_parameters.has_value()) {
+        if (benchmark_parameters->report_path.empty()) {
+            LOG_CRITICAL(Frontend, "Benchmark budgets require a --benchmark report path");
+            return -1;
+        }
+        if (benchmark_parameters->frame_budget == 0 &&
+            benchmark_parameters->time_budget == std::chrono::microseconds::zero()) {
+            benchmark_parameters->frame_budget = 600;
+        }
+        // Run as fast as possible, the report measures how long frames take rather than pacing
+        Settings::values.use_speed_limit.SetValue(false);
+    }
+
 #ifdef _WIN32
     LocalFree(argv_w);
 #endif
@@ -486,6 +572,12 @@ int main(int argc, char** argv) {
     Common::Linux::StartGamemode();
 #endif
 
+    std::optional<Benchmark> benchmark;
+    if (benchmark_parameters.has_value()) {
+        benchmark.emplace(system, std::move(*benchmark_parameters));
+        benchmark->Start([&emu_window] { emu_window->RequestClose(); });
+    }
+
     void(system.Run());
     if (system.DebuggerEnabled()) {
         system.InitializeDebugger();
@@ -495,6 +587,7 @@ int main(int argc, char** argv) {
     }
     system.DetachDebugger();
     void(system.Pause());
+    const bool benchmark_failed = benchmark.has_value() && !benchmark->Finish();
     system.ShutdownMainProcess();
 
 #ifdef __unix__
@@ -502,5 +595,5 @@ int main(int argc, char** argv) {
 #endif
 
     detached_tasks.WaitForAllTasks();
-    return 0;
+    return benchmark_failed ? -1 : 0;
 }
@@ -0,0 +1,478 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "audio_core/adsp/apps/audio_renderer/command_list_processor.h"
+#include "audio_core/renderer/command/mix/depop_for_mix_buffers.h"
+#include "audio_core/renderer/command/mix/mix.h"
+#include "audio_core/renderer/command/mix/mix_kernels.h"
+#include "audio_core/renderer/command/mix/mix_ramp.h"
+#include "audio_core/renderer/command/mix/mix_ramp_grouped.h"
+#include "audio_core/renderer/command/mix/volume.h"
+#include "audio_core/renderer/command/mix/volume_ramp.h"
+#include "audio_core/renderer/command/resample/resample.h"
+#include "common/common_types.h"
+#include "common/fixed_point.h"
+
+namespace {
+using namespace AudioCore::Renderer;
+using AudioCore::CpuAddr;
+using AudioCore::MaxMixBuffers;
+using AudioCore::SrcQuality;
+using AudioCore::ADSP::AudioRenderer::CommandListProcessor;
+
+constexpr u32 NUM_MIX_BUFFERS = 24;
+
+// Reference implementations, straightforward fixed point loops the optimized paths must match
+
+template <size_t Q>
+s32 ReferenceMixRamp(std::span<s32> output, std::span<const s32> input, f32 volume_, f32 ramp_) {
+    Common::FixedPoint<64 - Q, Q> volume{volume_};
+    const Common::FixedPoint<64 - Q, Q> ramp{ramp_};
+    Common::FixedPoint<64 - Q, Q> sample{0};
+    for (size_t i = 0; i < output.size(); i++) {
+        sample = input[i] * volume;
+        output[i] = (output[i] + sample).to_int();
+        volume += ramp;
+    }
+    return sample.to_int();
+}
+
+template <size_t Q>
+void ReferenceGain(std::span<s32> output, std::span<const s32> input, f32 volume_, f32 ramp_) {
+    Common::FixedPoint<64 - Q, Q> volume{volume_};
+    const Common::FixedPoint<64 - Q, Q> ramp{ramp_};
+    for (size_t i = 0; i < output.size(); i++) {
+        output[i] = (input[i] * volume).to_int();
+        volume += ramp;
+    }
+}
+
+s32 ReferenceMixRamp(u8 precision, std::span<s32> output, std::span<const s32> input, f32 volume,
+                     f32 ramp) {
+    return precision == 15 ? ReferenceMixRamp<15>(output, input, volume, ramp)
+                           : ReferenceMixRamp<23>(output, input, volume, ramp);
+}
+
+void ReferenceGain(u8 precision, std::span<s32> output, std::span<const s32> input, f32 volume,
+                   f32 ramp) {
+    if (precision == 15) {
+        ReferenceGain<15>(output, input, volume, ramp);
+    } else {
+        ReferenceGain<23>(output, input, volume, ramp);
+    }
+}
+
+s32 ReferenceDepop(std::span<s32> output, s32 depop_sample, Common::FixedPoint<49, 15> decay) {
+    s32 sample = std::abs(depop_sample);
+    for (s32& value : output) {
+        sample = static_cast<s32>((static_cast<s64>(sample) * decay.to_raw()) >> 15);
+        value += depop_sample <= 0 ? -sample : sample;
+    }
+    return depop_sample <= 0 ? -sample : sample;
+}
+
+/// Mix buffers and the state commands write to, updated by commands and by the reference
+struct MixState {
+    explicit MixState(u32 sample_count) : buffers(NUM_MIX_BUFFERS * sample_count) {}
+
+    std::vector<s32> buffers;
+    std::array<s32, MaxMixBuffers> previous_samples{};
+    std::array<s32, NUM_MIX_BUFFERS> depop{};
+
+    std::span<s32> Buffer(u32 index, u32 sample_count) {
+        return std::span{buffers}.subspan(index * sample_count, sample_count);
+    }
+
+    bool operator==(const MixState&) const = default;
+};
+
+/// Generates a random stream of mixing commands, runs it through the command processor and
+/// through the reference implementation, and checks both produce the same PCM.
+class CommandStream {
+public:
+    CommandStream(u32 sample_count_, u32 seed)
+        : sample_count{sample_count_}, rng{seed}, state{sample_count}, expected{sample_count} {
+        std::uniform_int_distribution<s32> pcm{-(1 << 23), 1 << 23};
+        for (s32& sample : state.buffers) {
+            sample = pcm(rng);
+        }
+        expected = state;
+
+        processor.mix_buffers = state.buffers;
+        processor.sample_count = sample_count;
+        processor.buffer_count = NUM_MIX_BUFFERS;
+    }
+
+    void Step() {
+        switch (std::uniform_int_distribution<int>{0, 5}(rng)) {
+        case 0:
+            ProcessMix();
+            break;
+        case 1:
+            ProcessMixRamp();
+            break;
+        case 2:
+            ProcessMixRampGrouped();
+            break;
+        case 3:
+            ProcessVolume();
+            break;
+        case 4:
+            ProcessVolumeRamp();
+            break;
+        case 5:
+            ProcessDepop();
+            break;
+        }
+    }
+
+    const MixState& Result() const {
+        return state;
+    }
+
+    const MixState& Expected() const {
+        return expected;
+    }
+
+private:
+    u8 RandomPrecision() {
+        return std::bernoulli_distribution{}(rng) ? 15 : 23;
+    }
+
+    s16 RandomIndex() {
+        return static_cast<s16>(std::uniform_int_distribution<u32>{0, NUM_MIX_BUFFERS - 1}(rng));
+    }
+
+    f32 RandomVolume() {
+        // Exact values hit the special cases of the commands
+        switch (std::uniform_int_distribution<int>{0, 7}(rng)) {
+        case 0:
+            return 0.0f;
+        case 1:
+            return 1.0f;
+        default:
+            return std::uniform_real_distribution<f32>{-2.0f, 2.0f}(rng);
+        }
+    }
+
+    f32 Ramp(f32 prev_volume, f32 volume) const {
+        return (volume - prev_volume) / static_cast<f32>(sample_count);
+    }
+
+    void ProcessMix() {
+        MixCommand command{};
+        command.precision = RandomPrecision();
+        command.input_index = RandomIndex();
+        command.output_index = RandomIndex();
+        command.volume = RandomVolume();
+        command.Process(processor);
+
+        if (command.volume != 0.0f) {
+            ReferenceMixRamp(command.precision, expected.Buffer(command.output_index, sample_count),
+                             expected.Buffer(command.input_index, sample_count), command.volume,
+                             0.0f);
+        }
+    }
+
+    void ProcessMixRamp() {
+        MixRampCommand command{};
+        command.precision = RandomPrecision();
+        command.input_index = RandomIndex();
+        command.output_index = RandomIndex();
+        command.prev_volume = RandomVolume();
+        command.volume = RandomVolume();
+        const u32 index = static_cast<u32>(RandomIndex());
+        command.previous_sample = reinterpret_cast<CpuAddr>(&state.previous_samples[index]);
+        command.Process(processor);
+
+        const f32 ramp = Ramp(command.prev_volume, command.volume);
+        if (command.prev_volume == 0.0f && ramp == 0.0f) {
+            expected.previous_samples[index] = 0;
+            return;
+        }
+        expected.previous_samples[index] = ReferenceMixRamp(
+            command.precision, expected.Buffer(command.output_index, sample_count),
+            expected.Buffer(command.input_index, sample_count), command.prev_volume, ramp);
+    }
+
+    void ProcessMixRampGrouped() {
+        MixRampGroupedCommand command{};
+        command.precision = RandomPrecision();
+        command.buffer_count = std::uniform_int_distribution<u32>{1, MaxMixBuffers}(rng);
+        for (u32 i = 0; i < command.buffer_count; i++) {
+            command.inputs[i] = RandomIndex();
+            command.outputs[i] = RandomIndex();
+            command.prev_volumes[i] = RandomVolume();
+            command.volumes[i] = RandomVolume();
+        }
+        command.previous_samples = reinterpret_cast<CpuAddr>(state.previous_samples.data());
+        command.Process(processor);
+
+        for (u32 i = 0; i < command.buffer_count; i++) {
+            s32 last_sample = 0;
+            if (command.prev_volumes[i] != 0.0f || command.volumes[i] != 0.0f) {
+                const f32 ramp = Ramp(command.prev_volumes[i], command.volumes[i]);
+                if (command.prev_volumes[i] == 0.0f && ramp == 0.0f) {
+                    expected.previous_samples[i] = 0;
+                    continue;
+                }
+                last_sample = ReferenceMixRamp(
+                    command.precision, expected.Buffer(command.outputs[i], sample_count),
+                    expected.Buffer(command.inputs[i], sample_count), command.prev_volumes[i],
+                    ramp);
+            }
+            expected.previous_samples[i] = last_sample;
+        }
+    }
+
+    void ProcessVolume() {
+        VolumeCommand command{};
+        command.precision = RandomPrecision();
+        command.input_index = RandomIndex();
+        command.output_index = RandomIndex();
+        command.volume = RandomVolume();
+        command.Process(processor);
+
+        ReferenceGain(command.precision, expected.Buffer(command.output_index, sample_count),
+                      expected.Buffer(command.input_index, sample_count), command.volume, 0.0f);
+    }
+
+    void ProcessVolumeRamp() {
+        VolumeRampCommand command{};
+        command.precision = RandomPrecision();
+        command.input_index = RandomIndex();
+        command.output_index = RandomIndex();
+        command.prev_volume = RandomVolume();
+        command.volume = RandomVolume();
+        command.Process(processor);
+
+        ReferenceGain(command.precision, expected.Buffer(command.output_index, sample_count),
+                      expected.Buffer(command.input_index, sample_count), command.prev_volume,
+                      Ramp(command.prev_volume, command.volume));
+    }
+
+    void ProcessDepop() {
+        std::uniform_int_distribution<s32> depop_sample{-(1 << 20), 1 << 20};
+        for (size_t i = 0; i < state.depop.size(); i++) {
+            state.depop[i] = depop_sample(rng);
+            expected.depop[i] = state.depop[i];
+        }
+        DepopForMixBuffersCommand command{};
+        command.input = RandomIndex();
+        command.count = std::uniform_int_distribution<u32>{1, NUM_MIX_BUFFERS}(rng);
+        command.decay = std::uniform_real_distribution<f32>{0.5f, 0.999f}(rng);
+        command.depop_buffer = reinterpret_cast<CpuAddr>(state.depop.data());
+        command.Process(processor);
+
+        const u32 end = std::min(NUM_MIX_BUFFERS, command.input + command.count);
+        for (u32 index = command.input; index < end; index++) {
+            if (expected.depop[index] != 0) {
+                expected.depop[index] = ReferenceDepop(expected.Buffer(index, sample_count),
+                                                       expected.depop[index], command.decay);
+            }
+        }
+    }
+
+    u32 sample_count;
+    std::mt19937 rng;
+    MixState state;
+    MixState expected;
+    CommandListProcessor processor;
+};
+} // Anonymous namespace
+
+TEST_CASE("AudioRenderer[MixKernels]", "[audio_core]") {
+    std::mt19937 rng{1};
+    std::uniform_int_distribution<s32> pcm{-(1 << 23), 1 << 23};
+    std::uniform_real_distribution<f32> volume{-4.0f, 4.0f};
+
+    const auto& generic = GetMixKernels(MixKernelLevel::Generic);
+    const auto& host = GetMixKernels(GetHostMixKernelLevel());
+    for (const u32 count : {1U, 7U, 8U, 15U, 160U, 240U, 241U}) {
+        for (const u32 q : {15U, 23U}) {
+            std::vector<s32> input(count);
+            std::vector<s32> base(count);
+            for (u32 i = 0; i < count; i++) {
+                input[i] = pcm(rng);
+                base[i] = pcm(rng);
+            }
+            const s64 start = static_cast<s64>(volume(rng) * static_cast<f32>(1 << q));
+            const s64 end = static_cast<s64>(volume(rng) * static_cast<f32>(1 << q));
+            const s64 ramp = (end - start) / count;
+
+            for (const auto kernel : {&MixKernels::gain, &MixKernels::mix}) {
+                auto expected = base;
+                auto result = base;
+                (generic.*kernel)(expected.data(), input.data(), count, start, ramp, q);
+                (host.*kernel)(result.data(), input.data(), count, start, ramp, q);
+                REQUIRE(result == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("AudioRenderer[CommandStream]", "[audio_core]") {
+    for (const u32 sample_count : {160U, 240U}) {
+        CommandStream stream{sample_count, sample_count};
+        for (int i = 0; i < 2000; i++) {
+            stream.Step();
+        }
+        REQUIRE(stream.Result() == stream.Expected());
+    }
+}
+
+TEST_CASE("AudioRenderer[VoiceSegments]", "[audio_core]") {
+    // Voices processed on different workers mix into their own zeroed buffers, which are then
+    // added to the shared ones. That must give the same samples as mixing every voice in order.
+    constexpr u32 sample_count = 240;
+    constexpr u32 num_voices = 48;
+    constexpr u32 num_chunks = 5;
+    constexpr u32 num_outputs = 6;
+    std::mt19937 rng{4};
+    std::uniform_int_distribution<s32> pcm{-(1 << 30), 1 << 30};
+    std::uniform_real_distribution<f32> volume{-2.0f, 2.0f};
+
+    std::vector<s32> voices(num_voices * sample_count);
+    for (s32& sample : voices) {
+        sample = pcm(rng);
+    }
+    std::vector<MixRampGroupedCommand> commands(num_voices);
+    std::array<s32, MaxMixBuffers> previous_samples{};
+    for (MixRampGroupedCommand& command : commands) {
+        command.precision = std::bernoulli_distribution{}(rng) ? 15 : 23;
+        command.buffer_count = num_outputs;
+        for (u32 i = 0; i < num_outputs; i++) {
+            command.inputs[i] = static_cast<s16>(num_outputs);
+            command.outputs[i] = static_cast<s16>(i);
+            command.prev_volumes[i] = volume(rng);
+            command.volumes[i] = volume(rng);
+        }
+        command.previous_samples = reinterpret_cast<CpuAddr>(previous_samples.data());
+    }
+
+    // Mix buffers followed by the voice channel
+    std::vector<s32> initial((num_outputs + 1) * sample_count);
+    for (s32& sample : initial) {
+        sample = pcm(rng);
+    }
+    const auto process = [&](std::vector<s32>& buffers, u32 first, u32 last) {
+        CommandListProcessor processor;
+        processor.mix_buffers = buffers;
+        processor.sample_count = sample_count;
+        processor.buffer_count = num_outputs + 1;
+        for (u32 voice = first; voice < last; voice++) {
+            std::copy_n(voices.begin() + voice * sample_count, sample_count,
+                        buffers.begin() + num_outputs * sample_count);
+            commands[voice].Process(processor);
+        }
+    };
+
+    auto expected = initial;
+    process(expected, 0, num_voices);
+
+    auto result = initial;
+    for (u32 chunk = 0; chunk < num_chunks; chunk++) {
+        std::vector<s32> buffers(initial.size());
+        process(buffers, chunk * num_voices / num_chunks, (chunk + 1) * num_voices / num_chunks);
+        for (u32 i = 0; i < num_outputs * sample_count; i++) {
+            result[i] = static_cast<s32>(static_cast<u32>(result[i]) + static_cast<u32>(buffers[i]));
+        }
+    }
+    REQUIRE(std::equal(result.begin(), result.begin() + num_outputs * sample_count,
+                       expected.begin()));
+}
+
+TEST_CASE("AudioRenderer[Resample]", "[audio_core]") {
+    constexpr u32 samples_to_write = 240;
+    std::mt19937 rng{2};
+    std::uniform_int_distribution<int> pcm{-32768, 32767};
+    std::vector<s16> input(samples_to_write * 3);
+    for (s16& sample : input) {
+        sample = static_cast<s16>(pcm(rng));
+    }
+
+    for (const SrcQuality quality : {SrcQuality::Low, SrcQuality::Medium, SrcQuality::High}) {
+        for (const f32 ratio : {0.5f, 0.6667f, 1.0f, 1.2f, 1.5f, 2.0f}) {
+            const Common::FixedPoint<49, 15> sample_rate_ratio{ratio};
+            const Common::FixedPoint<49, 15> start_fraction{0.25f};
+
+            std::vector<s32> result(samples_to_write);
+            auto fraction = start_fraction;
+            Resample(result, input, sample_rate_ratio, fraction, samples_to_write, quality);
+
+            // One sample at a time, only ever taking the scalar path
+            std::vector<s32> expected(samples_to_write);
+            auto expected_fraction = start_fraction;
+            size_t read_index = 0;
+            for (u32 i = 0; i < samples_to_write; i++) {
+                const s64 step = expected_fraction.to_raw() + sample_rate_ratio.to_raw();
+                Resample(std::span{expected}.subspan(i, 1), std::span{input}.subspan(read_index),
+                         sample_rate_ratio, expected_fraction, 1, quality);
+                read_index += static_cast<size_t>(step >> 15);
+            }
+            REQUIRE(result == expected);
+            REQUIRE(fraction.to_raw() == expected_fraction.to_raw());
+        }
+    }
+}
+
+TEST_CASE("AudioRenderer[Benchmark]", "[.][benchmark]") {
+    constexpr u32 sample_count = 240;
+    constexpr int iterations = 2000;
+    MixState state{sample_count};
+    std::mt19937 rng{3};
+    std::uniform_int_distribution<s32> pcm{-(1 << 15), 1 << 15};
+    for (s32& sample : state.buffers) {
+        sample = pcm(rng);
+    }
+    CommandListProcessor processor;
+    processor.mix_buffers = state.buffers;
+    processor.sample_count = sample_count;
+    processor.buffer_count = NUM_MIX_BUFFERS;
+
+    // A voice mixed into 6 channels with a volume ramp, as generated for every playing voice
+    MixRampGroupedCommand command{};
+    command.precision = 15;
+    command.buffer_count = 6;
+    for (u32 i = 0; i < command.buffer_count; i++) {
+        command.inputs[i] = static_cast<s16>(i);
+        command.outputs[i] = static_cast<s16>(6 + i);
+        command.prev_volumes[i] = 0.25f;
+        command.volumes[i] = 0.5f;
+    }
+    command.previous_samples = reinterpret_cast<CpuAddr>(state.previous_samples.data());
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        command.Process(processor);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double samples = static_cast<double>(sample_count) * command.buffer_count * iterations;
+    printf("MixRampGrouped: %.2f M samples/s\n", samples / elapsed.count() / 1e6);
+
+    std::vector<s16> input(sample_count * 3);
+    std::vector<s32> output(sample_count);
+    for (const SrcQuality quality : {SrcQuality::Medium, SrcQuality::High}) {
+        const Common::FixedPoint<49, 15> sample_rate_ratio{32000.0f / 48000.0f};
+        Common::FixedPoint<49, 15> fraction{0};
+        const auto resample_start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            Resample(output, input, sample_rate_ratio, fraction, sample_count, quality);
+        }
+        const std::chrono::duration<double> resample_elapsed =
+            std::chrono::steady_clock::now() - resample_start;
+        printf("Resample %s: %.2f M samples/s\n", quality == SrcQuality::High ? "high" : "medium",
+               static_cast<double>(sample_count) * iterations / resample_elapsed.count() / 1e6);
+    }
+}
@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/alignment.h"
+#include "common/logging/deferred.h"
+#include "common/logging/deferred_ring.h"
+#include "common/logging/formatter.h"
+
+namespace Common::Log {
+
+namespace {
+enum class ValueEnum : u16 { A = 3 };
+
+struct Custom {};
+
+template <typename T>
+T ReadAt(const u8* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+} // Anonymous namespace
+
+TEST_CASE("DeferredLog: Deferrable arguments", "[common]") {
+    STATIC_REQUIRE(IsDeferrable<>);
+    STATIC_REQUIRE(IsDeferrable<int, u64, bool, char, float, double>);
+    STATIC_REQUIRE(IsDeferrable<std::string, std::string_view, const char*, char[4]>);
+    STATIC_REQUIRE(IsDeferrable<const void*, std::nullptr_t, ValueEnum>);
+    STATIC_REQUIRE(!IsDeferrable<int, Custom>);
+    STATIC_REQUIRE(!IsDeferrable<const int*>);
+    STATIC_REQUIRE(!IsDeferrable<wchar_t>);
+}
+
+TEST_CASE("DeferredLog: Argument packing", "[common]") {
+    const std::string string = "text";
+    const s32 negative = -5;
+
+    std::array<u8, 64> buffer{};
+    u8* out = buffer.data();
+    out = Detail::WriteArg(out, negative);
+    out = Detail::WriteArg(out, string);
+    out = Detail::WriteArg(out, 'c');
+    out = Detail::WriteArg(out, 0.5f);
+    out = Detail::WriteArg(out, ValueEnum::A);
+
+    const size_t size = Detail::GetArgSize(negative) + Detail::GetArgSize(string) +
+                        Detail::GetArgSize('c') + Detail::GetArgSize(0.5f) +
+                        Detail::GetArgSize(ValueEnum::A);
+    REQUIRE(static_cast<size_t>(out - buffer.data()) == size);
+
+    const u8* in = buffer.data();
+    REQUIRE(in[0] == static_cast<u8>(ArgType::Signed));
+    REQUIRE(ReadAt<s64>(in + 1) == -5);
+    in += 1 + sizeof(s64);
+
+    REQUIRE(in[0] == static_cast<u8>(ArgType::String));
+    REQUIRE(ReadAt<u32>(in + 1) == string.size());
+    REQUIRE(std::string_view{reinterpret_cast<const char*>(in + 5), string.size()} == string);
+    in += 1 + sizeof(u32) + string.size();
+
+    REQUIRE(in[0] == static_cast<u8>(ArgType::Char));
+    REQUIRE(in[1] == 'c');
+    in += 2;
+
+    REQUIRE(in[0] == static_cast<u8>(ArgType::Float32));
+    REQUIRE(ReadAt<float>(in + 1) == 0.5f);
+    in += 1 + sizeof(float);
+
+    REQUIRE(in[0] == static_cast<u8>(ArgType::Unsigned));
+    REQUIRE(ReadAt<u64>(in + 1) == 3);
+}
+
+TEST_CASE("DeferredLog: Deferred and formatted messages of a thread stay in order", "[common]") {
+    constexpr unsigned int num_messages = 20'000;
+    const auto ring = std::make_unique<DeferredRing>();
+
+    // Every third message is formatted at the call site, like messages with a custom formatter
+    std::jthread producer([&ring] {
+        for (unsigned int line = 1; line <= num_messages; ++line) {
+            const DeferredRecord header{
+                .timestamp = line,
+                .filename = "file",
+                .function = "function",
+                .line_num = line,
+            };
+            if (line % 3 == 0) {
+                const std::string text = fmt::format("message {}", line);
+                while (!ring->PushText(header, text)) {
+                    std::this_thread::yield();
+                }
+                continue;
+            }
+            const size_t args_size = Detail::GetArgSize(line);
+            const size_t size =
+                Common::AlignUp(sizeof(DeferredRecord) + args_size, alignof(DeferredRecord));
+            DeferredRecord* record;
+            while ((record = ring->Reserve(size)) == nullptr) {
+                std::this_thread::yield();
+            }
+            record = std::construct_at(record, header);
+            record->size = static_cast<u32>(size);
+            record->num_args = 1;
+            record->args_size = static_cast<u32>(args_size);
+            record->format = "message {}";
+            Detail::WriteArg(record->Args(), line);
+            ring->Commit();
+        }
+    });
+
+    unsigned int expected = 1;
+    while (expected <= num_messages) {
+        const DeferredRecord* const record = ring->Front();
+        if (record == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        REQUIRE(record->line_num == expected);
+        REQUIRE(record->IsText() == (expected % 3 == 0));
+        if (record->IsText()) {
+            REQUIRE(record->Text() == fmt::format("message {}", expected));
+        } else {
+            REQUIRE(ReadAt<u64>(record->Args() + 1) == expected);
+        }
+        ring->Pop();
+        ++expected;
+    }
+    producer.join();
+    REQUIRE(ring->IsEmpty());
+
+    // Messages too large for the ring are left to the caller
+    const std::string large(DeferredRing::MAX_RECORD_SIZE, 'a');
+    REQUIRE(!ring->PushText(DeferredRecord{.filename = "file"}, large));
+    REQUIRE(ring->IsEmpty());
+}
+
+} // namespace Common::Log
@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/flat_hash_map.h"
+#include "common/hash.h"
+
+namespace {
+/// Same page size as the page tables of the texture cache
+constexpr u64 PAGE_BITS = 20;
+
+struct TraceImage {
+    u64 addr;
+    u64 size;
+};
+
+/// Page range accessed by a texture or render target lookup of a draw
+struct TraceAccess {
+    u64 addr;
+    u64 size;
+};
+
+/**
+ * Synthetic trace of the texture cache page table: images spread over the address space with a
+ * few large render targets, and draws looking up the regions of the images they bind, mostly
+ * among a small working set.
+ */
+struct Trace {
+    explicit Trace(u32 seed) {
+        std::mt19937_64 rng{seed};
+        for (u32 i = 0; i < 4096; ++i) {
+            const u64 size = i % 64 == 0 ? (8 + rng() % 32) << PAGE_BITS : 0x1000 + rng() % 0x80000;
+            images.push_back({.addr = (rng() % 0x100000) << 14, .size = size});
+        }
+        for (u32 draw = 0; draw < 1024; ++draw) {
+            for (u32 binding = 0; binding < 12; ++binding) {
+                const u64 index = binding < 10 ? rng() % 256 : rng() % images.size();
+                accesses.push_back({.addr = images[index].addr, .size = images[index].size});
+            }
+        }
+    }
+
+    std::vector<TraceImage> images;
+    std::vector<TraceAccess> accesses;
+};
+
+template <typename Map>
+void RegisterImages(Map& map, const Trace& trace) {
+    for (u32 id = 0; id < trace.images.size(); ++id) {
+        const TraceImage& image = trace.images[id];
+        const u64 page_end = (image.addr + image.size - 1) >> PAGE_BITS;
+        for (u64 page = image.addr >> PAGE_BITS; page <= page_end; ++page) {
+            map[page].push_back(id);
+        }
+    }
+}
+
+/// Walks the pages of every access like TextureCache::ForEachImageInRegion does
+template <typename Map>
+u64 ReplayAccesses(const Map& map, const Trace& trace) {
+    u64 result = 0;
+    for (const TraceAccess& access : trace.accesses) {
+        const u64 page_end = (access.addr + access.size - 1) >> PAGE_BITS;
+        for (u64 page = access.addr >> PAGE_BITS; page <= page_end; ++page) {
+            const auto it = map.find(page);
+            if (it == map.end()) {
+                continue;
+            }
+            for (const u32 id : it->second) {
+                const TraceImage& image = trace.images[id];
+                result += image.addr < access.addr + access.size &&
+                          access.addr < image.addr + image.size;
+            }
+        }
+    }
+    return result;
+}
+} // Anonymous namespace
+
+TEST_CASE("FlatHashMap[Operations]", "[common]") {
+    Common::FlatHashMap<u64, u64, Common::IdentityHash<u64>> map;
+    std::unordered_map<u64, u64> expected;
+    std::mt19937_64 rng{1234};
+    for (u32 i = 0; i < 100000; ++i) {
+        // A small key space makes inserts, erases and reused slots all common
+        const u64 key = rng() % 2048;
+        switch (rng() % 4) {
+        case 0:
+        case 1: {
+            const auto [it, is_new] = map.try_emplace(key, i);
+            const auto [expected_it, expected_is_new] = expected.try_emplace(key, i);
+            REQUIRE(is_new == expected_is_new);
+            REQUIRE(it->second == expected_it->second);
+            break;
+        }
+        case 2:
+            REQUIRE(map.erase(key) == expected.erase(key));
+            break;
+        case 3: {
+            const auto it = map.find(key);
+            const auto expected_it = expected.find(key);
+            REQUIRE((it == map.end()) == (expected_it == expected.end()));
+            if (it != map.end()) {
+                REQUIRE(it->second == expected_it->second);
+            }
+            break;
+        }
+        }
+        REQUIRE(map.size() == expected.size());
+    }
+
+    size_t num_visited = 0;
+    for (const auto& [key, value] : map) {
+        REQUIRE(expected.at(key) == value);
+        ++num_visited;
+    }
+    REQUIRE(num_visited == expected.size());
+
+    // Erasing while iterating visits every entry once
+    for (auto it = map.begin(); it != map.end();) {
+        it = it->second % 2 == 0 ? map.erase(it) : std::next(it);
+    }
+    std::erase_if(expected, [](const auto& pair) { return pair.second % 2 == 0; });
+    REQUIRE(map.size() == expected.size());
+    for (const auto& [key, value] : expected) {
+        REQUIRE(map.contains(key));
+        REQUIRE(map[key] == value);
+    }
+
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(map.begin() == map.end());
+}
+
+TEST_CASE("FlatHashMap[NonTrivial]", "[common]") {
+    Common::FlatHashMap<std::string, std::vector<u32>> map;
+    for (u32 i = 0; i < 1000; ++i) {
+        map[std::to_string(i % 100)].push_back(i);
+    }
+    REQUIRE(map.size() == 100);
+    for (u32 i = 0; i < 100; ++i) {
+        const auto it = map.find(std::to_string(i));
+        REQUIRE(it != map.end());
+        REQUIRE(it->second.size() == 10);
+        REQUIRE(it->second.front() == i);
+    }
+
+    auto moved = std::move(map);
+    REQUIRE(moved.size() == 100);
+    REQUIRE(moved.contains("42"));
+}
+
+TEST_CASE("FlatHashMap[Benchmark]", "[.][benchmark]") {
+    // Replays the page lookups of 1024 draws binding 12 textures each
+    const Trace trace{5678};
+    std::unordered_map<u64, std::vector<u32>, Common::IdentityHash<u64>> node_map;
+    Common::FlatHashMap<u64, boost::container::small_vector<u32, 4>, Common::IdentityHash<u64>>
+        flat_map;
+    RegisterImages(node_map, trace);
+    RegisterImages(flat_map, trace);
+    REQUIRE(ReplayAccesses(node_map, trace) == ReplayAccesses(flat_map, trace));
+
+    BENCHMARK("std::unordered_map, 1024 draws") {
+        return ReplayAccesses(node_map, trace);
+    };
+    BENCHMARK("FlatHashMap, 1024 draws") {
+        return ReplayAccesses(flat_map, trace);
+    };
+}
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <filesystem>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/common_types.h"
+#include "common/fs/file.h"
+#include "common/fs/mapped_file.h"
+
+namespace Common::FS {
+
+namespace {
+
+constexpr size_t DataSize = 100000;
+
+u8 ExpectedByte(u64 offset) {
+    return static_cast<u8>(offset * 7);
+}
+
+std::filesystem::path WriteTestFile(const char* name, size_t size) {
+    const auto path = std::filesystem::temp_directory_path() / name;
+    std::vector<u8> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = ExpectedByte(i);
+    }
+    IOFile file(path, FileAccessMode::Write, FileType::BinaryFile);
+    REQUIRE(file.WriteSpan(std::span<const u8>{data}) == size);
+    return path;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MappedFile: Concurrent reads", "[common]") {
+    const auto path = WriteTestFile("suyu_mapped_file_test.bin", DataSize);
+    {
+        MappedFile file(path);
+        REQUIRE(file.IsOpen());
+        REQUIRE(file.GetSize() == DataSize);
+        REQUIRE(file.GetMappedSpan().size() == DataSize);
+
+        std::vector<std::jthread> threads;
+        std::array<bool, 4> matches{};
+        for (size_t thread = 0; thread < matches.size(); thread++) {
+            threads.emplace_back([&file, &matches, thread] {
+                bool match = true;
+                std::vector<u8> buffer(1000);
+                // Read past the end of the file too, those reads must be trimmed
+                for (u64 offset = thread; offset < DataSize + 500; offset += 997) {
+                    const size_t expected_size =
+                        offset >= DataSize ? 0 : std::min<size_t>(1000, DataSize - offset);
+                    const size_t read_size = file.ReadAt(buffer, offset);
+                    match &= read_size == expected_size;
+                    for (size_t i = 0; i < read_size; i++) {
+                        match &= buffer[i] == ExpectedByte(offset + i);
+                    }
+                }
+                matches[thread] = match;
+            });
+        }
+        threads.clear();
+        for (const bool match : matches) {
+            REQUIRE(match);
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("MappedFile: Empty and missing files", "[common]") {
+    const auto path = WriteTestFile("suyu_mapped_file_empty.bin", 0);
+    {
+        MappedFile file(path);
+        REQUIRE(file.IsOpen());
+        REQUIRE(file.GetSize() == 0);
+        REQUIRE(file.GetMappedSpan().empty());
+
+        std::vector<u8> buffer(16);
+        REQUIRE(file.ReadAt(buffer, 0) == 0);
+    }
+    std::filesystem::remove(path);
+
+    MappedFile missing(path);
+    REQUIRE(!missing.IsOpen());
+}
+
+} // namespace Common::FS
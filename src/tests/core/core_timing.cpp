@@ -4,12 +4,15 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <array>
+#include <atomic>
 #include <bitset>
 #include <chrono>
 #include <cstdlib>
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -139,3 +142,68 @@ TEST_CASE("CoreTiming[BasicOrderNoPausing]", "[core]") {
     printf("HostTimer No Pausing Timer Time: %.3f %.6f\n", timer_time / 1000.f,
            timer_time / 1000000.f);
 }
+
+TEST_CASE("CoreTiming[MultiProducer]", "[core]") {
+    ScopeInit guard;
+    auto& core_timing = guard.core_timing;
+
+    constexpr size_t num_producers = 8;
+    constexpr size_t events_per_producer = 4096;
+
+    std::atomic<size_t> num_callbacks{};
+    std::atomic<size_t> num_unscheduled_callbacks{};
+    const auto event_type = Core::Timing::CreateEvent(
+        "MultiProducer",
+        [&](s64, std::chrono::nanoseconds) -> std::optional<std::chrono::nanoseconds> {
+            ++num_callbacks;
+            return std::nullopt;
+        });
+
+    std::array<std::shared_ptr<Core::Timing::EventType>, num_producers> unscheduled_types;
+    for (auto& type : unscheduled_types) {
+        type = Core::Timing::CreateEvent(
+            "MultiProducerUnscheduled",
+            [&](s64, std::chrono::nanoseconds) -> std::optional<std::chrono::nanoseconds> {
+                ++num_unscheduled_callbacks;
+                return std::nullopt;
+            });
+    }
+
+    core_timing.SyncPause(false);
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> producers;
+        for (size_t producer = 0; producer < num_producers; ++producer) {
+            producers.emplace_back([&, producer] {
+                for (size_t i = 0; i < events_per_producer; ++i) {
+                    core_timing.ScheduleEvent(std::chrono::nanoseconds{static_cast<s64>(i % 64)},
+                                              event_type);
+                    // Far enough in the future to always be unscheduled before it triggers
+                    core_timing.ScheduleEvent(std::chrono::seconds{60},
+                                              unscheduled_types[producer]);
+                    if (i % 16 == 0) {
+                        core_timing.UnscheduleEvent(unscheduled_types[producer],
+                                                    Core::Timing::UnscheduleEventType::NoWait);
+                    }
+                }
+                core_timing.UnscheduleEvent(unscheduled_types[producer]);
+            });
+        }
+    }
+    const auto scheduled = std::chrono::steady_clock::now();
+
+    while (core_timing.HasPendingEvents())
+        ;
+    const auto end = std::chrono::steady_clock::now();
+
+    REQUIRE(num_callbacks == num_producers * events_per_producer);
+    REQUIRE(num_unscheduled_callbacks == 0);
+
+    const auto seconds = [](auto duration) {
+        return std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+    };
+    const double total_events = static_cast<double>(num_producers * events_per_producer * 2);
+    printf("CoreTiming %zu producers: %.2f M schedules/s, %.2f M events retired/s\n",
+           num_producers, total_events / seconds(scheduled - start) / 1e6,
+           total_events / seconds(end - start) / 1e6);
+}
@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <random>
+#include <string_view>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/common_types.h"
+#include "common/hex_util.h"
+#include "core/crypto/aes_ctr_xts.h"
+
+namespace Core::Crypto {
+
+namespace {
+constexpr std::array KernelLevels{
+    AesKernelLevel::Generic,
+    AesKernelLevel::AESNI,
+    AesKernelLevel::VAES,
+};
+
+std::vector<u8> MakeRandomData(size_t size) {
+    std::mt19937 rng{size};
+    std::vector<u8> data(size);
+    for (auto& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+    return data;
+}
+} // Anonymous namespace
+
+TEST_CASE("AesCtrCipher: Known answer", "[core]") {
+    // NIST SP 800-38A F.5.1, the counter carries into its upper bytes after the first block
+    const auto key = Common::HexStringToArray<0x10>("2b7e151628aed2a6abf7158809cf4f3c");
+    const auto counter = Common::HexStringToArray<0x10>("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    const auto plaintext = Common::HexStringToVector("6bc1bee22e409f96e93d7e117393172a"
+                                                     "ae2d8a571e03ac9c9eb76fac45af8e51"
+                                                     "30c81c46a35ce411e5fbc1191a0a52ef"
+                                                     "f69f2445df4f9b17ad2b417be66c3710",
+                                                     false);
+    const auto ciphertext = Common::HexStringToVector("874d6191b620e3261bef6864990db6ce"
+                                                      "9806f66b7970fdff8617187bb9fffdff"
+                                                      "5ae4df3edbd5d35e5b4f09020db03eab"
+                                                      "1e031dda2fbe03d1792170a0f3009cee",
+                                                      false);
+
+    for (const auto level : KernelLevels) {
+        const AesCtrCipher cipher(key, level);
+        std::vector<u8> data = plaintext;
+        cipher.Transcode(data.data(), data.size(), data.data(), counter);
+        REQUIRE(data == ciphertext);
+
+        // Partial trailing blocks use the start of the key stream
+        std::vector<u8> partial(0x15);
+        cipher.Transcode(plaintext.data(), partial.size(), partial.data(), counter);
+        REQUIRE(std::equal(partial.begin(), partial.end(), ciphertext.begin()));
+    }
+}
+
+TEST_CASE("AesXtsCipher: Known answer", "[core]") {
+    // IEEE 1619-2007 vectors 1 and 2
+    const std::array<u8, 0x20> zero_key{};
+    const std::array<u8, 0x10> zero_tweak{};
+    const std::vector<u8> zero_plaintext(0x20);
+    const auto zero_ciphertext = Common::HexStringToVector(
+        "917cf69ebd68b2ec9b9fe9a3eadda692cd43d2f59598ed858c02c2652fbf922e", false);
+
+    std::array<u8, 0x20> key{};
+    std::fill(key.begin(), key.begin() + 0x10, u8{0x11});
+    std::fill(key.begin() + 0x10, key.end(), u8{0x22});
+    const auto tweak = Common::HexStringToArray<0x10>("33333333330000000000000000000000");
+    const std::vector<u8> plaintext(0x20, 0x44);
+    const auto ciphertext = Common::HexStringToVector(
+        "c454185e6a16936e39334038acef838bfb186fff7480adc4289382ecd6d394f0", false);
+
+    for (const auto level : KernelLevels) {
+        const AesXtsCipher zero_cipher(zero_key, level);
+        std::vector<u8> data(0x20);
+        zero_cipher.Encrypt(zero_plaintext.data(), data.size(), data.data(), zero_tweak, 0x200);
+        REQUIRE(data == zero_ciphertext);
+
+        const AesXtsCipher cipher(key, level);
+        cipher.Encrypt(plaintext.data(), data.size(), data.data(), tweak, 0x200);
+        REQUIRE(data == ciphertext);
+        cipher.Decrypt(data.data(), data.size(), data.data(), tweak, 0x200);
+        REQUIRE(data == plaintext);
+    }
+}
+
+TEST_CASE("AesCtrXts: Kernels and parallel splits match the generic kernel", "[core]") {
+    const auto ctr_key = Common::HexStringToArray<0x10>("000102030405060708090a0b0c0d0e0f");
+    const auto xts_key = Common::HexStringToArray<0x20>(
+        "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+    // The low half of the counter and the tweak overflow within the data
+    const auto counter = Common::HexStringToArray<0x10>("0000000000000001fffffffffffffff0");
+    const auto tweak = Common::HexStringToArray<0x10>("00000000000000000000000000ffffff");
+    constexpr size_t SectorSize = 0x4000;
+
+    // Large enough to be split across threads, with a short last sector
+    const auto plaintext = MakeRandomData(0x400000 + 0x1230);
+
+    const AesCtrCipher generic_ctr(ctr_key, AesKernelLevel::Generic);
+    std::vector<u8> expected_ctr(plaintext.size());
+    generic_ctr.Transcode(plaintext.data(), plaintext.size(), expected_ctr.data(), counter);
+
+    const AesXtsCipher generic_xts(xts_key, AesKernelLevel::Generic);
+    std::vector<u8> expected_xts(plaintext.size());
+    generic_xts.Encrypt(plaintext.data(), plaintext.size(), expected_xts.data(), tweak,
+                        SectorSize);
+
+    for (const auto level : KernelLevels) {
+        const AesCtrCipher ctr(ctr_key, level);
+        std::vector<u8> data(plaintext.size());
+        ctr.Transcode(plaintext.data(), plaintext.size(), data.data(), counter);
+        REQUIRE(data == expected_ctr);
+
+        const AesXtsCipher xts(xts_key, level);
+        xts.Encrypt(plaintext.data(), plaintext.size(), data.data(), tweak, SectorSize);
+        REQUIRE(data == expected_xts);
+        xts.Decrypt(data.data(), data.size(), data.data(), tweak, SectorSize);
+        REQUIRE(data == plaintext);
+    }
+}
+
+} // namespace Core::Crypto
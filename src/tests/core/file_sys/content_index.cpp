@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/common_types.h"
+#include "common/fs/fs.h"
+#include "core/file_sys/content_index.h"
+
+namespace FileSys {
+
+TEST_CASE("ContentIndex: Entries persist until their file changes", "[core]") {
+    const auto path = std::filesystem::temp_directory_path() / "suyu_content_index_test.bin";
+    void(Common::FS::RemoveFile(path));
+
+    const ContentIndexStamp stamp{.size = 0x1000, .modification_time = 1234};
+    const ContentIndexStamp changed_stamp{.size = 0x1000, .modification_time = 5678};
+    const std::vector<u8> data{1, 2, 3, 4};
+    {
+        ContentIndex index(path);
+        REQUIRE(!index.Find("kept", stamp));
+        index.Insert("kept", stamp, data);
+        index.Insert("removed", stamp, data);
+        REQUIRE(index.Commit());
+    }
+    {
+        ContentIndex index(path);
+        REQUIRE(index.Find("kept", stamp) == data);
+        REQUIRE(!index.Find("kept", changed_stamp));
+        // Entries that are not used before a commit are dropped by it
+        REQUIRE(index.Commit());
+    }
+    {
+        ContentIndex index(path);
+        REQUIRE(index.Find("kept", stamp) == data);
+        REQUIRE(!index.Find("removed", stamp));
+    }
+    REQUIRE(Common::FS::RemoveFile(path));
+}
+
+TEST_CASE("ContentIndex: Reader rejects truncated data", "[core]") {
+    ContentIndexWriter writer;
+    writer.Write(u64{0x1122334455667788});
+    writer.WriteString("name");
+    auto data = writer.Release();
+
+    {
+        ContentIndexReader reader(data);
+        REQUIRE(reader.Read<u64>() == 0x1122334455667788);
+        REQUIRE(reader.ReadString() == "name");
+        REQUIRE(reader.IsValid());
+    }
+
+    data.pop_back();
+    ContentIndexReader reader(data);
+    REQUIRE(reader.Read<u64>() == 0x1122334455667788);
+    REQUIRE(reader.ReadString().empty());
+    REQUIRE(!reader.IsValid());
+}
+
+} // namespace FileSys
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/common_types.h"
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "core/file_sys/layered_romfs.h"
+#include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs/vfs_layered.h"
+#include "core/file_sys/vfs/vfs_real.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+namespace FileSys {
+namespace {
+VirtualFile MakeFile(std::string_view name, std::string_view contents) {
+    return std::make_shared<VectorVfsFile>(std::vector<u8>(contents.begin(), contents.end()),
+                                           std::string{name});
+}
+
+void WriteHostFile(const std::filesystem::path& path, std::string_view contents) {
+    REQUIRE(Common::FS::CreateParentDirs(path));
+    REQUIRE(Common::FS::WriteStringToFile(path, Common::FS::FileType::BinaryFile, contents) ==
+            contents.size());
+}
+
+/// Builds the layered RomFS the way it was built before the layout cache
+std::vector<u8> BuildExpected(const VirtualFile& base_romfs, const VirtualDir& mod) {
+    auto layered = LayeredVfsDirectory::MakeLayeredDirectory({mod, ExtractRomFS(base_romfs)});
+    return CreateRomFS(std::move(layered))->ReadAllBytes();
+}
+} // Anonymous namespace
+
+TEST_CASE("LayeredRomFS: Cached layouts match a full build", "[core]") {
+    const auto root = std::filesystem::temp_directory_path() / "suyu_layered_romfs_test";
+    void(Common::FS::RemoveDirRecursively(root));
+    const auto mod_path = root / "mod" / "romfs";
+    const auto cache_path = root / "cache.bin";
+
+    const auto base_dir = std::make_shared<VectorVfsDirectory>(
+        std::vector<VirtualFile>{MakeFile("a.txt", "base a"), MakeFile("b.txt", "base b")},
+        std::vector<VirtualDir>{std::make_shared<VectorVfsDirectory>(
+            std::vector<VirtualFile>{MakeFile("c.bin", "base c")}, std::vector<VirtualDir>{},
+            "data")});
+    const VirtualFile base_romfs =
+        std::make_shared<VectorVfsFile>(CreateRomFS(base_dir)->ReadAllBytes());
+
+    WriteHostFile(mod_path / "b.txt", "mod b");
+    WriteHostFile(mod_path / "data" / "c.bin", "mod c, longer than the base file");
+    WriteHostFile(mod_path / "data" / "new" / "d.txt", "mod d");
+
+    RealVfsFilesystem filesystem;
+    const auto open_mod = [&] {
+        return filesystem.OpenDirectory(Common::FS::PathToUTF8String(mod_path));
+    };
+    const auto expected = BuildExpected(base_romfs, open_mod());
+
+    // The first build writes the layout, the second one loads it
+    for (int i = 0; i < 2; ++i) {
+        const auto romfs = CreateLayeredRomFS(base_romfs, {open_mod()}, {}, cache_path);
+        REQUIRE(romfs != nullptr);
+        REQUIRE(romfs->ReadAllBytes() == expected);
+        REQUIRE(Common::FS::Exists(cache_path));
+    }
+
+    // Changing a mod file changes the fingerprint, so the stale layout is not used
+    WriteHostFile(mod_path / "data" / "c.bin", "mod c, changed");
+    const auto changed = BuildExpected(base_romfs, open_mod());
+    REQUIRE(changed != expected);
+    for (int i = 0; i < 2; ++i) {
+        const auto romfs = CreateLayeredRomFS(base_romfs, {open_mod()}, {}, cache_path);
+        REQUIRE(romfs != nullptr);
+        REQUIRE(romfs->ReadAllBytes() == changed);
+    }
+
+    void(Common::FS::RemoveDirRecursively(root));
+}
+
+} // namespace FileSys
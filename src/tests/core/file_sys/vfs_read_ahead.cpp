@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/common_types.h"
+#include "core/file_sys/vfs/vfs_read_ahead.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+namespace FileSys {
+namespace {
+std::vector<u8> MakeContents(size_t size) {
+    std::vector<u8> contents(size);
+    for (size_t i = 0; i < size; ++i) {
+        contents[i] = static_cast<u8>(i * 7 + i / 251);
+    }
+    return contents;
+}
+} // Anonymous namespace
+
+TEST_CASE("ReadAheadVfsFile: Sequential reads are served from read ahead blocks", "[core]") {
+    constexpr size_t size = ReadAheadVfsFile::BlockSize * 16 + 1234;
+    const auto contents = MakeContents(size);
+    const auto statistics = std::make_shared<ReadAheadStatistics>();
+    const ReadAheadVfsFile file{std::make_shared<VectorVfsFile>(contents), statistics};
+
+    // Odd sized reads cross block boundaries
+    constexpr size_t chunk_size = 100'003;
+    std::vector<u8> result(size);
+    for (size_t offset = 0; offset < size; offset += chunk_size) {
+        const size_t length = std::min(chunk_size, size - offset);
+        REQUIRE(file.Read(result.data() + offset, length, offset) == length);
+    }
+    REQUIRE(result == contents);
+    REQUIRE(statistics->hits > 0);
+    REQUIRE(statistics->bytes_prefetched > 0);
+}
+
+TEST_CASE("ReadAheadVfsFile: Interleaved and random reads return the file data", "[core]") {
+    constexpr size_t size = ReadAheadVfsFile::BlockSize * 12;
+    const auto contents = MakeContents(size);
+    const auto statistics = std::make_shared<ReadAheadStatistics>();
+    const ReadAheadVfsFile file{std::make_shared<VectorVfsFile>(contents), statistics};
+
+    constexpr size_t chunk_size = 64'000;
+    const size_t half = size / 2;
+    std::vector<u8> buffer(chunk_size);
+    for (size_t offset = 0; offset < half; offset += chunk_size) {
+        for (const size_t base : {size_t{0}, half}) {
+            const size_t length = std::min(chunk_size, half - offset);
+            REQUIRE(file.Read(buffer.data(), length, base + offset) == length);
+            REQUIRE(std::equal(buffer.begin(), buffer.begin() + length,
+                               contents.begin() + base + offset));
+        }
+    }
+
+    u64 seed = 1;
+    for (size_t i = 0; i < 64; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const size_t offset = (seed >> 16) % size;
+        const size_t length = std::min(chunk_size, size - offset);
+        REQUIRE(file.Read(buffer.data(), chunk_size, offset) == length);
+        REQUIRE(std::equal(buffer.begin(), buffer.begin() + length, contents.begin() + offset));
+    }
+    REQUIRE(file.Read(buffer.data(), chunk_size, size) == 0);
+    REQUIRE(statistics->hits > 0);
+}
+
+TEST_CASE("ReadAheadVfsFile: Files that would not benefit are only serialized", "[core]") {
+    const auto statistics = std::make_shared<ReadAheadStatistics>();
+    const auto contents = MakeContents(ReadAheadVfsFile::BlockSize);
+    const VirtualFile small =
+        ReadAheadVfsFile::Create(std::make_shared<VectorVfsFile>(contents), statistics);
+    REQUIRE(std::dynamic_pointer_cast<SerializedVfsFile>(small) != nullptr);
+    REQUIRE(small->ReadAllBytes() == contents);
+
+    // Vector files are writable, writes go through to them
+    const auto vector_file =
+        std::make_shared<VectorVfsFile>(MakeContents(ReadAheadVfsFile::BlockSize * 4));
+    const VirtualFile writable = ReadAheadVfsFile::Create(vector_file, statistics);
+    REQUIRE(std::dynamic_pointer_cast<SerializedVfsFile>(writable) != nullptr);
+    REQUIRE(writable->IsWritable());
+    REQUIRE(writable->WriteByte(0xAB, 5));
+    REQUIRE(vector_file->ReadByte(5) == 0xAB);
+
+    REQUIRE(ReadAheadVfsFile::Create(nullptr, statistics) == nullptr);
+    REQUIRE(statistics->bytes_prefetched == 0);
+}
+
+} // namespace FileSys
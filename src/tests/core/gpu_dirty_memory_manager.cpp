@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/gpu_dirty_memory_manager.h"
+
+namespace {
+using Range = std::pair<PAddr, size_t>;
+
+constexpr size_t NUM_WRITERS = 4;
+
+std::vector<Range> Gather(Core::GPUDirtyMemoryManager& manager) {
+    std::vector<Range> ranges;
+    std::function<void(PAddr, size_t)> callback = [&](PAddr address, size_t size) {
+        ranges.emplace_back(address, size);
+    };
+    manager.Gather(callback);
+    return ranges;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("GPUDirtyMemoryManager: Single write", "[core]") {
+    auto manager = std::make_unique<Core::GPUDirtyMemoryManager>();
+    manager->Collect(0x1008, 4);
+    REQUIRE(Gather(*manager) == std::vector<Range>{{0x1000, 64}});
+    REQUIRE(Gather(*manager).empty());
+}
+
+TEST_CASE("GPUDirtyMemoryManager: Adjacent writes are merged", "[core]") {
+    auto manager = std::make_unique<Core::GPUDirtyMemoryManager>();
+    manager->Collect(0x2000, 8);
+    manager->Collect(0x2040, 8);
+    manager->Collect(0x2fc0, 64);
+    manager->Collect(0x3000, 4);
+    manager->Collect(0x5000, 4);
+    REQUIRE(Gather(*manager) ==
+            std::vector<Range>{{0x2000, 0x80}, {0x2fc0, 0x80}, {0x5000, 64}});
+}
+
+TEST_CASE("GPUDirtyMemoryManager: Writes crossing pages", "[core]") {
+    auto manager = std::make_unique<Core::GPUDirtyMemoryManager>();
+    manager->Collect(0x10f80, 0x2100);
+    REQUIRE(Gather(*manager) == std::vector<Range>{{0x10f80, 0x2100}});
+}
+
+TEST_CASE("GPUDirtyMemoryManager: Distant chunks", "[core]") {
+    auto manager = std::make_unique<Core::GPUDirtyMemoryManager>();
+    const PAddr high = (1ULL << 34) - 64;
+    manager->Collect(high, 64);
+    manager->Collect(0, 1);
+    manager->Collect(1ULL << 34, 64);
+    REQUIRE(Gather(*manager) == std::vector<Range>{{0, 64}, {high, 64}});
+}
+
+TEST_CASE("GPUDirtyMemoryManager: Concurrent writers", "[core]") {
+    auto manager = std::make_unique<Core::GPUDirtyMemoryManager>();
+    constexpr size_t writes_per_thread = 1 << 14;
+    std::unordered_set<PAddr> dirty_blocks;
+    const auto add_ranges = [&dirty_blocks](const std::vector<Range>& ranges) {
+        for (const auto& [address, size] : ranges) {
+            for (PAddr block = address; block < address + size; block += 64) {
+                dirty_blocks.insert(block);
+            }
+        }
+    };
+    std::atomic<bool> done{false};
+    std::thread gatherer([&] {
+        while (!done.load(std::memory_order_acquire)) {
+            add_ranges(Gather(*manager));
+        }
+    });
+    std::vector<std::thread> writers;
+    for (size_t thread = 0; thread < NUM_WRITERS; ++thread) {
+        writers.emplace_back([&manager, thread] {
+            for (size_t i = 0; i < writes_per_thread; ++i) {
+                manager->Collect((thread << 24) + i * 128, 8);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done.store(true, std::memory_order_release);
+    gatherer.join();
+    add_ranges(Gather(*manager));
+
+    // Every write must be reported by some Gather
+    size_t lost_writes = 0;
+    for (size_t thread = 0; thread < NUM_WRITERS; ++thread) {
+        for (size_t i = 0; i < writes_per_thread; ++i) {
+            lost_writes += dirty_blocks.contains((thread << 24) + i * 128) ? 0 : 1;
+        }
+    }
+    REQUIRE(lost_writes == 0);
+}
+
+TEST_CASE("GPUDirtyMemoryManager[Benchmark]", "[.][benchmark]") {
+    // Each writer interleaves two streams, like CPU side vertex and uniform uploads
+    constexpr size_t writes_per_thread = 1 << 20;
+    auto manager = std::make_unique<Core::GPUDirtyMemoryManager>();
+    std::function<void(PAddr, size_t)> discard = [](PAddr, size_t) {};
+
+    BENCHMARK("Collect with " + std::to_string(NUM_WRITERS) + " writers") {
+        std::vector<std::thread> writers;
+        for (size_t thread = 0; thread < NUM_WRITERS; ++thread) {
+            writers.emplace_back([&manager, thread] {
+                const PAddr vertices = thread << 28;
+                const PAddr uniforms = vertices + (1 << 24);
+                for (size_t i = 0; i < writes_per_thread; i += 2) {
+                    manager->Collect(vertices + (i * 16) % (1 << 24), 16);
+                    manager->Collect(uniforms + (i * 4) % (1 << 16), 4);
+                }
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+        manager->Gather(discard);
+    };
+}
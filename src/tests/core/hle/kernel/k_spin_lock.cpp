@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/common_types.h"
+#include "core/hle/kernel/k_spin_lock.h"
+
+namespace Kernel {
+
+static_assert(alignof(KAlignedSpinLock) == 64);
+
+TEST_CASE("KSpinLock: Mutual exclusion under contention", "[core]") {
+    constexpr u32 NumThreads = 8;
+    constexpr u32 NumIterations = 20000;
+
+    KAlignedSpinLock lock;
+    u64 counter = 0;
+    u64 num_try_locks = 0;
+    bool try_lock_contended = false;
+
+    std::vector<std::jthread> threads;
+    for (u32 i = 0; i < NumThreads; ++i) {
+        threads.emplace_back([&, i] {
+            for (u32 iteration = 0; iteration < NumIterations; ++iteration) {
+                // Half of the threads mix in try-locks to exercise both acquire paths
+                if (i % 2 == 0 && iteration % 4 == 0 && lock.TryLock()) {
+                    try_lock_contended |= lock.WasContended();
+                    ++num_try_locks;
+                } else {
+                    lock.Lock();
+                }
+                ++counter;
+                if (iteration % 64 == 0) {
+                    // Hold the lock for a while now and then so some waiters park
+                    std::this_thread::yield();
+                }
+                lock.Unlock();
+            }
+        });
+    }
+    threads.clear();
+
+    REQUIRE(counter == u64{NumThreads} * NumIterations);
+    REQUIRE_FALSE(try_lock_contended);
+    const KSpinLockStatistics stats = lock.GetStatistics();
+    REQUIRE(stats.acquire_count == counter);
+    REQUIRE(stats.contended_count <= stats.acquire_count - num_try_locks);
+    REQUIRE(stats.parked_count <= stats.contended_count);
+}
+
+TEST_CASE("KSpinLock: TryLock", "[core]") {
+    KSpinLock lock;
+    REQUIRE(lock.TryLock());
+    REQUIRE_FALSE(lock.TryLock());
+    lock.Unlock();
+
+    lock.Lock();
+    REQUIRE_FALSE(lock.WasContended());
+    REQUIRE_FALSE(lock.TryLock());
+    lock.Unlock();
+    REQUIRE(lock.TryLock());
+    lock.Unlock();
+
+    const KSpinLockStatistics stats = lock.GetStatistics();
+    REQUIRE(stats.acquire_count == 3);
+    REQUIRE(stats.contended_count == 0);
+}
+
+} // namespace Kernel
@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+
+#include "common/common_types.h"
+#include "core/hle/kernel/svc.h"
+#include "core/hle/kernel/svc_statistics.h"
+
+namespace {
+using Kernel::SvcStatistics;
+using Caller = SvcStatistics::Caller;
+
+constexpr u32 SetHeapSize = static_cast<u32>(Kernel::Svc::SvcId::SetHeapSize);
+constexpr u32 SleepThread = static_cast<u32>(Kernel::Svc::SvcId::SleepThread);
+} // Anonymous namespace
+
+TEST_CASE("SvcStatistics: Counters are summed over cores", "[core]") {
+    SvcStatistics statistics;
+    statistics.Record(0, SleepThread, 1000, std::nullopt);
+    statistics.Record(1, SleepThread, 3000, std::nullopt);
+    statistics.Record(3, SleepThread, 2000, std::nullopt);
+    statistics.Record(2, SetHeapSize, 500, std::nullopt);
+
+    const SvcStatistics::SvcCounters sleep = statistics.GetSvcCounters(SleepThread);
+    REQUIRE(sleep.count == 3);
+    REQUIRE(sleep.total_ns == 6000);
+    REQUIRE(sleep.max_ns == 3000);
+    REQUIRE(statistics.GetSvcCounters(SetHeapSize).count == 1);
+    REQUIRE(statistics.GetSvcCounters(0).count == 0);
+
+    // Invalid calls are not recorded
+    statistics.Record(0, SvcStatistics::NumSvcIds, 100, std::nullopt);
+    REQUIRE(statistics.GetSvcCounters(SvcStatistics::NumSvcIds).count == 0);
+
+    statistics.Reset();
+    REQUIRE(statistics.GetSvcCounters(SleepThread).count == 0);
+    REQUIRE(statistics.GetSvcCounters(SleepThread).max_ns == 0);
+}
+
+TEST_CASE("SvcStatistics: Latencies are bucketed by powers of two", "[core]") {
+    SvcStatistics statistics;
+    for (const u64 ns : {0ULL, 255ULL, 256ULL, 511ULL, 512ULL, 1023ULL, 1024ULL, 1ULL << 40}) {
+        statistics.Record(0, SleepThread, ns, std::nullopt);
+    }
+    const SvcStatistics::SvcCounters counters = statistics.GetSvcCounters(SleepThread);
+    REQUIRE(counters.histogram[0] == 2);
+    REQUIRE(counters.histogram[1] == 2);
+    REQUIRE(counters.histogram[2] == 2);
+    REQUIRE(counters.histogram[3] == 1);
+    // Latencies past the last bucket are clamped to it
+    REQUIRE(counters.histogram[SvcStatistics::NumHistogramBuckets - 1] == 1);
+    u64 total = 0;
+    for (const u64 bucket : counters.histogram) {
+        total += bucket;
+    }
+    REQUIRE(total == counters.count);
+}
+
+TEST_CASE("SvcStatistics: Threads are tracked across cores", "[core]") {
+    SvcStatistics statistics;
+    statistics.Record(0, SleepThread, 100, Caller{.thread_id = 7, .process_id = 81});
+    statistics.Record(1, SetHeapSize, 200, Caller{.thread_id = 7, .process_id = 81});
+    statistics.Record(1, SetHeapSize, 300, Caller{.thread_id = 8, .process_id = 81});
+    statistics.Record(2, SetHeapSize, 400, std::nullopt);
+
+    const auto thread = statistics.GetThreadCounters(7);
+    REQUIRE(thread.has_value());
+    REQUIRE(thread->process_id == 81);
+    REQUIRE(thread->count == 2);
+    REQUIRE(thread->total_ns == 300);
+    REQUIRE(statistics.GetThreadCounters(8)->count == 1);
+    REQUIRE(!statistics.GetThreadCounters(9).has_value());
+}
+
+TEST_CASE("SvcStatistics: Reports are JSON sorted by total latency", "[core]") {
+    SvcStatistics statistics;
+    REQUIRE(!statistics.Begin().has_value());
+    statistics.SetEnabled(true);
+    REQUIRE(statistics.Begin().has_value());
+
+    statistics.Record(0, SetHeapSize, 100, Caller{.thread_id = 7, .process_id = 81});
+    statistics.Record(0, SleepThread, 5000, Caller{.thread_id = 8, .process_id = 81});
+    statistics.Record(1, SleepThread, 3000, Caller{.thread_id = 8, .process_id = 81});
+    statistics.Record(1, 0xFF, 10, std::nullopt);
+
+    const nlohmann::json json = nlohmann::json::parse(statistics.ToJson());
+    REQUIRE(json["histogram_bucket_base_ns"] == 256);
+
+    const auto& svcs = json["svcs"];
+    REQUIRE(svcs.size() == 3);
+    REQUIRE(svcs[0]["name"] == "SleepThread");
+    REQUIRE(svcs[0]["id"] == SleepThread);
+    REQUIRE(svcs[0]["count"] == 2);
+    REQUIRE(svcs[0]["total_ns"] == 8000);
+    REQUIRE(svcs[0]["average_ns"] == 4000);
+    REQUIRE(svcs[0]["max_ns"] == 5000);
+    REQUIRE(svcs[0]["histogram"].size() == SvcStatistics::NumHistogramBuckets);
+    REQUIRE(svcs[0]["histogram"][4] == 1);
+    REQUIRE(svcs[0]["histogram"][5] == 1);
+    REQUIRE(svcs[1]["name"] == "SetHeapSize");
+    REQUIRE(svcs[2]["name"] == "UnknownFF");
+
+    const auto& cores = json["cores"];
+    REQUIRE(cores.size() == Core::Hardware::NUM_CPU_CORES);
+    REQUIRE(cores[0]["count"] == 2);
+    REQUIRE(cores[1]["count"] == 2);
+    REQUIRE(cores[2]["count"] == 0);
+
+    const auto& threads = json["threads"];
+    REQUIRE(threads.size() == 2);
+    REQUIRE(threads[0]["thread_id"] == 8);
+    REQUIRE(threads[0]["process_id"] == 81);
+    REQUIRE(threads[0]["count"] == 2);
+    REQUIRE(threads[0]["total_ns"] == 8000);
+    REQUIRE(threads[1]["thread_id"] == 7);
+}
@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/scratch_buffer.h"
+#include "core/hle/service/cmif_serialization.h"
+
+namespace {
+/// Request context with a single output buffer backed by host memory
+class FakeContext {
+public:
+    explicit FakeContext(size_t size, bool is_direct_, size_t offset = 0)
+        : guest(size + offset), buffer{std::span(guest).subspan(offset)}, is_direct{is_direct_} {}
+
+    std::span<u8> GetWriteBufferSpan(size_t) const {
+        return is_direct ? buffer : std::span<u8>{};
+    }
+
+    std::span<u8> GetWriteBufferSpanB(size_t index) const {
+        return GetWriteBufferSpan(index);
+    }
+
+    std::span<u8> GetWriteBufferSpanC(size_t index) const {
+        return GetWriteBufferSpan(index);
+    }
+
+    bool CanWriteBuffer(size_t) const {
+        return true;
+    }
+
+    size_t GetWriteBufferSize(size_t) const {
+        return buffer.size();
+    }
+
+    size_t WriteBuffer(const void* data, size_t size, size_t) {
+        ++num_writes;
+        std::memcpy(buffer.data(), data, std::min(size, buffer.size()));
+        return size;
+    }
+
+    size_t WriteBufferB(const void* data, size_t size, size_t index) {
+        return WriteBuffer(data, size, index);
+    }
+
+    size_t WriteBufferC(const void* data, size_t size, size_t index) {
+        return WriteBuffer(data, size, index);
+    }
+
+    std::vector<u8> guest;
+    std::span<u8> buffer;
+    bool is_direct;
+    size_t num_writes{};
+};
+
+/// Runs a handler writing an output buffer of u32 values the way CMIF handlers are run
+template <Service::BufferAttr Attr>
+std::span<u32> WriteValues(FakeContext& ctx, Common::ScratchBuffer<u8>& scratch) {
+    const std::span<u32> values = Service::GetOutBufferStorage<u32, Attr>(ctx, 0, scratch);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<u32>(i + 1) * 0x01010101;
+    }
+    Service::WriteOutBufferStorage<Attr>(ctx, 0, scratch);
+    return values;
+}
+
+bool HoldsValues(std::span<const u8> guest) {
+    for (size_t i = 0; i < guest.size() / sizeof(u32); ++i) {
+        u32 value;
+        std::memcpy(&value, guest.data() + i * sizeof(u32), sizeof(value));
+        if (value != static_cast<u32>(i + 1) * 0x01010101) {
+            return false;
+        }
+    }
+    return true;
+}
+} // Anonymous namespace
+
+TEST_CASE("CMIF: Output buffers are written directly to guest memory", "[core]") {
+    FakeContext ctx(0x40, true);
+    Common::ScratchBuffer<u8> scratch;
+    const std::span<u32> values = WriteValues<Service::BufferAttr_HipcMapAlias>(ctx, scratch);
+    REQUIRE(reinterpret_cast<u8*>(values.data()) == ctx.buffer.data());
+    REQUIRE(values.size() == 0x10);
+    REQUIRE(scratch.size() == 0);
+    REQUIRE(ctx.num_writes == 0);
+    REQUIRE(HoldsValues(ctx.buffer));
+}
+
+TEST_CASE("CMIF: Output buffers fall back to scratch memory", "[core]") {
+    FakeContext ctx(0x40, false);
+    Common::ScratchBuffer<u8> scratch;
+    const std::span<u32> values = WriteValues<Service::BufferAttr_HipcPointer>(ctx, scratch);
+    REQUIRE(reinterpret_cast<u8*>(values.data()) == scratch.data());
+    REQUIRE(values.size() == 0x10);
+    REQUIRE(ctx.num_writes == 1);
+    REQUIRE(HoldsValues(ctx.buffer));
+}
+
+TEST_CASE("CMIF: Misaligned output buffers fall back to scratch memory", "[core]") {
+    FakeContext ctx(0x40, true, 2);
+    Common::ScratchBuffer<u8> scratch;
+    const std::span<u32> values = WriteValues<Service::BufferAttr_HipcAutoSelect>(ctx, scratch);
+    REQUIRE(reinterpret_cast<u8*>(values.data()) == scratch.data());
+    REQUIRE(reinterpret_cast<uintptr_t>(values.data()) % alignof(u32) == 0);
+    REQUIRE(ctx.num_writes == 1);
+    REQUIRE(HoldsValues(ctx.buffer));
+
+    // Byte buffers are written directly at any address
+    Common::ScratchBuffer<u8> byte_scratch;
+    const std::span<u8> bytes =
+        Service::GetOutBufferStorage<u8, Service::BufferAttr_HipcAutoSelect>(ctx, 0, byte_scratch);
+    REQUIRE(bytes.data() == ctx.buffer.data());
+    REQUIRE(byte_scratch.size() == 0);
+}
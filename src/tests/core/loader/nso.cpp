@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/lz4_compression.h"
+#include "common/scope_exit.h"
+#include "common/settings.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+#include "core/loader/nso.h"
+#include "core/memory.h"
+
+namespace Loader {
+namespace {
+/// Vector file exposing its contents like a memory mapped file
+class MappedVfsFile : public FileSys::VectorVfsFile {
+public:
+    explicit MappedVfsFile(std::vector<u8> contents_)
+        : VectorVfsFile(contents_), contents{std::move(contents_)} {}
+
+    std::span<const u8> GetMappedSpan() const override {
+        return contents;
+    }
+
+private:
+    std::vector<u8> contents;
+};
+
+struct SegmentSource {
+    u32 location;
+    u32 size;
+    bool is_compressed;
+};
+
+std::vector<u8> MakeSegment(u32 size, u32 seed) {
+    // Repeating runs so LZ4 has something to compress
+    std::vector<u8> segment(size);
+    for (u32 i = 0; i < size; ++i) {
+        segment[i] = static_cast<u8>((i / 7) * seed + (i % 3));
+    }
+    return segment;
+}
+
+/// Builds an NSO file out of the given segments, filled by MakeSegment
+std::vector<u8> MakeNSO(const std::array<SegmentSource, 3>& sources, u32 bss_size) {
+    NSOHeader header{};
+    header.magic = Common::MakeMagic('N', 'S', 'O', '0');
+    for (size_t i = 0; i < header.build_id.size(); ++i) {
+        header.build_id[i] = static_cast<u8>(i + 1);
+    }
+    std::vector<u8> body;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const std::vector<u8> segment = MakeSegment(sources[i].size, static_cast<u32>(i) + 3);
+        const std::vector<u8> stored =
+            sources[i].is_compressed
+                ? Common::Compression::CompressDataLZ4(segment.data(), segment.size())
+                : segment;
+        header.flags |= sources[i].is_compressed ? 1U << i : 0U;
+        header.segments[i].offset = static_cast<u32>(sizeof(NSOHeader) + body.size());
+        header.segments[i].location = sources[i].location;
+        header.segments[i].size = sources[i].size;
+        header.segments_compressed_size[i] = static_cast<u32>(stored.size());
+        body.insert(body.end(), stored.begin(), stored.end());
+    }
+    header.segments[2].bss_size = bss_size;
+
+    std::vector<u8> nso(sizeof(NSOHeader));
+    std::memcpy(nso.data(), &header, sizeof(NSOHeader));
+    nso.insert(nso.end(), body.begin(), body.end());
+    return nso;
+}
+
+/// Program image built the way the loader did before loading segments in place: every segment
+/// decompressed into a vector of its own, then copied into the image
+NSOModuleImage ReferenceImage(const FileSys::VfsFile& nso_file, bool should_pass_arguments) {
+    constexpr auto page_align = [](u32 size) {
+        return static_cast<u32>((size + Core::Memory::SUYU_PAGEMASK) &
+                                ~Core::Memory::SUYU_PAGEMASK);
+    };
+    NSOModuleImage image;
+    NSOHeader& header = image.header;
+    REQUIRE(nso_file.ReadObject(&header) == sizeof(NSOHeader));
+
+    Kernel::CodeSet& codeset = image.codeset;
+    Kernel::PhysicalMemory& program_image = image.program_image;
+    for (size_t i = 0; i < header.segments.size(); ++i) {
+        std::vector<u8> data =
+            nso_file.ReadBytes(header.segments_compressed_size[i], header.segments[i].offset);
+        if (header.IsSegmentCompressed(i)) {
+            data = Common::Compression::DecompressDataLZ4(data, header.segments[i].size);
+        }
+        program_image.resize(header.segments[i].location + static_cast<u32>(data.size()));
+        std::memcpy(program_image.data() + header.segments[i].location, data.data(),
+                    data.size());
+        codeset.segments[i].addr = header.segments[i].location;
+        codeset.segments[i].offset = header.segments[i].location;
+        codeset.segments[i].size = header.segments[i].size;
+    }
+
+    if (should_pass_arguments && !Settings::values.program_args.GetValue().empty()) {
+        const auto arg_data{Settings::values.program_args.GetValue()};
+
+        codeset.DataSegment().size += NSO_ARGUMENT_DATA_ALLOCATION_SIZE;
+        NSOArgumentHeader args_header{
+            NSO_ARGUMENT_DATA_ALLOCATION_SIZE, static_cast<u32_le>(arg_data.size()), {}};
+        const auto end_offset = program_image.size();
+        program_image.resize(static_cast<u32>(program_image.size()) +
+                             NSO_ARGUMENT_DATA_ALLOCATION_SIZE);
+        std::memcpy(program_image.data() + end_offset, &args_header, sizeof(NSOArgumentHeader));
+        std::memcpy(program_image.data() + end_offset + sizeof(NSOArgumentHeader), arg_data.data(),
+                    arg_data.size());
+    }
+
+    codeset.DataSegment().size += header.segments[2].bss_size;
+    program_image.resize(
+        page_align(static_cast<u32>(program_image.size()) + header.segments[2].bss_size));
+
+    for (size_t i = 0; i < header.segments.size(); ++i) {
+        codeset.segments[i].size = page_align(codeset.segments[i].size);
+    }
+    return image;
+}
+
+void RequireSameImage(const NSOModuleImage& image, const NSOModuleImage& reference) {
+    REQUIRE(image.module_start == 0);
+    REQUIRE(std::memcmp(&image.header, &reference.header, sizeof(NSOHeader)) == 0);
+    for (size_t i = 0; i < image.codeset.segments.size(); ++i) {
+        REQUIRE(image.codeset.segments[i].addr == reference.codeset.segments[i].addr);
+        REQUIRE(image.codeset.segments[i].offset == reference.codeset.segments[i].offset);
+        REQUIRE(image.codeset.segments[i].size == reference.codeset.segments[i].size);
+    }
+    REQUIRE(std::ranges::equal(image.program_image, reference.program_image));
+}
+
+constexpr std::array<SegmentSource, 3> SEGMENTS{{
+    {.location = 0, .size = 0x5123, .is_compressed = true},
+    {.location = 0x6000, .size = 0x1801, .is_compressed = false},
+    {.location = 0x8000, .size = 0x2345, .is_compressed = true},
+}};
+} // Anonymous namespace
+
+TEST_CASE("NSO: Segments are loaded in place like decompressed copies", "[core]") {
+    SCOPE_EXIT {
+        Settings::values.program_args.SetValue(Settings::values.program_args.GetDefault());
+    };
+    Settings::values.program_args.SetValue("-arg value");
+
+    const std::vector<u8> nso = MakeNSO(SEGMENTS, 0x3456);
+    const auto file = std::make_shared<FileSys::VectorVfsFile>(nso);
+    const auto mapped_file = std::make_shared<MappedVfsFile>(nso);
+    const std::array<NSOModuleSource, 4> sources{{
+        {.file = file, .should_pass_arguments = true, .patch_index = -1},
+        {.file = mapped_file, .should_pass_arguments = false, .patch_index = -1},
+        {.file = nullptr, .should_pass_arguments = false, .patch_index = -1},
+        {.file = mapped_file, .should_pass_arguments = true, .patch_index = -1},
+    }};
+    const auto images = AppLoader_NSO::LoadModuleImages(sources, nullptr, nullptr);
+    REQUIRE(images.size() == sources.size());
+    REQUIRE(images[0].has_value());
+    REQUIRE(images[1].has_value());
+    REQUIRE(!images[2].has_value());
+    REQUIRE(images[3].has_value());
+
+    RequireSameImage(*images[0], ReferenceImage(*file, true));
+    RequireSameImage(*images[1], ReferenceImage(*file, false));
+    RequireSameImage(*images[3], ReferenceImage(*file, true));
+}
+
+TEST_CASE("NSO: Modules with damaged segments fail to load", "[core]") {
+    const std::vector<u8> nso = MakeNSO(SEGMENTS, 0);
+    NSOHeader header;
+    std::memcpy(&header, nso.data(), sizeof(NSOHeader));
+    // Cut the compressed data segment short
+    const std::vector<u8> damaged(nso.begin(),
+                                  nso.end() - header.segments_compressed_size[2] / 2);
+
+    const std::array<NSOModuleSource, 3> sources{{
+        {.file = std::make_shared<FileSys::VectorVfsFile>(damaged),
+         .should_pass_arguments = false,
+         .patch_index = -1},
+        {.file = std::make_shared<MappedVfsFile>(damaged),
+         .should_pass_arguments = false,
+         .patch_index = -1},
+        {.file = std::make_shared<FileSys::VectorVfsFile>(nso),
+         .should_pass_arguments = false,
+         .patch_index = -1},
+    }};
+    const auto images = AppLoader_NSO::LoadModuleImages(sources, nullptr, nullptr);
+    REQUIRE(!images[0].has_value());
+    REQUIRE(!images[1].has_value());
+    REQUIRE(images[2].has_value());
+}
+
+} // namespace Loader
@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/fs/fs.h"
+#include "common/scope_exit.h"
+#include "common/settings.h"
+#include "core/loader/nso.h"
+#include "core/loader/nso_image_cache.h"
+
+namespace Loader {
+namespace {
+constexpr u64 PATCH_HASH = 0x1234'5678'9ABC'DEF0ULL;
+
+NSOHeader MakeHeader(u8 build_id) {
+    NSOHeader header{};
+    header.build_id.fill(build_id);
+    header.segments[0].size = 0x1000;
+    return header;
+}
+
+std::vector<u8> MakeSection(u8 value) {
+    return std::vector<u8>(0x3000, value);
+}
+
+bool ReadsAs(const NSOImageCache& cache, const NSOHeader& header, u64 patch_hash, u8 value) {
+    std::vector<u8> section(MakeSection(0).size());
+    return cache.Read(header, patch_hash, section) && section == MakeSection(value);
+}
+
+size_t CountFiles(const std::filesystem::path& directory) {
+    size_t count = 0;
+    for ([[maybe_unused]] const auto& file : std::filesystem::directory_iterator(directory)) {
+        ++count;
+    }
+    return count;
+}
+
+std::filesystem::path PrepareDirectory(const char* name) {
+    const auto directory = std::filesystem::temp_directory_path() / name;
+    void(Common::FS::RemoveDirRecursively(directory));
+    return directory;
+}
+} // Anonymous namespace
+
+TEST_CASE("NSOImageCache: Images are read back with the same inputs", "[core]") {
+    const auto directory = PrepareDirectory("suyu_nso_image_cache_hit");
+    SCOPE_EXIT {
+        Settings::values.program_args.SetValue(Settings::values.program_args.GetDefault());
+        void(Common::FS::RemoveDirRecursively(directory));
+    };
+    const NSOImageCache cache{directory};
+    const NSOHeader header = MakeHeader(1);
+    REQUIRE(!ReadsAs(cache, header, PATCH_HASH, 1));
+
+    cache.Write(header, PATCH_HASH, MakeSection(1));
+    REQUIRE(ReadsAs(cache, header, PATCH_HASH, 1));
+
+    // The section of a module laid out differently doesn't match the image
+    std::vector<u8> small_section(MakeSection(0).size() / 2);
+    REQUIRE(!cache.Read(header, PATCH_HASH, small_section));
+}
+
+TEST_CASE("NSOImageCache: Changed patches or arguments miss the cache", "[core]") {
+    const auto directory = PrepareDirectory("suyu_nso_image_cache_miss");
+    SCOPE_EXIT {
+        Settings::values.program_args.SetValue(Settings::values.program_args.GetDefault());
+        void(Common::FS::RemoveDirRecursively(directory));
+    };
+    const NSOImageCache cache{directory};
+    const NSOHeader header = MakeHeader(1);
+    cache.Write(header, PATCH_HASH, MakeSection(1));
+
+    // Another patch set
+    REQUIRE(!ReadsAs(cache, header, PATCH_HASH + 1, 1));
+
+    // Other program arguments
+    Settings::values.program_args.SetValue("-arg");
+    REQUIRE(!ReadsAs(cache, header, PATCH_HASH, 1));
+    Settings::values.program_args.SetValue(Settings::values.program_args.GetDefault());
+    REQUIRE(ReadsAs(cache, header, PATCH_HASH, 1));
+
+    // Another header with the same build ID
+    NSOHeader other_header = header;
+    other_header.segments[0].size = 0x2000;
+    REQUIRE(!ReadsAs(cache, other_header, PATCH_HASH, 1));
+}
+
+TEST_CASE("NSOImageCache: Writing an image replaces the older ones of its build ID", "[core]") {
+    const auto directory = PrepareDirectory("suyu_nso_image_cache_prune");
+    SCOPE_EXIT {
+        void(Common::FS::RemoveDirRecursively(directory));
+    };
+    const NSOImageCache cache{directory};
+    const NSOHeader header = MakeHeader(1);
+    const NSOHeader other_header = MakeHeader(2);
+    cache.Write(header, PATCH_HASH, MakeSection(1));
+    cache.Write(other_header, PATCH_HASH, MakeSection(2));
+    std::ofstream(directory / "unrelated.txt") << "unrelated";
+    REQUIRE(CountFiles(directory) == 3);
+
+    // The patches changed, the image made with the old ones is removed
+    cache.Write(header, PATCH_HASH + 1, MakeSection(3));
+    REQUIRE(CountFiles(directory) == 3);
+    REQUIRE(!ReadsAs(cache, header, PATCH_HASH, 1));
+    REQUIRE(ReadsAs(cache, header, PATCH_HASH + 1, 3));
+    REQUIRE(ReadsAs(cache, other_header, PATCH_HASH, 2));
+    REQUIRE(Common::FS::Exists(directory / "unrelated.txt"));
+
+    // Rewriting the same image keeps it
+    cache.Write(header, PATCH_HASH + 1, MakeSection(4));
+    REQUIRE(CountFiles(directory) == 3);
+    REQUIRE(ReadsAs(cache, header, PATCH_HASH + 1, 4));
+}
+
+} // namespace Loader
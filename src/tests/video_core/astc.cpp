@@ -0,0 +1,395 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/div_ceil.h"
+#include "video_core/textures/astc.h"
+
+namespace {
+/// Encodes an LDR void extent block, decoded as a single color over the whole footprint
+std::array<u8, 16> MakeVoidExtentBlock(u8 r, u8 g, u8 b, u8 a) {
+    const u64 low = 0xFFFF'FFFF'FFFF'FDFCULL;
+    const u64 high = (u64{r} << 8) | (u64{g} << 24) | (u64{b} << 40) | (u64{a} << 56);
+    std::array<u8, 16> block;
+    std::memcpy(block.data(), &low, sizeof(low));
+    std::memcpy(block.data() + sizeof(low), &high, sizeof(high));
+    return block;
+}
+
+struct AstcFile {
+    u32 block_width;
+    u32 block_height;
+    u32 width;
+    u32 height;
+    u32 depth;
+    std::vector<u8> data;
+};
+
+/// Parses the '.astc' container written by the reference encoder
+bool ReadAstcFile(const std::filesystem::path& path, AstcFile& file) {
+    std::ifstream stream(path, std::ios::binary);
+    std::array<u8, 16> header;
+    if (!stream.read(reinterpret_cast<char*>(header.data()), header.size())) {
+        return false;
+    }
+    constexpr std::array<u8, 4> magic{0x13, 0xAB, 0xA1, 0x5C};
+    if (std::memcmp(header.data(), magic.data(), magic.size()) != 0 || header[6] != 1) {
+        return false;
+    }
+    const auto read_u24 = [&](size_t offset) {
+        return u32{header[offset]} | (u32{header[offset + 1]} << 8) |
+               (u32{header[offset + 2]} << 16);
+    };
+    file.block_width = header[4];
+    file.block_height = header[5];
+    file.width = read_u24(7);
+    file.height = read_u24(10);
+    file.depth = read_u24(13);
+    const size_t num_blocks = static_cast<size_t>(Common::DivCeil(file.width, file.block_width)) *
+                              Common::DivCeil(file.height, file.block_height) * file.depth;
+    file.data.resize(num_blocks * 16);
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(file.data.data()),
+                                         static_cast<std::streamsize>(file.data.size())));
+}
+
+/// Single partition LDR block whose color values and weights are stored as plain bits
+struct BlockParams {
+    u32 grid_width;
+    u32 grid_height;
+    u32 weight_bits;
+    bool dual_plane;
+    u32 plane_component; ///< Component using the second weight plane, 0 to 3 for R to A
+    u32 color_endpoint_mode;
+    std::vector<u8> colors;
+    std::vector<u8> weights; ///< Weights of both planes are interleaved
+};
+
+u32 NumColorValues(u32 color_endpoint_mode) {
+    return (color_endpoint_mode / 4 + 1) * 2;
+}
+
+void WriteBits(std::array<u8, 16>& block, u32 offset, u32 value, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        const u32 bit = offset + i;
+        block[bit / 8] |= static_cast<u8>(((value >> i) & 1) << (bit % 8));
+    }
+}
+
+std::array<u8, 16> EncodeBlock(const BlockParams& params) {
+    // Weight ranges with a power of two number of values, as the high precision bit and R
+    static constexpr std::array<std::pair<u32, u32>, 6> weight_ranges{{
+        {0, 0}, {0, 2}, {0, 4}, {0, 7}, {1, 4}, {1, 7}}};
+    const auto [high_precision, range] = weight_ranges[params.weight_bits];
+    u32 mode = ((range >> 1) & 3) | ((range & 1) << 4) | (high_precision << 9) |
+               (u32{params.dual_plane} << 10) | ((params.grid_height - 2) << 5);
+    if (params.grid_width >= 4) {
+        mode |= (params.grid_width - 4) << 7;
+    } else {
+        mode |= 0b1'0000'1100 | ((params.grid_width - 2) << 7);
+    }
+    std::array<u8, 16> block{};
+    WriteBits(block, 0, mode, 11);
+    WriteBits(block, 13, params.color_endpoint_mode, 4);
+    for (size_t i = 0; i < params.colors.size(); ++i) {
+        WriteBits(block, 17 + static_cast<u32>(i) * 8, params.colors[i], 8);
+    }
+    // Weights are stored bit reversed from the end of the block
+    const u32 num_weight_bits = static_cast<u32>(params.weights.size()) * params.weight_bits;
+    for (size_t i = 0; i < params.weights.size(); ++i) {
+        for (u32 bit = 0; bit < params.weight_bits; ++bit) {
+            WriteBits(block, 127 - static_cast<u32>(i) * params.weight_bits - bit,
+                      params.weights[i] >> bit, 1);
+        }
+    }
+    if (params.dual_plane) {
+        WriteBits(block, 128 - num_weight_bits - 2, params.plane_component, 2);
+    }
+    return block;
+}
+
+/// Makes a random block with a weight grid no larger than the given size
+BlockParams MakeRandomBlock(std::mt19937& rng, u32 max_grid_width, u32 max_grid_height) {
+    static constexpr std::array<u32, 4> modes{0, 4, 8, 12};
+    const auto random = [&rng](u32 min, u32 max) {
+        return std::uniform_int_distribution<u32>(min, max)(rng);
+    };
+    while (true) {
+        BlockParams params{
+            .grid_width = random(2, std::min(max_grid_width, 7U)),
+            .grid_height = random(2, std::min(max_grid_height, 5U)),
+            .weight_bits = random(1, 5),
+            .dual_plane = random(0, 1) == 1,
+            .plane_component = random(0, 3),
+            .color_endpoint_mode = modes[random(0, 3)],
+            .colors = {},
+            .weights = {},
+        };
+        const u32 num_weights =
+            params.grid_width * params.grid_height * (params.dual_plane ? 2 : 1);
+        const u32 num_colors = NumColorValues(params.color_endpoint_mode);
+        if (17 + num_colors * 8 + (params.dual_plane ? 2 : 0) + num_weights * params.weight_bits >
+            128) {
+            continue;
+        }
+        for (u32 i = 0; i < num_colors; ++i) {
+            params.colors.push_back(static_cast<u8>(random(0, 255)));
+        }
+        for (u32 i = 0; i < num_weights; ++i) {
+            params.weights.push_back(static_cast<u8>(random(0, (1U << params.weight_bits) - 1)));
+        }
+        return params;
+    }
+}
+
+/// Decodes a block following the specification, one texel at a time
+std::vector<u8> ReferenceDecode(const BlockParams& params, u32 block_width, u32 block_height) {
+    const std::vector<u8>& v = params.colors;
+    const auto blue_contract = [](u8 r, u8 g, u8 b, u8 a) {
+        return std::array<u8, 4>{static_cast<u8>((r + b) >> 1), static_cast<u8>((g + b) >> 1), b,
+                                 a};
+    };
+    std::array<std::array<u8, 4>, 2> endpoints;
+    switch (params.color_endpoint_mode) {
+    case 0:
+        endpoints = {{{v[0], v[0], v[0], 255}, {v[1], v[1], v[1], 255}}};
+        break;
+    case 4:
+        endpoints = {{{v[0], v[0], v[0], v[2]}, {v[1], v[1], v[1], v[3]}}};
+        break;
+    default: {
+        const u8 a0 = params.color_endpoint_mode == 12 ? v[6] : 255;
+        const u8 a1 = params.color_endpoint_mode == 12 ? v[7] : 255;
+        if (v[1] + v[3] + v[5] >= v[0] + v[2] + v[4]) {
+            endpoints = {{{v[0], v[2], v[4], a0}, {v[1], v[3], v[5], a1}}};
+        } else {
+            endpoints = {blue_contract(v[1], v[3], v[5], a1), blue_contract(v[0], v[2], v[4], a0)};
+        }
+        break;
+    }
+    }
+
+    const u32 num_planes = params.dual_plane ? 2 : 1;
+    const u32 grid_size = params.grid_width * params.grid_height;
+    const auto grid_weight = [&](u32 plane, u32 index) -> u32 {
+        if (index >= grid_size) {
+            return 0;
+        }
+        u32 weight = 0;
+        for (u32 shift = 6; shift > 0;) {
+            const u32 bits = std::min(shift, params.weight_bits);
+            shift -= bits;
+            weight |= (params.weights[index * num_planes + plane] >> (params.weight_bits - bits))
+                      << shift;
+        }
+        return weight > 32 ? weight + 1 : weight;
+    };
+    const u32 ds = (1024 + block_width / 2) / (block_width - 1);
+    const u32 dt = (1024 + block_height / 2) / (block_height - 1);
+
+    std::vector<u8> texels(static_cast<size_t>(block_width) * block_height * 4);
+    for (u32 t = 0; t < block_height; ++t) {
+        for (u32 s = 0; s < block_width; ++s) {
+            const u32 gs = (ds * s * (params.grid_width - 1) + 32) >> 6;
+            const u32 gt = (dt * t * (params.grid_height - 1) + 32) >> 6;
+            const u32 fs = gs & 0xF;
+            const u32 ft = gt & 0xF;
+            const u32 v0 = (gs >> 4) + (gt >> 4) * params.grid_width;
+            const u32 w11 = (fs * ft + 8) >> 4;
+            const u32 w10 = ft - w11;
+            const u32 w01 = fs - w11;
+            const u32 w00 = 16 - fs - ft + w11;
+            std::array<u32, 2> weights{};
+            for (u32 plane = 0; plane < num_planes; ++plane) {
+                weights[plane] = (grid_weight(plane, v0) * w00 + grid_weight(plane, v0 + 1) * w01 +
+                                  grid_weight(plane, v0 + params.grid_width) * w10 +
+                                  grid_weight(plane, v0 + params.grid_width + 1) * w11 + 8) >>
+                                 4;
+            }
+            for (u32 c = 0; c < 4; ++c) {
+                const u32 weight =
+                    weights[params.dual_plane && c == params.plane_component ? 1 : 0];
+                const u32 c0 = endpoints[0][c] * 257U;
+                const u32 c1 = endpoints[1][c] * 257U;
+                const u32 color = (c0 * (64 - weight) + c1 * weight + 32) / 64;
+                texels[(t * block_width + s) * 4 + c] =
+                    static_cast<u8>((color * 255 + 32768) >> 16);
+            }
+        }
+    }
+    return texels;
+}
+
+/// Texture made of randomly encoded blocks, repeated so decoded blocks are reused and evicted
+struct EncodedTexture {
+    std::vector<u8> data;
+    std::vector<size_t> block_indices;
+};
+
+EncodedTexture MakeEncodedTexture(std::span<const std::array<u8, 16>> blocks, u32 num_blocks) {
+    EncodedTexture texture;
+    for (u32 block = 0; block < num_blocks; ++block) {
+        // Runs of the same block with every distinct block spread across the texture
+        const size_t index = (block / 3 * 7) % blocks.size();
+        texture.block_indices.push_back(index);
+        texture.data.insert(texture.data.end(), blocks[index].begin(), blocks[index].end());
+    }
+    return texture;
+}
+} // Anonymous namespace
+
+TEST_CASE("ASTC[VoidExtent]", "[video_core]") {
+    for (const auto [width, height, depth, block_width, block_height] :
+         std::array<std::array<u32, 5>, 3>{{
+             {37, 21, 2, 6, 5},
+             {200, 100, 2, 4, 4},
+             {130, 70, 1, 12, 12},
+         }}) {
+        const u32 cols = Common::DivCeil(width, block_width);
+        const u32 rows = Common::DivCeil(height, block_height);
+
+        // Only a few distinct colors so identical blocks repeat across the texture
+        const auto color_of = [](u32 block) {
+            const u32 seed = (block % 5) * 0x3F1D2B7U;
+            return std::array<u8, 4>{static_cast<u8>(seed), static_cast<u8>(seed >> 8),
+                                     static_cast<u8>(seed >> 16), static_cast<u8>(block % 5)};
+        };
+        std::vector<u8> data;
+        for (u32 block = 0; block < cols * rows * depth; ++block) {
+            const auto color = color_of(block);
+            const auto encoded = MakeVoidExtentBlock(color[0], color[1], color[2], color[3]);
+            data.insert(data.end(), encoded.begin(), encoded.end());
+        }
+        std::vector<u8> expected(static_cast<size_t>(width) * height * depth * 4);
+        for (u32 z = 0; z < depth; ++z) {
+            for (u32 y = 0; y < height; ++y) {
+                for (u32 x = 0; x < width; ++x) {
+                    const u32 block = (z * rows + y / block_height) * cols + x / block_width;
+                    const auto color = color_of(block);
+                    const size_t offset = ((static_cast<size_t>(z) * height + y) * width + x) * 4;
+                    std::memcpy(expected.data() + offset, color.data(), color.size());
+                }
+            }
+        }
+        std::vector<u8> output(expected.size());
+        Tegra::Texture::ASTC::Decompress(data, width, height, depth, block_width, block_height,
+                                         output);
+        REQUIRE(output == expected);
+    }
+}
+
+TEST_CASE("ASTC[EncodedBlocks]", "[video_core]") {
+    std::mt19937 rng{0x5EED};
+    // Every grid fits the smallest footprint, so each block decodes with all of them
+    std::vector<BlockParams> params;
+    std::vector<std::array<u8, 16>> blocks;
+    for (int i = 0; i < 200; ++i) {
+        params.push_back(MakeRandomBlock(rng, 5, 4));
+        blocks.push_back(EncodeBlock(params.back()));
+    }
+    // The same blocks are decoded again with another footprint, decoded blocks can't be reused
+    for (const auto [block_width, block_height] : std::array<std::array<u32, 2>, 5>{{
+             {5, 4},
+             {8, 8},
+             {12, 12},
+             {5, 4},
+             {10, 6},
+         }}) {
+        constexpr u32 cols = 40;
+        constexpr u32 rows = 30;
+        const u32 width = cols * block_width - 3;
+        const u32 height = rows * block_height - 1;
+        const EncodedTexture texture = MakeEncodedTexture(blocks, cols * rows);
+
+        std::vector<std::vector<u8>> decoded;
+        for (const BlockParams& block : params) {
+            decoded.push_back(ReferenceDecode(block, block_width, block_height));
+        }
+        std::vector<u8> expected(static_cast<size_t>(width) * height * 4);
+        for (u32 y = 0; y < height; ++y) {
+            for (u32 x = 0; x < width; ++x) {
+                const size_t index =
+                    texture.block_indices[y / block_height * cols + x / block_width];
+                const size_t texel = (y % block_height) * block_width + x % block_width;
+                std::memcpy(expected.data() + (static_cast<size_t>(y) * width + x) * 4,
+                            decoded[index].data() + texel * 4, 4);
+            }
+        }
+        std::vector<u8> output(expected.size());
+        Tegra::Texture::ASTC::Decompress(texture.data, width, height, 1, block_width, block_height,
+                                         output);
+        INFO("Footprint " << block_width << "x" << block_height);
+        REQUIRE(output == expected);
+    }
+}
+
+TEST_CASE("ASTC[Benchmark]", "[.][benchmark]") {
+    // Directory of '.astc' dumps, e.g. produced by 'astcenc' from textures captured in titles.
+    // Without one, randomly encoded textures are decoded instead.
+    std::vector<AstcFile> files;
+    if (const char* const corpus = std::getenv("SUYU_ASTC_CORPUS")) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(corpus)) {
+            AstcFile file;
+            if (entry.path().extension() == ".astc" && ReadAstcFile(entry.path(), file)) {
+                files.push_back(std::move(file));
+            }
+        }
+    } else {
+        printf("SUYU_ASTC_CORPUS is not set, decoding randomly encoded textures\n");
+        std::mt19937 rng{0x5EED};
+        for (const auto [block_width, block_height] :
+             std::array<std::array<u32, 2>, 4>{{{4, 4}, {6, 6}, {8, 8}, {12, 12}}}) {
+            std::vector<std::array<u8, 16>> blocks;
+            for (int i = 0; i < 1024; ++i) {
+                blocks.push_back(EncodeBlock(MakeRandomBlock(rng, block_width, block_height)));
+            }
+            constexpr u32 size = 1024;
+            const u32 num_blocks = Common::DivCeil(size, block_width) *
+                                   Common::DivCeil(size, block_height);
+            files.push_back(AstcFile{
+                .block_width = block_width,
+                .block_height = block_height,
+                .width = size,
+                .height = size,
+                .depth = 1,
+                .data = MakeEncodedTexture(blocks, num_blocks).data,
+            });
+        }
+    }
+    REQUIRE(!files.empty());
+    constexpr int iterations = 8;
+
+    // Texels decoded and time taken, per block footprint
+    std::map<std::pair<u32, u32>, std::pair<double, double>> results;
+    for (const AstcFile& file : files) {
+        std::vector<u8> output(static_cast<size_t>(file.width) * file.height * file.depth * 4);
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            Tegra::Texture::ASTC::Decompress(file.data, file.width, file.height, file.depth,
+                                             file.block_width, file.block_height, output);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        auto& [texels, seconds] = results[{file.block_width, file.block_height}];
+        texels += static_cast<double>(output.size() / 4) * iterations;
+        seconds += elapsed.count();
+    }
+    for (const auto& [footprint, result] : results) {
+        printf("ASTC %ux%u: %.2f MTexels/s\n", footprint.first, footprint.second,
+               result.first / result.second / 1e6);
+    }
+}
@@ -0,0 +1,195 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/fence_queue.h"
+
+namespace {
+using Fence = std::shared_ptr<u64>;
+
+struct LargeCapture {
+    std::array<u64, 16> values{};
+};
+} // Anonymous namespace
+
+TEST_CASE("FenceOperation: Small callables are stored inline", "[video_core]") {
+    u64 value = 0;
+    const auto small = [&value] { value += 1; };
+    const auto large = [&value, capture = LargeCapture{}] { value += capture.values.size(); };
+    STATIC_REQUIRE(VideoCommon::FenceOperation::IsStoredInline<std::function<void()>>);
+    STATIC_REQUIRE(VideoCommon::FenceOperation::IsStoredInline<decltype(small)>);
+    STATIC_REQUIRE(!VideoCommon::FenceOperation::IsStoredInline<decltype(large)>);
+
+    VideoCommon::FenceOperation operation;
+    REQUIRE(!operation);
+    operation.Emplace(small);
+    REQUIRE(operation);
+    operation();
+    REQUIRE(value == 1);
+
+    // Callables larger than the inline storage are stored on the heap
+    operation.Emplace(large);
+    operation();
+    REQUIRE(value == 17);
+
+    operation.Emplace(std::function<void()>(small));
+    operation();
+    REQUIRE(value == 18);
+
+    // Captures are destroyed on reset
+    const auto shared = std::make_shared<int>();
+    operation.Emplace([shared] {});
+    REQUIRE(shared.use_count() == 2);
+    operation.Reset();
+    REQUIRE(shared.use_count() == 1);
+    REQUIRE(!operation);
+}
+
+TEST_CASE("FenceOperationQueue: Operations run in order and chunks are reused", "[video_core]") {
+    VideoCommon::FenceOperationQueue queue;
+    std::vector<u64> order;
+    u64 next = 0;
+    for (u64 round = 0; round < 8; ++round) {
+        for (u64 i = 0; i < 150; ++i) {
+            queue.Push([&order, value = next++] { order.push_back(value); });
+        }
+        queue.RunUntil(queue.PushCount() - 10);
+    }
+    queue.RunUntil(queue.PushCount());
+    REQUIRE(order.size() == next);
+    for (u64 i = 0; i < order.size(); ++i) {
+        REQUIRE(order[i] == i);
+    }
+
+    // Operations that never ran are destroyed with the queue
+    const auto shared = std::make_shared<int>();
+    {
+        VideoCommon::FenceOperationQueue unrun_queue;
+        for (int i = 0; i < 100; ++i) {
+            unrun_queue.Push([shared] {});
+        }
+        REQUIRE(shared.use_count() == 101);
+    }
+    REQUIRE(shared.use_count() == 1);
+}
+
+TEST_CASE("FenceOperationQueue: Operations are released by another thread", "[video_core]") {
+    // Hands fences over like the fence manager does for backends with a release thread
+    struct PendingFence {
+        Fence fence;
+        u64 operations_end{};
+    };
+    VideoCommon::FenceOperationQueue operations;
+    VideoCommon::FenceSequence released_fences;
+    std::queue<PendingFence> fences;
+    std::mutex guard;
+    std::condition_variable cv;
+
+    constexpr u64 num_fences = 1000;
+    std::vector<u64> order;
+    bool in_order = true;
+    std::jthread release_thread([&](std::stop_token token) {
+        for (u64 released = 0; released < num_fences; ++released) {
+            PendingFence current;
+            {
+                std::unique_lock lock{guard};
+                cv.wait(lock, [&] { return token.stop_requested() || !fences.empty(); });
+                if (token.stop_requested()) {
+                    return;
+                }
+                current = std::move(fences.front());
+                fences.pop();
+            }
+            in_order = in_order && *current.fence == released + 1;
+            operations.RunUntil(current.operations_end);
+            released_fences.Advance();
+        }
+    });
+    u64 next = 0;
+    for (u64 fence = 1; fence <= num_fences; ++fence) {
+        for (u64 i = 0; i < fence % 4; ++i) {
+            operations.Push([&order, value = next++] { order.push_back(value); });
+        }
+        {
+            std::scoped_lock lock{guard};
+            fences.push({std::make_shared<u64>(fence), operations.PushCount()});
+        }
+        cv.notify_all();
+        if (fence % 100 == 0) {
+            // Forced waits return once every operation before them has run
+            released_fences.Wait(fence);
+            REQUIRE(order.size() == next);
+        }
+    }
+    released_fences.Wait(num_fences);
+    release_thread.join();
+    REQUIRE(in_order);
+    REQUIRE(order.size() == next);
+    for (u64 i = 0; i < order.size(); ++i) {
+        REQUIRE(order[i] == i);
+    }
+}
+
+TEST_CASE("FenceOperationQueue[Benchmark]", "[.][benchmark]") {
+    constexpr u64 num_fences = 4096;
+    u64 sum = 0;
+
+    // Releases fences on the signaling thread every 4 fences, like the OpenGL backend does
+    BENCHMARK("std::function and deque pipeline, released in place, 4096 fences") {
+        std::queue<Fence> fences;
+        std::deque<std::function<void()>> uncommitted_operations;
+        std::deque<std::deque<std::function<void()>>> pending_operations;
+        for (u64 fence = 1; fence <= num_fences; ++fence) {
+            uncommitted_operations.emplace_back([&sum, fence] { sum += fence; });
+            uncommitted_operations.emplace_back([&sum, fence] { sum += fence; });
+            pending_operations.emplace_back(std::move(uncommitted_operations));
+            fences.push(std::make_shared<u64>(fence));
+            if (fence % 4 != 0) {
+                continue;
+            }
+            while (!fences.empty()) {
+                auto operations = std::move(pending_operations.front());
+                pending_operations.pop_front();
+                for (auto& operation : operations) {
+                    operation();
+                }
+                fences.pop();
+            }
+        }
+        return sum;
+    };
+
+    VideoCommon::FenceOperationQueue operations;
+    BENCHMARK("Operation queue, released in place, 4096 fences") {
+        std::queue<Fence> fences;
+        std::queue<u64> operations_end;
+        for (u64 fence = 1; fence <= num_fences; ++fence) {
+            operations.Push([&sum, fence] { sum += fence; });
+            operations.Push([&sum, fence] { sum += fence; });
+            operations_end.push(operations.PushCount());
+            fences.push(std::make_shared<u64>(fence));
+            if (fence % 4 != 0) {
+                continue;
+            }
+            while (!fences.empty()) {
+                operations.RunUntil(operations_end.front());
+                operations_end.pop();
+                fences.pop();
+            }
+        }
+        return sum;
+    };
+}
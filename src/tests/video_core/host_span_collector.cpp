@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <optional>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/host_span_collector.h"
+
+namespace {
+using Core::DEVICE_PAGESIZE;
+
+/// Device memory whose pages are backed by chosen pages of a host buffer
+class FakeDeviceMemory {
+public:
+    explicit FakeDeviceMemory(std::vector<std::optional<size_t>> host_pages_)
+        : host_pages{std::move(host_pages_)}, buffer(host_pages.size() * DEVICE_PAGESIZE) {}
+
+    template <typename T>
+    T* GetPointer(DAddr address) {
+        ++num_translations;
+        const std::optional<size_t> host_page = host_pages.at(address / DEVICE_PAGESIZE);
+        if (!host_page) {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(HostPage(*host_page) + address % DEVICE_PAGESIZE);
+    }
+
+    u8* HostPage(size_t page) {
+        return buffer.data() + page * DEVICE_PAGESIZE;
+    }
+
+    size_t num_translations{};
+
+private:
+    std::vector<std::optional<size_t>> host_pages;
+    std::vector<u8> buffer;
+};
+} // Anonymous namespace
+
+TEST_CASE("HostSpanCollector: Pages adjacent in host memory are merged", "[video_core]") {
+    FakeDeviceMemory memory({0, 1, 2});
+    Tegra::HostSpanList spans;
+    Tegra::HostSpanCollector collector(memory, spans, 1);
+    REQUIRE(!collector.AppendPages(0x800, DEVICE_PAGESIZE * 2));
+    REQUIRE(collector.IsValid());
+    REQUIRE(spans.size() == 1);
+    REQUIRE(spans[0].data() == memory.HostPage(0) + 0x800);
+    REQUIRE(spans[0].size() == DEVICE_PAGESIZE * 2);
+
+    // Ranges appended one after the other are merged too
+    REQUIRE(!collector.AppendPages(0x2800, 0x100));
+    REQUIRE(spans.size() == 1);
+    REQUIRE(spans[0].size() == DEVICE_PAGESIZE * 2 + 0x100);
+}
+
+TEST_CASE("HostSpanCollector: Pages apart in host memory need more spans", "[video_core]") {
+    FakeDeviceMemory memory({0, 2, 1});
+    {
+        Tegra::HostSpanList spans;
+        Tegra::HostSpanCollector collector(memory, spans, 1);
+        REQUIRE(collector.AppendPages(0, DEVICE_PAGESIZE * 3));
+        REQUIRE(!collector.IsValid());
+    }
+    Tegra::HostSpanList spans;
+    Tegra::HostSpanCollector collector(memory, spans, 3);
+    REQUIRE(!collector.AppendPages(0, DEVICE_PAGESIZE * 3));
+    REQUIRE(collector.IsValid());
+    REQUIRE(spans.size() == 3);
+    REQUIRE(spans[0].data() == memory.HostPage(0));
+    REQUIRE(spans[1].data() == memory.HostPage(2));
+    REQUIRE(spans[2].data() == memory.HostPage(1));
+}
+
+TEST_CASE("HostSpanCollector: Ranges across unmapped pages fail", "[video_core]") {
+    FakeDeviceMemory memory({0, std::nullopt, 2});
+    Tegra::HostSpanList spans;
+    Tegra::HostSpanCollector collector(memory, spans, 4);
+    REQUIRE(!collector.AppendPages(0, DEVICE_PAGESIZE));
+    REQUIRE(collector.AppendPages(DEVICE_PAGESIZE - 0x10, 0x20));
+    REQUIRE(!collector.IsValid());
+
+    // Unmapped GPU pages fail the collection without translating anything
+    Tegra::HostSpanList unmapped_spans;
+    Tegra::HostSpanCollector unmapped(memory, unmapped_spans, 4);
+    REQUIRE(unmapped.Fail());
+    REQUIRE(!unmapped.IsValid());
+}
+
+TEST_CASE("HostSpanCollector: Continuous big pages are translated once", "[video_core]") {
+    FakeDeviceMemory memory({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15});
+    Tegra::HostSpanList spans;
+    Tegra::HostSpanCollector collector(memory, spans, 1);
+    REQUIRE(!collector.AppendContinuous(0x100, DEVICE_PAGESIZE * 16 - 0x100));
+    REQUIRE(memory.num_translations == 1);
+    REQUIRE(spans.size() == 1);
+    REQUIRE(spans[0].data() == memory.HostPage(0) + 0x100);
+    REQUIRE(spans[0].size() == DEVICE_PAGESIZE * 16 - 0x100);
+
+    memory.num_translations = 0;
+    Tegra::HostSpanList page_spans;
+    Tegra::HostSpanCollector page_collector(memory, page_spans, 1);
+    REQUIRE(!page_collector.AppendPages(0x100, DEVICE_PAGESIZE * 16 - 0x100));
+    REQUIRE(memory.num_translations == 16);
+    REQUIRE(page_spans.size() == 1);
+}
+
+TEST_CASE("HostSpanCollector: Empty ranges add no spans", "[video_core]") {
+    FakeDeviceMemory memory({std::nullopt});
+    Tegra::HostSpanList spans;
+    Tegra::HostSpanCollector collector(memory, spans, 1);
+    REQUIRE(!collector.AppendPages(0, 0));
+    REQUIRE(collector.IsValid());
+    REQUIRE(spans.empty());
+    REQUIRE(memory.num_translations == 0);
+}
@@ -0,0 +1,233 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/common_types.h"
+#include "common/fs/fs.h"
+#include "shader_recompiler/environment.h"
+#include "video_core/shader_environment.h"
+#include "video_core/shader_translation_store.h"
+
+namespace {
+class FakeEnvironment final : public Shader::Environment {
+public:
+    explicit FakeEnvironment(u32 cbuf_value_) : cbuf_value{cbuf_value_} {
+        stage = Shader::Stage::Compute;
+        start_address = 0x10;
+    }
+
+    u64 ReadInstruction(u32 address) override {
+        return 0x1234'5678'0000'0000ULL | address;
+    }
+
+    u32 ReadCbufValue(u32, u32) override {
+        return cbuf_value;
+    }
+
+    Shader::TextureType ReadTextureType(u32) override {
+        return Shader::TextureType::Color2D;
+    }
+
+    Shader::TexturePixelFormat ReadTexturePixelFormat(u32) override {
+        return Shader::TexturePixelFormat::A8B8G8R8_UNORM;
+    }
+
+    bool IsTexturePixelFormatInteger(u32) override {
+        return false;
+    }
+
+    u32 ReadViewportTransformState() override {
+        return 0;
+    }
+
+    u32 TextureBoundBuffer() const override {
+        return 2;
+    }
+
+    u32 LocalMemorySize() const override {
+        return 0;
+    }
+
+    u32 SharedMemorySize() const override {
+        return 0x100;
+    }
+
+    std::array<u32, 3> WorkgroupSize() const override {
+        return {32, 1, 1};
+    }
+
+    bool HasHLEMacroState() const override {
+        return false;
+    }
+
+    std::optional<Shader::ReplaceConstant> GetReplaceConstBuffer(u32, u32) override {
+        return std::nullopt;
+    }
+
+    void Dump(u64, u64) override {}
+
+private:
+    u32 cbuf_value;
+};
+
+/// Translates a fake program, reading the code and a constant buffer value through the recording
+VideoCommon::TranslatedShader Translate(VideoCommon::RecordingEnvironment& env) {
+    VideoCommon::TranslatedShader shader{};
+    shader.info.uses_workgroup_id = true;
+    shader.info.constant_buffer_mask = 1;
+    for (u32 address = 0x10; address < 0x40; address += sizeof(u64)) {
+        shader.code.push_back(static_cast<u32>(env.ReadInstruction(address)));
+    }
+    shader.code.push_back(env.ReadCbufValue(0, 0x20));
+    return shader;
+}
+
+constexpr u128 KEY{0x1111, 0x2222};
+} // Anonymous namespace
+
+TEST_CASE("ShaderTranslationStore: Pipelines are reused by other titles", "[video_core]") {
+    const auto path = std::filesystem::temp_directory_path() / "suyu_translation_store_test.bin";
+    void(Common::FS::RemoveFile(path));
+
+    FakeEnvironment env{7};
+    VideoCommon::TranslatedShader translated;
+    {
+        VideoCommon::ShaderTranslationStore store;
+        REQUIRE(store.Open(path, 0x0100000000001000));
+        std::array<VideoCommon::RecordingEnvironment, 1> recordings{
+            VideoCommon::RecordingEnvironment{env}};
+        translated = Translate(recordings[0]);
+        store.Insert(KEY, recordings, std::array{translated});
+        REQUIRE(store.Size() == 1);
+    }
+    {
+        VideoCommon::ShaderTranslationStore store;
+        REQUIRE(store.Open(path, 0x0100000000002000));
+        REQUIRE(store.Size() == 1);
+
+        std::vector<VideoCommon::TranslatedShader> shaders;
+        FakeEnvironment same_env{7};
+        const std::array<Shader::Environment*, 1> same_envs{&same_env};
+        REQUIRE(store.Find(KEY, same_envs, shaders));
+        REQUIRE(shaders.size() == 1);
+        REQUIRE(shaders[0].code == translated.code);
+        REQUIRE(shaders[0].info.uses_workgroup_id);
+        REQUIRE(shaders[0].info.constant_buffer_mask == 1);
+
+        // Translation would read another value, so the shaders can't be reused
+        FakeEnvironment other_env{8};
+        const std::array<Shader::Environment*, 1> other_envs{&other_env};
+        REQUIRE(!store.Find(KEY, other_envs, shaders));
+        REQUIRE(!store.Find(u128{0x1111, 0x3333}, same_envs, shaders));
+    }
+    REQUIRE(Common::FS::RemoveFile(path));
+}
+
+TEST_CASE("ShaderTranslationStore: Read-only stores are never modified", "[video_core]") {
+    using OpenMode = VideoCommon::ShaderTranslationStore::OpenMode;
+    const auto path = std::filesystem::temp_directory_path() / "suyu_translation_store_ro.bin";
+    void(Common::FS::RemoveFile(path));
+    {
+        VideoCommon::ShaderTranslationStore store;
+        REQUIRE(!store.Open(path, 0x0100000000001000, OpenMode::ReadOnly));
+        REQUIRE(!Common::FS::Exists(path));
+    }
+
+    FakeEnvironment env{7};
+    {
+        VideoCommon::ShaderTranslationStore store;
+        REQUIRE(store.Open(path, 0x0100000000001000));
+        std::array<VideoCommon::RecordingEnvironment, 1> recordings{
+            VideoCommon::RecordingEnvironment{env}};
+        store.Insert(KEY, recordings, std::array{Translate(recordings[0])});
+    }
+    {
+        // Leave a partially written entry behind
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file.write("partial", 7);
+    }
+    const u64 size = Common::FS::GetSize(path);
+    {
+        VideoCommon::ShaderTranslationStore store;
+        REQUIRE(store.Open(path, 0x0100000000002000, OpenMode::ReadOnly));
+        REQUIRE(store.Size() == 1);
+        REQUIRE(store.Size(0x0100000000001000) == 1);
+        REQUIRE(store.Size(0x0100000000002000) == 0);
+
+        std::vector<VideoCommon::TranslatedShader> shaders;
+        const std::array<Shader::Environment*, 1> envs{&env};
+        REQUIRE(store.Find(KEY, envs, shaders));
+
+        std::array<VideoCommon::RecordingEnvironment, 1> recordings{
+            VideoCommon::RecordingEnvironment{env}};
+        store.Insert(u128{0x1111, 0x3333}, recordings, std::array{Translate(recordings[0])});
+        REQUIRE(store.Size() == 1);
+    }
+    REQUIRE(Common::FS::GetSize(path) == size);
+
+    // Stores of another build are not recreated either
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(8 + sizeof(u32));
+        file.write("otherbld", 8);
+    }
+    {
+        VideoCommon::ShaderTranslationStore store;
+        REQUIRE(!store.Open(path, 0, OpenMode::ReadOnly));
+    }
+    REQUIRE(Common::FS::GetSize(path) == size);
+    REQUIRE(Common::FS::RemoveFile(path));
+}
+
+TEST_CASE("ShaderTranslationStore: Compact keeps titles with a current cache", "[video_core]") {
+    const auto shader_dir = std::filesystem::temp_directory_path() / "suyu_translation_store_dir";
+    void(Common::FS::RemoveDirRecursively(shader_dir));
+    REQUIRE(Common::FS::CreateDirs(shader_dir));
+    const auto path = shader_dir / "vulkan_shaders.bin";
+
+    const auto write_cache{[&](const char* title, u32 version) {
+        REQUIRE(Common::FS::CreateDir(shader_dir / title));
+        std::ofstream file(shader_dir / title / "vulkan.bin", std::ios::binary);
+        file.write("yuzucach", 8).write(reinterpret_cast<const char*>(&version), sizeof(version));
+    }};
+    write_cache("0100000000001000", VideoCommon::VULKAN_PIPELINE_CACHE_VERSION);
+    write_cache("0100000000002000", VideoCommon::VULKAN_PIPELINE_CACHE_VERSION - 1);
+
+    FakeEnvironment env{7};
+    for (const u64 title_id :
+         {0x0100000000001000ULL, 0x0100000000002000ULL, 0x0100000000003000ULL}) {
+        VideoCommon::ShaderTranslationStore store;
+        REQUIRE(store.Open(path, title_id));
+        std::array<VideoCommon::RecordingEnvironment, 1> recordings{
+            VideoCommon::RecordingEnvironment{env}};
+        const std::array shaders{Translate(recordings[0])};
+        store.Insert(u128{title_id, 0}, recordings, shaders);
+    }
+    VideoCommon::ShaderTranslationStore::Compact(path, "vulkan.bin",
+                                                 VideoCommon::VULKAN_PIPELINE_CACHE_VERSION);
+    {
+        VideoCommon::ShaderTranslationStore store;
+        REQUIRE(store.Open(path, 0));
+        REQUIRE(store.Size() == 1);
+
+        std::vector<VideoCommon::TranslatedShader> shaders;
+        const std::array<Shader::Environment*, 1> envs{&env};
+        REQUIRE(store.Find(u128{0x0100000000001000ULL, 0}, envs, shaders));
+    }
+
+    // The store stays in place even when no title keeps entries in it
+    REQUIRE(Common::FS::RemoveDirRecursively(shader_dir / "0100000000001000"));
+    VideoCommon::ShaderTranslationStore::Compact(path, "vulkan.bin",
+                                                 VideoCommon::VULKAN_PIPELINE_CACHE_VERSION);
+    REQUIRE(Common::FS::Exists(path));
+    {
+        VideoCommon::ShaderTranslationStore store;
+        REQUIRE(store.Open(path, 0));
+        REQUIRE(store.Size() == 0);
+    }
+    REQUIRE(Common::FS::RemoveDirRecursively(shader_dir));
+}
@@ -0,0 +1,206 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/alignment.h"
+#include "common/common_types.h"
+#include "common/div_ceil.h"
+#include "video_core/textures/decoders.h"
+#include "video_core/textures/gob_kernels.h"
+
+namespace {
+using namespace Tegra::Texture;
+
+constexpr SwizzleTable SWIZZLE_TABLE = MakeSwizzleTable();
+
+constexpr std::array<u32, 8> BYTES_PER_PIXEL{1, 2, 3, 4, 6, 8, 12, 16};
+
+/// Straightforward block linear addressing, used as the reference for the optimized paths
+struct BlockLinearLayout {
+    u32 stride;
+    u32 height;
+    u32 block_height;
+    u32 block_depth;
+
+    u32 Offset(u32 x, u32 y, u32 z) const {
+        const u32 gobs_in_x = Common::DivCeil(stride, GOB_SIZE_X);
+        const u32 block_size = gobs_in_x << (GOB_SIZE_SHIFT + block_height + block_depth);
+        const u32 slice_size = Common::DivCeil(height, GOB_SIZE_Y << block_height) * block_size;
+        const u32 gob_x = x / GOB_SIZE_X;
+        const u32 gob_y = y / GOB_SIZE_Y;
+        const u32 block_y = gob_y >> block_height;
+        const u32 gob_in_block_y = gob_y & ((1U << block_height) - 1);
+        const u32 block_z = z >> block_depth;
+        const u32 gob_in_block_z = z & ((1U << block_depth) - 1);
+        return block_z * slice_size + block_y * block_size +
+               gob_x * (GOB_SIZE << (block_height + block_depth)) +
+               gob_in_block_z * (GOB_SIZE << block_height) + gob_in_block_y * GOB_SIZE +
+               SWIZZLE_TABLE[y % GOB_SIZE_Y][x % GOB_SIZE_X];
+    }
+};
+
+std::vector<u8> RandomBytes(size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> result(size);
+    for (u8& value : result) {
+        value = static_cast<u8>(rng());
+    }
+    return result;
+}
+
+void ReferenceUnswizzle(std::vector<u8>& output, const std::vector<u8>& input, u32 bpp, u32 width,
+                        u32 height, u32 depth, u32 block_height, u32 block_depth) {
+    const BlockLinearLayout layout{width * bpp, height, block_height, block_depth};
+    for (u32 z = 0; z < depth; ++z) {
+        for (u32 y = 0; y < height; ++y) {
+            for (u32 x = 0; x < width * bpp; ++x) {
+                output[(z * height + y) * width * bpp + x] = input[layout.Offset(x, y, z)];
+            }
+        }
+    }
+}
+
+/// Subrect copies move whole pixels, so the bytes of a pixel stay contiguous in the tiled image
+u32 PixelOffset(const BlockLinearLayout& layout, u32 bpp, u32 x, u32 y) {
+    const u32 pixel_x = x - x % bpp;
+    return layout.Offset(pixel_x, y, 0) + x % bpp;
+}
+
+size_t TiledSize(u32 bpp, u32 width, u32 height, u32 depth, u32 block_height, u32 block_depth) {
+    return CalculateSize(true, bpp, width, height, depth, block_height, block_depth);
+}
+} // Anonymous namespace
+
+TEST_CASE("Swizzle[GobKernels]", "[video_core]") {
+    const auto input = RandomBytes(GOB_SIZE * 4, 1);
+    constexpr u32 pitch = GOB_SIZE_X * 2;
+    const auto& reference = GetGobKernels(GobKernelLevel::Generic);
+
+    const GobKernelLevel host_level = GetHostGobKernelLevel();
+    for (const GobKernelLevel level :
+         {GobKernelLevel::Generic, GobKernelLevel::SSE, GobKernelLevel::AVX2}) {
+        if (static_cast<int>(level) > static_cast<int>(host_level)) {
+            continue;
+        }
+        const auto& kernels = GetGobKernels(level);
+
+        std::vector<u8> expected(pitch * GOB_SIZE_Y);
+        std::vector<u8> result(pitch * GOB_SIZE_Y);
+        reference.unswizzle(expected.data(), pitch, input.data());
+        kernels.unswizzle(result.data(), pitch, input.data());
+        REQUIRE(result == expected);
+
+        std::vector<u8> expected_gob(GOB_SIZE);
+        std::vector<u8> result_gob(GOB_SIZE);
+        reference.swizzle(expected_gob.data(), input.data(), pitch);
+        kernels.swizzle(result_gob.data(), input.data(), pitch);
+        REQUIRE(result_gob == expected_gob);
+    }
+}
+
+TEST_CASE("Swizzle[UnswizzleTexture]", "[video_core]") {
+    u32 seed = 0;
+    for (const u32 bpp : BYTES_PER_PIXEL) {
+        for (const auto [width, height, depth, block_height, block_depth] :
+             std::array<std::array<u32, 5>, 6>{{
+                 {64, 64, 1, 3, 0},
+                 {67, 29, 1, 2, 0},
+                 {128, 16, 1, 0, 0},
+                 {35, 70, 3, 4, 1},
+                 {16, 16, 8, 1, 2},
+                 {200, 9, 2, 5, 1},
+             }}) {
+            const size_t tiled_size = TiledSize(bpp, width, height, depth, block_height, block_depth);
+            const auto tiled = RandomBytes(tiled_size, ++seed);
+
+            std::vector<u8> expected(static_cast<size_t>(width) * height * depth * bpp);
+            std::vector<u8> result(expected.size());
+            ReferenceUnswizzle(expected, tiled, bpp, width, height, depth, block_height,
+                               block_depth);
+            UnswizzleTexture(result, tiled, bpp, width, height, depth, block_height, block_depth);
+            REQUIRE(result == expected);
+
+            // Swizzling the unswizzled data must reproduce every byte the texture covers
+            std::vector<u8> swizzled(tiled_size);
+            SwizzleTexture(swizzled, result, bpp, width, height, depth, block_height, block_depth);
+            std::vector<u8> roundtrip(expected.size());
+            ReferenceUnswizzle(roundtrip, swizzled, bpp, width, height, depth, block_height,
+                               block_depth);
+            REQUIRE(roundtrip == expected);
+        }
+    }
+}
+
+TEST_CASE("Swizzle[Subrect]", "[video_core]") {
+    u32 seed = 100;
+    for (const u32 bpp : BYTES_PER_PIXEL) {
+        for (const auto [width, height, origin_x, origin_y, extent_x, extent_y, block_height] :
+             std::array<std::array<u32, 7>, 4>{{
+                 {256, 64, 0, 0, 256, 64, 2},
+                 {256, 64, 64, 8, 128, 40, 3},
+                 {300, 50, 13, 5, 200, 37, 1},
+                 {128, 128, 17, 3, 100, 120, 4},
+             }}) {
+            const BlockLinearLayout layout{
+                Common::AlignUpLog2(width * bpp, GOB_SIZE_X_SHIFT), height, block_height, 0};
+            const u32 pitch = extent_x * bpp;
+            const u32 num_lines = std::min(extent_y, height - origin_y);
+            const size_t tiled_size = TiledSize(bpp, width, height, 1, block_height, 0);
+
+            const auto tiled = RandomBytes(tiled_size, ++seed);
+            std::vector<u8> expected(static_cast<size_t>(pitch) * extent_y);
+            std::vector<u8> result(expected.size());
+            for (u32 line = 0; line < num_lines; ++line) {
+                for (u32 x = 0; x < extent_x * bpp; ++x) {
+                    expected[line * pitch + x] = tiled[PixelOffset(layout, bpp, origin_x * bpp + x,
+                                                                   origin_y + line)];
+                }
+            }
+            UnswizzleSubrect(result, tiled, bpp, width, height, 1, origin_x, origin_y, extent_x,
+                             extent_y, block_height, 0, pitch);
+            REQUIRE(result == expected);
+
+            auto swizzled = tiled;
+            auto expected_swizzled = tiled;
+            const auto linear = RandomBytes(expected.size(), ++seed);
+            for (u32 line = 0; line < num_lines; ++line) {
+                for (u32 x = 0; x < extent_x * bpp; ++x) {
+                    expected_swizzled[PixelOffset(layout, bpp, origin_x * bpp + x,
+                                                  origin_y + line)] = linear[line * pitch + x];
+                }
+            }
+            SwizzleSubrect(swizzled, linear, bpp, width, height, 1, origin_x, origin_y, extent_x,
+                           extent_y, block_height, 0, pitch);
+            REQUIRE(swizzled == expected_swizzled);
+        }
+    }
+}
+
+TEST_CASE("Swizzle[Benchmark]", "[.][benchmark]") {
+    constexpr u32 width = 1024;
+    constexpr u32 height = 1024;
+    for (const u32 bpp : {1U, 2U, 4U, 8U, 16U}) {
+        for (const u32 block_depth : {0U, 2U}) {
+            const u32 depth = 1U << block_depth;
+            const size_t tiled_size = TiledSize(bpp, width, height, depth, 4, block_depth);
+            const auto tiled = RandomBytes(tiled_size, bpp);
+            std::vector<u8> linear(static_cast<size_t>(width) * height * depth * bpp);
+
+            BENCHMARK("Unswizzle " + std::to_string(bpp) + "bpp depth " + std::to_string(depth)) {
+                UnswizzleTexture(linear, tiled, bpp, width, height, depth, 4, block_depth);
+                return linear[0];
+            };
+            std::vector<u8> swizzled(tiled_size);
+            BENCHMARK("Swizzle " + std::to_string(bpp) + "bpp depth " + std::to_string(depth)) {
+                SwizzleTexture(swizzled, linear, bpp, width, height, depth, 4, block_depth);
+                return swizzled[0];
+            };
+        }
+    }
+}
@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include "common/common_types.h"
+#include "common/fs/fs.h"
+#include "common/literals.h"
+#include "common/scope_exit.h"
+#include "common/settings.h"
+#include "video_core/texture_cache/transcode_cache.h"
+
+namespace {
+using namespace Common::Literals;
+
+/// Smallest size limit of the cache, in MiB
+constexpr u16 SIZE_LIMIT_MIB = 64;
+
+/// Three entries don't fit in the smallest size limit, two do
+constexpr size_t ENTRY_SIZE = 24_MiB;
+
+constexpr u128 KEY_A{0xA, 0x1};
+constexpr u128 KEY_B{0xB, 0x2};
+constexpr u128 KEY_C{0xC, 0x3};
+
+std::filesystem::path EntryPath(const std::filesystem::path& directory, const u128& key) {
+    return directory / fmt::format("{:016x}{:016x}.bin", key[1], key[0]);
+}
+
+std::vector<u8> MakeData(u8 value) {
+    return std::vector<u8>(ENTRY_SIZE, value);
+}
+
+bool ReadsAs(VideoCommon::TranscodeCache& cache, const u128& key, u8 value) {
+    std::vector<u8> output(ENTRY_SIZE);
+    return cache.Read(key, output) && output == MakeData(value);
+}
+
+/// Creates a fresh cache directory and limits the cache to its smallest size for the test
+std::filesystem::path PrepareDirectory(const char* name) {
+    const auto directory = std::filesystem::temp_directory_path() / name;
+    void(Common::FS::RemoveDirRecursively(directory));
+    REQUIRE(Common::FS::CreateDirs(directory));
+    Settings::values.disk_texture_cache_size.SetValue(SIZE_LIMIT_MIB);
+    return directory;
+}
+} // Anonymous namespace
+
+TEST_CASE("TranscodeCache: Index is built from the cache directory", "[video_core]") {
+    const auto directory = PrepareDirectory("suyu_transcode_cache_index");
+    SCOPE_EXIT {
+        Settings::values.disk_texture_cache_size.SetValue(
+            Settings::values.disk_texture_cache_size.GetDefault());
+        void(Common::FS::RemoveDirRecursively(directory));
+    };
+
+    // Entries written by an earlier session, the first one used the longest time ago
+    const auto now = std::filesystem::file_time_type::clock::now();
+    for (const auto& [key, value, age] : {std::tuple{KEY_A, u8{1}, std::chrono::hours{3}},
+                                          std::tuple{KEY_B, u8{2}, std::chrono::hours{2}},
+                                          std::tuple{KEY_C, u8{3}, std::chrono::hours{1}}}) {
+        const auto path = EntryPath(directory, key);
+        const std::vector<u8> data = MakeData(value);
+        std::ofstream(path, std::ios::binary)
+            .write(reinterpret_cast<const char*>(data.data()), data.size());
+        std::filesystem::last_write_time(path, now - age);
+    }
+    std::ofstream(directory / "0123.tmp", std::ios::binary) << "interrupted";
+    std::ofstream(directory / "unrelated.txt", std::ios::binary) << "unrelated";
+
+    VideoCommon::TranscodeCache cache{directory};
+    cache.WaitForRequests();
+
+    // The least recently used entry doesn't fit in the size limit
+    REQUIRE(!ReadsAs(cache, KEY_A, 1));
+    REQUIRE(!Common::FS::Exists(EntryPath(directory, KEY_A)));
+    REQUIRE(ReadsAs(cache, KEY_B, 2));
+    REQUIRE(ReadsAs(cache, KEY_C, 3));
+
+    // Interrupted writes are removed, other files are left alone
+    REQUIRE(!Common::FS::Exists(directory / "0123.tmp"));
+    REQUIRE(Common::FS::Exists(directory / "unrelated.txt"));
+}
+
+TEST_CASE("TranscodeCache: Least recently used entries are evicted", "[video_core]") {
+    const auto directory = PrepareDirectory("suyu_transcode_cache_lru");
+    SCOPE_EXIT {
+        Settings::values.disk_texture_cache_size.SetValue(
+            Settings::values.disk_texture_cache_size.GetDefault());
+        void(Common::FS::RemoveDirRecursively(directory));
+    };
+    {
+        VideoCommon::TranscodeCache cache{directory};
+        cache.WaitForRequests();
+        cache.Write(KEY_A, MakeData(1));
+        cache.Write(KEY_B, MakeData(2));
+        cache.WaitForRequests();
+        REQUIRE(Common::FS::Exists(EntryPath(directory, KEY_A)));
+        REQUIRE(Common::FS::Exists(EntryPath(directory, KEY_B)));
+
+        // Reading the first entry makes the second one the least recently used
+        REQUIRE(ReadsAs(cache, KEY_A, 1));
+        cache.Write(KEY_C, MakeData(3));
+        cache.WaitForRequests();
+        REQUIRE(!Common::FS::Exists(EntryPath(directory, KEY_B)));
+        REQUIRE(!ReadsAs(cache, KEY_B, 2));
+        REQUIRE(ReadsAs(cache, KEY_A, 1));
+        REQUIRE(ReadsAs(cache, KEY_C, 3));
+        cache.WaitForRequests();
+    }
+
+    // The order survives in the modification times of the files
+    VideoCommon::TranscodeCache cache{directory};
+    cache.WaitForRequests();
+    cache.Write(KEY_B, MakeData(2));
+    cache.WaitForRequests();
+    REQUIRE(!Common::FS::Exists(EntryPath(directory, KEY_A)));
+    REQUIRE(ReadsAs(cache, KEY_B, 2));
+    REQUIRE(ReadsAs(cache, KEY_C, 3));
+}
+
+TEST_CASE("TranscodeCache: Entries that fail to read are dropped", "[video_core]") {
+    const auto directory = PrepareDirectory("suyu_transcode_cache_damaged");
+    SCOPE_EXIT {
+        Settings::values.disk_texture_cache_size.SetValue(
+            Settings::values.disk_texture_cache_size.GetDefault());
+        void(Common::FS::RemoveDirRecursively(directory));
+    };
+    VideoCommon::TranscodeCache cache{directory};
+    cache.WaitForRequests();
+    cache.Write(KEY_A, MakeData(1));
+    cache.WaitForRequests();
+
+    // The file disappears behind the back of the cache
+    REQUIRE(Common::FS::RemoveFile(EntryPath(directory, KEY_A)));
+    REQUIRE(!ReadsAs(cache, KEY_A, 1));
+
+    // The entry is gone, so the next transcode of the level writes it again
+    cache.Write(KEY_A, MakeData(4));
+    cache.WaitForRequests();
+    REQUIRE(ReadsAs(cache, KEY_A, 4));
+
+    // Keys cover the size of the level, a file of another size is damaged
+    std::vector<u8> small_output(ENTRY_SIZE / 2);
+    REQUIRE(!cache.Read(KEY_A, small_output));
+    REQUIRE(!Common::FS::Exists(EntryPath(directory, KEY_A)));
+    REQUIRE(!ReadsAs(cache, KEY_A, 4));
+}
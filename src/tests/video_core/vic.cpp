@@ -0,0 +1,229 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/div_ceil.h"
+#include "common/thread_worker.h"
+#include "video_core/host1x/vic_kernels.h"
+
+namespace {
+using namespace Tegra::Host1x;
+
+constexpr std::array<VicKernelLevel, 3> LEVELS{VicKernelLevel::Generic, VicKernelLevel::SSE,
+                                               VicKernelLevel::AVX2};
+
+/// Widths around the vector sizes of the kernels, plus a 1080p line
+constexpr std::array<u32, 9> WIDTHS{1, 2, 7, 8, 15, 16, 33, 100, 1925};
+
+/// BT.601 limited range to RGB, in the S12.8 format of the VIC with a shift of 0
+constexpr VicColorMatrix BT601_MATRIX{
+    .coefficients{{
+        {298, 0, 409, -57068},
+        {298, -100, -208, 34707},
+        {298, 516, 0, -70870},
+    }},
+    .shift = 0,
+    .clamp_min = 0,
+    .clamp_max = 1023,
+};
+
+std::vector<u8> RandomBytes(size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> result(size);
+    for (u8& value : result) {
+        value = static_cast<u8>(rng());
+    }
+    return result;
+}
+
+std::vector<Pixel> RandomPixels(size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<Pixel> result(size);
+    for (Pixel& pixel : result) {
+        pixel = {
+            .r = static_cast<u16>(rng() & 0x3FF),
+            .g = static_cast<u16>(rng() & 0x3FF),
+            .b = static_cast<u16>(rng() & 0x3FF),
+            .a = static_cast<u16>(rng() & 0x3FF),
+        };
+    }
+    return result;
+}
+
+/// Calls func with every kernel level the host supports, except the generic one
+template <typename Func>
+void ForEachHostLevel(Func&& func) {
+    const VicKernelLevel host_level = GetHostVicKernelLevel();
+    for (const VicKernelLevel level : LEVELS) {
+        if (level != VicKernelLevel::Generic &&
+            static_cast<int>(level) <= static_cast<int>(host_level)) {
+            func(GetVicKernels(level));
+        }
+    }
+}
+
+/// Synthetic NV12 frame, a gradient with some noise so the chroma is not constant
+struct Nv12Frame {
+    explicit Nv12Frame(u32 width_, u32 height_) : width{width_}, height{height_} {
+        const auto noise = RandomBytes(static_cast<size_t>(width) * height, 1);
+        luma.resize(static_cast<size_t>(width) * height);
+        chroma.resize(static_cast<size_t>(width) * Common::DivCeil(height, 2U));
+        for (u32 y = 0; y < height; ++y) {
+            for (u32 x = 0; x < width; ++x) {
+                const size_t index = static_cast<size_t>(y) * width + x;
+                luma[index] = static_cast<u8>(16 + (x + y) % 220 + (noise[index] & 3));
+            }
+        }
+        for (u32 y = 0; y < height / 2; ++y) {
+            for (u32 x = 0; x < width; x += 2) {
+                chroma[static_cast<size_t>(y) * width + x + 0] = static_cast<u8>(16 + x % 224);
+                chroma[static_cast<size_t>(y) * width + x + 1] = static_cast<u8>(16 + y % 224);
+            }
+        }
+    }
+
+    u32 width;
+    u32 height;
+    std::vector<u8> luma;
+    std::vector<u8> chroma;
+};
+
+/// Converts rows [first_row, last_row) of an NV12 frame to A8B8G8R8 like the VIC does
+void ConvertRows(const VicKernels& kernels, const Nv12Frame& frame, std::vector<u8>& output,
+                 std::vector<Pixel>& line, std::vector<Pixel>& converted, u32 first_row,
+                 u32 last_row) {
+    for (u32 y = first_row; y < last_row; ++y) {
+        kernels.read_semi_planar(line.data(), &frame.luma[static_cast<size_t>(y) * frame.width],
+                                 &frame.chroma[static_cast<size_t>(y / 2) * frame.width],
+                                 frame.width, 1023);
+        kernels.color_matrix(converted.data(), line.data(), frame.width, BT601_MATRIX);
+        kernels.write_abgr(&output[static_cast<size_t>(y) * frame.width * 4], converted.data(),
+                           frame.width);
+    }
+}
+} // Anonymous namespace
+
+TEST_CASE("VIC[Read]", "[video_core]") {
+    const auto& reference = GetVicKernels(VicKernelLevel::Generic);
+    ForEachHostLevel([&](const VicKernels& kernels) {
+        for (const u32 width : WIDTHS) {
+            const auto luma = RandomBytes(width, width);
+            const auto chroma = RandomBytes(width + 1, width + 1);
+            const auto chroma_v = RandomBytes(width, width + 2);
+            const u16 alpha = static_cast<u16>(width & 0x3FF);
+
+            std::vector<Pixel> expected(width);
+            std::vector<Pixel> result(width);
+            reference.read_semi_planar(expected.data(), luma.data(), chroma.data(), width, alpha);
+            kernels.read_semi_planar(result.data(), luma.data(), chroma.data(), width, alpha);
+            REQUIRE(result == expected);
+
+            reference.read_planar(expected.data(), luma.data(), chroma.data(), chroma_v.data(),
+                                  width, alpha);
+            kernels.read_planar(result.data(), luma.data(), chroma.data(), chroma_v.data(), width,
+                                alpha);
+            REQUIRE(result == expected);
+        }
+    });
+}
+
+TEST_CASE("VIC[ColorMatrix]", "[video_core]") {
+    const auto& reference = GetVicKernels(VicKernelLevel::Generic);
+    VicColorMatrix shifted = BT601_MATRIX;
+    shifted.shift = 2;
+    shifted.clamp_min = 64;
+    shifted.clamp_max = 940;
+    for (const VicColorMatrix& matrix : {BT601_MATRIX, shifted}) {
+        ForEachHostLevel([&](const VicKernels& kernels) {
+            for (const u32 width : WIDTHS) {
+                const auto input = RandomPixels(width, width);
+                std::vector<Pixel> expected(width);
+                std::vector<Pixel> result(width);
+                reference.color_matrix(expected.data(), input.data(), width, matrix);
+                kernels.color_matrix(result.data(), input.data(), width, matrix);
+                REQUIRE(result == expected);
+            }
+        });
+    }
+}
+
+TEST_CASE("VIC[Write]", "[video_core]") {
+    const auto& reference = GetVicKernels(VicKernelLevel::Generic);
+    ForEachHostLevel([&](const VicKernels& kernels) {
+        for (const u32 width : WIDTHS) {
+            const auto input = RandomPixels(width, width);
+            // Chroma of an odd width line still writes the pair of the last pixel
+            const size_t chroma_size = width + 1;
+
+            std::vector<u8> expected_luma(width);
+            std::vector<u8> expected_chroma(chroma_size);
+            std::vector<u8> result_luma(width);
+            std::vector<u8> result_chroma(chroma_size);
+            reference.write_y8_v8u8(expected_luma.data(), expected_chroma.data(), input.data(),
+                                    width);
+            kernels.write_y8_v8u8(result_luma.data(), result_chroma.data(), input.data(), width);
+            REQUIRE(result_luma == expected_luma);
+            REQUIRE(result_chroma == expected_chroma);
+
+            kernels.write_y8_v8u8(result_luma.data(), nullptr, input.data(), width);
+            REQUIRE(result_luma == expected_luma);
+
+            std::vector<u8> expected(width * 4);
+            std::vector<u8> result(width * 4);
+            reference.write_abgr(expected.data(), input.data(), width);
+            kernels.write_abgr(result.data(), input.data(), width);
+            REQUIRE(result == expected);
+
+            reference.write_argb(expected.data(), input.data(), width);
+            kernels.write_argb(result.data(), input.data(), width);
+            REQUIRE(result == expected);
+        }
+    });
+}
+
+TEST_CASE("VIC[Benchmark]", "[.][benchmark]") {
+    // NV12 to A8B8G8R8 through the colour matrix, the path taken by video playback
+    constexpr u32 rows_per_band = 32;
+    const Nv12Frame frame{1920, 1080};
+    std::vector<u8> output(static_cast<size_t>(frame.width) * frame.height * 4);
+
+    const u32 num_bands = Common::DivCeil(frame.height, rows_per_band);
+    std::vector<std::vector<Pixel>> lines(num_bands, std::vector<Pixel>(frame.width));
+    std::vector<std::vector<Pixel>> converted(num_bands, std::vector<Pixel>(frame.width));
+    Common::ThreadWorker workers{std::max(std::thread::hardware_concurrency(), 2U) / 2,
+                                 "VicBenchmark"};
+
+    const VicKernelLevel host_level = GetHostVicKernelLevel();
+    for (const VicKernelLevel level : LEVELS) {
+        if (static_cast<int>(level) > static_cast<int>(host_level)) {
+            continue;
+        }
+        const auto& kernels = GetVicKernels(level);
+        const std::string name = "1080p level " + std::to_string(static_cast<int>(level));
+
+        BENCHMARK(name + " single thread") {
+            ConvertRows(kernels, frame, output, lines[0], converted[0], 0, frame.height);
+            return output[0];
+        };
+        BENCHMARK(name + " row bands") {
+            for (u32 band = 0; band < num_bands; ++band) {
+                workers.QueueWork([&, band] {
+                    const u32 first_row = band * rows_per_band;
+                    ConvertRows(kernels, frame, output, lines[band], converted[band], first_row,
+                                std::min(first_row + rows_per_band, frame.height));
+                });
+            }
+            workers.WaitForRequests();
+            return output[0];
+        };
+    }
+}
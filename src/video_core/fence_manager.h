@@ -6,8 +6,6 @@
 #include <algorithm>
 #include <condition_variable>
 #include <cstring>
-#include <deque>
-#include <functional>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -19,6 +17,7 @@
 #include "common/settings.h"
 #include "common/thread.h"
 #include "video_core/delayed_destruction_ring.h"
+#include "video_core/fence_queue.h"
 #include "video_core/gpu.h"
 #include "video_core/host1x/host1x.h"
 #include "video_core/host1x/syncpoint_manager.h"
@@ -63,15 +62,16 @@ public:
     }
 
     void SignalReference() {
-        std::function<void()> do_nothing([] {});
-        SignalFence(std::move(do_nothing));
+        SignalFence([] {});
     }
 
-    void SyncOperation(std::function<void()>&& func) {
-        uncommitted_operations.emplace_back(std::move(func));
+    template <typename Func>
+    void SyncOperation(Func&& func) {
+        operations.Push(std::forward<Func>(func));
     }
 
-    void SignalFence(std::function<void()>&& func) {
+    template <typename Func>
+    void SignalFence(Func&& func) {
         bool delay_fence = Settings::IsGPULevelHigh();
         if constexpr (!can_async_check) {
             TryReleasePendingFences<false>();
@@ -83,14 +83,14 @@ public:
             guard.lock();
         }
         if (delay_fence) {
-            uncommitted_operations.emplace_back(std::move(func));
+            SyncOperation(std::forward<Func>(func));
         }
-        pending_operations.emplace_back(std::move(uncommitted_operations));
         QueueFence(new_fence);
         if (!delay_fence) {
             func();
         }
-        fences.push(std::move(new_fence));
+        fences.push({std::move(new_fence), operations.PushCount()});
+        ++num_signaled_fences;
         if (should_flush) {
             rasterizer.FlushCommands();
         }
@@ -103,8 +103,7 @@ public:
 
     void SignalSyncPoint(u32 value) {
         syncpoint_manager.IncrementGuest(value);
-        std::function<void()> func([this, value] { syncpoint_manager.IncrementHost(value); });
-        SignalFence(std::move(func));
+        SignalFence([this, value] { syncpoint_manager.IncrementHost(value); });
     }
 
     void WaitPendingFences([[maybe_unused]] bool force) {
@@ -114,18 +113,11 @@ public:
             if (!force) {
                 return;
             }
-            std::mutex wait_mutex;
-            std::condition_variable wait_cv;
-            std::atomic<bool> wait_finished{};
-            std::function<void()> func([&] {
-                std::scoped_lock lk(wait_mutex);
-                wait_finished.store(true, std::memory_order_relaxed);
-                wait_cv.notify_all();
-            });
-            SignalFence(std::move(func));
-            std::unique_lock lk(wait_mutex);
-            wait_cv.wait(
-                lk, [&wait_finished] { return wait_finished.load(std::memory_order_relaxed); });
+            SignalFence([] {});
+            if (Settings::IsGPULevelHigh()) {
+                // The fence only delays its operations, and so the wait, on high GPU accuracy
+                released_fences.Wait(num_signaled_fences);
+            }
         }
     }
 
@@ -170,23 +162,19 @@ private:
     template <bool force_wait>
     void TryReleasePendingFences() {
         while (!fences.empty()) {
-            TFence& current_fence = fences.front();
-            if (ShouldWait() && !IsFenceSignaled(current_fence)) {
+            PendingFence& current = fences.front();
+            if (ShouldWait() && !IsFenceSignaled(current.fence)) {
                 if constexpr (force_wait) {
-                    WaitFence(current_fence);
+                    WaitFence(current.fence);
                 } else {
                     return;
                 }
             }
             PopAsyncFlushes();
-            auto operations = std::move(pending_operations.front());
-            pending_operations.pop_front();
-            for (auto& operation : operations) {
-                operation();
-            }
+            operations.RunUntil(current.operations_end);
             {
                 std::unique_lock lock(ring_guard);
-                delayed_destruction_ring.Push(std::move(current_fence));
+                delayed_destruction_ring.Push(std::move(current.fence));
             }
             fences.pop();
         }
@@ -204,8 +192,7 @@ private:
         Common::SetCurrentThreadName(name.c_str());
         Common::SetCurrentThreadPriority(Common::ThreadPriority::High);
 
-        TFence current_fence;
-        std::deque<std::function<void()>> current_operations;
+        PendingFence current;
         while (!stop_token.stop_requested()) {
             {
                 std::unique_lock lock(guard);
@@ -213,22 +200,20 @@ private:
                 if (stop_token.stop_requested()) [[unlikely]] {
                     return;
                 }
-                current_fence = std::move(fences.front());
-                current_operations = std::move(pending_operations.front());
+                current = std::move(fences.front());
                 fences.pop();
-                pending_operations.pop_front();
             }
-            if (!current_fence->IsStubbed()) {
-                WaitFence(current_fence);
+            if (!current.fence->IsStubbed()) {
+                WaitFence(current.fence);
             }
             PopAsyncFlushes();
-            for (auto& operation : current_operations) {
-                operation();
-            }
+            // The operations were pushed before the fence was handed over under the guard
+            operations.RunUntil(current.operations_end);
             {
                 std::unique_lock lock(ring_guard);
-                delayed_destruction_ring.Push(std::move(current_fence));
+                delayed_destruction_ring.Push(std::move(current.fence));
             }
+            released_fences.Advance();
         }
     }
 
@@ -262,9 +247,16 @@ private:
         query_cache.CommitAsyncFlushes();
     }
 
-    std::queue<TFence> fences;
-    std::deque<std::function<void()>> uncommitted_operations;
-    std::deque<std::deque<std::function<void()>>> pending_operations;
+    struct PendingFence {
+        TFence fence;
+        u64 operations_end{}; ///< Number of operations to have run once the fence is released
+    };
+
+    std::queue<PendingFence> fences;
+    FenceOperationQueue operations;
+
+    u64 num_signaled_fences{};
+    FenceSequence released_fences;
 
     std::mutex guard;
     std::mutex ring_guard;
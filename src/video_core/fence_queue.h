@@ -0,0 +1,211 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+
+namespace VideoCommon {
+
+/// Type-erased void() callable. Callables that fit in its inline storage, like std::function or
+/// lambdas capturing a few values, are stored without allocating.
+class FenceOperation {
+public:
+    /// Large enough for std::function on every supported standard library, MSVC's is 64 bytes
+    static constexpr size_t InlineSize = 64;
+
+    /// Whether a callable of this type is stored without allocating
+    template <typename Func>
+    static constexpr bool IsStoredInline = sizeof(std::decay_t<Func>) <= InlineSize &&
+                                           alignof(std::decay_t<Func>) <= alignof(std::max_align_t);
+
+    FenceOperation() = default;
+
+    ~FenceOperation() {
+        Reset();
+    }
+
+    SUYU_NON_COPYABLE(FenceOperation);
+    SUYU_NON_MOVEABLE(FenceOperation);
+
+    template <typename Func>
+    void Emplace(Func&& func) {
+        using Functor = std::decay_t<Func>;
+        Reset();
+        if constexpr (IsStoredInline<Functor>) {
+            std::construct_at(reinterpret_cast<Functor*>(storage.data()), std::forward<Func>(func));
+        } else {
+            *reinterpret_cast<Functor**>(storage.data()) = new Functor(std::forward<Func>(func));
+        }
+        vtable = &VTableFor<Functor>;
+    }
+
+    void Reset() {
+        if (vtable != nullptr) {
+            vtable->destroy(storage.data());
+            vtable = nullptr;
+        }
+    }
+
+    void operator()() {
+        vtable->invoke(storage.data());
+    }
+
+    explicit operator bool() const {
+        return vtable != nullptr;
+    }
+
+private:
+    struct VTable {
+        void (*invoke)(std::byte*);
+        void (*destroy)(std::byte*);
+    };
+
+    template <typename Functor>
+    static Functor& Get(std::byte* data) {
+        if constexpr (IsStoredInline<Functor>) {
+            return *std::launder(reinterpret_cast<Functor*>(data));
+        } else {
+            return **reinterpret_cast<Functor**>(data);
+        }
+    }
+
+    template <typename Functor>
+    static constexpr VTable VTableFor{
+        .invoke = [](std::byte* data) { Get<Functor>(data)(); },
+        .destroy =
+            [](std::byte* data) {
+                if constexpr (IsStoredInline<Functor>) {
+                    std::destroy_at(&Get<Functor>(data));
+                } else {
+                    delete &Get<Functor>(data);
+                }
+            },
+    };
+
+    alignas(std::max_align_t) std::array<std::byte, InlineSize> storage;
+    const VTable* vtable{};
+};
+
+static_assert(FenceOperation::IsStoredInline<std::function<void()>>);
+
+/**
+ * Single producer, single consumer queue of the operations run when fences are released.
+ * Operations are stored in a circular list of chunks, and chunks the consumer is done with are
+ * reused by the producer, so once the queue has grown to the number of operations in flight it
+ * no longer allocates.
+ *
+ * The consumer only runs operations the producer has published to it, through a mutex or a
+ * release store.
+ */
+class FenceOperationQueue {
+public:
+    FenceOperationQueue() {
+        Chunk* const chunk = chunks.emplace_back(std::make_unique<Chunk>()).get();
+        chunk->next = chunk;
+        producer_chunk = chunk;
+        consumer_chunk.store(chunk, std::memory_order_relaxed);
+    }
+
+    SUYU_NON_COPYABLE(FenceOperationQueue);
+    SUYU_NON_MOVEABLE(FenceOperationQueue);
+
+    /// Producer: queues an operation
+    template <typename Func>
+    void Push(Func&& func) {
+        if (producer_index == ChunkSize) {
+            AdvanceProducer();
+        }
+        producer_chunk->operations[producer_index++].Emplace(std::forward<Func>(func));
+        ++push_count;
+    }
+
+    /// Producer: returns the number of operations pushed so far
+    u64 PushCount() const {
+        return push_count;
+    }
+
+    /// Consumer: runs and destroys operations in push order until `end` have been run
+    void RunUntil(u64 end) {
+        Chunk* chunk = consumer_chunk.load(std::memory_order_relaxed);
+        while (run_count < end) {
+            if (consumer_index == ChunkSize) {
+                // The producer has linked the next chunk before publishing its operations
+                chunk = chunk->next;
+                consumer_index = 0;
+                consumer_chunk.store(chunk, std::memory_order_release);
+            }
+            FenceOperation& operation = chunk->operations[consumer_index++];
+            operation();
+            operation.Reset();
+            ++run_count;
+        }
+    }
+
+private:
+    static constexpr size_t ChunkSize = 64;
+
+    struct Chunk {
+        std::array<FenceOperation, ChunkSize> operations;
+        Chunk* next{};
+    };
+
+    void AdvanceProducer() {
+        // The chunks from the consumer's up to the producer's hold operations that have not been
+        // run, the ones after the producer's up to the consumer's are free to reuse.
+        Chunk* next = producer_chunk->next;
+        if (next == consumer_chunk.load(std::memory_order_acquire)) {
+            Chunk* const chunk = chunks.emplace_back(std::make_unique<Chunk>()).get();
+            chunk->next = next;
+            producer_chunk->next = chunk;
+            next = chunk;
+        }
+        producer_chunk = next;
+        producer_index = 0;
+    }
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+
+    Chunk* producer_chunk{};
+    size_t producer_index{};
+    u64 push_count{};
+
+    std::atomic<Chunk*> consumer_chunk{};
+    size_t consumer_index{};
+    u64 run_count{};
+};
+
+/// Number of fences released by a release thread, which other threads can wait on
+class FenceSequence {
+public:
+    /// Release thread: marks the next fence as released and wakes the waiting threads
+    void Advance() {
+        value.fetch_add(1, std::memory_order_release);
+        value.notify_all();
+    }
+
+    /// Blocks until `sequence` fences have been released
+    void Wait(u64 sequence) const {
+        u64 current = value.load(std::memory_order_acquire);
+        while (current < sequence) {
+            value.wait(current, std::memory_order_acquire);
+            current = value.load(std::memory_order_acquire);
+        }
+    }
+
+private:
+    std::atomic<u64> value{};
+};
+
+} // namespace VideoCommon
@@ -7,6 +7,7 @@
 #include <condition_variable>
 #include <list>
 #include <memory>
+#include <span>
 
 #include "common/assert.h"
 #include "common/microprofile.h"
@@ -284,6 +285,13 @@ struct GPU::Impl {
         gpu_thread.FlushAndInvalidateRegion(addr, size);
     }
 
+    /// Composites the layers on the GPU thread, and adds the time it took to the perf stats
+    void CompositeAndRecordTime(std::span<const Tegra::FramebufferConfig> layers) {
+        const auto present_begin = Core::PerfStats::Clock::now();
+        renderer->Composite(layers);
+        system.GetPerfStats().AddPresentTime(Core::PerfStats::Clock::now() - present_begin);
+    }
+
     void RequestComposite(std::vector<Tegra::FramebufferConfig>&& layers,
                           std::vector<Service::Nvidia::NvFence>&& fences) {
         size_t num_fences{fences.size()};
@@ -303,7 +311,7 @@ struct GPU::Impl {
             RequestSyncOperation([this, current_request_counter, &layers, &fences, num_fences] {
                 auto& syncpoint_manager = host1x.GetSyncpointManager();
                 if (num_fences == 0) {
-                    renderer->Composite(layers);
+                    CompositeAndRecordTime(layers);
                 }
                 const auto executer = [this, current_request_counter, layers_copy = layers]() {
                     {
@@ -313,7 +321,7 @@ struct GPU::Impl {
                         }
                         free_swap_counters.push_back(current_request_counter);
                     }
-                    renderer->Composite(layers_copy);
+                    CompositeAndRecordTime(layers_copy);
                 };
                 for (size_t i = 0; i < num_fences; i++) {
                     syncpoint_manager.RegisterGuestAction(fences[i].id, fences[i].value, executer);
@@ -7,23 +7,20 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <vector>
 
 #include "common/common_types.h"
 #include "common/scratch_buffer.h"
+#include "common/thread_worker.h"
 #include "video_core/cdma_pusher.h"
+#include "video_core/host1x/vic_kernels.h"
 
 namespace Tegra::Host1x {
 class Host1x;
 class Nvdec;
 
-struct Pixel {
-    u16 r;
-    u16 g;
-    u16 b;
-    u16 a;
-};
-
 // One underscore represents separate pixels.
 // Double underscore represents separate planes.
 // _N represents chroma subsampling, not a separate pixel.
@@ -609,20 +606,21 @@ public:
     void ProcessMethod(u32 method, u32 arg) override;
 
 private:
+    struct SlotSource;
+
+    /// Rows converted by each task when a frame is split over the workers
+    static constexpr u32 ROWS_PER_BAND = 32;
+
     void Execute();
 
-    void Blend(const ConfigStruct& config, const SlotStruct& slot);
+    /// Calls func with bands of rows in [first_row, last_row) and a line buffer owned by the band
+    template <typename Func>
+    void ForEachBand(u32 first_row, u32 last_row, Func&& func);
 
-    template <bool Planar, bool Interlaced = false>
-    void ReadProgressiveY8__V8U8_N420(const SlotStruct& slot, std::span<const PlaneOffsets> offsets,
-                                      std::shared_ptr<const FFmpeg::Frame> frame);
-    template <bool Planar, bool TopField>
-    void ReadInterlacedY8__V8U8_N420(const SlotStruct& slot, std::span<const PlaneOffsets> offsets,
-                                     std::shared_ptr<const FFmpeg::Frame> frame);
+    std::optional<SlotSource> ReadSlot(const SlotStruct& slot,
+                                       std::shared_ptr<const FFmpeg::Frame> frame);
 
-    template <bool Planar>
-    void ReadY8__V8U8_N420(const SlotStruct& slot, std::span<const PlaneOffsets> offsets,
-                           std::shared_ptr<const FFmpeg::Frame> frame);
+    void Blend(const ConfigStruct& config, const SlotStruct& slot, const SlotSource& source);
 
     void WriteY8__V8U8_N420(const OutputSurfaceConfig& output_surface_config);
 
@@ -636,10 +634,11 @@ private:
     VicRegisters regs{};
     FrameQueue& frame_queue;
 
-    const bool has_sse41{false};
+    const VicKernels& kernels;
+    std::unique_ptr<Common::ThreadWorker> workers;
+    std::vector<Common::ScratchBuffer<Pixel>> band_rows;
 
     Common::ScratchBuffer<Pixel> output_surface;
-    Common::ScratchBuffer<Pixel> slot_surface;
     Common::ScratchBuffer<u8> luma_scratch;
     Common::ScratchBuffer<u8> chroma_scratch;
     Common::ScratchBuffer<u8> swizzle_scratch;
@@ -0,0 +1,669 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+
+#if defined(ARCHITECTURE_x86_64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#elif defined(ARCHITECTURE_arm64)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wimplicit-int-conversion"
+#include <sse2neon.h>
+#pragma GCC diagnostic pop
+#endif
+
+#include "common/alignment.h"
+#include "video_core/host1x/vic_kernels.h"
+
+#if defined(ARCHITECTURE_x86_64)
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Tegra::Host1x {
+namespace {
+namespace Generic {
+void ReadSemiPlanar(Pixel* output, const u8* luma, const u8* chroma, u32 width, u16 alpha) {
+    for (u32 x = 0; x < width; x++) {
+        // Chroma samples are duplicated horizontally.
+        output[x] = {
+            .r = static_cast<u16>(luma[x] << 2),
+            .g = static_cast<u16>(chroma[(x & ~1U) + 0] << 2),
+            .b = static_cast<u16>(chroma[(x & ~1U) + 1] << 2),
+            .a = alpha,
+        };
+    }
+}
+
+void ReadPlanar(Pixel* output, const u8* luma, const u8* chroma_u, const u8* chroma_v, u32 width,
+                u16 alpha) {
+    for (u32 x = 0; x < width; x++) {
+        output[x] = {
+            .r = static_cast<u16>(luma[x] << 2),
+            .g = static_cast<u16>(chroma_u[x / 2] << 2),
+            .b = static_cast<u16>(chroma_v[x / 2] << 2),
+            .a = alpha,
+        };
+    }
+}
+
+void ColorMatrix(Pixel* output, const Pixel* input, u32 width, const VicColorMatrix& matrix) {
+    const auto& m = matrix.coefficients;
+    const s32 clamp_min = matrix.clamp_min;
+    const s32 clamp_max = matrix.clamp_max;
+    // Clamped like the vector kernels, which stay defined when the soft clamp is inverted
+    const auto clamp = [clamp_min, clamp_max](s32 value) {
+        return static_cast<u16>(std::min(std::max(value, clamp_min), clamp_max));
+    };
+    for (u32 x = 0; x < width; x++) {
+        const s32 r = input[x].r;
+        const s32 g = input[x].g;
+        const s32 b = input[x].b;
+        const s32 a = input[x].a;
+
+        // The last column ignores the shift, as per the TRM, and the result is S12.8
+        const s32 out_r = (((r * m[0][0] + g * m[0][1] + b * m[0][2]) >> matrix.shift) + m[0][3]) >> 8;
+        const s32 out_g = (((r * m[1][0] + g * m[1][1] + b * m[1][2]) >> matrix.shift) + m[1][3]) >> 8;
+        const s32 out_b = (((r * m[2][0] + g * m[2][1] + b * m[2][2]) >> matrix.shift) + m[2][3]) >> 8;
+
+        output[x] = {
+            .r = clamp(out_r),
+            .g = clamp(out_g),
+            .b = clamp(out_b),
+            .a = clamp(a),
+        };
+    }
+}
+
+void WriteY8V8U8(u8* luma, u8* chroma, const Pixel* input, u32 width) {
+    for (u32 x = 0; x < width; x++) {
+        luma[x] = static_cast<u8>(input[x].r >> 2);
+    }
+    if (!chroma) {
+        return;
+    }
+    // Chroma is half the width of luma, every other pixel is skipped.
+    for (u32 x = 0; x < width; x += 2) {
+        chroma[x + 0] = static_cast<u8>(input[x].g >> 2);
+        chroma[x + 1] = static_cast<u8>(input[x].b >> 2);
+    }
+}
+
+void WriteABGR(u8* output, const Pixel* input, u32 width) {
+    for (u32 x = 0; x < width; x++) {
+        output[x * 4 + 0] = static_cast<u8>(input[x].r >> 2);
+        output[x * 4 + 1] = static_cast<u8>(input[x].g >> 2);
+        output[x * 4 + 2] = static_cast<u8>(input[x].b >> 2);
+        output[x * 4 + 3] = static_cast<u8>(input[x].a >> 2);
+    }
+}
+
+void WriteARGB(u8* output, const Pixel* input, u32 width) {
+    for (u32 x = 0; x < width; x++) {
+        output[x * 4 + 0] = static_cast<u8>(input[x].b >> 2);
+        output[x * 4 + 1] = static_cast<u8>(input[x].g >> 2);
+        output[x * 4 + 2] = static_cast<u8>(input[x].r >> 2);
+        output[x * 4 + 3] = static_cast<u8>(input[x].a >> 2);
+    }
+}
+} // namespace Generic
+
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_arm64)
+namespace SSE {
+template <bool Planar>
+void ReadYUV420(Pixel* output, const u8* luma, const u8* chroma_u, const u8* chroma_v, u32 width,
+                u16 alpha_value) {
+    const auto alpha = _mm_slli_epi64(_mm_set1_epi64x(static_cast<s64>(alpha_value)), 48);
+    const auto shuffle_mask = _mm_set_epi8(13, 15, 14, 12, 9, 11, 10, 8, 5, 7, 6, 4, 1, 3, 2, 0);
+    const u32 sse_aligned_width = Common::AlignDown(width, 16U);
+
+    u32 x = 0;
+    for (; x < sse_aligned_width; x += 16) {
+        // clang-format off
+        // Load 8 bytes * 2 of 8-bit luma samples
+        // luma0 = 00 00 00 00 00 00 00 00 LL LL LL LL LL LL LL LL
+        auto luma0 = _mm_loadl_epi64((const __m128i*)&luma[x + 0]);
+        auto luma1 = _mm_loadl_epi64((const __m128i*)&luma[x + 8]);
+
+        __m128i chroma;
+
+        if constexpr (Planar) {
+            // If Chroma is planar, we have separate U and V planes, load 8 bytes of each
+            // chroma_u0 = 00 00 00 00 00 00 00 00 UU UU UU UU UU UU UU UU
+            // chroma_v0 = 00 00 00 00 00 00 00 00 VV VV VV VV VV VV VV VV
+            auto chroma_u0 = _mm_loadl_epi64((const __m128i*)&chroma_u[x / 2]);
+            auto chroma_v0 = _mm_loadl_epi64((const __m128i*)&chroma_v[x / 2]);
+
+            // Interleave the 8 bytes of U and V into a single 16 byte reg
+            // chroma = VV UU VV UU VV UU VV UU VV UU VV UU VV UU VV UU
+            chroma = _mm_unpacklo_epi8(chroma_u0, chroma_v0);
+        } else {
+            // Chroma is already interleaved in semiplanar format, just load 16 bytes
+            // chroma = VV UU VV UU VV UU VV UU VV UU VV UU VV UU VV UU
+            chroma = _mm_loadu_si128((const __m128i*)&chroma_u[x]);
+        }
+
+        // Convert the low 8 bytes of 8-bit luma into 16-bit luma
+        // luma0 = [00] [00] [00] [00] [00] [00] [00] [00] [LL] [LL] [LL] [LL] [LL] [LL] [LL] [LL]
+        // ->
+        // luma0 = [00 LL] [00 LL] [00 LL] [00 LL] [00 LL] [00 LL] [00 LL] [00 LL]
+        luma0 = _mm_cvtepu8_epi16(luma0);
+        luma1 = _mm_cvtepu8_epi16(luma1);
+
+        // Treat the 8 bytes of 8-bit chroma as 16-bit channels, this allows us to take both the
+        // U and V together as one element. Using chroma twice here duplicates the values, as we
+        // take element 0 from chroma, and then element 0 from chroma again, etc. We need to
+        // duplicate chroma horitonally as chroma is half the width of luma.
+        // chroma   = [VV8 UU8] [VV7 UU7] [VV6 UU6] [VV5 UU5] [VV4 UU4] [VV3 UU3] [VV2 UU2] [VV1 UU1]
+        // ->
+        // chroma00 = [VV4 UU4] [VV4 UU4] [VV3 UU3] [VV3 UU3] [VV2 UU2] [VV2 UU2] [VV1 UU1] [VV1 UU1]
+        // chroma01 = [VV8 UU8] [VV8 UU8] [VV7 UU7] [VV7 UU7] [VV6 UU6] [VV6 UU6] [VV5 UU5] [VV5 UU5]
+        auto chroma00 = _mm_unpacklo_epi16(chroma, chroma);
+        auto chroma01 = _mm_unpackhi_epi16(chroma, chroma);
+
+        // Interleave the 16-bit luma and chroma.
+        // luma0    = [008 LL8] [007 LL7] [006 LL6] [005 LL5] [004 LL4] [003 LL3] [002 LL2] [001 LL1]
+        // chroma00 = [VV8 UU8] [VV7 UU7] [VV6 UU6] [VV5 UU5] [VV4 UU4] [VV3 UU3] [VV2 UU2] [VV1 UU1]
+        // ->
+        // yuv0     = [VV4 UU4 004 LL4] [VV3 UU3 003 LL3] [VV2 UU2 002 LL2] [VV1 UU1 001 LL1]
+        // yuv1     = [VV8 UU8 008 LL8] [VV7 UU7 007 LL7] [VV6 UU6 006 LL6] [VV5 UU5 005 LL5]
+        auto yuv0 = _mm_unpacklo_epi16(luma0, chroma00);
+        auto yuv1 = _mm_unpackhi_epi16(luma0, chroma00);
+        auto yuv2 = _mm_unpacklo_epi16(luma1, chroma01);
+        auto yuv3 = _mm_unpackhi_epi16(luma1, chroma01);
+
+        // Shuffle the luma/chroma into the channel ordering we actually want. The high byte of
+        // the luma which is now a constant 0 after converting 8-bit -> 16-bit is used as the
+        // alpha. Luma -> R, U -> G, V -> B, 0 -> A
+        // yuv0 = [VV4 UU4 004 LL4] [VV3 UU3 003 LL3] [VV2 UU2 002 LL2] [VV1 UU1 001 LL1]
+        // ->
+        // yuv0 = [AA4 VV4 UU4 LL4] [AA3 VV3 UU3 LL3] [AA2 VV2 UU2 LL2] [AA1 VV1 UU1 LL1]
+        yuv0 = _mm_shuffle_epi8(yuv0, shuffle_mask);
+        yuv1 = _mm_shuffle_epi8(yuv1, shuffle_mask);
+        yuv2 = _mm_shuffle_epi8(yuv2, shuffle_mask);
+        yuv3 = _mm_shuffle_epi8(yuv3, shuffle_mask);
+
+        // Extend the 8-bit channels we have into 16-bits, as that's the target surface format.
+        // Since this turns just the low 8 bytes into 16 bytes, the second of
+        // each operation here right shifts the register by 8 to get the high pixels.
+        // yuv0  = [AA4] [VV4] [UU4] [LL4] [AA3] [VV3] [UU3] [LL3] [AA2] [VV2] [UU2] [LL2] [AA1] [VV1] [UU1] [LL1]
+        // ->
+        // yuv01 = [002 AA2] [002 VV2] [002 UU2] [002 LL2] [001 AA1] [001 VV1] [001 UU1] [001 LL1]
+        // yuv23 = [004 AA4] [004 VV4] [004 UU4] [004 LL4] [003 AA3] [003 VV3] ]003 UU3] [003 LL3]
+        auto yuv01 = _mm_cvtepu8_epi16(yuv0);
+        auto yuv23 = _mm_cvtepu8_epi16(_mm_srli_si128(yuv0, 8));
+        auto yuv45 = _mm_cvtepu8_epi16(yuv1);
+        auto yuv67 = _mm_cvtepu8_epi16(_mm_srli_si128(yuv1, 8));
+        auto yuv89 = _mm_cvtepu8_epi16(yuv2);
+        auto yuv1011 = _mm_cvtepu8_epi16(_mm_srli_si128(yuv2, 8));
+        auto yuv1213 = _mm_cvtepu8_epi16(yuv3);
+        auto yuv1415 = _mm_cvtepu8_epi16(_mm_srli_si128(yuv3, 8));
+
+        // Left-shift all 16-bit channels by 2, this is to get us into a 10-bit format instead
+        // of 8, which is the format alpha is in, as well as other blending values.
+        yuv01 = _mm_slli_epi16(yuv01, 2);
+        yuv23 = _mm_slli_epi16(yuv23, 2);
+        yuv45 = _mm_slli_epi16(yuv45, 2);
+        yuv67 = _mm_slli_epi16(yuv67, 2);
+        yuv89 = _mm_slli_epi16(yuv89, 2);
+        yuv1011 = _mm_slli_epi16(yuv1011, 2);
+        yuv1213 = _mm_slli_epi16(yuv1213, 2);
+        yuv1415 = _mm_slli_epi16(yuv1415, 2);
+
+        // OR in the planar alpha, this has already been duplicated and shifted into position,
+        // and just fills in the AA channels with the actual alpha value.
+        yuv01 = _mm_or_si128(yuv01, alpha);
+        yuv23 = _mm_or_si128(yuv23, alpha);
+        yuv45 = _mm_or_si128(yuv45, alpha);
+        yuv67 = _mm_or_si128(yuv67, alpha);
+        yuv89 = _mm_or_si128(yuv89, alpha);
+        yuv1011 = _mm_or_si128(yuv1011, alpha);
+        yuv1213 = _mm_or_si128(yuv1213, alpha);
+        yuv1415 = _mm_or_si128(yuv1415, alpha);
+
+        // Store out the pixels. One pixel is now 8 bytes, so each store is 2 pixels.
+        // [AA AA] [VV VV] [UU UU] [LL LL] [AA AA] [VV VV] [UU UU] [LL LL]
+        _mm_storeu_si128((__m128i*)&output[x + 0], yuv01);
+        _mm_storeu_si128((__m128i*)&output[x + 2], yuv23);
+        _mm_storeu_si128((__m128i*)&output[x + 4], yuv45);
+        _mm_storeu_si128((__m128i*)&output[x + 6], yuv67);
+        _mm_storeu_si128((__m128i*)&output[x + 8], yuv89);
+        _mm_storeu_si128((__m128i*)&output[x + 10], yuv1011);
+        _mm_storeu_si128((__m128i*)&output[x + 12], yuv1213);
+        _mm_storeu_si128((__m128i*)&output[x + 14], yuv1415);
+
+        // clang-format on
+    }
+
+    if constexpr (Planar) {
+        Generic::ReadPlanar(output + x, luma + x, chroma_u + x / 2, chroma_v + x / 2, width - x,
+                            alpha_value);
+    } else {
+        Generic::ReadSemiPlanar(output + x, luma + x, chroma_u + x, width - x, alpha_value);
+    }
+}
+
+void ReadSemiPlanar(Pixel* output, const u8* luma, const u8* chroma, u32 width, u16 alpha) {
+    ReadYUV420<false>(output, luma, chroma, nullptr, width, alpha);
+}
+
+void ReadPlanar(Pixel* output, const u8* luma, const u8* chroma_u, const u8* chroma_v, u32 width,
+                u16 alpha) {
+    ReadYUV420<true>(output, luma, chroma_u, chroma_v, width, alpha);
+}
+
+void ColorMatrix(Pixel* output, const Pixel* input, u32 width, const VicColorMatrix& matrix) {
+    const auto& m = matrix.coefficients;
+
+    // clang-format off
+    // Colour conversion is a 3x4 * 4x1 matrix multiplication, resulting in a 3x1 matrix.
+    // | r0c0 r0c1 r0c2 r0c3 |   | R |   | R |
+    // | r1c0 r1c1 r1c2 r1c3 | * | G | = | G |
+    // | r2c0 r2c1 r2c2 r2c3 |   | B |   | B |
+    //                           | 1 |
+    // clang-format on
+
+    // Fill the columns, e.g
+    // c0 = [00 00 00 00] [r2c0 r2c0 r2c0 r2c0] [r1c0 r1c0 r1c0 r1c0] [r0c0 r0c0 r0c0 r0c0]
+    const auto c0 = _mm_set_epi32(0, m[2][0], m[1][0], m[0][0]);
+    const auto c1 = _mm_set_epi32(0, m[2][1], m[1][1], m[0][1]);
+    const auto c2 = _mm_set_epi32(0, m[2][2], m[1][2], m[0][2]);
+    const auto c3 = _mm_set_epi32(0, m[2][3], m[1][3], m[0][3]);
+
+    // Set the matrix right-shift as a single element.
+    const auto shift = _mm_set_epi32(0, 0, 0, matrix.shift);
+
+    // Set every 16-bit value to the soft clamp values for clamping every 16-bit channel.
+    const auto clamp_min = _mm_set1_epi16(static_cast<s16>(matrix.clamp_min));
+    const auto clamp_max = _mm_set1_epi16(static_cast<s16>(matrix.clamp_max));
+
+    // clang-format off
+
+    auto MatMul = [](__m128i& p, const __m128i& col0, const __m128i& col1, const __m128i& col2,
+                     const __m128i& col3, const __m128i& trm_shift) -> __m128i {
+        // Duplicate the 32-bit channels, e.g
+        // p = [AA AA AA AA] [BB BB BB BB] [GG GG GG GG] [RR RR RR RR]
+        // ->
+        // r = [RR4 RR4 RR4 RR4] [RR3 RR3 RR3 RR3] [RR2 RR2 RR2 RR2] [RR1 RR1 RR1 RR1]
+        auto r = _mm_shuffle_epi32(p, 0x0);
+        auto g = _mm_shuffle_epi32(p, 0x55);
+        auto b = _mm_shuffle_epi32(p, 0xAA);
+
+        // Multiply the rows and columns c0 * r, c1 * g, c2 * b, e.g
+        // r  = [RR4 RR4 RR4 RR4] [ RR3  RR3  RR3  RR3] [ RR2  RR2  RR2  RR2] [ RR1  RR1  RR1  RR1]
+        //                                             *
+        // c0 = [ 00  00  00  00] [r2c0 r2c0 r2c0 r2c0] [r1c0 r1c0 r1c0 r1c0] [r0c0 r0c0 r0c0 r0c0]
+        r = _mm_mullo_epi32(r, col0);
+        g = _mm_mullo_epi32(g, col1);
+        b = _mm_mullo_epi32(b, col2);
+
+        // Add them all together vertically, such that the 32-bit element
+        // out[0] = (r[0] * c0[0]) + (g[0] * c1[0]) + (b[0] * c2[0])
+        auto out = _mm_add_epi32(_mm_add_epi32(r, g), b);
+
+        // Shift the result by r_shift, as the TRM says
+        out = _mm_sra_epi32(out, trm_shift);
+
+        // Add the final column. Because the 4x1 matrix has this row as 1, there's no need to
+        // multiply by it, and as per the TRM this column ignores r_shift, so it's just added
+        // here after shifting.
+        out = _mm_add_epi32(out, col3);
+
+        // Shift the result back from S12.8 to integer values
+        return _mm_srai_epi32(out, 8);
+    };
+
+    const u32 sse_aligned_width = Common::AlignDown(width, 8U);
+
+    u32 x = 0;
+    for (; x < sse_aligned_width; x += 8) {
+        // Load in pixels
+        // p01 = [AA AA] [BB BB] [GG GG] [RR RR] [AA AA] [BB BB] [GG GG] [RR RR]
+        auto p01 = _mm_loadu_si128((const __m128i*)&input[x + 0]);
+        auto p23 = _mm_loadu_si128((const __m128i*)&input[x + 2]);
+        auto p45 = _mm_loadu_si128((const __m128i*)&input[x + 4]);
+        auto p67 = _mm_loadu_si128((const __m128i*)&input[x + 6]);
+
+        // Convert the 16-bit channels into 32-bit (unsigned), as the matrix values are
+        // 32-bit and to avoid overflow.
+        // p01    = [AA2 AA2] [BB2 BB2] [GG2 GG2] [RR2 RR2] [AA1 AA1] [BB1 BB1] [GG1 GG1] [RR1 RR1]
+        // ->
+        // p01_lo = [001 001 AA1 AA1] [001 001 BB1 BB1] [001 001 GG1 GG1] [001 001 RR1 RR1]
+        // p01_hi = [002 002 AA2 AA2] [002 002 BB2 BB2] [002 002 GG2 GG2] [002 002 RR2 RR2]
+        auto p01_lo = _mm_cvtepu16_epi32(p01);
+        auto p01_hi = _mm_cvtepu16_epi32(_mm_srli_si128(p01, 8));
+        auto p23_lo = _mm_cvtepu16_epi32(p23);
+        auto p23_hi = _mm_cvtepu16_epi32(_mm_srli_si128(p23, 8));
+        auto p45_lo = _mm_cvtepu16_epi32(p45);
+        auto p45_hi = _mm_cvtepu16_epi32(_mm_srli_si128(p45, 8));
+        auto p67_lo = _mm_cvtepu16_epi32(p67);
+        auto p67_hi = _mm_cvtepu16_epi32(_mm_srli_si128(p67, 8));
+
+        // Matrix multiply the pixel, doing the colour conversion.
+        auto out0 = MatMul(p01_lo, c0, c1, c2, c3, shift);
+        auto out1 = MatMul(p01_hi, c0, c1, c2, c3, shift);
+        auto out2 = MatMul(p23_lo, c0, c1, c2, c3, shift);
+        auto out3 = MatMul(p23_hi, c0, c1, c2, c3, shift);
+        auto out4 = MatMul(p45_lo, c0, c1, c2, c3, shift);
+        auto out5 = MatMul(p45_hi, c0, c1, c2, c3, shift);
+        auto out6 = MatMul(p67_lo, c0, c1, c2, c3, shift);
+        auto out7 = MatMul(p67_hi, c0, c1, c2, c3, shift);
+
+        // Pack the 32-bit channel pixels back into 16-bit using unsigned saturation
+        // out0  = [001 001 AA1 AA1] [001 001 BB1 BB1] [001 001 GG1 GG1] [001 001 RR1 RR1]
+        // out1  = [002 002 AA2 AA2] [002 002 BB2 BB2] [002 002 GG2 GG2] [002 002 RR2 RR2]
+        // ->
+        // done0 = [AA2 AA2] [BB2 BB2] [GG2 GG2] [RR2 RR2] [AA1 AA1] [BB1 BB1] [GG1 GG1] [RR1 RR1]
+        auto done0 = _mm_packus_epi32(out0, out1);
+        auto done1 = _mm_packus_epi32(out2, out3);
+        auto done2 = _mm_packus_epi32(out4, out5);
+        auto done3 = _mm_packus_epi32(out6, out7);
+
+        // Blend the original alpha back into the pixel, as the matrix multiply gives us a
+        // 3-channel output, not 4.
+        // 0x88 = b10001000, taking RGB from the first argument, A from the second argument.
+        // done0 = [002 002] [BB2 BB2] [GG2 GG2] [RR2 RR2] [001 001] [BB1 BB1] [GG1 GG1] [RR1 RR1]
+        // ->
+        // done0 = [AA2 AA2] [BB2 BB2] [GG2 GG2] [RR2 RR2] [AA1 AA1] [BB1 BB1] [GG1 GG1] [RR1 RR1]
+        done0 = _mm_blend_epi16(done0, p01, 0x88);
+        done1 = _mm_blend_epi16(done1, p23, 0x88);
+        done2 = _mm_blend_epi16(done2, p45, 0x88);
+        done3 = _mm_blend_epi16(done3, p67, 0x88);
+
+        // Clamp the 16-bit channels to the soft-clamp min/max.
+        done0 = _mm_max_epu16(done0, clamp_min);
+        done1 = _mm_max_epu16(done1, clamp_min);
+        done2 = _mm_max_epu16(done2, clamp_min);
+        done3 = _mm_max_epu16(done3, clamp_min);
+
+        done0 = _mm_min_epu16(done0, clamp_max);
+        done1 = _mm_min_epu16(done1, clamp_max);
+        done2 = _mm_min_epu16(done2, clamp_max);
+        done3 = _mm_min_epu16(done3, clamp_max);
+
+        // Store the pixels to the output surface.
+        _mm_storeu_si128((__m128i*)&output[x + 0], done0);
+        _mm_storeu_si128((__m128i*)&output[x + 2], done1);
+        _mm_storeu_si128((__m128i*)&output[x + 4], done2);
+        _mm_storeu_si128((__m128i*)&output[x + 6], done3);
+    }
+    // clang-format on
+
+    Generic::ColorMatrix(output + x, input + x, width - x, matrix);
+}
+
+void WriteY8V8U8(u8* luma, u8* chroma, const Pixel* input, u32 width) {
+    // luma_mask   = [00 00] [00 00] [00 00] [FF FF] [00 00] [00 00] [00 00] [FF FF]
+    const auto luma_mask = _mm_set_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+
+    const u32 sse_aligned_width = Common::AlignDown(width, 16U);
+
+    u32 x = 0;
+    for (; x < sse_aligned_width; x += 16) {
+        // clang-format off
+        // Load the 64-bit pixels, 2 per variable.
+        auto pixel01 = _mm_loadu_si128((const __m128i*)&input[x + 0]);
+        auto pixel23 = _mm_loadu_si128((const __m128i*)&input[x + 2]);
+        auto pixel45 = _mm_loadu_si128((const __m128i*)&input[x + 4]);
+        auto pixel67 = _mm_loadu_si128((const __m128i*)&input[x + 6]);
+        auto pixel89 = _mm_loadu_si128((const __m128i*)&input[x + 8]);
+        auto pixel1011 = _mm_loadu_si128((const __m128i*)&input[x + 10]);
+        auto pixel1213 = _mm_loadu_si128((const __m128i*)&input[x + 12]);
+        auto pixel1415 = _mm_loadu_si128((const __m128i*)&input[x + 14]);
+
+        // Split out the luma of each pixel using the luma_mask above.
+        // pixel01 = [AA2 AA2] [VV2 VV2] [UU2 UU2] [LL2 LL2] [AA1 AA1] [VV1 VV1] [UU1 UU1] [LL1 LL1]
+        // ->
+        //     l01 = [002 002] [002 002] [002 002] [LL2 LL2] [001 001] [001 001] [001 001] [LL1 LL1]
+        auto l01 = _mm_and_si128(pixel01, luma_mask);
+        auto l23 = _mm_and_si128(pixel23, luma_mask);
+        auto l45 = _mm_and_si128(pixel45, luma_mask);
+        auto l67 = _mm_and_si128(pixel67, luma_mask);
+        auto l89 = _mm_and_si128(pixel89, luma_mask);
+        auto l1011 = _mm_and_si128(pixel1011, luma_mask);
+        auto l1213 = _mm_and_si128(pixel1213, luma_mask);
+        auto l1415 = _mm_and_si128(pixel1415, luma_mask);
+
+        // Pack 32-bit elements from 2 registers down into 16-bit elements in 1 register.
+        // l01   = [002 002 002 002] [002 002 LL2 LL2] [001 001 001 001] [001 001 LL1 LL1]
+        // l23   = [004 004 004 004] [004 004 LL4 LL4] [003 003 003 003] [003 003 LL3 LL3]
+        // ->
+        // l0123 = [004 004] [LL4 LL4] [003 003] [LL3 LL3] [002 002] [LL2 LL2] [001 001] [LL1 LL1]
+        auto l0123 = _mm_packus_epi32(l01, l23);
+        auto l4567 = _mm_packus_epi32(l45, l67);
+        auto l891011 = _mm_packus_epi32(l89, l1011);
+        auto l12131415 = _mm_packus_epi32(l1213, l1415);
+
+        // Pack 32-bit elements from 2 registers down into 16-bit elements in 1 register.
+        // l0123   = [004 004 LL4 LL4] [003 003 LL3 LL3] [002 002 LL2 LL2] [001 001 LL1 LL1]
+        // l4567   = [008 008 LL8 LL8] [007 007 LL7 LL7] [006 006 LL6 LL6] [005 005 LL5 LL5]
+        // ->
+        // luma_lo = [LL8 LL8] [LL7 LL7] [LL6 LL6] [LL5 LL5] [LL4 LL4] [LL3 LL3] [LL2 LL2] [LL1 LL1]
+        auto luma_lo = _mm_packus_epi32(l0123, l4567);
+        auto luma_hi = _mm_packus_epi32(l891011, l12131415);
+
+        // Right-shift the 16-bit elements by 2, un-doing the left shift by 2 on read
+        // and bringing the range back to 8-bit.
+        luma_lo = _mm_srli_epi16(luma_lo, 2);
+        luma_hi = _mm_srli_epi16(luma_hi, 2);
+
+        // Pack with unsigned saturation the 16-bit values in 2 registers into 8-bit values in 1 register.
+        // luma_lo =  [LL8  LL8]  [LL7  LL7]  [LL6  LL6]  [LL5  LL5]  [LL4  LL4]  [LL3  LL3]  [LL2  LL2] [LL1 LL1]
+        // luma_hi = [LL16 LL16] [LL15 LL15] [LL14 LL14] [LL13 LL13] [LL12 LL12] [LL11 LL11] [LL10 LL10] [LL9 LL9]
+        // ->
+        // luma = [LL16] [LL15] [LL14] [LL13] [LL12] [LL11] [LL10] [LL9] [LL8] [LL7] [LL6] [LL5] [LL4] [LL3] [LL2] [LL1]
+        auto luma_bytes = _mm_packus_epi16(luma_lo, luma_hi);
+
+        // Store the 16 bytes of luma
+        _mm_storeu_si128((__m128i*)&luma[x], luma_bytes);
+
+        if (chroma) {
+            // Chroma, done every other line as it's half the height of luma.
+
+            // Shift the register right by 2 bytes (not bits), to kick out the 16-bit luma.
+            // We can do this instead of &'ing a mask and then shifting.
+            // pixel01 = [AA2 AA2] [VV2 VV2] [UU2 UU2] [LL2 LL2] [AA1 AA1] [VV1 VV1] [UU1 UU1] [LL1 LL1]
+            // ->
+            //     c01 = [ 00  00] [AA2 AA2] [VV2 VV2] [UU2 UU2] [LL2 LL2] [AA1 AA1] [VV1 VV1] [UU1 UU1]
+            auto c01 = _mm_srli_si128(pixel01, 2);
+            auto c23 = _mm_srli_si128(pixel23, 2);
+            auto c45 = _mm_srli_si128(pixel45, 2);
+            auto c67 = _mm_srli_si128(pixel67, 2);
+            auto c89 = _mm_srli_si128(pixel89, 2);
+            auto c1011 = _mm_srli_si128(pixel1011, 2);
+            auto c1213 = _mm_srli_si128(pixel1213, 2);
+            auto c1415 = _mm_srli_si128(pixel1415, 2);
+
+            // Interleave the lower 8 bytes as 32-bit elements from 2 registers into 1 register.
+            // This has the effect of skipping every other chroma value horitonally,
+            // notice the high pixels UU2/UU4 are skipped.
+            // This is intended as N420 chroma width is half the luma width.
+            // c01   = [ 00  00 AA2 AA2] [VV2 VV2 UU2 UU2] [LL2 LL2 AA1 AA1] [VV1 VV1 UU1 UU1]
+            // c23   = [ 00  00 AA4 AA4] [VV4 VV4 UU4 UU4] [LL4 LL4 AA3 AA3] [VV3 VV3 UU3 UU3]
+            // ->
+            // c0123 = [LL4 LL4 AA3 AA3] [LL2 LL2 AA1 AA1] [VV3 VV3 UU3 UU3] [VV1 VV1 UU1 UU1]
+            auto c0123 = _mm_unpacklo_epi32(c01, c23);
+            auto c4567 = _mm_unpacklo_epi32(c45, c67);
+            auto c891011 = _mm_unpacklo_epi32(c89, c1011);
+            auto c12131415 = _mm_unpacklo_epi32(c1213, c1415);
+
+            // Interleave the low 64-bit elements from 2 registers into 1.
+            // c0123     = [LL4 LL4 AA3 AA3 LL2 LL2 AA1 AA1] [VV3 VV3 UU3 UU3 VV1 VV1 UU1 UU1]
+            // c4567     = [LL8 LL8 AA7 AA7 LL6 LL6 AA5 AA5] [VV7 VV7 UU7 UU7 VV5 VV5 UU5 UU5]
+            // ->
+            // chroma_lo = [VV7 VV7 UU7 UU7 VV5 VV5 UU5 UU5] [VV3 VV3 UU3 UU3 VV1 VV1 UU1 UU1]
+            auto chroma_lo = _mm_unpacklo_epi64(c0123, c4567);
+            auto chroma_hi = _mm_unpacklo_epi64(c891011, c12131415);
+
+            // Right-shift the 16-bit elements by 2, un-doing the left shift by 2 on read
+            // and bringing the range back to 8-bit.
+            chroma_lo = _mm_srli_epi16(chroma_lo, 2);
+            chroma_hi = _mm_srli_epi16(chroma_hi, 2);
+
+            // Pack with unsigned saturation the 16-bit elements from 2 registers into 8-bit elements in 1 register.
+            // chroma_lo = [ VV7  VV7] [ UU7  UU7] [ VV5  VV5] [ UU5  UU5] [ VV3  VV3] [ UU3  UU3] [VV1 VV1] [UU1 UU1]
+            // chroma_hi = [VV15 VV15] [UU15 UU15] [VV13 VV13] [UU13 UU13] [VV11 VV11] [UU11 UU11] [VV9 VV9] [UU9 UU9]
+            // ->
+            // chroma    = [VV15] [UU15] [VV13] [UU13] [VV11] [UU11] [VV9] [UU9] [VV7] [UU7] [VV5] [UU5] [VV3] [UU3] [VV1] [UU1]
+            auto chroma_bytes = _mm_packus_epi16(chroma_lo, chroma_hi);
+
+            // Store the 16 bytes of chroma.
+            _mm_storeu_si128((__m128i*)&chroma[x], chroma_bytes);
+        }
+
+        // clang-format on
+    }
+
+    Generic::WriteY8V8U8(luma + x, chroma ? chroma + x : nullptr, input + x, width - x);
+}
+
+template <bool SwapRB>
+void WriteRGBA(u8* output, const Pixel* input, u32 width) {
+    const u32 sse_aligned_width = Common::AlignDown(width, 16U);
+
+    u32 x = 0;
+    for (; x < sse_aligned_width; x += 16) {
+        // clang-format off
+        // Load the pixels, 16-bit channels, 8 bytes per pixel, e.g
+        // pixel01 = [AA AA BB BB GG GG RR RR AA AA BB BB GG GG RR RR
+        auto pixel01 = _mm_loadu_si128((const __m128i*)&input[x + 0]);
+        auto pixel23 = _mm_loadu_si128((const __m128i*)&input[x + 2]);
+        auto pixel45 = _mm_loadu_si128((const __m128i*)&input[x + 4]);
+        auto pixel67 = _mm_loadu_si128((const __m128i*)&input[x + 6]);
+        auto pixel89 = _mm_loadu_si128((const __m128i*)&input[x + 8]);
+        auto pixel1011 = _mm_loadu_si128((const __m128i*)&input[x + 10]);
+        auto pixel1213 = _mm_loadu_si128((const __m128i*)&input[x + 12]);
+        auto pixel1415 = _mm_loadu_si128((const __m128i*)&input[x + 14]);
+
+        // Right-shift the channels by 16 to un-do the left shit on read and bring the range
+        // back to 8-bit.
+        pixel01 = _mm_srli_epi16(pixel01, 2);
+        pixel23 = _mm_srli_epi16(pixel23, 2);
+        pixel45 = _mm_srli_epi16(pixel45, 2);
+        pixel67 = _mm_srli_epi16(pixel67, 2);
+        pixel89 = _mm_srli_epi16(pixel89, 2);
+        pixel1011 = _mm_srli_epi16(pixel1011, 2);
+        pixel1213 = _mm_srli_epi16(pixel1213, 2);
+        pixel1415 = _mm_srli_epi16(pixel1415, 2);
+
+        // Pack with unsigned saturation 16-bit channels from 2 registers into 8-bit channels in 1 register.
+        // pixel01    = [AA2 AA2] [BB2 BB2] [GG2 GG2] [RR2 RR2] [AA1 AA1] [BB1 BB1] [GG1 GG1] [RR1 RR1]
+        // pixel23    = [AA4 AA4] [BB4 BB4] [GG4 GG4] [RR4 RR4] [AA3 AA3] [BB3 BB3] [GG3 GG3] [RR3 RR3]
+        // ->
+        // pixels0_lo = [AA4] [BB4] [GG4] [RR4] [AA3] [BB3] [GG3] [RR3] [AA2] [BB2] [GG2] [RR2] [AA1] [BB1] [GG1] [RR1]
+        auto pixels0_lo = _mm_packus_epi16(pixel01, pixel23);
+        auto pixels0_hi = _mm_packus_epi16(pixel45, pixel67);
+        auto pixels1_lo = _mm_packus_epi16(pixel89, pixel1011);
+        auto pixels1_hi = _mm_packus_epi16(pixel1213, pixel1415);
+
+        if constexpr (SwapRB) {
+            const auto shuffle =
+                _mm_set_epi8(15, 12, 13, 14, 11, 8, 9, 10, 7, 4, 5, 6, 3, 0, 1, 2);
+
+            // Our pixels are ABGR (big-endian) by default, if ARGB is needed, we need to shuffle.
+            // pixels0_lo = [AA4 BB4 GG4 RR4] [AA3 BB3 GG3 RR3] [AA2 BB2 GG2 RR2] [AA1 BB1 GG1 RR1]
+            // ->
+            // pixels0_lo = [AA4 RR4 GG4 BB4] [AA3 RR3 GG3 BB3] [AA2 RR2 GG2 BB2] [AA1 RR1 GG1 BB1]
+            pixels0_lo = _mm_shuffle_epi8(pixels0_lo, shuffle);
+            pixels0_hi = _mm_shuffle_epi8(pixels0_hi, shuffle);
+            pixels1_lo = _mm_shuffle_epi8(pixels1_lo, shuffle);
+            pixels1_hi = _mm_shuffle_epi8(pixels1_hi, shuffle);
+        }
+
+        // Store the pixels
+        _mm_storeu_si128((__m128i*)&output[x * 4 + 0], pixels0_lo);
+        _mm_storeu_si128((__m128i*)&output[x * 4 + 16], pixels0_hi);
+        _mm_storeu_si128((__m128i*)&output[x * 4 + 32], pixels1_lo);
+        _mm_storeu_si128((__m128i*)&output[x * 4 + 48], pixels1_hi);
+
+        // clang-format on
+    }
+
+    if constexpr (SwapRB) {
+        Generic::WriteARGB(output + x * 4, input + x, width - x);
+    } else {
+        Generic::WriteABGR(output + x * 4, input + x, width - x);
+    }
+}
+
+void WriteABGR(u8* output, const Pixel* input, u32 width) {
+    WriteRGBA<false>(output, input, width);
+}
+
+void WriteARGB(u8* output, const Pixel* input, u32 width) {
+    WriteRGBA<true>(output, input, width);
+}
+} // namespace SSE
+#endif
+
+constexpr VicKernels GENERIC_KERNELS{
+    .read_semi_planar = &Generic::ReadSemiPlanar,
+    .read_planar = &Generic::ReadPlanar,
+    .color_matrix = &Generic::ColorMatrix,
+    .write_y8_v8u8 = &Generic::WriteY8V8U8,
+    .write_abgr = &Generic::WriteABGR,
+    .write_argb = &Generic::WriteARGB,
+};
+
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_arm64)
+constexpr VicKernels SSE_KERNELS{
+    .read_semi_planar = &SSE::ReadSemiPlanar,
+    .read_planar = &SSE::ReadPlanar,
+    .color_matrix = &SSE::ColorMatrix,
+    .write_y8_v8u8 = &SSE::WriteY8V8U8,
+    .write_abgr = &SSE::WriteABGR,
+    .write_argb = &SSE::WriteARGB,
+};
+#endif
+
+#if defined(ARCHITECTURE_x86_64)
+constexpr VicKernels AVX2_KERNELS{
+    .read_semi_planar = &AVX2::ReadSemiPlanar,
+    .read_planar = &AVX2::ReadPlanar,
+    .color_matrix = &AVX2::ColorMatrix,
+    .write_y8_v8u8 = &AVX2::WriteY8V8U8,
+    .write_abgr = &AVX2::WriteABGR,
+    .write_argb = &AVX2::WriteARGB,
+};
+#endif
+} // Anonymous namespace
+
+const VicKernels& GetVicKernels(VicKernelLevel level) {
+    switch (level) {
+    case VicKernelLevel::AVX2:
+#if defined(ARCHITECTURE_x86_64)
+        return AVX2_KERNELS;
+#endif
+        [[fallthrough]];
+    case VicKernelLevel::SSE:
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_arm64)
+        return SSE_KERNELS;
+#endif
+        [[fallthrough]];
+    case VicKernelLevel::Generic:
+        break;
+    }
+    return GENERIC_KERNELS;
+}
+
+VicKernelLevel GetHostVicKernelLevel() {
+#if defined(ARCHITECTURE_x86_64)
+    static const VicKernelLevel level = [] {
+        const auto& caps = Common::GetCPUCaps();
+        if (caps.avx2) {
+            return VicKernelLevel::AVX2;
+        }
+        return caps.sse4_1 ? VicKernelLevel::SSE : VicKernelLevel::Generic;
+    }();
+    return level;
+#elif defined(ARCHITECTURE_arm64)
+    return VicKernelLevel::SSE;
+#else
+    return VicKernelLevel::Generic;
+#endif
+}
+
+} // namespace Tegra::Host1x
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+
+#include "common/common_types.h"
+
+namespace Tegra::Host1x {
+
+/// Slot and output surface pixel, 10-bit channels stored in 16 bits
+struct Pixel {
+    u16 r;
+    u16 g;
+    u16 b;
+    u16 a;
+
+    bool operator==(const Pixel&) const = default;
+};
+
+/// Colour conversion applied to a slot, a 3x4 matrix of S12.8 values
+struct VicColorMatrix {
+    std::array<std::array<s32, 4>, 3> coefficients;
+    s32 shift;
+    u16 clamp_min;
+    u16 clamp_max;
+};
+
+/// Converts a line of 8-bit semi-planar YUV 4:2:0 (NV12) into 10-bit pixels
+using ReadSemiPlanarFn = void (*)(Pixel* output, const u8* luma, const u8* chroma, u32 width,
+                                  u16 alpha);
+
+/// Converts a line of 8-bit planar YUV 4:2:0 into 10-bit pixels
+using ReadPlanarFn = void (*)(Pixel* output, const u8* luma, const u8* chroma_u,
+                              const u8* chroma_v, u32 width, u16 alpha);
+
+/// Applies a colour matrix to a line of pixels, keeping their alpha
+using ColorMatrixFn = void (*)(Pixel* output, const Pixel* input, u32 width,
+                               const VicColorMatrix& matrix);
+
+/// Writes a line of pixels as Y8__V8U8_N420, chroma is only written when it is not null
+using WriteY8V8U8Fn = void (*)(u8* luma, u8* chroma, const Pixel* input, u32 width);
+
+/// Writes a line of pixels as 8-bit RGBA, A8B8G8R8 or A8R8G8B8 depending on the kernel
+using WriteRGBAFn = void (*)(u8* output, const Pixel* input, u32 width);
+
+struct VicKernels {
+    ReadSemiPlanarFn read_semi_planar;
+    ReadPlanarFn read_planar;
+    ColorMatrixFn color_matrix;
+    WriteY8V8U8Fn write_y8_v8u8;
+    WriteRGBAFn write_abgr;
+    WriteRGBAFn write_argb;
+};
+
+enum class VicKernelLevel {
+    Generic,
+    SSE,
+    AVX2,
+};
+
+/// Returns the VIC line kernels for the given instruction set level
+[[nodiscard]] const VicKernels& GetVicKernels(VicKernelLevel level);
+
+/// Returns the best VIC kernel level supported by the host CPU
+[[nodiscard]] VicKernelLevel GetHostVicKernelLevel();
+
+#if defined(ARCHITECTURE_x86_64)
+namespace AVX2 {
+void ReadSemiPlanar(Pixel* output, const u8* luma, const u8* chroma, u32 width, u16 alpha);
+void ReadPlanar(Pixel* output, const u8* luma, const u8* chroma_u, const u8* chroma_v, u32 width,
+                u16 alpha);
+void ColorMatrix(Pixel* output, const Pixel* input, u32 width, const VicColorMatrix& matrix);
+void WriteY8V8U8(u8* luma, u8* chroma, const Pixel* input, u32 width);
+void WriteABGR(u8* output, const Pixel* input, u32 width);
+void WriteARGB(u8* output, const Pixel* input, u32 width);
+} // namespace AVX2
+#endif
+
+} // namespace Tegra::Host1x
@@ -0,0 +1,255 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// This file is compiled with AVX2 enabled, it must only be called after checking the host CPU.
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+#include "common/alignment.h"
+#include "video_core/host1x/vic_kernels.h"
+
+namespace Tegra::Host1x::AVX2 {
+
+namespace {
+/// Tails shorter than a vector go through the generic kernels
+const VicKernels& GenericKernels() {
+    return GetVicKernels(VicKernelLevel::Generic);
+}
+
+template <bool Planar>
+void ReadYUV420(Pixel* output, const u8* luma, const u8* chroma_u, const u8* chroma_v, u32 width,
+                u16 alpha_value) {
+    const auto alpha = _mm256_set1_epi32(static_cast<s32>(alpha_value) << 16);
+    const auto zero = _mm256_setzero_si256();
+    const u32 avx_aligned_width = Common::AlignDown(width, 16U);
+
+    u32 x = 0;
+    for (; x < avx_aligned_width; x += 16) {
+        // clang-format off
+        // Widen 16 luma samples to 16-bit and bring them to 10-bit, pixels 0-7 end up in the low
+        // lane and pixels 8-15 in the high lane.
+        // luma = [LL15 .. LL8] [LL7 .. LL0]
+        const auto luma8 = _mm_loadu_si128((const __m128i*)&luma[x]);
+        const auto luma16 = _mm256_slli_epi16(_mm256_cvtepu8_epi16(luma8), 2);
+
+        __m128i chroma8;
+        if constexpr (Planar) {
+            const auto u8 = _mm_loadl_epi64((const __m128i*)&chroma_u[x / 2]);
+            const auto v8 = _mm_loadl_epi64((const __m128i*)&chroma_v[x / 2]);
+            chroma8 = _mm_unpacklo_epi8(u8, v8);
+        } else {
+            chroma8 = _mm_loadu_si128((const __m128i*)&chroma_u[x]);
+        }
+
+        // Widen the 8 chroma pairs the same way, each 32-bit element now holds one pair, which
+        // matches the lane split of the luma.
+        // chroma = [VV7 UU7] .. [VV4 UU4] | [VV3 UU3] .. [VV0 UU0]
+        const auto chroma16 = _mm256_slli_epi16(_mm256_cvtepu8_epi16(chroma8), 2);
+
+        // Duplicate the chroma pairs horizontally, as chroma is half the width of luma.
+        // chroma_lo = [VV5 UU5] [VV5 UU5] [VV4 UU4] [VV4 UU4] | [VV1 UU1] [VV1 UU1] [VV0 UU0] [VV0 UU0]
+        // chroma_hi = [VV7 UU7] [VV7 UU7] [VV6 UU6] [VV6 UU6] | [VV3 UU3] [VV3 UU3] [VV2 UU2] [VV2 UU2]
+        const auto chroma_lo = _mm256_unpacklo_epi32(chroma16, chroma16);
+        const auto chroma_hi = _mm256_unpackhi_epi32(chroma16, chroma16);
+
+        // Widen luma to 32-bit, matching the duplicated chroma.
+        // luma_lo = [000 LL11] .. [000 LL8] | [000 LL3] .. [000 LL0]
+        // luma_hi = [000 LL15] .. [000 LL12] | [000 LL7] .. [000 LL4]
+        const auto luma_lo = _mm256_unpacklo_epi16(luma16, zero);
+        const auto luma_hi = _mm256_unpackhi_epi16(luma16, zero);
+
+        // Build the low and high halves of every pixel.
+        // rg = [UU LL], ba = [AA VV]
+        const auto rg_lo = _mm256_or_si256(luma_lo, _mm256_slli_epi32(chroma_lo, 16));
+        const auto rg_hi = _mm256_or_si256(luma_hi, _mm256_slli_epi32(chroma_hi, 16));
+        const auto ba_lo = _mm256_or_si256(_mm256_srli_epi32(chroma_lo, 16), alpha);
+        const auto ba_hi = _mm256_or_si256(_mm256_srli_epi32(chroma_hi, 16), alpha);
+
+        // Interleave the halves into pixels.
+        // pixels01_89   = [AA9 VV9 UU9 LL9] [AA8 VV8 UU8 LL8] | [AA1 VV1 UU1 LL1] [AA0 VV0 UU0 LL0]
+        // pixels23_1011 = [AA11 .. LL11] [AA10 .. LL10] | [AA3 .. LL3] [AA2 .. LL2]
+        const auto pixels01_89 = _mm256_unpacklo_epi32(rg_lo, ba_lo);
+        const auto pixels23_1011 = _mm256_unpackhi_epi32(rg_lo, ba_lo);
+        const auto pixels45_1213 = _mm256_unpacklo_epi32(rg_hi, ba_hi);
+        const auto pixels67_1415 = _mm256_unpackhi_epi32(rg_hi, ba_hi);
+
+        // Put the lanes back in pixel order and store 4 pixels per register.
+        _mm256_storeu_si256((__m256i*)&output[x + 0],
+                            _mm256_permute2x128_si256(pixels01_89, pixels23_1011, 0x20));
+        _mm256_storeu_si256((__m256i*)&output[x + 4],
+                            _mm256_permute2x128_si256(pixels45_1213, pixels67_1415, 0x20));
+        _mm256_storeu_si256((__m256i*)&output[x + 8],
+                            _mm256_permute2x128_si256(pixels01_89, pixels23_1011, 0x31));
+        _mm256_storeu_si256((__m256i*)&output[x + 12],
+                            _mm256_permute2x128_si256(pixels45_1213, pixels67_1415, 0x31));
+        // clang-format on
+    }
+
+    if constexpr (Planar) {
+        GenericKernels().read_planar(output + x, luma + x, chroma_u + x / 2, chroma_v + x / 2,
+                                     width - x, alpha_value);
+    } else {
+        GenericKernels().read_semi_planar(output + x, luma + x, chroma_u + x, width - x,
+                                          alpha_value);
+    }
+}
+
+template <bool SwapRB>
+void WriteRGBA(u8* output, const Pixel* input, u32 width) {
+    // Swaps the R and B bytes of every pixel, same pattern in both lanes
+    const auto shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2,
+                                          1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    const u32 avx_aligned_width = Common::AlignDown(width, 16U);
+
+    u32 x = 0;
+    for (; x < avx_aligned_width; x += 16) {
+        auto pixels0 = _mm256_loadu_si256((const __m256i*)&input[x + 0]);
+        auto pixels1 = _mm256_loadu_si256((const __m256i*)&input[x + 4]);
+        auto pixels2 = _mm256_loadu_si256((const __m256i*)&input[x + 8]);
+        auto pixels3 = _mm256_loadu_si256((const __m256i*)&input[x + 12]);
+
+        // Bring the channels back to 8-bit.
+        pixels0 = _mm256_srli_epi16(pixels0, 2);
+        pixels1 = _mm256_srli_epi16(pixels1, 2);
+        pixels2 = _mm256_srli_epi16(pixels2, 2);
+        pixels3 = _mm256_srli_epi16(pixels3, 2);
+
+        // Packing works per lane, which leaves the pixel pairs as [67 23 45 01], permute them
+        // back into order.
+        auto out_lo = _mm256_permute4x64_epi64(_mm256_packus_epi16(pixels0, pixels1), 0xD8);
+        auto out_hi = _mm256_permute4x64_epi64(_mm256_packus_epi16(pixels2, pixels3), 0xD8);
+
+        if constexpr (SwapRB) {
+            out_lo = _mm256_shuffle_epi8(out_lo, shuffle);
+            out_hi = _mm256_shuffle_epi8(out_hi, shuffle);
+        }
+
+        _mm256_storeu_si256((__m256i*)&output[x * 4 + 0], out_lo);
+        _mm256_storeu_si256((__m256i*)&output[x * 4 + 32], out_hi);
+    }
+
+    if constexpr (SwapRB) {
+        GenericKernels().write_argb(output + x * 4, input + x, width - x);
+    } else {
+        GenericKernels().write_abgr(output + x * 4, input + x, width - x);
+    }
+}
+} // Anonymous namespace
+
+void ReadSemiPlanar(Pixel* output, const u8* luma, const u8* chroma, u32 width, u16 alpha) {
+    ReadYUV420<false>(output, luma, chroma, nullptr, width, alpha);
+}
+
+void ReadPlanar(Pixel* output, const u8* luma, const u8* chroma_u, const u8* chroma_v, u32 width,
+                u16 alpha) {
+    ReadYUV420<true>(output, luma, chroma_u, chroma_v, width, alpha);
+}
+
+void ColorMatrix(Pixel* output, const Pixel* input, u32 width, const VicColorMatrix& matrix) {
+    const auto& m = matrix.coefficients;
+
+    // Same columns as the SSE kernel, repeated in both lanes so each lane converts one pixel.
+    const auto c0 = _mm256_setr_epi32(m[0][0], m[1][0], m[2][0], 0, m[0][0], m[1][0], m[2][0], 0);
+    const auto c1 = _mm256_setr_epi32(m[0][1], m[1][1], m[2][1], 0, m[0][1], m[1][1], m[2][1], 0);
+    const auto c2 = _mm256_setr_epi32(m[0][2], m[1][2], m[2][2], 0, m[0][2], m[1][2], m[2][2], 0);
+    const auto c3 = _mm256_setr_epi32(m[0][3], m[1][3], m[2][3], 0, m[0][3], m[1][3], m[2][3], 0);
+    const auto shift = _mm_cvtsi32_si128(matrix.shift);
+    const auto clamp_min = _mm256_set1_epi16(static_cast<s16>(matrix.clamp_min));
+    const auto clamp_max = _mm256_set1_epi16(static_cast<s16>(matrix.clamp_max));
+
+    const auto MatMul = [&](__m128i pixels) {
+        // [001 AA1] [001 BB1] [001 GG1] [001 RR1] | [000 AA0] [000 BB0] [000 GG0] [000 RR0]
+        const auto p = _mm256_cvtepu16_epi32(pixels);
+        const auto r = _mm256_mullo_epi32(_mm256_shuffle_epi32(p, 0x00), c0);
+        const auto g = _mm256_mullo_epi32(_mm256_shuffle_epi32(p, 0x55), c1);
+        const auto b = _mm256_mullo_epi32(_mm256_shuffle_epi32(p, 0xAA), c2);
+        auto out = _mm256_sra_epi32(_mm256_add_epi32(_mm256_add_epi32(r, g), b), shift);
+        out = _mm256_add_epi32(out, c3);
+        return _mm256_srai_epi32(out, 8);
+    };
+
+    const auto Convert = [&](const __m256i& pixels) {
+        // Packing works per lane, which leaves the pixels as [3 1 2 0], permute them back.
+        const auto out0 = MatMul(_mm256_castsi256_si128(pixels));
+        const auto out1 = MatMul(_mm256_extracti128_si256(pixels, 1));
+        auto done = _mm256_permute4x64_epi64(_mm256_packus_epi32(out0, out1), 0xD8);
+
+        // Take the alpha back from the source pixels and apply the soft clamp.
+        done = _mm256_blend_epi16(done, pixels, 0x88);
+        done = _mm256_max_epu16(done, clamp_min);
+        return _mm256_min_epu16(done, clamp_max);
+    };
+
+    const u32 avx_aligned_width = Common::AlignDown(width, 8U);
+
+    u32 x = 0;
+    for (; x < avx_aligned_width; x += 8) {
+        const auto pixels0 = _mm256_loadu_si256((const __m256i*)&input[x + 0]);
+        const auto pixels1 = _mm256_loadu_si256((const __m256i*)&input[x + 4]);
+        _mm256_storeu_si256((__m256i*)&output[x + 0], Convert(pixels0));
+        _mm256_storeu_si256((__m256i*)&output[x + 4], Convert(pixels1));
+    }
+
+    GenericKernels().color_matrix(output + x, input + x, width - x, matrix);
+}
+
+void WriteY8V8U8(u8* luma, u8* chroma, const Pixel* input, u32 width) {
+    const auto luma_mask = _mm256_set1_epi64x(0xFFFF);
+    const auto zero = _mm256_setzero_si256();
+    // The packs below leave the samples, or chroma pairs, in the order
+    // [15 14 11 10 7 6 3 2 13 12 9 8 5 4 1 0], this puts them back in order.
+    const auto order = _mm_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+    const u32 avx_aligned_width = Common::AlignDown(width, 16U);
+
+    u32 x = 0;
+    for (; x < avx_aligned_width; x += 16) {
+        const auto pixels0 = _mm256_loadu_si256((const __m256i*)&input[x + 0]);
+        const auto pixels1 = _mm256_loadu_si256((const __m256i*)&input[x + 4]);
+        const auto pixels2 = _mm256_loadu_si256((const __m256i*)&input[x + 8]);
+        const auto pixels3 = _mm256_loadu_si256((const __m256i*)&input[x + 12]);
+
+        // Keep the luma of every pixel and pack it down to 8-bit.
+        const auto luma01 = _mm256_packus_epi32(_mm256_and_si256(pixels0, luma_mask),
+                                                _mm256_and_si256(pixels1, luma_mask));
+        const auto luma23 = _mm256_packus_epi32(_mm256_and_si256(pixels2, luma_mask),
+                                                _mm256_and_si256(pixels3, luma_mask));
+        const auto luma16 = _mm256_srli_epi16(_mm256_packus_epi32(luma01, luma23), 2);
+        const auto luma8 =
+            _mm256_permute4x64_epi64(_mm256_packus_epi16(luma16, zero), 0xD8);
+        _mm_storeu_si128((__m128i*)&luma[x],
+                         _mm_shuffle_epi8(_mm256_castsi256_si128(luma8), order));
+
+        if (chroma) {
+            // Shift out the luma so the chroma pair of the first pixel of each lane sits in the
+            // low 32-bits, the odd pixels are skipped as chroma is half the width of luma.
+            const auto chroma0 = _mm256_srli_si256(pixels0, 2);
+            const auto chroma1 = _mm256_srli_si256(pixels1, 2);
+            const auto chroma2 = _mm256_srli_si256(pixels2, 2);
+            const auto chroma3 = _mm256_srli_si256(pixels3, 2);
+
+            const auto chroma01 = _mm256_unpacklo_epi32(chroma0, chroma1);
+            const auto chroma23 = _mm256_unpacklo_epi32(chroma2, chroma3);
+            const auto chroma16 = _mm256_srli_epi16(_mm256_unpacklo_epi64(chroma01, chroma23), 2);
+            const auto chroma8 =
+                _mm256_permute4x64_epi64(_mm256_packus_epi16(chroma16, zero), 0xD8);
+            _mm_storeu_si128((__m128i*)&chroma[x],
+                             _mm_shuffle_epi8(_mm256_castsi256_si128(chroma8), order));
+        }
+    }
+
+    GenericKernels().write_y8_v8u8(luma + x, chroma ? chroma + x : nullptr, input + x, width - x);
+}
+
+void WriteABGR(u8* output, const Pixel* input, u32 width) {
+    WriteRGBA<false>(output, input, width);
+}
+
+void WriteARGB(u8* output, const Pixel* input, u32 width) {
+    WriteRGBA<true>(output, input, width);
+}
+
+} // namespace Tegra::Host1x::AVX2
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <boost/container/small_vector.hpp>
+
+#include "common/common_types.h"
+#include "core/device_memory_manager.h"
+
+namespace Tegra {
+
+using HostSpanList = boost::container::small_vector<std::span<u8>, 1>;
+
+/**
+ * Collects the host memory spans backing consecutive device memory ranges, merging ranges that
+ * are adjacent in host memory. Collection fails when a range is not backed by host memory or
+ * when it would need more than the given number of spans.
+ *
+ * The append functions return true when collection has to stop, like the callbacks of a page
+ * table walk do.
+ */
+template <typename DeviceMemory>
+class HostSpanCollector {
+public:
+    explicit HostSpanCollector(DeviceMemory& memory_, HostSpanList& spans_, size_t max_spans_)
+        : memory{memory_}, spans{spans_}, max_spans{max_spans_} {}
+
+    /// Appends a device range whose pages are known to be adjacent in host memory
+    bool AppendContinuous(DAddr dev_addr, size_t size) {
+        return Append(memory.template GetPointer<u8>(dev_addr), size);
+    }
+
+    /// Appends a device range, translating each of its pages as they may be anywhere in host
+    /// memory
+    bool AppendPages(DAddr dev_addr, size_t size) {
+        while (size > 0) {
+            const size_t page_left =
+                Core::DEVICE_PAGESIZE - static_cast<size_t>(dev_addr & Core::DEVICE_PAGEMASK);
+            const size_t amount = std::min(size, page_left);
+            if (Append(memory.template GetPointer<u8>(dev_addr), amount)) {
+                return true;
+            }
+            dev_addr += amount;
+            size -= amount;
+        }
+        return false;
+    }
+
+    /// Fails collection, for ranges that are not mapped
+    bool Fail() {
+        is_valid = false;
+        return true;
+    }
+
+    /// Returns true when every appended range is backed by host memory within the span limit
+    [[nodiscard]] bool IsValid() const {
+        return is_valid;
+    }
+
+private:
+    bool Append(u8* host_ptr, size_t size) {
+        if (host_ptr == nullptr) [[unlikely]] {
+            return Fail();
+        }
+        if (!spans.empty() && spans.back().data() + spans.back().size() == host_ptr) {
+            spans.back() = std::span<u8>(spans.back().data(), spans.back().size() + size);
+            return false;
+        }
+        if (spans.size() == max_spans) {
+            return Fail();
+        }
+        spans.emplace_back(host_ptr, size);
+        return false;
+    }
+
+    DeviceMemory& memory;
+    HostSpanList& spans;
+    size_t max_spans;
+    bool is_valid{true};
+};
+
+} // namespace Tegra
@@ -229,16 +229,35 @@ std::optional<DAddr> MemoryManager::GpuToCpuAddress(GPUVAddr gpu_addr) const {
 }
 
 std::optional<DAddr> MemoryManager::GpuToCpuAddress(GPUVAddr addr, std::size_t size) const {
-    size_t page_index{addr >> page_bits};
-    const size_t page_last{(addr + size + page_size - 1) >> page_bits};
-    while (page_index < page_last) {
-        const auto page_addr{GpuToCpuAddress(page_index << page_bits)};
-        if (page_addr) {
-            return page_addr;
-        }
-        ++page_index;
+    // Returns the start of the first mapped page, walk whole pages so unmapped big pages are
+    // skipped at once instead of translating each of their pages
+    const GPUVAddr start = addr & ~page_mask;
+    const GPUVAddr end = std::min<GPUVAddr>(Common::AlignUp(addr + size, page_size),
+                                            address_space_size);
+    if (start >= end) {
+        return std::nullopt;
     }
-    return std::nullopt;
+    std::optional<DAddr> result{};
+    auto skip = [&]([[maybe_unused]] std::size_t page_index, [[maybe_unused]] std::size_t offset,
+                    [[maybe_unused]] std::size_t copy_amount) { return false; };
+    auto mapped_normal = [&](std::size_t page_index, std::size_t offset,
+                             [[maybe_unused]] std::size_t copy_amount) {
+        result = (static_cast<DAddr>(page_table[page_index]) << cpu_page_bits) + offset;
+        return true;
+    };
+    auto mapped_big = [&](std::size_t page_index, std::size_t offset,
+                          [[maybe_unused]] std::size_t copy_amount) {
+        result = (static_cast<DAddr>(big_page_table_dev[page_index]) << cpu_page_bits) + offset;
+        return true;
+    };
+    auto check_short_pages = [&](std::size_t page_index, std::size_t offset,
+                                 std::size_t copy_amount) {
+        GPUVAddr base = (page_index << big_page_bits) + offset;
+        MemoryOperation<false>(base, copy_amount, mapped_normal, skip, skip);
+        return result.has_value();
+    };
+    MemoryOperation<true>(start, end - start, mapped_big, skip, check_short_pages);
+    return result;
 }
 
 template <typename T>
@@ -762,26 +781,50 @@ void MemoryManager::FlushCaching() {
     accumulator->Clear();
 }
 
+bool MemoryManager::GetHostSpans(GPUVAddr gpu_addr, std::size_t size, HostSpanList& spans,
+                                 std::size_t max_spans) const {
+    HostSpanCollector collector(memory, spans, max_spans);
+    auto fail = [&]([[maybe_unused]] std::size_t page_index, [[maybe_unused]] std::size_t offset,
+                    [[maybe_unused]] std::size_t copy_amount) { return collector.Fail(); };
+    auto mapped_normal = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
+        const DAddr dev_addr_base =
+            (static_cast<DAddr>(page_table[page_index]) << cpu_page_bits) + offset;
+        return collector.AppendPages(dev_addr_base, copy_amount);
+    };
+    auto mapped_big = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
+        const DAddr dev_addr_base =
+            (static_cast<DAddr>(big_page_table_dev[page_index]) << cpu_page_bits) + offset;
+        if (IsBigPageContinuous(page_index)) [[likely]] {
+            return collector.AppendContinuous(dev_addr_base, copy_amount);
+        }
+        return collector.AppendPages(dev_addr_base, copy_amount);
+    };
+    auto check_short_pages = [&](std::size_t page_index, std::size_t offset,
+                                 std::size_t copy_amount) {
+        GPUVAddr base = (page_index << big_page_bits) + offset;
+        MemoryOperation<false>(base, copy_amount, mapped_normal, fail, fail);
+        return !collector.IsValid();
+    };
+    MemoryOperation<true>(gpu_addr, size, mapped_big, fail, check_short_pages);
+    return collector.IsValid();
+}
+
 const u8* MemoryManager::GetSpan(const GPUVAddr src_addr, const std::size_t size) const {
-    if (!IsContinuousRange(src_addr, size)) {
+    // An empty range still resolves to the address it starts at
+    HostSpanList spans;
+    if (!GetHostSpans(src_addr, std::max<std::size_t>(size, 1), spans, 1) || spans.empty()) {
         return nullptr;
     }
-    auto dev_addr = GpuToCpuAddress(src_addr);
-    if (dev_addr) {
-        return memory.GetSpan(*dev_addr, size);
-    }
-    return nullptr;
+    return spans.front().data();
 }
 
 u8* MemoryManager::GetSpan(const GPUVAddr src_addr, const std::size_t size) {
-    if (!IsContinuousRange(src_addr, size)) {
+    // An empty range still resolves to the address it starts at
+    HostSpanList spans;
+    if (!GetHostSpans(src_addr, std::max<std::size_t>(size, 1), spans, 1) || spans.empty()) {
         return nullptr;
     }
-    auto dev_addr = GpuToCpuAddress(src_addr);
-    if (dev_addr) {
-        return memory.GetSpan(*dev_addr, size);
-    }
-    return nullptr;
+    return spans.front().data();
 }
 
 } // namespace Tegra
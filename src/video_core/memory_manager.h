@@ -7,6 +7,7 @@
 #include <map>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <vector>
 #include <boost/container/small_vector.hpp>
 
@@ -17,6 +18,7 @@
 #include "common/virtual_buffer.h"
 #include "video_core/cache_types.h"
 #include "video_core/host1x/gpu_device_memory_manager.h"
+#include "video_core/host_span_collector.h"
 #include "video_core/pte_kind.h"
 
 namespace VideoCore {
@@ -184,6 +186,14 @@ private:
     inline bool IsBigPageContinuous(size_t big_page_index) const;
     inline void SetBigPageContinuous(size_t big_page_index, bool value);
 
+    /**
+     * Translates a gpu region into the host memory spans backing it in a single page walk,
+     * merging pages that are adjacent in host memory. Returns false if any part of the region is
+     * not mapped or if it needs more than max_spans spans.
+     */
+    bool GetHostSpans(GPUVAddr gpu_addr, std::size_t size, HostSpanList& spans,
+                      std::size_t max_spans) const;
+
     template <bool is_gpu_address>
     void GetSubmappedRangeImpl(
         GPUVAddr gpu_addr, std::size_t size,
@@ -51,7 +51,7 @@ using VideoCommon::LoadPipelines;
 using VideoCommon::SerializePipeline;
 using Context = ShaderContext::Context;
 
-constexpr u32 CACHE_VERSION = 10;
+constexpr u32 CACHE_VERSION = VideoCommon::OPENGL_PIPELINE_CACHE_VERSION;
 
 template <typename Container>
 auto MakeSpan(Container& container) {
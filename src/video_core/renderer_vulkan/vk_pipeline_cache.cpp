@@ -36,6 +36,7 @@
 #include "video_core/shader_cache.h"
 #include "video_core/shader_environment.h"
 #include "video_core/shader_notify.h"
+#include "video_core/shader_translation_store.h"
 #include "video_core/vulkan_common/vulkan_device.h"
 #include "video_core/vulkan_common/vulkan_wrapper.h"
 
@@ -53,7 +54,7 @@ using VideoCommon::FileEnvironment;
 using VideoCommon::GenericEnvironment;
 using VideoCommon::GraphicsEnvironment;
 
-constexpr u32 CACHE_VERSION = 11;
+constexpr u32 CACHE_VERSION = VideoCommon::VULKAN_PIPELINE_CACHE_VERSION;
 constexpr std::array<char, 8> VULKAN_CACHE_MAGIC_NUMBER{'y', 'u', 'z', 'u', 'v', 'k', 'c', 'h'};
 
 template <typename Container>
@@ -61,6 +62,23 @@ auto MakeSpan(Container& container) {
     return std::span(container.data(), container.size());
 }
 
+/// Hashes the used bytes of a pipeline key for the shader translation store
+u128 TranslationStoreKey(const u128& seed, const void* key, size_t key_size) {
+    return Common::CityHash128WithSeed(static_cast<const char*>(key), key_size, seed);
+}
+
+/// Hashes what translation depends on besides the pipeline key and the environments
+u128 MakeTranslationSeed(const Device& device) {
+    const auto& resolution{Settings::values.resolution_info};
+    std::string seed{device.GetModelName()};
+    seed += fmt::format(":{:x}:{:x}:{:x}:{}:{}:{}:{}:{}", device.GetDriverVersion(),
+                        static_cast<u32>(device.GetDriverID()), device.ApiVersion(),
+                        resolution.active, resolution.up_scale, resolution.down_shift,
+                        Settings::values.renderer_debug.GetValue(),
+                        Settings::values.disable_shader_loop_safety_checks.GetValue());
+    return Common::CityHash128(seed.data(), seed.size());
+}
+
 Shader::OutputTopology MaxwellToOutputTopology(Maxwell::PrimitiveTopology topology) {
     switch (topology) {
     case Maxwell::PrimitiveTopology::Points:
@@ -471,6 +489,8 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
         return;
     }
     pipeline_cache_filename = base_dir / "vulkan.bin";
+    translation_seed = MakeTranslationSeed(device);
+    translation_store.Open(shader_dir / VideoCommon::VULKAN_TRANSLATION_STORE_NAME, title_id);
 
     if (use_vulkan_pipeline_cache) {
         vulkan_pipeline_cache_filename = base_dir / "vulkan_pipelines.bin";
@@ -610,6 +630,63 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
     bool build_in_parallel) try {
     auto hash = key.Hash();
     LOG_INFO(Render_Vulkan, "0x{:016x}", hash);
+    const bool use_translation_store{translation_store.IsOpen() && !Settings::values.dump_shaders};
+    const u128 store_key{TranslationStoreKey(translation_seed, &key, key.Size())};
+    std::vector<VideoCommon::TranslatedShader> shaders;
+    if (!use_translation_store || !translation_store.Find(store_key, envs, shaders)) {
+        boost::container::static_vector<VideoCommon::RecordingEnvironment,
+                                        Maxwell::MaxShaderProgram>
+            recordings;
+        for (Shader::Environment* const env : envs) {
+            recordings.emplace_back(*env);
+        }
+        TranslateGraphicsPipeline(pools, key, recordings, shaders);
+        if (use_translation_store) {
+            translation_store.Insert(store_key, recordings, shaders);
+        }
+    }
+    std::array<const Shader::Info*, Maxwell::MaxShaderStage> infos{};
+    std::array<vk::ShaderModule, Maxwell::MaxShaderStage> modules;
+    for (const VideoCommon::TranslatedShader& shader : shaders) {
+        const size_t stage_index{shader.stage_index};
+        infos[stage_index] = &shader.info;
+        device.SaveShader(shader.code);
+        modules[stage_index] = BuildShader(device, shader.code);
+        if (device.HasDebuggingToolAttached()) {
+            const u64 shader_hash{key.unique_hashes[stage_index + 1]};
+            const std::string name{fmt::format("Shader {:016x}", shader_hash)};
+            modules[stage_index].SetObjectNameEXT(name.c_str());
+        }
+    }
+    Common::ThreadWorker* const thread_worker{build_in_parallel ? &workers : nullptr};
+    return std::make_unique<GraphicsPipeline>(
+        scheduler, buffer_cache, texture_cache, vulkan_pipeline_cache, &shader_notify, device,
+        descriptor_pool, guest_descriptor_queue, thread_worker, statistics, render_pass_cache, key,
+        std::move(modules), infos);
+
+} catch (const Shader::Exception& exception) {
+    auto hash = key.Hash();
+    size_t env_index{0};
+    for (size_t index = 0; index < Maxwell::MaxShaderProgram; ++index) {
+        if (key.unique_hashes[index] == 0) {
+            continue;
+        }
+        Shader::Environment& env{*envs[env_index]};
+        ++env_index;
+
+        const u32 cfg_offset{static_cast<u32>(env.StartAddress() + sizeof(Shader::ProgramHeader))};
+        Shader::Maxwell::Flow::CFG cfg(env, pools.flow_block, cfg_offset, index == 0);
+        env.Dump(hash, key.unique_hashes[index]);
+    }
+    LOG_ERROR(Render_Vulkan, "{}", exception.what());
+    return nullptr;
+}
+
+void PipelineCache::TranslateGraphicsPipeline(ShaderPools& pools,
+                                              const GraphicsPipelineCacheKey& key,
+                                              std::span<VideoCommon::RecordingEnvironment> envs,
+                                              std::vector<VideoCommon::TranslatedShader>& shaders) {
+    const u64 hash{key.Hash()};
     size_t env_index{0};
     std::array<Shader::IR::Program, Maxwell::MaxShaderProgram> programs;
     const bool uses_vertex_a{key.unique_hashes[0] != 0};
@@ -630,7 +707,7 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
         if (key.unique_hashes[index] == 0) {
             continue;
         }
-        Shader::Environment& env{*envs[env_index]};
+        Shader::Environment& env{envs[env_index]};
         ++env_index;
 
         const u32 cfg_offset{static_cast<u32>(env.StartAddress() + sizeof(Shader::ProgramHeader))};
@@ -653,9 +730,6 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
             layer_source_program = &programs[index];
         }
     }
-    std::array<const Shader::Info*, Maxwell::MaxShaderStage> infos{};
-    std::array<vk::ShaderModule, Maxwell::MaxShaderStage> modules;
-
     const Shader::IR::Program* previous_stage{};
     Shader::Backend::Bindings binding;
     for (size_t index = uses_vertex_a && uses_vertex_b ? 1 : 0; index < Maxwell::MaxShaderProgram;
@@ -668,42 +742,16 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
         UNIMPLEMENTED_IF(index == 0);
 
         Shader::IR::Program& program{programs[index]};
-        const size_t stage_index{index - 1};
-        infos[stage_index] = &program.info;
-
         const auto runtime_info{MakeRuntimeInfo(programs, key, program, previous_stage)};
         ConvertLegacyToGeneric(program, runtime_info);
-        const std::vector<u32> code{EmitSPIRV(profile, runtime_info, program, binding)};
-        device.SaveShader(code);
-        modules[stage_index] = BuildShader(device, code);
-        if (device.HasDebuggingToolAttached()) {
-            const std::string name{fmt::format("Shader {:016x}", key.unique_hashes[index])};
-            modules[stage_index].SetObjectNameEXT(name.c_str());
-        }
+        std::vector<u32> code{EmitSPIRV(profile, runtime_info, program, binding)};
+        shaders.push_back({
+            .stage_index = static_cast<u32>(index - 1),
+            .info = program.info,
+            .code = std::move(code),
+        });
         previous_stage = &program;
     }
-    Common::ThreadWorker* const thread_worker{build_in_parallel ? &workers : nullptr};
-    return std::make_unique<GraphicsPipeline>(
-        scheduler, buffer_cache, texture_cache, vulkan_pipeline_cache, &shader_notify, device,
-        descriptor_pool, guest_descriptor_queue, thread_worker, statistics, render_pass_cache, key,
-        std::move(modules), infos);
-
-} catch (const Shader::Exception& exception) {
-    auto hash = key.Hash();
-    size_t env_index{0};
-    for (size_t index = 0; index < Maxwell::MaxShaderProgram; ++index) {
-        if (key.unique_hashes[index] == 0) {
-            continue;
-        }
-        Shader::Environment& env{*envs[env_index]};
-        ++env_index;
-
-        const u32 cfg_offset{static_cast<u32>(env.StartAddress() + sizeof(Shader::ProgramHeader))};
-        Shader::Maxwell::Flow::CFG cfg(env, pools.flow_block, cfg_offset, index == 0);
-        env.Dump(hash, key.unique_hashes[index]);
-    }
-    LOG_ERROR(Render_Vulkan, "{}", exception.what());
-    return nullptr;
 }
 
 std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline() {
@@ -759,17 +807,34 @@ std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
 
     LOG_INFO(Render_Vulkan, "0x{:016x}", hash);
 
-    Shader::Maxwell::Flow::CFG cfg{env, pools.flow_block, env.StartAddress()};
+    const bool use_translation_store{translation_store.IsOpen() && !Settings::values.dump_shaders};
+    const u128 store_key{TranslationStoreKey(translation_seed, &key, sizeof(key))};
+    std::vector<VideoCommon::TranslatedShader> shaders;
+    Shader::Environment* const env_ptr{&env};
+    if (!use_translation_store ||
+        !translation_store.Find(store_key, std::span(&env_ptr, 1), shaders)) {
+        VideoCommon::RecordingEnvironment recording{env};
+        Shader::Maxwell::Flow::CFG cfg{recording, pools.flow_block, recording.StartAddress()};
 
-    // Dump it before error.
-    if (Settings::values.dump_shaders) {
-        env.Dump(hash, key.unique_hash);
-    }
+        // Dump it before error.
+        if (Settings::values.dump_shaders) {
+            env.Dump(hash, key.unique_hash);
+        }
 
-    auto program{TranslateProgram(pools.inst, pools.block, env, cfg, host_info)};
-    const std::vector<u32> code{EmitSPIRV(profile, program)};
-    device.SaveShader(code);
-    vk::ShaderModule spv_module{BuildShader(device, code)};
+        auto program{TranslateProgram(pools.inst, pools.block, recording, cfg, host_info)};
+        std::vector<u32> code{EmitSPIRV(profile, program)};
+        shaders.push_back({
+            .stage_index = 0,
+            .info = program.info,
+            .code = std::move(code),
+        });
+        if (use_translation_store) {
+            translation_store.Insert(store_key, std::span(&recording, 1), shaders);
+        }
+    }
+    const VideoCommon::TranslatedShader& shader{shaders.front()};
+    device.SaveShader(shader.code);
+    vk::ShaderModule spv_module{BuildShader(device, shader.code)};
     if (device.HasDebuggingToolAttached()) {
         const auto name{fmt::format("Shader {:016x}", key.unique_hash)};
         spv_module.SetObjectNameEXT(name.c_str());
@@ -777,7 +842,7 @@ std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
     Common::ThreadWorker* const thread_worker{build_in_parallel ? &workers : nullptr};
     return std::make_unique<ComputePipeline>(device, vulkan_pipeline_cache, descriptor_pool,
                                              guest_descriptor_queue, thread_worker, statistics,
-                                             &shader_notify, program.info, std::move(spv_module));
+                                             &shader_notify, shader.info, std::move(spv_module));
 
 } catch (const Shader::Exception& exception) {
     LOG_ERROR(Render_Vulkan, "{}", exception.what());
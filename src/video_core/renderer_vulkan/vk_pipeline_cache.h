@@ -27,6 +27,7 @@
 #include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
 #include "video_core/renderer_vulkan/vk_texture_cache.h"
 #include "video_core/shader_cache.h"
+#include "video_core/shader_translation_store.h"
 
 namespace Core {
 class System;
@@ -125,6 +126,11 @@ private:
         std::span<Shader::Environment* const> envs, PipelineStatistics* statistics,
         bool build_in_parallel);
 
+    /// Translates the programs of a graphics pipeline to SPIR-V
+    void TranslateGraphicsPipeline(ShaderPools& pools, const GraphicsPipelineCacheKey& key,
+                                   std::span<VideoCommon::RecordingEnvironment> envs,
+                                   std::vector<VideoCommon::TranslatedShader>& shaders);
+
     std::unique_ptr<ComputePipeline> CreateComputePipeline(const ComputePipelineCacheKey& key,
                                                            const ShaderInfo* shader);
 
@@ -163,6 +169,8 @@ private:
     Shader::HostTranslateInfo host_info;
 
     std::filesystem::path pipeline_cache_filename;
+    VideoCommon::ShaderTranslationStore translation_store;
+    u128 translation_seed{};
 
     std::filesystem::path vulkan_pipeline_cache_filename;
     vk::PipelineCache vulkan_pipeline_cache;
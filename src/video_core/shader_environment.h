@@ -212,6 +212,11 @@ private:
     u32 viewport_transform_state = 1;
 };
 
+/// Versions of the pipeline cache files written by the renderers, files of other versions are
+/// discarded on load.
+constexpr u32 VULKAN_PIPELINE_CACHE_VERSION = 11;
+constexpr u32 OPENGL_PIPELINE_CACHE_VERSION = 10;
+
 void SerializePipeline(std::span<const char> key, std::span<const GenericEnvironment* const> envs,
                        const std::filesystem::path& filename, u32 cache_version);
 
@@ -0,0 +1,709 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#include "common/cityhash.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "shader_recompiler/exception.h"
+#include "video_core/shader_translation_store.h"
+
+namespace VideoCommon {
+
+namespace {
+constexpr std::array<char, 8> MAGIC_NUMBER{'s', 'u', 'y', 'u', 't', 'r', 'n', 's'};
+constexpr u32 STORE_VERSION = 1;
+
+constexpr u64 HEADER_SIZE = MAGIC_NUMBER.size() + sizeof(STORE_VERSION) + sizeof(u64);
+constexpr u64 ENTRY_HEADER_SIZE = sizeof(u128) + sizeof(u64) + sizeof(u64);
+
+/// Magic number of the pipeline cache files, see SerializePipeline
+constexpr std::array<char, 8> PIPELINE_CACHE_MAGIC_NUMBER{'y', 'u', 'z', 'u', 'c', 'a', 'c', 'h'};
+
+template <typename T>
+void WriteObject(std::ostream& stream, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+void ReadObject(std::istream& stream, T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+template <typename Container>
+void WriteRange(std::ostream& stream, const Container& container) {
+    const u64 size{static_cast<u64>(container.size())};
+    WriteObject(stream, size);
+    for (const auto& element : container) {
+        WriteObject(stream, element);
+    }
+}
+
+template <typename Container>
+void ReadRange(std::istream& stream, Container& container) {
+    u64 size{};
+    ReadObject(stream, size);
+    if (size > container.max_size()) {
+        stream.setstate(std::ios::failbit);
+        return;
+    }
+    container.resize(static_cast<size_t>(size));
+    for (auto& element : container) {
+        ReadObject(stream, element);
+    }
+}
+
+/// Visits every member of a Shader::Info, serialization and deserialization use the same order
+template <typename Info, typename Visitor>
+void VisitInfo(Info& info, Visitor&& visit) {
+    visit(info.uses_workgroup_id);
+    visit(info.uses_local_invocation_id);
+    visit(info.uses_invocation_id);
+    visit(info.uses_invocation_info);
+    visit(info.uses_sample_id);
+    visit(info.uses_is_helper_invocation);
+    visit(info.uses_subgroup_invocation_id);
+    visit(info.uses_subgroup_shuffles);
+    visit(info.uses_patches);
+    visit(info.interpolation);
+    visit(info.loads);
+    visit(info.stores);
+    visit(info.passthrough);
+    visit(info.loads_indexed_attributes);
+    visit(info.stores_frag_color);
+    visit(info.stores_sample_mask);
+    visit(info.stores_frag_depth);
+    visit(info.stores_tess_level_outer);
+    visit(info.stores_tess_level_inner);
+    visit(info.stores_indexed_attributes);
+    visit(info.stores_global_memory);
+    visit(info.uses_local_memory);
+    visit(info.uses_fp16);
+    visit(info.uses_fp64);
+    visit(info.uses_fp16_denorms_flush);
+    visit(info.uses_fp16_denorms_preserve);
+    visit(info.uses_fp32_denorms_flush);
+    visit(info.uses_fp32_denorms_preserve);
+    visit(info.uses_int8);
+    visit(info.uses_int16);
+    visit(info.uses_int64);
+    visit(info.uses_image_1d);
+    visit(info.uses_sampled_1d);
+    visit(info.uses_sparse_residency);
+    visit(info.uses_demote_to_helper_invocation);
+    visit(info.uses_subgroup_vote);
+    visit(info.uses_subgroup_mask);
+    visit(info.uses_fswzadd);
+    visit(info.uses_derivatives);
+    visit(info.uses_typeless_image_reads);
+    visit(info.uses_typeless_image_writes);
+    visit(info.uses_image_buffers);
+    visit(info.uses_shared_increment);
+    visit(info.uses_shared_decrement);
+    visit(info.uses_global_increment);
+    visit(info.uses_global_decrement);
+    visit(info.uses_atomic_f32_add);
+    visit(info.uses_atomic_f16x2_add);
+    visit(info.uses_atomic_f16x2_min);
+    visit(info.uses_atomic_f16x2_max);
+    visit(info.uses_atomic_f32x2_add);
+    visit(info.uses_atomic_f32x2_min);
+    visit(info.uses_atomic_f32x2_max);
+    visit(info.uses_atomic_s32_min);
+    visit(info.uses_atomic_s32_max);
+    visit(info.uses_int64_bit_atomics);
+    visit(info.uses_global_memory);
+    visit(info.uses_atomic_image_u32);
+    visit(info.uses_shadow_lod);
+    visit(info.uses_rescaling_uniform);
+    visit(info.uses_cbuf_indirect);
+    visit(info.uses_render_area);
+    visit(info.used_constant_buffer_types);
+    visit(info.used_storage_buffer_types);
+    visit(info.used_indirect_cbuf_types);
+    visit(info.constant_buffer_mask);
+    visit(info.constant_buffer_used_sizes);
+    visit(info.nvn_buffer_base);
+    visit(info.nvn_buffer_used);
+    visit(info.requires_layer_emulation);
+    visit(info.emulated_layer);
+    visit(info.used_clip_distances);
+}
+
+void SerializeInfo(std::ostream& stream, const Shader::Info& info) {
+    VisitInfo(info, [&stream](const auto& member) { WriteObject(stream, member); });
+
+    const u64 num_legacy_stores{static_cast<u64>(info.legacy_stores_mapping.size())};
+    WriteObject(stream, num_legacy_stores);
+    for (const auto& [attribute, legacy_attribute] : info.legacy_stores_mapping) {
+        WriteObject(stream, attribute);
+        WriteObject(stream, legacy_attribute);
+    }
+    WriteRange(stream, info.constant_buffer_descriptors);
+    WriteRange(stream, info.storage_buffers_descriptors);
+    WriteRange(stream, info.texture_buffer_descriptors);
+    WriteRange(stream, info.image_buffer_descriptors);
+    WriteRange(stream, info.texture_descriptors);
+    WriteRange(stream, info.image_descriptors);
+}
+
+void DeserializeInfo(std::istream& stream, Shader::Info& info) {
+    VisitInfo(info, [&stream](auto& member) { ReadObject(stream, member); });
+
+    u64 num_legacy_stores{};
+    ReadObject(stream, num_legacy_stores);
+    for (u64 index = 0; index < num_legacy_stores && stream.good(); ++index) {
+        Shader::IR::Attribute attribute{};
+        Shader::IR::Attribute legacy_attribute{};
+        ReadObject(stream, attribute);
+        ReadObject(stream, legacy_attribute);
+        info.legacy_stores_mapping.emplace(attribute, legacy_attribute);
+    }
+    ReadRange(stream, info.constant_buffer_descriptors);
+    ReadRange(stream, info.storage_buffers_descriptors);
+    ReadRange(stream, info.texture_buffer_descriptors);
+    ReadRange(stream, info.image_buffer_descriptors);
+    ReadRange(stream, info.texture_descriptors);
+    ReadRange(stream, info.image_descriptors);
+}
+
+u64 BuildHash() {
+    return Common::CityHash64(Common::g_scm_rev, std::strlen(Common::g_scm_rev));
+}
+
+bool CreateStoreFile(const std::filesystem::path& filename) {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(MAGIC_NUMBER.data(), MAGIC_NUMBER.size());
+    WriteObject(file, STORE_VERSION);
+    WriteObject(file, BuildHash());
+    return file.good();
+}
+
+bool IsValidStoreFile(const std::filesystem::path& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    std::array<char, 8> magic_number{};
+    u32 version{};
+    u64 build_hash{};
+    file.read(magic_number.data(), magic_number.size());
+    ReadObject(file, version);
+    ReadObject(file, build_hash);
+    return file.good() && magic_number == MAGIC_NUMBER && version == STORE_VERSION &&
+           build_hash == BuildHash();
+}
+
+/// Returns true when the header of a pipeline cache file could be read and has the given version
+bool IsCurrentPipelineCache(const std::filesystem::path& filename, u32 cache_version) {
+    std::ifstream file(filename, std::ios::binary);
+    std::array<char, 8> magic_number{};
+    u32 version{};
+    file.read(magic_number.data(), magic_number.size());
+    ReadObject(file, version);
+    return file.good() && magic_number == PIPELINE_CACHE_MAGIC_NUMBER && version == cache_version;
+}
+
+/// Parses the name of the directory of a title in the shader directory
+std::optional<u64> ParseTitleId(const std::filesystem::path& path) {
+    const std::string name{Common::FS::PathToUTF8String(path.filename())};
+    u64 title_id{};
+    const auto [end, ec]{std::from_chars(name.data(), name.data() + name.size(), title_id, 16)};
+    if (ec != std::errc{} || end != name.data() + name.size() || title_id == 0) {
+        return std::nullopt;
+    }
+    return title_id;
+}
+} // Anonymous namespace
+
+RecordingEnvironment::RecordingEnvironment(Shader::Environment& env_) : env{&env_} {
+    sph = env->SPH();
+    gp_passthrough_mask = env->GpPassthroughMask();
+    stage = env->ShaderStage();
+    start_address = env->StartAddress();
+    is_proprietary_driver = env->IsProprietaryDriver();
+}
+
+RecordingEnvironment::~RecordingEnvironment() = default;
+
+u64 RecordingEnvironment::ReadInstruction(u32 address) {
+    read_lowest = std::min(read_lowest, address);
+    read_highest = std::max(read_highest, address);
+    return env->ReadInstruction(address);
+}
+
+u32 RecordingEnvironment::ReadCbufValue(u32 cbuf_index, u32 cbuf_offset) {
+    const u32 value{env->ReadCbufValue(cbuf_index, cbuf_offset)};
+    reads.push_back({ReadType::CbufValue, cbuf_index, cbuf_offset, value});
+    return value;
+}
+
+Shader::TextureType RecordingEnvironment::ReadTextureType(u32 raw_handle) {
+    const Shader::TextureType type{env->ReadTextureType(raw_handle)};
+    reads.push_back({ReadType::TextureType, raw_handle, 0, static_cast<u32>(type)});
+    return type;
+}
+
+Shader::TexturePixelFormat RecordingEnvironment::ReadTexturePixelFormat(u32 raw_handle) {
+    const Shader::TexturePixelFormat format{env->ReadTexturePixelFormat(raw_handle)};
+    reads.push_back({ReadType::TexturePixelFormat, raw_handle, 0, static_cast<u32>(format)});
+    return format;
+}
+
+bool RecordingEnvironment::IsTexturePixelFormatInteger(u32 raw_handle) {
+    const bool is_integer{env->IsTexturePixelFormatInteger(raw_handle)};
+    reads.push_back({ReadType::TexturePixelFormatInteger, raw_handle, 0, is_integer ? 1U : 0U});
+    return is_integer;
+}
+
+u32 RecordingEnvironment::ReadViewportTransformState() {
+    const u32 state{env->ReadViewportTransformState()};
+    reads.push_back({ReadType::ViewportTransformState, 0, 0, state});
+    return state;
+}
+
+u32 RecordingEnvironment::TextureBoundBuffer() const {
+    return env->TextureBoundBuffer();
+}
+
+u32 RecordingEnvironment::LocalMemorySize() const {
+    return env->LocalMemorySize();
+}
+
+u32 RecordingEnvironment::SharedMemorySize() const {
+    return env->SharedMemorySize();
+}
+
+std::array<u32, 3> RecordingEnvironment::WorkgroupSize() const {
+    return env->WorkgroupSize();
+}
+
+bool RecordingEnvironment::HasHLEMacroState() const {
+    return env->HasHLEMacroState();
+}
+
+std::optional<Shader::ReplaceConstant> RecordingEnvironment::GetReplaceConstBuffer(u32 bank,
+                                                                                   u32 offset) {
+    const std::optional<Shader::ReplaceConstant> replacement{
+        env->GetReplaceConstBuffer(bank, offset)};
+    // Zero records that there is no replacement
+    const u32 value{replacement ? static_cast<u32>(*replacement) + 1 : 0};
+    reads.push_back({ReadType::ReplaceConstBuffer, bank, offset, value});
+    return replacement;
+}
+
+void RecordingEnvironment::Dump(u64 pipeline_hash, u64 shader_hash) {
+    env->Dump(pipeline_hash, shader_hash);
+}
+
+void RecordingEnvironment::Serialize(std::ostream& stream) {
+    const u32 lowest{read_lowest <= read_highest ? read_lowest : 0};
+    const u64 num_words{read_lowest <= read_highest
+                            ? (static_cast<u64>(read_highest) - read_lowest) / sizeof(u64) + 1
+                            : 0};
+    WriteObject(stream, stage);
+    WriteObject(stream, start_address);
+    WriteObject(stream, is_proprietary_driver);
+    WriteObject(stream, sph);
+    WriteObject(stream, gp_passthrough_mask);
+    WriteObject(stream, env->TextureBoundBuffer());
+    WriteObject(stream, env->LocalMemorySize());
+    WriteObject(stream, env->SharedMemorySize());
+    WriteObject(stream, env->WorkgroupSize());
+    WriteObject(stream, env->HasHLEMacroState());
+    WriteObject(stream, lowest);
+    WriteObject(stream, num_words);
+    for (u64 index = 0; index < num_words; ++index) {
+        WriteObject(stream, env->ReadInstruction(static_cast<u32>(lowest + index * sizeof(u64))));
+    }
+    const u64 num_reads{static_cast<u64>(reads.size())};
+    WriteObject(stream, num_reads);
+    for (const Read& read : reads) {
+        WriteObject(stream, read.type);
+        WriteObject(stream, read.arg0);
+        WriteObject(stream, read.arg1);
+        WriteObject(stream, read.value);
+    }
+}
+
+bool RecordingEnvironment::Matches(std::istream& stream, Shader::Environment& env) {
+    Shader::Stage recorded_stage{};
+    u32 recorded_start_address{};
+    bool recorded_is_proprietary_driver{};
+    Shader::ProgramHeader recorded_sph{};
+    std::array<u32, 8> recorded_gp_passthrough_mask{};
+    u32 texture_bound{};
+    u32 local_memory_size{};
+    u32 shared_memory_size{};
+    std::array<u32, 3> workgroup_size{};
+    bool has_hle_macro_state{};
+    ReadObject(stream, recorded_stage);
+    ReadObject(stream, recorded_start_address);
+    ReadObject(stream, recorded_is_proprietary_driver);
+    ReadObject(stream, recorded_sph);
+    ReadObject(stream, recorded_gp_passthrough_mask);
+    ReadObject(stream, texture_bound);
+    ReadObject(stream, local_memory_size);
+    ReadObject(stream, shared_memory_size);
+    ReadObject(stream, workgroup_size);
+    ReadObject(stream, has_hle_macro_state);
+    if (!stream.good() || recorded_stage != env.ShaderStage() ||
+        recorded_start_address != env.StartAddress() ||
+        recorded_is_proprietary_driver != env.IsProprietaryDriver() ||
+        std::memcmp(&recorded_sph, &env.SPH(), sizeof(recorded_sph)) != 0 ||
+        recorded_gp_passthrough_mask != env.GpPassthroughMask() ||
+        texture_bound != env.TextureBoundBuffer() || local_memory_size != env.LocalMemorySize() ||
+        shared_memory_size != env.SharedMemorySize() || workgroup_size != env.WorkgroupSize() ||
+        has_hle_macro_state != env.HasHLEMacroState()) {
+        return false;
+    }
+    u32 lowest{};
+    u64 num_words{};
+    ReadObject(stream, lowest);
+    ReadObject(stream, num_words);
+    for (u64 index = 0; index < num_words; ++index) {
+        u64 word{};
+        ReadObject(stream, word);
+        if (!stream.good() ||
+            word != env.ReadInstruction(static_cast<u32>(lowest + index * sizeof(u64)))) {
+            return false;
+        }
+    }
+    u64 num_reads{};
+    ReadObject(stream, num_reads);
+    for (u64 index = 0; index < num_reads; ++index) {
+        ReadType type{};
+        u32 arg0{};
+        u32 arg1{};
+        u32 value{};
+        ReadObject(stream, type);
+        ReadObject(stream, arg0);
+        ReadObject(stream, arg1);
+        ReadObject(stream, value);
+        if (!stream.good() || type > ReadType::ReplaceConstBuffer ||
+            value != ReadValue(env, type, arg0, arg1)) {
+            return false;
+        }
+    }
+    return stream.good();
+}
+
+u32 RecordingEnvironment::ReadValue(Shader::Environment& env, ReadType type, u32 arg0, u32 arg1) {
+    switch (type) {
+    case ReadType::CbufValue:
+        return env.ReadCbufValue(arg0, arg1);
+    case ReadType::TextureType:
+        return static_cast<u32>(env.ReadTextureType(arg0));
+    case ReadType::TexturePixelFormat:
+        return static_cast<u32>(env.ReadTexturePixelFormat(arg0));
+    case ReadType::TexturePixelFormatInteger:
+        return env.IsTexturePixelFormatInteger(arg0) ? 1U : 0U;
+    case ReadType::ViewportTransformState:
+        return env.ReadViewportTransformState();
+    case ReadType::ReplaceConstBuffer: {
+        const std::optional<Shader::ReplaceConstant> replacement{
+            env.GetReplaceConstBuffer(arg0, arg1)};
+        return replacement ? static_cast<u32>(*replacement) + 1 : 0;
+    }
+    }
+    return 0;
+}
+
+ShaderTranslationStore::ShaderTranslationStore() = default;
+
+ShaderTranslationStore::~ShaderTranslationStore() = default;
+
+bool ShaderTranslationStore::Open(const std::filesystem::path& filename_, u64 title_id_,
+                                  OpenMode mode_) {
+    std::scoped_lock lock{mutex};
+    title_id = title_id_;
+    if (file.is_open() && filename == filename_ && mode == mode_) {
+        return true;
+    }
+    file.close();
+    entries.clear();
+    filename = filename_;
+    mode = mode_;
+
+    const bool is_valid{Common::FS::Exists(filename) && IsValidStoreFile(filename)};
+    if (!is_valid && mode == OpenMode::ReadOnly) {
+        LOG_ERROR(Common_Filesystem, "Missing or outdated shader translation store {}",
+                  Common::FS::PathToUTF8String(filename));
+        return false;
+    }
+    if (!is_valid) {
+        if (Common::FS::Exists(filename)) {
+            LOG_INFO(Common_Filesystem, "Recreating shader translation store of another build");
+        }
+        if (!CreateStoreFile(filename)) {
+            LOG_ERROR(Common_Filesystem, "Failed to create shader translation store {}",
+                      Common::FS::PathToUTF8String(filename));
+            return false;
+        }
+    }
+    file.open(filename, OpenFlags());
+    if (!file.is_open()) {
+        LOG_ERROR(Common_Filesystem, "Failed to open shader translation store {}",
+                  Common::FS::PathToUTF8String(filename));
+        return false;
+    }
+    BuildIndex();
+    LOG_INFO(Common_Filesystem, "Shader translation store has {} pipelines", entries.size());
+    return true;
+}
+
+bool ShaderTranslationStore::IsOpen() const {
+    std::scoped_lock lock{mutex};
+    return file.is_open();
+}
+
+bool ShaderTranslationStore::Find(const u128& key, std::span<Shader::Environment* const> envs,
+                                  std::vector<TranslatedShader>& shaders) {
+    std::vector<std::string> candidates;
+    {
+        std::scoped_lock lock{mutex};
+        const auto [begin, end]{entries.equal_range(key)};
+        for (auto it = begin; it != end; ++it) {
+            std::string& data{candidates.emplace_back(it->second.size, '\0')};
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(it->second.offset));
+            file.read(data.data(), data.size());
+            if (!file.good()) {
+                candidates.pop_back();
+            }
+        }
+    }
+    for (std::string& data : candidates) {
+        std::istringstream stream(std::move(data), std::ios::binary);
+        try {
+            u32 num_envs{};
+            ReadObject(stream, num_envs);
+            if (num_envs != envs.size()) {
+                continue;
+            }
+            const bool matches{std::ranges::all_of(envs, [&stream](Shader::Environment* env) {
+                return RecordingEnvironment::Matches(stream, *env);
+            })};
+            if (!matches) {
+                continue;
+            }
+            u32 num_shaders{};
+            ReadObject(stream, num_shaders);
+            shaders.clear();
+            for (u32 index = 0; index < num_shaders && stream.good(); ++index) {
+                TranslatedShader& shader{shaders.emplace_back()};
+                ReadObject(stream, shader.stage_index);
+                DeserializeInfo(stream, shader.info);
+                ReadRange(stream, shader.code);
+            }
+            if (stream.good()) {
+                return true;
+            }
+        } catch (const Shader::Exception&) {
+            // Environments loaded from a pipeline cache throw on values they don't hold
+        }
+    }
+    shaders.clear();
+    return false;
+}
+
+void ShaderTranslationStore::Insert(const u128& key, std::span<RecordingEnvironment> envs,
+                                    std::span<const TranslatedShader> shaders) {
+    std::ostringstream stream(std::ios::binary);
+    WriteObject(stream, static_cast<u32>(envs.size()));
+    for (RecordingEnvironment& env : envs) {
+        env.Serialize(stream);
+    }
+    WriteObject(stream, static_cast<u32>(shaders.size()));
+    for (const TranslatedShader& shader : shaders) {
+        WriteObject(stream, shader.stage_index);
+        SerializeInfo(stream, shader.info);
+        WriteRange(stream, shader.code);
+    }
+    const std::string data{std::move(stream).str()};
+    const u64 size{static_cast<u64>(data.size())};
+
+    std::scoped_lock lock{mutex};
+    if (!file.is_open() || mode == OpenMode::ReadOnly) {
+        return;
+    }
+    file.clear();
+    file.seekp(static_cast<std::streamoff>(end_offset));
+    WriteObject(file, key);
+    WriteObject(file, title_id);
+    WriteObject(file, size);
+    file.write(data.data(), data.size());
+    file.flush();
+    if (!file.good()) {
+        LOG_ERROR(Common_Filesystem, "Failed to write to shader translation store {}",
+                  Common::FS::PathToUTF8String(filename));
+        return;
+    }
+    entries.emplace(key, Entry{
+                             .offset = end_offset + ENTRY_HEADER_SIZE,
+                             .size = size,
+                             .title_id = title_id,
+                         });
+    end_offset += ENTRY_HEADER_SIZE + size;
+}
+
+size_t ShaderTranslationStore::Size() const {
+    std::scoped_lock lock{mutex};
+    return entries.size();
+}
+
+size_t ShaderTranslationStore::Size(u64 title_id_) const {
+    std::scoped_lock lock{mutex};
+    return static_cast<size_t>(std::ranges::count_if(
+        entries, [title_id_](const auto& pair) { return pair.second.title_id == title_id_; }));
+}
+
+void ShaderTranslationStore::Compact(const std::filesystem::path& filename,
+                                     const std::filesystem::path& cache_name, u32 cache_version) {
+    if (!Common::FS::Exists(filename) || !IsValidStoreFile(filename)) {
+        return;
+    }
+    std::unordered_set<u64> title_ids;
+    std::error_code ec;
+    for (const auto& title_dir : std::filesystem::directory_iterator(filename.parent_path(), ec)) {
+        if (!title_dir.is_directory(ec)) {
+            continue;
+        }
+        const std::optional<u64> title_id{ParseTitleId(title_dir.path())};
+        if (title_id && IsCurrentPipelineCache(title_dir.path() / cache_name, cache_version)) {
+            title_ids.insert(*title_id);
+        }
+    }
+    if (ec) {
+        LOG_ERROR(Common_Filesystem, "Failed to list the pipeline caches of {}: {}",
+                  Common::FS::PathToUTF8String(filename.parent_path()), ec.message());
+        return;
+    }
+    ShaderTranslationStore store;
+    if (store.Open(filename, 0)) {
+        std::scoped_lock lock{store.mutex};
+        store.Retain(title_ids);
+    }
+}
+
+bool ShaderTranslationStore::Retain(const std::unordered_set<u64>& title_ids) {
+    if (std::ranges::all_of(entries, [&title_ids](const auto& pair) {
+            return title_ids.contains(pair.second.title_id);
+        })) {
+        return true;
+    }
+    auto temp_filename{filename};
+    temp_filename += ".tmp";
+    if (!CreateStoreFile(temp_filename)) {
+        LOG_ERROR(Common_Filesystem, "Failed to create shader translation store {}",
+                  Common::FS::PathToUTF8String(temp_filename));
+        return false;
+    }
+    std::ofstream temp_file(temp_filename, std::ios::binary | std::ios::app);
+    std::vector<char> data;
+    size_t num_removed{};
+    for (const auto& [key, entry] : entries) {
+        if (!title_ids.contains(entry.title_id)) {
+            ++num_removed;
+            continue;
+        }
+        data.resize(entry.size);
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(entry.offset));
+        file.read(data.data(), data.size());
+        if (!file.good()) {
+            ++num_removed;
+            continue;
+        }
+        WriteObject(temp_file, key);
+        WriteObject(temp_file, entry.title_id);
+        WriteObject(temp_file, entry.size);
+        temp_file.write(data.data(), data.size());
+    }
+    temp_file.close();
+    if (!temp_file.good()) {
+        LOG_ERROR(Common_Filesystem, "Failed to write shader translation store {}",
+                  Common::FS::PathToUTF8String(temp_filename));
+        static_cast<void>(Common::FS::RemoveFile(temp_filename));
+        return false;
+    }
+    file.close();
+    std::error_code ec;
+    std::filesystem::rename(temp_filename, filename, ec);
+    if (ec) {
+        LOG_ERROR(Common_Filesystem, "Failed to replace shader translation store {}: {}",
+                  Common::FS::PathToUTF8String(filename), ec.message());
+        static_cast<void>(Common::FS::RemoveFile(temp_filename));
+    }
+    file.open(filename, OpenFlags());
+    entries.clear();
+    if (file.is_open()) {
+        BuildIndex();
+    }
+    if (ec) {
+        return false;
+    }
+    LOG_INFO(Common_Filesystem, "Removed {} pipelines of removed titles from the shader store",
+             num_removed);
+    return true;
+}
+
+void ShaderTranslationStore::BuildIndex() {
+    file.seekg(0, std::ios::end);
+    const u64 file_size{static_cast<u64>(file.tellg())};
+
+    u64 offset{HEADER_SIZE};
+    while (offset + ENTRY_HEADER_SIZE <= file_size) {
+        u128 key{};
+        u64 entry_title_id{};
+        u64 size{};
+        file.seekg(static_cast<std::streamoff>(offset));
+        ReadObject(file, key);
+        ReadObject(file, entry_title_id);
+        ReadObject(file, size);
+        if (!file.good() || offset + ENTRY_HEADER_SIZE + size > file_size) {
+            break;
+        }
+        entries.emplace(key, Entry{
+                                 .offset = offset + ENTRY_HEADER_SIZE,
+                                 .size = size,
+                                 .title_id = entry_title_id,
+                             });
+        offset += ENTRY_HEADER_SIZE + size;
+    }
+    end_offset = offset;
+    file.clear();
+
+    if (end_offset != file_size && mode == OpenMode::ReadOnly) {
+        LOG_WARNING(Common_Filesystem, "Ignoring {} trailing bytes of shader translation store",
+                    file_size - end_offset);
+    } else if (end_offset != file_size) {
+        // Drop the partially written entry left behind by an interrupted write
+        LOG_WARNING(Common_Filesystem, "Discarding {} trailing bytes of shader translation store",
+                    file_size - end_offset);
+        file.close();
+        std::error_code ec;
+        std::filesystem::resize_file(filename, end_offset, ec);
+        file.open(filename, OpenFlags());
+    }
+}
+
+std::ios::openmode ShaderTranslationStore::OpenFlags() const {
+    if (mode == OpenMode::ReadOnly) {
+        return std::ios::in | std::ios::binary;
+    }
+    return std::ios::in | std::ios::out | std::ios::binary;
+}
+
+} // namespace VideoCommon
@@ -0,0 +1,201 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <iosfwd>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/common_types.h"
+#include "shader_recompiler/environment.h"
+#include "shader_recompiler/shader_info.h"
+
+namespace VideoCommon {
+
+/// Name of the shader translation store of the Vulkan renderer in the shader directory
+constexpr std::string_view VULKAN_TRANSLATION_STORE_NAME = "vulkan_shaders.bin";
+
+/// Environment forwarding to another environment, which records in order every value that
+/// translation reads from it. A translation of the same code that reads the same values produces
+/// the same shader, so a recording can stand in for the translation.
+class RecordingEnvironment final : public Shader::Environment {
+public:
+    explicit RecordingEnvironment(Shader::Environment& env_);
+    ~RecordingEnvironment() override;
+
+    [[nodiscard]] u64 ReadInstruction(u32 address) override;
+
+    [[nodiscard]] u32 ReadCbufValue(u32 cbuf_index, u32 cbuf_offset) override;
+
+    [[nodiscard]] Shader::TextureType ReadTextureType(u32 raw_handle) override;
+
+    [[nodiscard]] Shader::TexturePixelFormat ReadTexturePixelFormat(u32 raw_handle) override;
+
+    [[nodiscard]] bool IsTexturePixelFormatInteger(u32 raw_handle) override;
+
+    [[nodiscard]] u32 ReadViewportTransformState() override;
+
+    [[nodiscard]] u32 TextureBoundBuffer() const override;
+
+    [[nodiscard]] u32 LocalMemorySize() const override;
+
+    [[nodiscard]] u32 SharedMemorySize() const override;
+
+    [[nodiscard]] std::array<u32, 3> WorkgroupSize() const override;
+
+    [[nodiscard]] bool HasHLEMacroState() const override;
+
+    [[nodiscard]] std::optional<Shader::ReplaceConstant> GetReplaceConstBuffer(u32 bank,
+                                                                               u32 offset) override;
+
+    void Dump(u64 pipeline_hash, u64 shader_hash) override;
+
+    /// Writes the code read so far, the properties of the environment and the recorded values
+    void Serialize(std::ostream& stream);
+
+    /// Reads a recording and checks it against an environment. Values are read from the
+    /// environment in the order they were recorded and the check stops at the first difference,
+    /// so the environment is only asked what a translation of its code would ask.
+    /// @return True when the environment holds the same code and returns the same values
+    [[nodiscard]] static bool Matches(std::istream& stream, Shader::Environment& env);
+
+private:
+    enum class ReadType : u32 {
+        CbufValue,
+        TextureType,
+        TexturePixelFormat,
+        TexturePixelFormatInteger,
+        ViewportTransformState,
+        ReplaceConstBuffer,
+    };
+
+    struct Read {
+        ReadType type;
+        u32 arg0;
+        u32 arg1;
+        u32 value;
+    };
+
+    /// Reads the value of a recorded read from an environment
+    static u32 ReadValue(Shader::Environment& env, ReadType type, u32 arg0, u32 arg1);
+
+    Shader::Environment* env;
+    std::vector<Read> reads;
+    u32 read_lowest = std::numeric_limits<u32>::max();
+    u32 read_highest = 0;
+};
+
+/// Shader translated for a stage of a pipeline
+struct TranslatedShader {
+    u32 stage_index{};
+    Shader::Info info;
+    std::vector<u32> code;
+};
+
+/// Store of translated shaders shared by every title.
+///
+/// Titles built on the same engine ship identical programs. Entries are keyed by a hash of the
+/// pipeline key, which covers the hashes of the programs and the fixed function state, and of
+/// anything else translation depends on. An entry holds the recorded environments of the
+/// pipeline next to its shaders, and a pipeline only reuses the shaders when its environments
+/// match the recordings, so a title skips translating the pipelines another title already built.
+class ShaderTranslationStore {
+public:
+    enum class OpenMode {
+        ReadWrite, ///< Creates the store when needed and adds entries to it
+        ReadOnly,  ///< Only reads an existing store, the file is never modified
+    };
+
+    explicit ShaderTranslationStore();
+    ~ShaderTranslationStore();
+
+    ShaderTranslationStore& operator=(const ShaderTranslationStore&) = delete;
+    ShaderTranslationStore(const ShaderTranslationStore&) = delete;
+
+    /// Opens the store at the given path, creating it if it doesn't exist. A store written by
+    /// another build is recreated, as translation changes between builds. In read-only mode a
+    /// missing store or a store of another build fails to open instead, a truncated tail is left
+    /// in place and entries are never added.
+    /// @param title_id Title the entries added to the store belong to
+    /// @param mode Whether the store may be modified
+    /// @return True on success, false otherwise
+    bool Open(const std::filesystem::path& filename, u64 title_id,
+              OpenMode mode = OpenMode::ReadWrite);
+
+    /// Returns true when the store has been opened successfully
+    [[nodiscard]] bool IsOpen() const;
+
+    /// Looks for the shaders of a pipeline
+    /// @param key Hash of the pipeline key and of anything else translation depends on
+    /// @param envs Environments of the pipeline, in the order they are translated
+    /// @param shaders Output translated shaders
+    /// @return True when an entry with matching environments was found
+    [[nodiscard]] bool Find(const u128& key, std::span<Shader::Environment* const> envs,
+                            std::vector<TranslatedShader>& shaders);
+
+    /// Adds the shaders of a pipeline to the store, does nothing when opened read-only
+    /// @param key Hash of the pipeline key and of anything else translation depends on
+    /// @param envs Environments the pipeline was translated from, in the order they were used
+    /// @param shaders Translated shaders
+    void Insert(const u128& key, std::span<RecordingEnvironment> envs,
+                std::span<const TranslatedShader> shaders);
+
+    /// Returns the number of entries in the store
+    [[nodiscard]] size_t Size() const;
+
+    /// Returns the number of entries added to the store by a title
+    [[nodiscard]] size_t Size(u64 title_id) const;
+
+    /// Removes the entries of the titles without a pipeline cache of the current version in the
+    /// shader directory. Titles are only kept from caches whose header was read successfully, and
+    /// the store itself is never removed. Must not run while a title is using the store.
+    /// @param filename Path of the store, in the shader directory
+    /// @param cache_name Name of the pipeline cache file in the directory of a title
+    /// @param cache_version Version of the pipeline cache files
+    static void Compact(const std::filesystem::path& filename,
+                        const std::filesystem::path& cache_name, u32 cache_version);
+
+private:
+    struct Entry {
+        u64 offset;
+        u64 size;
+        u64 title_id;
+    };
+
+    struct KeyHash {
+        size_t operator()(const u128& key) const noexcept {
+            return static_cast<size_t>(key[0] ^ key[1]);
+        }
+    };
+
+    /// Rewrites the store with only the entries of the given titles
+    /// @return True on success, false otherwise
+    bool Retain(const std::unordered_set<u64>& title_ids);
+
+    /// Indexes every complete entry in the store, dropping a truncated tail if there is one and
+    /// the store is writable
+    void BuildIndex();
+
+    /// Returns the flags to open the store file with in the current mode
+    [[nodiscard]] std::ios::openmode OpenFlags() const;
+
+    mutable std::mutex mutex;
+    std::filesystem::path filename;
+    std::fstream file;
+    std::unordered_multimap<u128, Entry, KeyHash> entries;
+    u64 end_offset{};
+    u64 title_id{};
+    OpenMode mode{OpenMode::ReadWrite};
+};
+
+} // namespace VideoCommon
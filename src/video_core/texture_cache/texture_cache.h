@@ -1104,11 +1104,13 @@ ImageViewId TextureCache<P>::FindImageView(const TICEntry& config) {
     if (!IsValidEntry(*gpu_memory, config)) {
         return NULL_IMAGE_VIEW_ID;
     }
-    const auto [pair, is_new] = channel_state->image_views.try_emplace(config);
-    ImageViewId& image_view_id = pair->second;
-    if (is_new) {
-        image_view_id = CreateImageView(config);
+    const auto it = channel_state->image_views.find(config);
+    if (it != channel_state->image_views.end()) {
+        return it->second;
     }
+    // Creating the view may erase other entries, so only insert once it exists
+    const ImageViewId image_view_id = CreateImageView(config);
+    channel_state->image_views.try_emplace(config, image_view_id);
     return image_view_id;
 }
 
@@ -2033,24 +2035,21 @@ void TextureCache<P>::UnregisterImage(ImageId image_id) {
     image.flags &= ~ImageFlagBits::Registered;
     image.flags &= ~ImageFlagBits::BadOverlap;
     lru_cache.Free(image.lru_index);
-    const auto& clear_page_table =
-        [image_id](u64 page,
-                   std::unordered_map<u64, std::vector<ImageId>, Common::IdentityHash<u64>>&
-                       selected_page_table) {
-            const auto page_it = selected_page_table.find(page);
-            if (page_it == selected_page_table.end()) {
-                ASSERT_MSG(false, "Unregistering unregistered page=0x{:x}", page << SUYU_PAGEBITS);
-                return;
-            }
-            std::vector<ImageId>& image_ids = page_it->second;
-            const auto vector_it = std::ranges::find(image_ids, image_id);
-            if (vector_it == image_ids.end()) {
-                ASSERT_MSG(false, "Unregistering unregistered image in page=0x{:x}",
-                           page << SUYU_PAGEBITS);
-                return;
-            }
-            image_ids.erase(vector_it);
-        };
+    const auto& clear_page_table = [image_id](u64 page, TextureCacheGPUMap& selected_page_table) {
+        const auto page_it = selected_page_table.find(page);
+        if (page_it == selected_page_table.end()) {
+            ASSERT_MSG(false, "Unregistering unregistered page=0x{:x}", page << SUYU_PAGEBITS);
+            return;
+        }
+        PageImageIds& image_ids = page_it->second;
+        const auto vector_it = std::ranges::find(image_ids, image_id);
+        if (vector_it == image_ids.end()) {
+            ASSERT_MSG(false, "Unregistering unregistered image in page=0x{:x}",
+                       page << SUYU_PAGEBITS);
+            return;
+        }
+        image_ids.erase(vector_it);
+    };
     ForEachGPUPage(image.gpu_addr, image.guest_size_bytes, [this, &clear_page_table](u64 page) {
         clear_page_table(page, (*channel_state->gpu_page_table));
     });
@@ -2062,7 +2061,7 @@ void TextureCache<P>::UnregisterImage(ImageId image_id) {
                 ASSERT_MSG(false, "Unregistering unregistered page=0x{:x}", page << SUYU_PAGEBITS);
                 return;
             }
-            std::vector<ImageMapId>& image_map_ids = page_it->second;
+            auto& image_map_ids = page_it->second;
             const auto vector_it = std::ranges::find(image_map_ids, map_id);
             if (vector_it == image_map_ids.end()) {
                 ASSERT_MSG(false, "Unregistering unregistered image in page=0x{:x}",
@@ -2090,7 +2089,7 @@ void TextureCache<P>::UnregisterImage(ImageId image_id) {
                 ASSERT_MSG(false, "Unregistering unregistered page=0x{:x}", page << SUYU_PAGEBITS);
                 return;
             }
-            std::vector<ImageMapId>& image_map_ids = page_it->second;
+            auto& image_map_ids = page_it->second;
             auto vector_it = image_map_ids.begin();
             while (vector_it != image_map_ids.end()) {
                 ImageMapView& map = slot_map_views[*vector_it];
@@ -16,6 +16,7 @@
 #include <queue>
 
 #include "common/common_types.h"
+#include "common/flat_hash_map.h"
 #include "common/hash.h"
 #include "common/literals.h"
 #include "common/lru_cache.h"
@@ -63,7 +64,9 @@ struct AsyncDecodeContext {
     std::atomic_bool complete;
 };
 
-using TextureCacheGPUMap = std::unordered_map<u64, std::vector<ImageId>, Common::IdentityHash<u64>>;
+/// Images overlapping a page, most pages only hold a few
+using PageImageIds = boost::container::small_vector<ImageId, 4>;
+using TextureCacheGPUMap = Common::FlatHashMap<u64, PageImageIds, Common::IdentityHash<u64>>;
 
 class TextureCacheChannelInfo : public ChannelInfo {
 public:
@@ -82,8 +85,8 @@ public:
     std::vector<SamplerId> compute_sampler_ids;
     std::vector<ImageViewId> compute_image_view_ids;
 
-    std::unordered_map<TICEntry, ImageViewId> image_views;
-    std::unordered_map<TSCEntry, SamplerId> samplers;
+    Common::FlatHashMap<TICEntry, ImageViewId> image_views;
+    Common::FlatHashMap<TSCEntry, SamplerId> samplers;
 
     TextureCacheGPUMap* gpu_page_table;
     TextureCacheGPUMap* sparse_page_table;
@@ -429,9 +432,12 @@ private:
 
     RenderTargets render_targets;
 
-    std::unordered_map<RenderTargets, FramebufferId> framebuffers;
+    Common::FlatHashMap<RenderTargets, FramebufferId> framebuffers;
 
-    std::unordered_map<u64, std::vector<ImageMapId>, Common::IdentityHash<u64>> page_table;
+    // Page tables are flat, so images must not be registered while iterating over a page
+    Common::FlatHashMap<u64, boost::container::small_vector<ImageMapId, 4>,
+                        Common::IdentityHash<u64>>
+        page_table;
     std::unordered_map<ImageId, boost::container::small_vector<ImageViewId, 16>> sparse_views;
 
     DAddr virtual_invalid_space{};
@@ -481,7 +487,7 @@ private:
     DelayedDestructionRing<ImageView, TICKS_TO_DESTROY> sentenced_image_view;
     DelayedDestructionRing<Framebuffer, TICKS_TO_DESTROY> sentenced_framebuffers;
 
-    std::unordered_map<GPUVAddr, ImageAllocId> image_allocs_table;
+    Common::FlatHashMap<GPUVAddr, ImageAllocId, Common::IdentityHash<GPUVAddr>> image_allocs_table;
 
     Common::ScratchBuffer<u8> swizzle_data_buffer;
     Common::ScratchBuffer<u8> unswizzle_data_buffer;
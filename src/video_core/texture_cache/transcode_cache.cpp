@@ -0,0 +1,237 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <charconv>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "common/cityhash.h"
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/literals.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
+#include "video_core/texture_cache/transcode_cache.h"
+
+namespace VideoCommon {
+
+namespace {
+using namespace Common::Literals;
+
+/// Bumped whenever the output of a transcoder changes, so stale entries are never read
+constexpr u64 TRANSCODE_CACHE_VERSION = 1;
+
+/// Writes are dropped instead of queued while this many bytes are waiting to be written
+constexpr u64 MAX_PENDING_SIZE = 256_MiB;
+
+constexpr std::string_view ENTRY_EXTENSION = ".bin";
+constexpr std::string_view TEMP_EXTENSION = ".tmp";
+
+std::optional<u128> ParseKey(std::string_view name) {
+    if (name.size() != 32 + ENTRY_EXTENSION.size() || !name.ends_with(ENTRY_EXTENSION)) {
+        return std::nullopt;
+    }
+    u128 key{};
+    for (size_t half = 0; half < 2; ++half) {
+        const char* const begin = name.data() + half * 16;
+        const auto [ptr, ec] = std::from_chars(begin, begin + 16, key[1 - half], 16);
+        if (ec != std::errc{} || ptr != begin + 16) {
+            return std::nullopt;
+        }
+    }
+    return key;
+}
+} // Anonymous namespace
+
+TranscodeCache::TranscodeCache(const std::filesystem::path& directory_)
+    : directory{directory_}, writer{1, "TranscodeCache"} {
+    writer.QueueWork([this] { BuildIndex(); });
+}
+
+TranscodeCache::~TranscodeCache() = default;
+
+u128 TranscodeCache::MakeKey(std::span<const u8> guest_data,
+                             VideoCore::Surface::PixelFormat format, const BufferImageCopy& copy) {
+    const auto recompression = Settings::values.astc_recompression.GetValue();
+    const Extent3D& extent = copy.image_extent;
+    const u128 seed{
+        TRANSCODE_CACHE_VERSION | (static_cast<u64>(format) << 16) |
+            (static_cast<u64>(recompression) << 32),
+        u64{extent.width} | (u64{extent.height} << 16) | (u64{extent.depth} << 32) |
+            (static_cast<u64>(copy.image_subresource.num_layers) << 48),
+    };
+    return Common::CityHash128WithSeed(reinterpret_cast<const char*>(guest_data.data()),
+                                       guest_data.size(), seed);
+}
+
+bool TranscodeCache::Read(const u128& key, std::span<u8> output) {
+    {
+        std::scoped_lock lock{mutex};
+        if (!is_ready) {
+            return false;
+        }
+        const auto it = entries.find(key);
+        if (it == entries.end()) {
+            return false;
+        }
+        if (it->second->size != output.size()) {
+            // The key covers the size of the level, so the file is damaged
+            Remove(it);
+            return false;
+        }
+        lru.splice(lru.begin(), lru, it->second);
+    }
+    const auto path = EntryPath(key);
+    {
+        Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read,
+                                Common::FS::FileType::BinaryFile};
+        if (!file.IsOpen() || file.ReadSpan(output) != output.size()) {
+            LOG_WARNING(HW_GPU, "Failed to read transcoded texture {}",
+                        Common::FS::PathToUTF8String(path));
+            file.Close();
+            // Drop the entry so the next transcode of this level replaces it
+            std::scoped_lock lock{mutex};
+            if (const auto it = entries.find(key); it != entries.end()) {
+                Remove(it);
+            }
+            return false;
+        }
+    }
+    // Entries are ordered by modification time when the cache is loaded in later sessions
+    writer.QueueWork([path] {
+        std::error_code ec;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    });
+    return true;
+}
+
+void TranscodeCache::Write(const u128& key, std::span<const u8> data) {
+    {
+        std::scoped_lock lock{mutex};
+        if (!is_ready || entries.contains(key) || pending.contains(key) ||
+            pending_size + data.size() > MAX_PENDING_SIZE) {
+            return;
+        }
+        pending.insert(key);
+        pending_size += data.size();
+    }
+    writer.QueueWork([this, key, data = std::vector<u8>(data.begin(), data.end())] {
+        const auto path = EntryPath(key);
+        auto temp_path = path;
+        temp_path.replace_extension(TEMP_EXTENSION);
+
+        bool is_written{};
+        {
+            Common::FS::IOFile file{temp_path, Common::FS::FileAccessMode::Write,
+                                    Common::FS::FileType::BinaryFile};
+            is_written = file.IsOpen() && file.WriteSpan(std::span{data}) == data.size();
+        }
+        // Entries only become visible once complete, so a crash never leaves a truncated one
+        is_written = is_written && Common::FS::RenameFile(temp_path, path);
+        if (!is_written) {
+            LOG_ERROR(HW_GPU, "Failed to write transcoded texture {}",
+                      Common::FS::PathToUTF8String(path));
+            Common::FS::RemoveFile(temp_path);
+        }
+
+        std::scoped_lock lock{mutex};
+        pending.erase(key);
+        pending_size -= data.size();
+        if (!is_written) {
+            return;
+        }
+        lru.push_front(Entry{
+            .key = key,
+            .size = data.size(),
+        });
+        entries.emplace(key, lru.begin());
+        total_size += data.size();
+        Evict();
+    });
+}
+
+void TranscodeCache::WaitForRequests() {
+    writer.WaitForRequests();
+}
+
+void TranscodeCache::BuildIndex() {
+    struct FoundEntry {
+        std::filesystem::file_time_type last_use;
+        Entry entry;
+    };
+    std::vector<FoundEntry> found;
+
+    if (!Common::FS::CreateDirs(directory)) {
+        LOG_ERROR(HW_GPU, "Failed to create transcoded texture cache directory {}",
+                  Common::FS::PathToUTF8String(directory));
+        return;
+    }
+    std::error_code ec;
+    for (const auto& file : std::filesystem::directory_iterator(directory, ec)) {
+        const auto& path = file.path();
+        if (path.extension() == TEMP_EXTENSION) {
+            // Left behind by a write that was interrupted
+            Common::FS::RemoveFile(path);
+            continue;
+        }
+        const std::optional<u128> key = ParseKey(Common::FS::PathToUTF8String(path.filename()));
+        if (!key || !file.is_regular_file(ec)) {
+            continue;
+        }
+        found.push_back({
+            .last_use = file.last_write_time(ec),
+            .entry{
+                .key = *key,
+                .size = file.file_size(ec),
+            },
+        });
+    }
+    std::ranges::sort(found, std::ranges::greater{}, &FoundEntry::last_use);
+
+    std::scoped_lock lock{mutex};
+    for (const FoundEntry& found_entry : found) {
+        lru.push_back(found_entry.entry);
+        entries.emplace(found_entry.entry.key, std::prev(lru.end()));
+        total_size += found_entry.entry.size;
+    }
+    is_ready = true;
+    Evict();
+
+    LOG_INFO(HW_GPU, "Transcoded texture cache has {} entries, {} MiB", entries.size(),
+             total_size >> 20);
+}
+
+void TranscodeCache::Evict() {
+    const u64 size_limit = u64{Settings::values.disk_texture_cache_size.GetValue()} << 20;
+    while (total_size > size_limit && !lru.empty()) {
+        Remove(entries.find(lru.back().key));
+    }
+}
+
+void TranscodeCache::Remove(EntryMap::iterator it) {
+    const auto entry = it->second;
+    Common::FS::RemoveFile(EntryPath(entry->key));
+    total_size -= entry->size;
+    entries.erase(it);
+    lru.erase(entry);
+}
+
+std::filesystem::path TranscodeCache::EntryPath(const u128& key) const {
+    return directory / fmt::format("{:016x}{:016x}{}", key[1], key[0], ENTRY_EXTENSION);
+}
+
+TranscodeCache* GetTranscodeCache() {
+    if (!Settings::values.use_disk_texture_cache.GetValue()) {
+        return nullptr;
+    }
+    static TranscodeCache cache{Common::FS::GetSuyuPath(Common::FS::SuyuPath::CacheDir) /
+                                "transcoded_textures"};
+    return &cache;
+}
+
+} // namespace VideoCommon
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "common/common_types.h"
+#include "common/thread_worker.h"
+#include "video_core/surface.h"
+#include "video_core/texture_cache/types.h"
+
+namespace VideoCommon {
+
+/// Persistent cache of textures transcoded on the CPU, like decoded or recompressed ASTC and
+/// decompressed BCn textures.
+///
+/// Entries are keyed by a hash of the guest data and the conversion applied to it, each entry is
+/// stored in its own file. Files are written in the background and the least recently used ones
+/// are evicted when the cache grows past the size limit set by the user.
+class TranscodeCache {
+public:
+    explicit TranscodeCache(const std::filesystem::path& directory);
+    ~TranscodeCache();
+
+    TranscodeCache& operator=(const TranscodeCache&) = delete;
+    TranscodeCache(const TranscodeCache&) = delete;
+
+    /// Computes the key of a texture level transcoded from the given guest data
+    [[nodiscard]] static u128 MakeKey(std::span<const u8> guest_data,
+                                      VideoCore::Surface::PixelFormat format,
+                                      const BufferImageCopy& copy);
+
+    /// Reads a transcoded texture level
+    /// @return True on success, false if it's not cached or its size doesn't match the output
+    [[nodiscard]] bool Read(const u128& key, std::span<u8> output);
+
+    /// Queues a transcoded texture level to be written to disk
+    void Write(const u128& key, std::span<const u8> data);
+
+    /// Waits until the cache is loaded and every queued write is done
+    void WaitForRequests();
+
+private:
+    struct Entry {
+        u128 key;
+        u64 size;
+    };
+
+    struct KeyHash {
+        size_t operator()(const u128& key) const noexcept {
+            return static_cast<size_t>(key[0] ^ key[1]);
+        }
+    };
+
+    /// Indexes the files already in the cache, oldest first
+    void BuildIndex();
+
+    using EntryMap = std::unordered_map<u128, std::list<Entry>::iterator, KeyHash>;
+
+    /// Removes the least recently used entries until the cache fits in its size limit
+    void Evict();
+
+    /// Removes an entry from the index and deletes its file
+    void Remove(EntryMap::iterator it);
+
+    [[nodiscard]] std::filesystem::path EntryPath(const u128& key) const;
+
+    std::filesystem::path directory;
+
+    std::mutex mutex;
+    bool is_ready{};
+    std::list<Entry> lru; ///< Entries from most to least recently used
+    EntryMap entries;
+    std::unordered_set<u128, KeyHash> pending; ///< Entries queued to be written
+    u64 total_size{};
+    u64 pending_size{};
+
+    Common::ThreadWorker writer;
+};
+
+/// Returns the shared transcode cache, or nullptr when the disk texture cache is disabled
+[[nodiscard]] TranscodeCache* GetTranscodeCache();
+
+} // namespace VideoCommon
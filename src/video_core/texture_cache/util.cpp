@@ -29,6 +29,7 @@
 #include "video_core/texture_cache/format_lookup_table.h"
 #include "video_core/texture_cache/formatter.h"
 #include "video_core/texture_cache/samples_helper.h"
+#include "video_core/texture_cache/transcode_cache.h"
 #include "video_core/texture_cache/util.h"
 #include "video_core/textures/astc.h"
 #include "video_core/textures/bcn.h"
@@ -914,6 +915,22 @@ void ConvertImage(std::span<const u8> input, const ImageInfo& info, std::span<u8
                   std::span<BufferImageCopy> copies) {
     u32 output_offset = 0;
     Common::ScratchBuffer<u8> decode_scratch;
+    TranscodeCache* const transcode_cache = GetTranscodeCache();
+
+    // Runs the conversion of a level unless its result is already in the disk cache
+    const auto transcode = [&](std::span<const u8> guest_data, std::span<u8> dst,
+                               const BufferImageCopy& copy, auto&& convert) {
+        if (!transcode_cache) {
+            convert();
+            return;
+        }
+        const u128 key = TranscodeCache::MakeKey(guest_data, info.format, copy);
+        if (transcode_cache->Read(key, dst)) {
+            return;
+        }
+        convert();
+        transcode_cache->Write(key, dst);
+    };
 
     const Extent2D tile_size = DefaultBlockSize(info.format);
     for (BufferImageCopy& copy : copies) {
@@ -926,20 +943,25 @@ void ConvertImage(std::span<const u8> input, const ImageInfo& info, std::span<u8
         ASSERT(copy.buffer_image_height == Common::AlignUp(mip_size.height, tile_size.height));
 
         const auto input_offset = input.subspan(copy.buffer_offset);
+        const auto guest_data = input_offset.subspan(0, copy.buffer_size);
         copy.buffer_offset = output_offset;
 
         const auto recompression_setting = Settings::values.astc_recompression.GetValue();
         const bool astc = IsPixelFormatASTC(info.format);
 
         if (astc && recompression_setting == Settings::AstcRecompression::Uncompressed) {
-            Tegra::Texture::ASTC::Decompress(
-                input_offset, copy.image_extent.width, copy.image_extent.height,
-                copy.image_subresource.num_layers * copy.image_extent.depth, tile_size.width,
-                tile_size.height, output.subspan(output_offset));
-
-            output_offset += copy.image_extent.width * copy.image_extent.height *
-                             copy.image_subresource.num_layers *
-                             BytesPerBlock(PixelFormat::A8B8G8R8_UNORM);
+            const u32 plane_size = copy.image_extent.width * copy.image_extent.height *
+                                   copy.image_subresource.num_layers *
+                                   BytesPerBlock(PixelFormat::A8B8G8R8_UNORM);
+            const auto dst = output.subspan(output_offset, plane_size * copy.image_extent.depth);
+            transcode(guest_data, dst, copy, [&] {
+                Tegra::Texture::ASTC::Decompress(
+                    input_offset, copy.image_extent.width, copy.image_extent.height,
+                    copy.image_subresource.num_layers * copy.image_extent.depth, tile_size.width,
+                    tile_size.height, dst);
+            });
+
+            output_offset += plane_size;
         } else if (astc) {
             // BC1 uses 0.5 bytes per texel
             // BC3 uses 1 byte per texel
@@ -948,33 +970,39 @@ void ConvertImage(std::span<const u8> input, const ImageInfo& info, std::span<u8
                                       : Tegra::Texture::BCN::CompressBC3;
             const auto bpp_div = recompression_setting == Settings::AstcRecompression::Bc1 ? 2 : 1;
 
-            const u32 plane_dim = copy.image_extent.width * copy.image_extent.height;
-            const u32 level_size = plane_dim * copy.image_extent.depth *
-                                   copy.image_subresource.num_layers *
-                                   BytesPerBlock(PixelFormat::A8B8G8R8_UNORM);
-            decode_scratch.resize_destructive(level_size);
-
-            Tegra::Texture::ASTC::Decompress(
-                input_offset, copy.image_extent.width, copy.image_extent.height,
-                copy.image_subresource.num_layers * copy.image_extent.depth, tile_size.width,
-                tile_size.height, decode_scratch);
-
-            compress(decode_scratch, copy.image_extent.width, copy.image_extent.height,
-                     copy.image_subresource.num_layers * copy.image_extent.depth,
-                     output.subspan(output_offset));
-
             const u32 aligned_plane_dim = Common::AlignUp(copy.image_extent.width, 4) *
                                           Common::AlignUp(copy.image_extent.height, 4);
-
-            copy.buffer_size =
+            const size_t compressed_size =
                 (aligned_plane_dim * copy.image_extent.depth * copy.image_subresource.num_layers) /
                 bpp_div;
+
+            transcode(guest_data, output.subspan(output_offset, compressed_size), copy, [&] {
+                const u32 plane_dim = copy.image_extent.width * copy.image_extent.height;
+                const u32 level_size = plane_dim * copy.image_extent.depth *
+                                       copy.image_subresource.num_layers *
+                                       BytesPerBlock(PixelFormat::A8B8G8R8_UNORM);
+                decode_scratch.resize_destructive(level_size);
+
+                Tegra::Texture::ASTC::Decompress(
+                    input_offset, copy.image_extent.width, copy.image_extent.height,
+                    copy.image_subresource.num_layers * copy.image_extent.depth, tile_size.width,
+                    tile_size.height, decode_scratch);
+
+                compress(decode_scratch, copy.image_extent.width, copy.image_extent.height,
+                         copy.image_subresource.num_layers * copy.image_extent.depth,
+                         output.subspan(output_offset));
+            });
+
+            copy.buffer_size = compressed_size;
             output_offset += static_cast<u32>(copy.buffer_size);
         } else {
-            DecompressBCn(input_offset, output.subspan(output_offset), copy, info.format);
-            output_offset += copy.image_extent.width * copy.image_extent.height *
-                             copy.image_subresource.num_layers *
-                             ConvertedBytesPerBlock(info.format);
+            const u32 plane_size = copy.image_extent.width * copy.image_extent.height *
+                                   copy.image_subresource.num_layers *
+                                   ConvertedBytesPerBlock(info.format);
+            const auto dst = output.subspan(output_offset, plane_size * copy.image_extent.depth);
+            transcode(guest_data, dst, copy,
+                      [&] { DecompressBCn(input_offset, dst, copy, info.format); });
+            output_offset += plane_size;
         }
 
         copy.buffer_row_length = mip_size.width;
@@ -5,6 +5,7 @@
 // <http://gamma.cs.unc.edu/FasTC/>
 
 #include <algorithm>
+#include <array>
 #include <bit>
 #include <cassert>
 #include <cstring>
@@ -13,6 +14,19 @@
 
 #include <boost/container/static_vector.hpp>
 
+#if defined(ARCHITECTURE_x86_64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#elif defined(ARCHITECTURE_arm64)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wimplicit-int-conversion"
+#include <sse2neon.h>
+#pragma GCC diagnostic pop
+#endif
+
 #include "common/alignment.h"
 #include "common/common_types.h"
 #include "common/polyfill_ranges.h"
@@ -1078,8 +1092,11 @@ static u32 UnquantizeTexelWeight(const IntegerEncodedValue& val) {
 static void UnquantizeTexelWeights(u32 out[2][144], const IntegerEncodedVector& weights,
                                    const TexelWeightParams& params, const u32 blockWidth,
                                    const u32 blockHeight) {
+    // Texels past the end of the weight grid read as zero. The grid is padded so the infill below
+    // can sample it without bounds checks.
+    static constexpr u32 GRID_SIZE = 144 + 2 * 12 + 2;
     u32 weightIdx = 0;
-    u32 unquantized[2][144];
+    u32 unquantized[2][GRID_SIZE];
 
     for (auto itr = weights.begin(); itr != weights.end(); ++itr) {
         unquantized[0][weightIdx] = UnquantizeTexelWeight(*itr);
@@ -1096,50 +1113,44 @@ static void UnquantizeTexelWeights(u32 out[2][144], const IntegerEncodedVector&
             break;
     }
 
+    const u32 kPlaneScale = params.m_bDualPlane ? 2U : 1U;
+    for (u32 plane = 0; plane < kPlaneScale; plane++) {
+        std::fill(std::begin(unquantized[plane]) + weightIdx, std::end(unquantized[plane]), 0U);
+    }
+
     // Do infill if necessary (Section C.2.18) ...
     u32 Ds = (1024 + (blockWidth / 2)) / (blockWidth - 1);
     u32 Dt = (1024 + (blockHeight / 2)) / (blockHeight - 1);
 
-    const u32 kPlaneScale = params.m_bDualPlane ? 2U : 1U;
+    // The grid coordinates are separable, compute them once per column and row
+    std::array<u32, 12> js;
+    std::array<u32, 12> fs;
+    for (u32 s = 0; s < blockWidth; s++) {
+        u32 gs = (Ds * s * (params.m_Width - 1) + 32) >> 6;
+        js[s] = gs >> 4;
+        fs[s] = gs & 0xF;
+    }
+    std::array<u32, 12> jt;
+    std::array<u32, 12> ft;
+    for (u32 t = 0; t < blockHeight; t++) {
+        u32 gt = (Dt * t * (params.m_Height - 1) + 32) >> 6;
+        jt[t] = gt >> 4;
+        ft[t] = gt & 0x0F;
+    }
+
     for (u32 plane = 0; plane < kPlaneScale; plane++)
         for (u32 t = 0; t < blockHeight; t++)
             for (u32 s = 0; s < blockWidth; s++) {
-                u32 cs = Ds * s;
-                u32 ct = Dt * t;
-
-                u32 gs = (cs * (params.m_Width - 1) + 32) >> 6;
-                u32 gt = (ct * (params.m_Height - 1) + 32) >> 6;
-
-                u32 js = gs >> 4;
-                u32 fs = gs & 0xF;
-
-                u32 jt = gt >> 4;
-                u32 ft = gt & 0x0F;
+                u32 w11 = (fs[s] * ft[t] + 8) >> 4;
+                u32 w10 = ft[t] - w11;
+                u32 w01 = fs[s] - w11;
+                u32 w00 = 16 - fs[s] - ft[t] + w11;
 
-                u32 w11 = (fs * ft + 8) >> 4;
-                u32 w10 = ft - w11;
-                u32 w01 = fs - w11;
-                u32 w00 = 16 - fs - ft + w11;
-
-                u32 v0 = js + jt * params.m_Width;
-
-#define FIND_TEXEL(tidx, bidx)                                                                     \
-    u32 p##bidx = 0;                                                                               \
-    do {                                                                                           \
-        if ((tidx) < (params.m_Width * params.m_Height)) {                                         \
-            p##bidx = unquantized[plane][(tidx)];                                                  \
-        }                                                                                          \
-    } while (0)
-
-                FIND_TEXEL(v0, 00);
-                FIND_TEXEL(v0 + 1, 01);
-                FIND_TEXEL(v0 + params.m_Width, 10);
-                FIND_TEXEL(v0 + params.m_Width + 1, 11);
-
-#undef FIND_TEXEL
+                const u32* const p0 = &unquantized[plane][js[s] + jt[t] * params.m_Width];
+                const u32* const p1 = p0 + params.m_Width;
 
                 out[plane][t * blockWidth + s] =
-                    (p00 * w00 + p01 * w01 + p10 * w10 + p11 * w11 + 8) >> 4;
+                    (p0[0] * w00 + p0[1] * w01 + p1[0] * w10 + p1[1] * w11 + 8) >> 4;
             }
 }
 
@@ -1419,6 +1430,81 @@ static void FillError(std::span<u32> outBuf, u32 blockWidth, u32 blockHeight) {
     }
 }
 
+// Interpolates between the endpoints of each texel's partition and converts the result to
+// UNORM8. The conversion is 'trunc(255 * C / 65536 + 0.5)' evaluated exactly in integers.
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_arm64)
+static void InterpolateTexels(std::span<u32, 12 * 12> outBuf, const Pixel (&endpoints)[4][2],
+                              const u32 (&weights)[2][144], u32 partitionIndex, u32 nPartitions,
+                              u32 dualPlaneComponent, u32 blockWidth, u32 blockHeight) {
+    // Lanes hold the A, R, G and B components
+    __m128i low[4];
+    __m128i high[4];
+    for (u32 i = 0; i < nPartitions; i++) {
+        const auto replicate = [&](u32 endpoint, u32 c) {
+            return static_cast<int>(ReplicateByteTo16(endpoints[i][endpoint].Component(c)));
+        };
+        low[i] = _mm_set_epi32(replicate(0, 3), replicate(0, 2), replicate(0, 1), replicate(0, 0));
+        high[i] = _mm_set_epi32(replicate(1, 3), replicate(1, 2), replicate(1, 1), replicate(1, 0));
+    }
+    const __m128i plane_mask = _mm_cmpeq_epi32(_mm_set_epi32(3, 2, 1, 0),
+                                               _mm_set1_epi32(static_cast<int>(dualPlaneComponent)));
+    const u32* const plane1 = dualPlaneComponent < 4 ? weights[1] : weights[0];
+
+    const __m128i max_weight = _mm_set1_epi32(64);
+    const __m128i weight_round = _mm_set1_epi32(32);
+    const __m128i unorm_round = _mm_set1_epi32(32768);
+    // Gathers the low byte of R, G, B and A in that order
+    const __m128i pack_mask = _mm_set_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128,
+                                           -128, -128, -128, 0, 12, 8, 4);
+    const bool smallBlock = (blockHeight * blockWidth) < 32;
+
+    for (u32 j = 0; j < blockHeight; j++)
+        for (u32 i = 0; i < blockWidth; i++) {
+            const u32 partition = Select2DPartition(partitionIndex, i, j, nPartitions, smallBlock);
+            assert(partition < nPartitions);
+
+            const u32 index = j * blockWidth + i;
+            const __m128i weight =
+                _mm_blendv_epi8(_mm_set1_epi32(static_cast<int>(weights[0][index])),
+                                _mm_set1_epi32(static_cast<int>(plane1[index])), plane_mask);
+            const __m128i lerp = _mm_add_epi32(
+                _mm_mullo_epi32(low[partition], _mm_sub_epi32(max_weight, weight)),
+                _mm_mullo_epi32(high[partition], weight));
+            const __m128i color = _mm_srli_epi32(_mm_add_epi32(lerp, weight_round), 6);
+            const __m128i unorm = _mm_srli_epi32(
+                _mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(color, 8), color), unorm_round), 16);
+            outBuf[index] = static_cast<u32>(_mm_cvtsi128_si32(_mm_shuffle_epi8(unorm, pack_mask)));
+        }
+}
+#else
+static void InterpolateTexels(std::span<u32, 12 * 12> outBuf, const Pixel (&endpoints)[4][2],
+                              const u32 (&weights)[2][144], u32 partitionIndex, u32 nPartitions,
+                              u32 dualPlaneComponent, u32 blockWidth, u32 blockHeight) {
+    for (u32 j = 0; j < blockHeight; j++)
+        for (u32 i = 0; i < blockWidth; i++) {
+            u32 partition = Select2DPartition(partitionIndex, i, j, nPartitions,
+                                              (blockHeight * blockWidth) < 32);
+            assert(partition < nPartitions);
+
+            Pixel p;
+            for (u32 c = 0; c < 4; c++) {
+                u32 C0 = endpoints[partition][0].Component(c);
+                C0 = ReplicateByteTo16(C0);
+                u32 C1 = endpoints[partition][1].Component(c);
+                C1 = ReplicateByteTo16(C1);
+
+                u32 plane = c == dualPlaneComponent ? 1 : 0;
+
+                u32 weight = weights[plane][j * blockWidth + i];
+                u32 C = (C0 * (64 - weight) + C1 * weight + 32) / 64;
+                p.Component(c) = static_cast<s16>((C * 255 + 32768) >> 16);
+            }
+
+            outBuf[j * blockWidth + i] = p.Pack();
+        }
+}
+#endif
+
 static void DecompressBlock(std::span<const u8, 16> inBuf, const u32 blockWidth,
                             const u32 blockHeight, std::span<u32, 12 * 12> outBuf) {
     InputBitStream strm(inBuf);
@@ -1619,75 +1705,123 @@ static void DecompressBlock(std::span<const u8, 16> inBuf, const u32 blockWidth,
 
     // Now that we have endpoints and weights, we can interpolate and generate
     // the proper decoding...
-    for (u32 j = 0; j < blockHeight; j++)
-        for (u32 i = 0; i < blockWidth; i++) {
-            u32 partition = Select2DPartition(partitionIndex, i, j, nPartitions,
-                                              (blockHeight * blockWidth) < 32);
-            assert(partition < nPartitions);
+    const u32 dualPlaneComponent = weightParams.m_bDualPlane ? ((planeIdx + 1) & 3) : 4;
+    InterpolateTexels(outBuf, endpoints, weights, partitionIndex, nPartitions, dualPlaneComponent,
+                      blockWidth, blockHeight);
+}
 
-            Pixel p;
-            for (u32 c = 0; c < 4; c++) {
-                u32 C0 = endpoints[partition][0].Component(c);
-                C0 = ReplicateByteTo16(C0);
-                u32 C1 = endpoints[partition][1].Component(c);
-                C1 = ReplicateByteTo16(C1);
+namespace {
+/// Set associative LRU cache of decoded blocks keyed by their bits. Flat areas and repeated
+/// patterns encode to identical blocks, so these are only decoded once per worker thread.
+class DecodedBlockCache {
+public:
+    std::span<const u32, 12 * 12> Decode(std::span<const u8, 16> block, u32 block_width,
+                                         u32 block_height) {
+        std::array<u64, 2> bits;
+        std::memcpy(bits.data(), block.data(), sizeof(bits));
+
+        const u64 hash = (bits[0] ^ (bits[1] * 0x9E3779B97F4A7C15ULL)) * 0xFF51AFD7ED558CCDULL;
+        Set& set = sets[(hash >> 32) % NUM_SETS];
+        for (u32 i = 0; i < NUM_WAYS; ++i) {
+            Entry& entry = set.entries[set.order[i]];
+            if (entry.bits == bits && entry.block_width == block_width &&
+                entry.block_height == block_height) {
+                MarkUsed(set, i);
+                return entry.texels;
+            }
+        }
+        MarkUsed(set, NUM_WAYS - 1);
+        Entry& entry = set.entries[set.order[0]];
+        entry.bits = bits;
+        entry.block_width = block_width;
+        entry.block_height = block_height;
+        DecompressBlock(block, block_width, block_height, entry.texels);
+        return entry.texels;
+    }
 
-                u32 plane = 0;
-                if (weightParams.m_bDualPlane && (((planeIdx + 1) & 3) == c)) {
-                    plane = 1;
-                }
+private:
+    static constexpr u32 NUM_SETS = 16;
+    static constexpr u32 NUM_WAYS = 4;
+
+    struct Entry {
+        std::array<u64, 2> bits{};
+        u32 block_width{};
+        u32 block_height{};
+        std::array<u32, 12 * 12> texels;
+    };
 
-                u32 weight = weights[plane][j * blockWidth + i];
-                u32 C = (C0 * (64 - weight) + C1 * weight + 32) / 64;
-                if (C == 65535) {
-                    p.Component(c) = 255;
-                } else {
-                    double Cf = static_cast<double>(C);
-                    p.Component(c) = static_cast<u16>(255.0 * (Cf / 65536.0) + 0.5);
-                }
-            }
+    struct Set {
+        std::array<Entry, NUM_WAYS> entries;
+        std::array<u8, NUM_WAYS> order{0, 1, 2, 3}; ///< Ways from most to least recently used
+    };
 
-            outBuf[j * blockWidth + i] = p.Pack();
+    static void MarkUsed(Set& set, u32 position) {
+        std::rotate(set.order.begin(), set.order.begin() + position,
+                    set.order.begin() + position + 1);
+    }
+
+    std::array<Set, NUM_SETS> sets;
+};
+
+/// Number of blocks decoded by a single job
+constexpr u32 BLOCKS_PER_TILE = 512;
+
+void DecompressRows(std::span<const u8> data, u32 width, u32 height, u32 block_width,
+                    u32 block_height, std::span<u8> output, u32 rows, u32 cols, u32 first_row,
+                    u32 last_row) {
+    thread_local DecodedBlockCache cache;
+
+    for (u32 row = first_row; row < last_row; ++row) {
+        const u32 z = row / rows;
+        const u32 y_index = row % rows;
+        const u32 depth_offset = z * height * width * 4;
+        const u32 y = y_index * block_height;
+        for (u32 x_index = 0; x_index < cols; ++x_index) {
+            const u32 block_index = row * cols + x_index;
+            const u32 x = x_index * block_width;
+
+            const std::span<const u8, 16> blockPtr{data.subspan(block_index * 16, 16)};
+            const std::span<const u32, 12 * 12> uncompData{
+                cache.Decode(blockPtr, block_width, block_height)};
+
+            u32 decompWidth = std::min(block_width, width - x);
+            u32 decompHeight = std::min(block_height, height - y);
+
+            const std::span<u8> outRow = output.subspan(depth_offset + (y * width + x) * 4);
+            for (u32 h = 0; h < decompHeight; ++h) {
+                std::memcpy(outRow.data() + h * width * 4, uncompData.data() + h * block_width,
+                            decompWidth * 4);
+            }
         }
+    }
 }
+} // Anonymous namespace
 
 void Decompress(std::span<const uint8_t> data, uint32_t width, uint32_t height, uint32_t depth,
                 uint32_t block_width, uint32_t block_height, std::span<uint8_t> output) {
     const u32 rows = Common::DivideUp(height, block_height);
     const u32 cols = Common::DivideUp(width, block_width);
+    const u32 total_rows = rows * depth;
+
+    // Split the texture in tiles of whole block rows, spanning every slice, so small textures
+    // aren't dominated by scheduling overhead and large ones keep every worker busy.
+    const u32 rows_per_tile = Common::DivideUp(BLOCKS_PER_TILE, cols);
+    if (rows_per_tile >= total_rows) {
+        DecompressRows(data, width, height, block_width, block_height, output, rows, cols, 0,
+                       total_rows);
+        return;
+    }
 
     Common::ThreadWorker& workers{GetThreadWorkers()};
-
-    for (u32 z = 0; z < depth; ++z) {
-        const u32 depth_offset = z * height * width * 4;
-        for (u32 y_index = 0; y_index < rows; ++y_index) {
-            auto decompress_stride = [data, width, height, block_width, block_height, output, rows,
-                                      cols, z, depth_offset, y_index] {
-                const u32 y = y_index * block_height;
-                for (u32 x_index = 0; x_index < cols; ++x_index) {
-                    const u32 block_index = (z * rows * cols) + (y_index * cols) + x_index;
-                    const u32 x = x_index * block_width;
-
-                    const std::span<const u8, 16> blockPtr{data.subspan(block_index * 16, 16)};
-
-                    // Blocks can be at most 12x12
-                    std::array<u32, 12 * 12> uncompData;
-                    DecompressBlock(blockPtr, block_width, block_height, uncompData);
-
-                    u32 decompWidth = std::min(block_width, width - x);
-                    u32 decompHeight = std::min(block_height, height - y);
-
-                    const std::span<u8> outRow = output.subspan(depth_offset + (y * width + x) * 4);
-                    for (u32 h = 0; h < decompHeight; ++h) {
-                        std::memcpy(outRow.data() + h * width * 4,
-                                    uncompData.data() + h * block_width, decompWidth * 4);
-                    }
-                }
-            };
-            workers.QueueWork(std::move(decompress_stride));
-        }
-        workers.WaitForRequests();
-    }
+    for (u32 first_row = 0; first_row < total_rows; first_row += rows_per_tile) {
+        const u32 last_row = std::min(first_row + rows_per_tile, total_rows);
+        workers.QueueWork([data, width, height, block_width, block_height, output, rows, cols,
+                           first_row, last_row] {
+            DecompressRows(data, width, height, block_width, block_height, output, rows, cols,
+                           first_row, last_row);
+        });
+    }
+    workers.WaitForRequests();
 }
 
 } // namespace Tegra::Texture::ASTC
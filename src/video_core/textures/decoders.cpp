@@ -12,6 +12,7 @@
 #include "common/div_ceil.h"
 #include "video_core/gpu.h"
 #include "video_core/textures/decoders.h"
+#include "video_core/textures/gob_kernels.h"
 
 namespace Tegra::Texture {
 namespace {
@@ -33,6 +34,94 @@ void incrpdep(u32& value) {
     value = ((value | ~mask) + swizzled_incr) & mask;
 }
 
+/// Swizzles or unswizzles the columns [column_begin, column_end) of a single line
+template <bool TO_LINEAR, u32 BYTES_PER_PIXEL>
+void SwizzleLine(std::span<u8> output, std::span<const u8> input, u32 y, u32 offset_yz,
+                 u32 unswizzled_line_offset, u32 origin_x, u32 column_begin, u32 column_end,
+                 u32 x_shift) {
+    const u32 swizzled_y = pdep<SWIZZLE_Y_BITS>(y);
+
+    u32 swizzled_x = pdep<SWIZZLE_X_BITS>((origin_x + column_begin) * BYTES_PER_PIXEL);
+    for (u32 column = column_begin; column < column_end;
+         ++column, incrpdep<SWIZZLE_X_BITS, BYTES_PER_PIXEL>(swizzled_x)) {
+        const u32 x = (column + origin_x) * BYTES_PER_PIXEL;
+        const u32 offset_x = (x >> GOB_SIZE_X_SHIFT) << x_shift;
+
+        const u32 base_swizzled_offset = offset_yz + offset_x;
+        const u32 swizzled_offset = base_swizzled_offset + (swizzled_x | swizzled_y);
+
+        const u32 unswizzled_offset = unswizzled_line_offset + column * BYTES_PER_PIXEL;
+
+        u8* const dst = &output[TO_LINEAR ? swizzled_offset : unswizzled_offset];
+        const u8* const src = &input[TO_LINEAR ? unswizzled_offset : swizzled_offset];
+
+        std::memcpy(dst, src, BYTES_PER_PIXEL);
+    }
+}
+
+/// Swizzles or unswizzles 'num_lines' lines of a slice. Areas covering whole GOBs are copied with
+/// the GOB kernels of the host, the remaining edges are copied a pixel at a time.
+template <bool TO_LINEAR, u32 BYTES_PER_PIXEL>
+void SwizzleSlice(std::span<u8> output, std::span<const u8> input, u32 offset_z,
+                  u32 unswizzled_slice_offset, u32 pitch, u32 origin_x, u32 origin_y, u32 extent_x,
+                  u32 num_lines, u32 block_height, u32 block_size, u32 x_shift) {
+    const u32 block_height_mask = (1U << block_height) - 1;
+
+    // Range of columns, relative to origin_x, made of whole GOBs
+    u32 gob_begin = extent_x;
+    u32 gob_end = extent_x;
+    if constexpr (GOB_SIZE_X % BYTES_PER_PIXEL == 0) {
+        static constexpr u32 gob_columns = GOB_SIZE_X / BYTES_PER_PIXEL;
+        const u32 first = Common::AlignUp(origin_x, gob_columns) - origin_x;
+        const u32 last = Common::AlignDown(origin_x + extent_x, gob_columns) - origin_x;
+        if (first < last && last <= extent_x) {
+            gob_begin = first;
+            gob_end = last;
+        }
+    }
+    const GobKernels& kernels = GetGobKernels(GetHostGobKernelLevel());
+
+    u32 line = 0;
+    while (line < num_lines) {
+        const u32 y = line + origin_y;
+        const u32 block_y = y >> GOB_SIZE_Y_SHIFT;
+        const u32 offset_y = (block_y >> block_height) * block_size +
+                             ((block_y & block_height_mask) << GOB_SIZE_SHIFT);
+        const u32 offset_yz = offset_z + offset_y;
+
+        const bool is_gob_row = gob_begin < gob_end && (y & (GOB_SIZE_Y - 1)) == 0 &&
+                                num_lines - line >= GOB_SIZE_Y;
+        if (!is_gob_row) {
+            SwizzleLine<TO_LINEAR, BYTES_PER_PIXEL>(output, input, y, offset_yz,
+                                                    unswizzled_slice_offset + line * pitch,
+                                                    origin_x, 0, extent_x, x_shift);
+            ++line;
+            continue;
+        }
+        for (u32 gob_line = 0; gob_line < GOB_SIZE_Y; ++gob_line) {
+            const u32 unswizzled_line_offset = unswizzled_slice_offset + (line + gob_line) * pitch;
+            SwizzleLine<TO_LINEAR, BYTES_PER_PIXEL>(output, input, y + gob_line, offset_yz,
+                                                    unswizzled_line_offset, origin_x, 0, gob_begin,
+                                                    x_shift);
+            SwizzleLine<TO_LINEAR, BYTES_PER_PIXEL>(output, input, y + gob_line, offset_yz,
+                                                    unswizzled_line_offset, origin_x, gob_end,
+                                                    extent_x, x_shift);
+        }
+        for (u32 column = gob_begin; column < gob_end; column += GOB_SIZE_X / BYTES_PER_PIXEL) {
+            const u32 x = (column + origin_x) * BYTES_PER_PIXEL;
+            const u32 swizzled_offset = offset_yz + ((x >> GOB_SIZE_X_SHIFT) << x_shift);
+            const u32 unswizzled_offset =
+                unswizzled_slice_offset + line * pitch + column * BYTES_PER_PIXEL;
+            if constexpr (TO_LINEAR) {
+                kernels.swizzle(&output[swizzled_offset], &input[unswizzled_offset], pitch);
+            } else {
+                kernels.unswizzle(&output[unswizzled_offset], pitch, &input[swizzled_offset]);
+            }
+        }
+        line += GOB_SIZE_Y;
+    }
+}
+
 template <bool TO_LINEAR, u32 BYTES_PER_PIXEL>
 void SwizzleImpl(std::span<u8> output, std::span<const u8> input, u32 width, u32 height, u32 depth,
                  u32 block_height, u32 block_depth, u32 stride) {
@@ -51,7 +140,6 @@ void SwizzleImpl(std::span<u8> output, std::span<const u8> input, u32 width, u32
     const u32 slice_size =
         Common::DivCeilLog2(height, block_height + GOB_SIZE_Y_SHIFT) * block_size;
 
-    const u32 block_height_mask = (1U << block_height) - 1;
     const u32 block_depth_mask = (1U << block_depth) - 1;
     const u32 x_shift = GOB_SIZE_SHIFT + block_height + block_depth;
 
@@ -59,32 +147,9 @@ void SwizzleImpl(std::span<u8> output, std::span<const u8> input, u32 width, u32
         const u32 z = slice + origin_z;
         const u32 offset_z = (z >> block_depth) * slice_size +
                              ((z & block_depth_mask) << (GOB_SIZE_SHIFT + block_height));
-        for (u32 line = 0; line < height; ++line) {
-            const u32 y = line + origin_y;
-            const u32 swizzled_y = pdep<SWIZZLE_Y_BITS>(y);
-
-            const u32 block_y = y >> GOB_SIZE_Y_SHIFT;
-            const u32 offset_y = (block_y >> block_height) * block_size +
-                                 ((block_y & block_height_mask) << GOB_SIZE_SHIFT);
-
-            u32 swizzled_x = pdep<SWIZZLE_X_BITS>(origin_x * BYTES_PER_PIXEL);
-            for (u32 column = 0; column < width;
-                 ++column, incrpdep<SWIZZLE_X_BITS, BYTES_PER_PIXEL>(swizzled_x)) {
-                const u32 x = (column + origin_x) * BYTES_PER_PIXEL;
-                const u32 offset_x = (x >> GOB_SIZE_X_SHIFT) << x_shift;
-
-                const u32 base_swizzled_offset = offset_z + offset_y + offset_x;
-                const u32 swizzled_offset = base_swizzled_offset + (swizzled_x | swizzled_y);
-
-                const u32 unswizzled_offset =
-                    slice * pitch * height + line * pitch + column * BYTES_PER_PIXEL;
-
-                u8* const dst = &output[TO_LINEAR ? swizzled_offset : unswizzled_offset];
-                const u8* const src = &input[TO_LINEAR ? unswizzled_offset : swizzled_offset];
-
-                std::memcpy(dst, src, BYTES_PER_PIXEL);
-            }
-        }
+        SwizzleSlice<TO_LINEAR, BYTES_PER_PIXEL>(output, input, offset_z, slice * pitch * height,
+                                                 pitch, origin_x, origin_y, width, height,
+                                                 block_height, block_size, x_shift);
     }
 }
 
@@ -106,7 +171,6 @@ void SwizzleSubrectImpl(std::span<u8> output, std::span<const u8> input, u32 wid
     const u32 slice_size =
         Common::DivCeilLog2(height, block_height + GOB_SIZE_Y_SHIFT) * block_size;
 
-    const u32 block_height_mask = (1U << block_height) - 1;
     const u32 block_depth_mask = (1U << block_depth) - 1;
     const u32 x_shift = GOB_SIZE_SHIFT + block_height + block_depth;
 
@@ -118,32 +182,9 @@ void SwizzleSubrectImpl(std::span<u8> output, std::span<const u8> input, u32 wid
         const u32 offset_z = (z >> block_depth) * slice_size +
                              ((z & block_depth_mask) << (GOB_SIZE_SHIFT + block_height));
         const u32 lines_in_y = std::min(unprocessed_lines, extent_y);
-        for (u32 line = 0; line < lines_in_y; ++line) {
-            const u32 y = line + origin_y;
-            const u32 swizzled_y = pdep<SWIZZLE_Y_BITS>(y);
-
-            const u32 block_y = y >> GOB_SIZE_Y_SHIFT;
-            const u32 offset_y = (block_y >> block_height) * block_size +
-                                 ((block_y & block_height_mask) << GOB_SIZE_SHIFT);
-
-            u32 swizzled_x = pdep<SWIZZLE_X_BITS>(origin_x * BYTES_PER_PIXEL);
-            for (u32 column = 0; column < extent_x;
-                 ++column, incrpdep<SWIZZLE_X_BITS, BYTES_PER_PIXEL>(swizzled_x)) {
-                const u32 x = (column + origin_x) * BYTES_PER_PIXEL;
-                const u32 offset_x = (x >> GOB_SIZE_X_SHIFT) << x_shift;
-
-                const u32 base_swizzled_offset = offset_z + offset_y + offset_x;
-                const u32 swizzled_offset = base_swizzled_offset + (swizzled_x | swizzled_y);
-
-                const u32 unswizzled_offset =
-                    slice * pitch * height + line * pitch + column * BYTES_PER_PIXEL;
-
-                u8* const dst = &output[TO_LINEAR ? swizzled_offset : unswizzled_offset];
-                const u8* const src = &input[TO_LINEAR ? unswizzled_offset : swizzled_offset];
-
-                std::memcpy(dst, src, BYTES_PER_PIXEL);
-            }
-        }
+        SwizzleSlice<TO_LINEAR, BYTES_PER_PIXEL>(output, input, offset_z, slice * pitch * height,
+                                                 pitch, origin_x, origin_y, extent_x, lines_in_y,
+                                                 block_height, block_size, x_shift);
         unprocessed_lines -= lines_in_y;
         if (unprocessed_lines == 0) {
             return;
@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+
+#if defined(ARCHITECTURE_x86_64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#elif defined(ARCHITECTURE_arm64)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wimplicit-int-conversion"
+#include <sse2neon.h>
+#pragma GCC diagnostic pop
+#endif
+
+#include "video_core/textures/gob_kernels.h"
+
+#if defined(ARCHITECTURE_x86_64)
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Tegra::Texture {
+namespace {
+// A GOB is made of 16 byte sectors. The sector holding line 'y' and 16 byte column 'c' is at:
+//   (c / 2) * 256 + (y / 2) * 64 + (c % 2) * 32 + (y % 2) * 16
+constexpr u32 SectorOffset(u32 line, u32 column) {
+    return (column / 2) * 256 + (line / 2) * 64 + (column % 2) * 32 + (line % 2) * 16;
+}
+
+namespace Generic {
+void UnswizzleGob(u8* linear, u32 pitch, const u8* gob) {
+    for (u32 line = 0; line < 8; ++line) {
+        for (u32 column = 0; column < 4; ++column) {
+            std::memcpy(linear + line * pitch + column * 16, gob + SectorOffset(line, column), 16);
+        }
+    }
+}
+
+void SwizzleGob(u8* gob, const u8* linear, u32 pitch) {
+    for (u32 line = 0; line < 8; ++line) {
+        for (u32 column = 0; column < 4; ++column) {
+            std::memcpy(gob + SectorOffset(line, column), linear + line * pitch + column * 16, 16);
+        }
+    }
+}
+} // namespace Generic
+
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_arm64)
+namespace SSE {
+void UnswizzleGob(u8* linear, u32 pitch, const u8* gob) {
+    for (u32 line = 0; line < 8; ++line) {
+        u8* const dst = linear + line * pitch;
+        const __m128i s0 = _mm_loadu_si128((const __m128i*)(gob + SectorOffset(line, 0)));
+        const __m128i s1 = _mm_loadu_si128((const __m128i*)(gob + SectorOffset(line, 1)));
+        const __m128i s2 = _mm_loadu_si128((const __m128i*)(gob + SectorOffset(line, 2)));
+        const __m128i s3 = _mm_loadu_si128((const __m128i*)(gob + SectorOffset(line, 3)));
+        _mm_storeu_si128((__m128i*)(dst + 0), s0);
+        _mm_storeu_si128((__m128i*)(dst + 16), s1);
+        _mm_storeu_si128((__m128i*)(dst + 32), s2);
+        _mm_storeu_si128((__m128i*)(dst + 48), s3);
+    }
+}
+
+void SwizzleGob(u8* gob, const u8* linear, u32 pitch) {
+    for (u32 line = 0; line < 8; ++line) {
+        const u8* const src = linear + line * pitch;
+        const __m128i s0 = _mm_loadu_si128((const __m128i*)(src + 0));
+        const __m128i s1 = _mm_loadu_si128((const __m128i*)(src + 16));
+        const __m128i s2 = _mm_loadu_si128((const __m128i*)(src + 32));
+        const __m128i s3 = _mm_loadu_si128((const __m128i*)(src + 48));
+        _mm_storeu_si128((__m128i*)(gob + SectorOffset(line, 0)), s0);
+        _mm_storeu_si128((__m128i*)(gob + SectorOffset(line, 1)), s1);
+        _mm_storeu_si128((__m128i*)(gob + SectorOffset(line, 2)), s2);
+        _mm_storeu_si128((__m128i*)(gob + SectorOffset(line, 3)), s3);
+    }
+}
+} // namespace SSE
+#endif
+
+constexpr GobKernels GENERIC_KERNELS{
+    .unswizzle = &Generic::UnswizzleGob,
+    .swizzle = &Generic::SwizzleGob,
+};
+
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_arm64)
+constexpr GobKernels SSE_KERNELS{
+    .unswizzle = &SSE::UnswizzleGob,
+    .swizzle = &SSE::SwizzleGob,
+};
+#endif
+
+#if defined(ARCHITECTURE_x86_64)
+constexpr GobKernels AVX2_KERNELS{
+    .unswizzle = &AVX2::UnswizzleGob,
+    .swizzle = &AVX2::SwizzleGob,
+};
+#endif
+} // Anonymous namespace
+
+const GobKernels& GetGobKernels(GobKernelLevel level) {
+    switch (level) {
+    case GobKernelLevel::AVX2:
+#if defined(ARCHITECTURE_x86_64)
+        return AVX2_KERNELS;
+#endif
+        [[fallthrough]];
+    case GobKernelLevel::SSE:
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_arm64)
+        return SSE_KERNELS;
+#endif
+        [[fallthrough]];
+    case GobKernelLevel::Generic:
+        break;
+    }
+    return GENERIC_KERNELS;
+}
+
+GobKernelLevel GetHostGobKernelLevel() {
+#if defined(ARCHITECTURE_x86_64)
+    static const bool has_avx2 = Common::GetCPUCaps().avx2;
+    return has_avx2 ? GobKernelLevel::AVX2 : GobKernelLevel::SSE;
+#elif defined(ARCHITECTURE_arm64)
+    return GobKernelLevel::SSE;
+#else
+    return GobKernelLevel::Generic;
+#endif
+}
+
+} // namespace Tegra::Texture
@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace Tegra::Texture {
+
+/// Copies a whole GOB (64 bytes x 8 lines) from block linear memory into a pitch linear surface
+using UnswizzleGobFn = void (*)(u8* linear, u32 pitch, const u8* gob);
+
+/// Copies 64 bytes x 8 lines of a pitch linear surface into a whole block linear GOB
+using SwizzleGobFn = void (*)(u8* gob, const u8* linear, u32 pitch);
+
+struct GobKernels {
+    UnswizzleGobFn unswizzle;
+    SwizzleGobFn swizzle;
+};
+
+enum class GobKernelLevel {
+    Generic,
+    SSE,
+    AVX2,
+};
+
+/// Returns the GOB copy kernels for the given instruction set level
+[[nodiscard]] const GobKernels& GetGobKernels(GobKernelLevel level);
+
+/// Returns the best GOB kernel level supported by the host CPU
+[[nodiscard]] GobKernelLevel GetHostGobKernelLevel();
+
+#if defined(ARCHITECTURE_x86_64)
+namespace AVX2 {
+void UnswizzleGob(u8* linear, u32 pitch, const u8* gob);
+void SwizzleGob(u8* gob, const u8* linear, u32 pitch);
+} // namespace AVX2
+#endif
+
+} // namespace Tegra::Texture
@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: Copyright 2024 suyu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// This file is compiled with AVX2 enabled, it must only be called after checking the host CPU.
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+#include "video_core/textures/gob_kernels.h"
+
+namespace Tegra::Texture::AVX2 {
+
+// Inside a GOB, the 16 byte sectors at the same x of two consecutive even/odd lines are adjacent.
+// Each 32 byte block linear access therefore maps to two 16 byte accesses of the linear surface.
+// The offset of the sector pair for line pair 'p' and 16 byte column 'c' is:
+//   (c / 2) * 256 + p * 64 + (c % 2) * 32
+
+void UnswizzleGob(u8* linear, u32 pitch, const u8* gob) {
+    for (u32 pair = 0; pair < 4; ++pair) {
+        u8* const line0 = linear + (pair * 2) * pitch;
+        u8* const line1 = line0 + pitch;
+        for (u32 column = 0; column < 4; ++column) {
+            const u32 offset = (column / 2) * 256 + pair * 64 + (column % 2) * 32;
+            const __m256i sectors =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(gob + offset));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(line0 + column * 16),
+                             _mm256_castsi256_si128(sectors));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(line1 + column * 16),
+                             _mm256_extracti128_si256(sectors, 1));
+        }
+    }
+}
+
+void SwizzleGob(u8* gob, const u8* linear, u32 pitch) {
+    for (u32 pair = 0; pair < 4; ++pair) {
+        const u8* const line0 = linear + (pair * 2) * pitch;
+        const u8* const line1 = line0 + pitch;
+        for (u32 column = 0; column < 4; ++column) {
+            const u32 offset = (column / 2) * 256 + pair * 64 + (column % 2) * 32;
+            const __m128i low =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(line0 + column * 16));
+            const __m128i high =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(line1 + column * 16));
+            const __m256i sectors = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(gob + offset), sectors);
+        }
+    }
+}
+
+} // namespace Tegra::Texture::AVX2
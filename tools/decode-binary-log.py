@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+
+# SPDX-FileCopyrightText: 2024 suyu Emulator Project
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""Turns a binary log (suyu_log.bin, written when log_binary is enabled) back into text.
+
+The layout is documented at BinaryFileBackend in src/common/logging/backend.cpp and the argument
+packing at WriteArg in src/common/logging/deferred.h. Messages are formatted with Python's format
+mini-language, which matches the fmt specifications used by the log calls.
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"SUYULOG\0"
+VERSION = 1
+
+RECORD_STRING, RECORD_TEXT, RECORD_MESSAGE = range(3)
+
+ARG_BOOL, ARG_CHAR, ARG_SIGNED, ARG_UNSIGNED, ARG_FLOAT32, ARG_FLOAT64, ARG_STRING, ARG_POINTER = \
+    range(8)
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def at_end(self):
+        return self.offset >= len(self.data)
+
+    def unpack(self, fmt):
+        values = struct.unpack_from("<" + fmt, self.data, self.offset)
+        self.offset += struct.calcsize("<" + fmt)
+        return values if len(values) > 1 else values[0]
+
+    def bytes(self, size):
+        value = self.data[self.offset:self.offset + size]
+        if len(value) != size:
+            raise EOFError("truncated record")
+        self.offset += size
+        return value
+
+    def string(self):
+        return self.bytes(self.unpack("I")).decode("utf-8", errors="replace")
+
+
+def read_args(reader, count):
+    args = []
+    for _ in range(count):
+        kind = reader.unpack("B")
+        if kind == ARG_BOOL:
+            args.append((kind, reader.unpack("B") != 0))
+        elif kind == ARG_CHAR:
+            args.append((kind, chr(reader.unpack("B"))))
+        elif kind == ARG_SIGNED:
+            args.append((kind, reader.unpack("q")))
+        elif kind == ARG_UNSIGNED or kind == ARG_POINTER:
+            args.append((kind, reader.unpack("Q")))
+        elif kind == ARG_FLOAT32:
+            args.append((kind, reader.unpack("f")))
+        elif kind == ARG_FLOAT64:
+            args.append((kind, reader.unpack("d")))
+        elif kind == ARG_STRING:
+            args.append((kind, reader.string()))
+        else:
+            raise ValueError(f"unknown argument type {kind}")
+    return args
+
+
+def shortest_float(value, is_float32):
+    """Formats like fmt's default, the shortest representation that round-trips."""
+    if value != value or value in (float("inf"), float("-inf")):
+        return {"nan": "nan", "inf": "inf", "-inf": "-inf"}[repr(value)]
+    if is_float32:
+        bits = struct.pack("<f", value)
+        for precision in range(1, 10):
+            text = "%.*g" % (precision, value)
+            if struct.pack("<f", float(text)) == bits:
+                value = float(text)
+                break
+    text = repr(value)
+    if text.endswith(".0"):
+        text = text[:-2]
+    return text
+
+
+def format_arg(kind, value, spec):
+    presentation = spec[-1:] if spec[-1:].isalpha() else ""
+    if kind == ARG_BOOL:
+        if presentation in ("", "s"):
+            return format("true" if value else "false", spec[:len(spec) - len(presentation)])
+        value = int(value)
+    elif kind == ARG_CHAR:
+        if presentation in ("", "c"):
+            return format(value, spec[:len(spec) - len(presentation)])
+        value = ord(value)
+    elif kind == ARG_POINTER:
+        return format(hex(value), spec[:len(spec) - len(presentation)])
+    elif kind in (ARG_FLOAT32, ARG_FLOAT64) and spec == "":
+        return shortest_float(value, kind == ARG_FLOAT32)
+
+    if presentation == "B":
+        return format(value, spec[:-1] + "b").replace("0b", "0B")
+    if presentation == "L":
+        spec = spec[:-1]
+    return format(value, spec)
+
+
+def format_message(fmt, args):
+    out = []
+    next_arg = 0
+    index = 0
+    while index < len(fmt):
+        char = fmt[index]
+        if char == "}":
+            out.append("}")
+            index += 2 if fmt.startswith("}}", index) else 1
+            continue
+        if char != "{":
+            out.append(char)
+            index += 1
+            continue
+        if fmt.startswith("{{", index):
+            out.append("{")
+            index += 2
+            continue
+
+        # Find the end of the replacement field, specs may contain nested fields
+        depth = 0
+        end = index
+        while end < len(fmt):
+            if fmt[end] == "{":
+                depth += 1
+            elif fmt[end] == "}":
+                depth -= 1
+                if depth == 0:
+                    break
+            end += 1
+        field = fmt[index + 1:end]
+        index = end + 1
+
+        arg_id, _, spec = field.partition(":")
+        if arg_id:
+            arg = args[int(arg_id)]
+        else:
+            arg = args[next_arg]
+            next_arg += 1
+        # Resolve dynamic width and precision
+        while "{" in spec:
+            start = spec.index("{")
+            stop = spec.index("}", start)
+            nested_id = spec[start + 1:stop]
+            if nested_id:
+                nested = args[int(nested_id)][1]
+            else:
+                nested = args[next_arg][1]
+                next_arg += 1
+            spec = spec[:start] + str(nested) + spec[stop + 1:]
+        out.append(format_arg(arg[0], arg[1], spec))
+    return "".join(out)
+
+
+def format_line(timestamp, class_name, level_name, filename, function, line_num, message):
+    return "[{:4d}.{:06d}] {} <{}> {}:{}:{}: {}".format(
+        timestamp // 1000000, timestamp % 1000000, class_name, level_name, filename, function,
+        line_num, message)
+
+
+def decode(data, output):
+    reader = Reader(data)
+    if reader.bytes(len(MAGIC)) != MAGIC:
+        raise ValueError("not a binary log")
+    version = reader.unpack("I")
+    if version != VERSION:
+        raise ValueError(f"unsupported binary log version {version}")
+    class_names = [reader.string() for _ in range(reader.unpack("I"))]
+    level_names = [reader.string() for _ in range(reader.unpack("I"))]
+
+    strings = {}
+    while not reader.at_end():
+        kind = reader.unpack("B")
+        if kind == RECORD_STRING:
+            string_id = reader.unpack("I")
+            strings[string_id] = reader.string()
+            continue
+
+        timestamp, log_class, log_level, line_num, filename_id, function_id = \
+            reader.unpack("qBBIII")
+        if kind == RECORD_TEXT:
+            message = reader.string()
+        elif kind == RECORD_MESSAGE:
+            format_id, num_args, args_size = reader.unpack("III")
+            args = read_args(Reader(reader.bytes(args_size)), num_args)
+            fmt = strings[format_id]
+            try:
+                message = format_message(fmt, args)
+            except (IndexError, ValueError) as e:
+                message = f"{fmt} (format error: {e})"
+        else:
+            raise ValueError(f"unknown record kind {kind}")
+
+        output.write(format_line(timestamp, class_names[log_class], level_names[log_level],
+                                 strings[filename_id], strings[function_id], line_num,
+                                 message))
+        output.write("\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decodes a suyu binary log into text.")
+    parser.add_argument("log", help="path to suyu_log.bin")
+    parser.add_argument("-o", "--output", help="write the text log here instead of stdout")
+    args = parser.parse_args()
+
+    with open(args.log, "rb") as log:
+        data = log.read()
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as output:
+            decode(data, output)
+    else:
+        decode(data, sys.stdout)
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except (EOFError, struct.error):
+        # A log that was cut off by a crash still decodes up to the last complete record
+        sys.exit(0)